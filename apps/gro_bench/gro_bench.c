@@ -0,0 +1,248 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fsl_types.h"
+#include "fsl_stdio.h"
+#include "fsl_dpni_drv.h"
+#include "fsl_parser.h"
+#include "fsl_fdma.h"
+#include "fsl_cdma.h"
+#include "fsl_tman.h"
+#include "fsl_malloc.h"
+#include "fsl_platform.h"
+#include "fsl_dbg.h"
+#include "fsl_evmng.h"
+#include "fsl_gro.h"
+#include "gro_bench.h"
+
+#define AIOP_APP_NAME		"GRO_BENCH"
+
+/* Flows of the GRO flow table */
+#define GRO_BENCH_FLOWS		64
+/* Timers of the GRO TMAN instance (one per open aggregation) */
+#define GRO_BENCH_TIMERS	64
+/* Segments received by a core between two reports */
+#define GRO_BENCH_REPORT_SEGS	4096
+/* Aggregation timeout, in 100 usec units */
+#define GRO_BENCH_TIMEOUT	50
+
+static struct tcp_gro_flow_table gro_bench_table;
+static struct tcp_gro_context_params gro_bench_params;
+static uint64_t gro_bench_tmi_addr;
+static uint64_t gro_bench_stats_addr;
+/* Segments per core, updated without task switch */
+static uint32_t gro_bench_core_segs[INTG_MAX_NUM_OF_CORES];
+
+static void gro_bench_send(uint16_t ni, uint32_t flags)
+{
+	int err = dpni_drv_send(ni, flags);
+
+	if (err == -ENOMEM)
+		fdma_discard_default_frame(FDMA_DIS_NO_FLAGS);
+	else if (err) /* (err == -EBUSY) */
+		ARCH_FDMA_DISCARD_FD();
+}
+
+/* Prints the flow table statistics and the GRO context DMA per segment */
+static void gro_bench_report(void)
+{
+	struct tcp_gro_flow_stats stats;
+#ifdef GRO_CTX_DMA_STATS
+	uint64_t bytes = tcp_gro_get_ctx_dma_bytes();
+#endif
+
+	tcp_gro_flow_table_get_stats(&gro_bench_table, &stats);
+	fsl_print("%s : segments %d packets %d ratio %d.%02d\n",
+		  AIOP_APP_NAME, stats.seg_num, stats.pkt_num,
+		  stats.agg_ratio / 100, stats.agg_ratio % 100);
+	fsl_print("%s : flows hit %d miss %d evicted %d bypassed %d\n",
+		  AIOP_APP_NAME, stats.hits, stats.misses, stats.evictions,
+		  stats.bypassed);
+#ifdef GRO_CTX_DMA_STATS
+	if (stats.seg_num)
+		fsl_print("%s : GRO context DMA %d bytes/segment "
+			  "(full context read-modify-write: %d bytes)\n",
+			  AIOP_APP_NAME,
+			  (uint32_t)(bytes / stats.seg_num),
+			  2 * TCP_GRO_CONTEXT_SIZE);
+#endif
+}
+
+/* Aggregation timeout: the aggregated frame is the default frame */
+static void gro_bench_timeout_cb(uint64_t arg)
+{
+	gro_bench_send((uint16_t)arg, DPNI_DRV_SEND_FLAGS);
+	fdma_terminate_task();
+}
+
+/* Performs frames processing */
+__HOT_CODE ENTRY_POINT static void app_gro_bench(void)
+{
+	struct tcp_gro_context_params params;
+	uint64_t gro_ctx;
+	uint16_t ni;
+	int status;
+
+	sl_prolog();
+
+	ni = (uint16_t)task_get_receive_niid();
+	if (!PARSER_IS_TCP_DEFAULT()) {
+		gro_bench_send(ni, DPNI_DRV_SEND_FLAGS);
+		fdma_terminate_task();
+	}
+
+	params = gro_bench_params;
+	params.timeout_params.gro_timeout_cb_arg = ni;
+	status = tcp_gro_flow_aggregate_seg(&gro_bench_table, ni, &params,
+					    TCP_GRO_CALCULATE_TCP_CHECKSUM |
+					    TCP_GRO_CALCULATE_IP_CHECKSUM,
+					    &gro_ctx);
+	if (status < 0) {
+		fdma_discard_default_frame(FDMA_DIS_NO_FLAGS);
+		fdma_terminate_task();
+	}
+
+	if ((++gro_bench_core_segs[core_get_id()] %
+			GRO_BENCH_REPORT_SEGS) == 0)
+		gro_bench_report();
+
+	if (((status & TCP_GRO_SEG_AGG_DONE) == TCP_GRO_SEG_AGG_DONE) ||
+	    ((status & TCP_GRO_SEG_AGG_DONE_AGG_OPEN) ==
+			    TCP_GRO_SEG_AGG_DONE_AGG_OPEN))
+		gro_bench_send(ni, DPNI_DRV_SEND_MODE_NONE);
+
+	if ((status & TCP_GRO_FLUSH_REQUIRED) == TCP_GRO_FLUSH_REQUIRED) {
+		if (tcp_gro_flush_aggregation(gro_ctx) ==
+				TCP_GRO_FLUSH_AGG_DONE)
+			gro_bench_send(ni, DPNI_DRV_SEND_MODE_NONE);
+	}
+
+	fdma_terminate_task();
+}
+
+static int app_dpni_add_cb(uint8_t generator_id, uint8_t event_id,
+			   uint64_t app_ctx, void *event_data)
+{
+	uint16_t	ni = (uint16_t)((uint32_t)event_data);
+	int		err;
+
+	UNUSED(generator_id);
+	UNUSED(event_id);
+
+	/* Configure frame processing callback */
+	err = dpni_drv_register_rx_cb(ni, (rx_cb_t *)app_ctx);
+	if (err) {
+		pr_err("Cannot configure processing callback on NI %d\n", ni);
+		return err;
+	}
+
+	/* Default ordering mode should be Concurrent */
+	err = dpni_drv_set_concurrent(ni);
+	if (err) {
+		pr_err("Cannot set Concurrent Execution on NI %d\n", ni);
+		return err;
+	}
+
+	/* Enable DPNI to receive frames */
+	err = dpni_drv_enable(ni);
+	if (err) {
+		pr_err("Cannot enable NI %d for Rx/Tx\n", ni);
+		return err;
+	}
+
+	fsl_print("%s : Successfully configured ni%d\n", AIOP_APP_NAME, ni);
+	return 0;
+}
+
+/* Early initialization */
+int app_early_init(void)
+{
+	return 0;
+}
+
+/* Initializes the application */
+int app_init(void)
+{
+	struct tcp_gro_stats_cntrs stats;
+	int mem_pid = MEM_PART_SYSTEM_DDR;
+	uint8_t tmi_id;
+	int err;
+
+	if (fsl_mem_exists(MEM_PART_DP_DDR))
+		mem_pid = MEM_PART_DP_DDR;
+
+	err = fsl_get_mem((GRO_BENCH_TIMERS + 1) * 64, mem_pid, 64,
+			  &gro_bench_tmi_addr);
+	if (err) {
+		pr_err("Cannot allocate TMI memory\n");
+		return err;
+	}
+	err = tman_create_tmi(gro_bench_tmi_addr, GRO_BENCH_TIMERS, &tmi_id);
+	if (err) {
+		pr_err("Cannot create TMI: %d\n", err);
+		return err;
+	}
+
+	err = fsl_get_mem(sizeof(struct tcp_gro_stats_cntrs), mem_pid, 64,
+			  &gro_bench_stats_addr);
+	if (err) {
+		pr_err("Cannot allocate GRO statistics\n");
+		return err;
+	}
+	memset(&stats, 0, sizeof(struct tcp_gro_stats_cntrs));
+	cdma_write(gro_bench_stats_addr, &stats,
+		   sizeof(struct tcp_gro_stats_cntrs));
+
+	err = tcp_gro_flow_table_init(&gro_bench_table, GRO_BENCH_FLOWS,
+				      mem_pid);
+	if (err) {
+		pr_err("Cannot create GRO flow table: %d\n", err);
+		return err;
+	}
+
+	gro_bench_params.timeout_params.gro_timeout_cb = gro_bench_timeout_cb;
+	gro_bench_params.timeout_params.granularity =
+			TCP_GRO_CREATE_TIMER_MODE_100_USEC_GRANULARITY;
+	gro_bench_params.timeout_params.tmi_id = tmi_id;
+	gro_bench_params.limits.timeout_limit = GRO_BENCH_TIMEOUT;
+	gro_bench_params.limits.packet_size_limit = 0xffff;
+	gro_bench_params.limits.seg_num_limit = 32;
+	gro_bench_params.metadata_addr = 0;
+	gro_bench_params.stats_addr = gro_bench_stats_addr;
+
+	err = evmng_register(EVMNG_GENERATOR_AIOPSL, DPNI_EVENT_ADDED, 1,
+			     (uint64_t) app_gro_bench, app_dpni_add_cb);
+	if (err) {
+		pr_err("Cannot register DPNI ADD event\n");
+		return err;
+	}
+
+	return 0;
+}
+
+/* Frees application allocated resources */
+void app_free(void)
+{}
@@ -190,6 +190,170 @@
  *
  * It enables IPR to use software hash tables instead of CTLU ones.
  * Disabled by default.
+ *
+ * #define IPR_SW_TABLE_MAX_WAYS 16
+ *
+ * Maximum number of entries on a table line that an IPR instance may
+ * request with IPR_MODE_SW_TABLE_GEOMETRY. A table line is copied on the
+ * task stack, 40 bytes per entry. Default is 8.
+ */
+
+/*
+ * Slab allocator module
+ * SLAB_DDR_STE_ACCOUNTING
+ *
+ * #define SLAB_DDR_STE_ACCOUNTING
+ *
+ * It enables DDR managed slab pools (cluster > 0) to keep the allocated and
+ * failed counters in STE counters and to check only a shared RAM credit on
+ * acquire/release, instead of a CDMA mutex read-modify-write of the pool.
+ * Disabled by default.
+ */
+
+/*
+ * Log module
+ * LOG_PER_CORE_STAGING
+ *
+ * #define LOG_PER_CORE_STAGING
+ *
+ * At runtime the messages printed to the log buffer are staged per core and
+ * written to the DDR log buffer in batches ordered by time stamp. Without a
+ * registered console the print does not take the print mutex.
+ * LOG_STAGE_SIZE (bytes per core, default 512), LOG_STAGE_FLUSH_THRESHOLD
+ * (default LOG_STAGE_SIZE / 2) and LOG_STAGE_FLUSH_PERIOD_USEC (default 10000)
+ * may be overridden.
+ * Staged messages are written on the threshold, every
+ * LOG_STAGE_FLUSH_PERIOD_USEC micro seconds by a TMAN timer, on log_flush()
+ * and on a fatal error. Disabled by default.
+ */
+
+/*
+ * Memory management module
+ * MEM_MNG_ALLOC_HISTOGRAM
+ *
+ * #define MEM_MNG_ALLOC_HISTOGRAM
+ *
+ * It enables the allocation latency histograms of fsl_malloc() and
+ * fsl_get_mem(), per partition and separately for the size classes and the
+ * slob. See sys_print_mem_alloc_histogram(). Disabled by default.
+ */
+
+/*
+ * RCU module
+ * RCU_NB_CORE_CBS, RCU_NB_SEGS, RCU_NB_DELAY_MAX, RCU_NB_DELAY_MIN
+ *
+ * #define RCU_NB_CORE_CBS 16
+ *
+ * Callbacks of rcu_synchronize_nb() staged per core (power of 2). A grace
+ * period collects the callbacks of all the cores into one of RCU_NB_SEGS
+ * DDR segments (default 8). The grace period is scheduled after
+ * RCU_NB_DELAY_MAX usec (default 1000), shorter as the callbacks are staged,
+ * down to RCU_NB_DELAY_MIN usec (default 20).
+ */
+
+/*
+ * TCP GRO module
+ * GRO_CTX_DMA_STATS
+ *
+ * #define GRO_CTX_DMA_STATS
+ *
+ * It counts the bytes of the TCP GRO contexts transferred by CDMA, see
+ * tcp_gro_get_ctx_dma_bytes() and the gro_bench application.
+ * Disabled by default.
+ */
+
+/*
+ * IPSEC module
+ * IPSEC_SA_CACHE
+ *
+ * #define IPSEC_SA_CACHE
+ *
+ * ipsec_frame_encrypt()/ipsec_frame_decrypt() read the SA parameters from a
+ * shared RAM cache of IPSEC_SA_CACHE_SIZE entries (default 32) instead of
+ * the SA descriptor. The STE lifetime counters are read from the SA
+ * descriptor only after the frames that can be processed before a limit may
+ * be crossed, at most IPSEC_SA_CACHE_CHECK_INTERVAL frames (default 64).
+ * Disabled by default.
+ */
+
+/*
+ * IPSEC module
+ * IPSEC_LIFETIME_BATCH
+ *
+ * #define IPSEC_LIFETIME_BATCH
+ *
+ * The byte/packet lifetime counters of the processed frames are staged per
+ * core (IPSEC_LIFETIME_BATCH_SLOTS SAs, default 4) and added to the SA
+ * descriptor counters after IPSEC_LIFETIME_BATCH_PKTS frames (default 32)
+ * or IPSEC_LIFETIME_BATCH_USEC micro seconds (default 1000). The soft/hard
+ * kilobytes/packets limits are evaluated on the flush, with a safety margin
+ * of IPSEC_LIFETIME_BATCH_MARGIN_PKTS packets and
+ * IPSEC_LIFETIME_BATCH_MARGIN_BYTES bytes (default: the frames that can be
+ * staged on all the cores), capped at limit >> IPSEC_LIFETIME_BATCH_MARGIN_SHIFT
+ * (default 4) for each limit. The lifetime statistics and seconds timer paths
+ * flush the frames staged on all the cores. Disabled by default.
+ */
+
+/*
+ * CAPWAP DTLS module
+ * CWAP_DTLS_SA_CACHE
+ *
+ * #define CWAP_DTLS_SA_CACHE
+ *
+ * cwap_dtls_frame_encrypt()/cwap_dtls_frame_decrypt() and
+ * cwap_dtls_get_ar_info() read the SA parameters from a shared RAM cache of
+ * CWAP_DTLS_SA_CACHE_SIZE entries (default 64) instead of the SA descriptor.
+ * Disabled by default.
+ */
+
+/*
+ * CAPWAP DTLS module
+ * CWAP_DTLS_STATS_BATCH
+ *
+ * #define CWAP_DTLS_STATS_BATCH
+ *
+ * The packets/bytes statistics of the processed frames are staged per core
+ * (CWAP_DTLS_STATS_BATCH_SLOTS SAs, default 4) and added to the SA
+ * descriptor counters after CWAP_DTLS_STATS_BATCH_PKTS frames (default 32)
+ * or CWAP_DTLS_STATS_BATCH_USEC micro seconds (default 1000).
+ * cwap_dtls_get_sa_stats() adds the staged frames. Disabled by default.
+ */
+
+/*
+ * Time functions module
+ * TIME_COARSE
+ *
+ * #define TIME_COARSE
+ *
+ * A periodic TMAN timer refreshes the time read by fsl_get_time_ms_coarse()
+ * and fsl_get_time_us_coarse() every TIME_COARSE_PERIOD_USEC micro seconds
+ * (default 1000). The readers only load the refreshed time, without reading
+ * the time base or the TMAN time stamp. Disabled by default.
+ */
+
+/*
+ * CDMA module
+ * CDMA_MUTEX_PROFILE
+ *
+ * #define CDMA_MUTEX_PROFILE
+ *
+ * One of CDMA_MUTEX_PROFILE_SAMPLE (default 16) CDMA mutex takes of a task is
+ * sampled. The wait and hold times of the sampled takes are accounted per
+ * mutex address in a DDR table of CDMA_MUTEX_PROFILE_ENTRIES entries
+ * (default 256). The profile is printed by the SL_CMD_CDMA_MUTEX_PROF_DUMP
+ * command of the service layer command module (or cdma_mutex_prof_dump()).
+ * CDMA rev 2 only. Disabled by default.
+ */
+
+/*
+ * Spinlock
+ * SPINLOCK_STATS
+ *
+ * #define SPINLOCK_STATS
+ *
+ * Each queued spinlock (struct qspinlock) counts the acquisitions, the
+ * contended acquisitions and the longest wait, see qspinlock_stats_dump().
+ * Disabled by default.
  */
 
 /*
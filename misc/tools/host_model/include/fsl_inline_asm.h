@@ -0,0 +1,79 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		fsl_inline_asm.h
+
+@Description	Host replacement of arch/core/ppc/include/fsl_inline_asm.h.
+
+		Found before the PPC header on the host include path; every
+		macro keeps the operand order of the original instruction.
+		The host model runs one task at a time so the reservation
+		based accesses always succeed.
+*//***************************************************************************/
+
+#ifndef __INLINE_ASM_H_
+#define __INLINE_ASM_H_
+
+#include <stdint.h>
+
+#define __lbarx(_res, _disp, _base)					\
+	((_res) = *((volatile uint8_t *)HOST_EA(_disp, _base)));
+#define __lharx(_res, _disp, _base)					\
+	((_res) = *((volatile uint16_t *)HOST_EA(_disp, _base)));
+#define __lwarx(_res, _disp, _base)					\
+	((_res) = *((volatile uint32_t *)HOST_EA(_disp, _base)));
+#define __stbcx(_res, _disp, _base)					\
+	(*((volatile uint8_t *)HOST_EA(_disp, _base)) = (uint8_t)(_res));
+#define __sthcx(_res, _disp, _base)					\
+	(*((volatile uint16_t *)HOST_EA(_disp, _base)) = (uint16_t)(_res));
+#define __stwcx(_res, _disp, _base)					\
+	(*((volatile uint32_t *)HOST_EA(_disp, _base)) = (uint32_t)(_res));
+#define __st64dw_d(_val, _disp)						\
+	(*((volatile uint64_t *)HOST_EA(_disp, 0)) = (uint64_t)(_val));
+#define __st64dw_b(_val, _base_reg)					\
+	(*((volatile uint64_t *)HOST_EA(0, _base_reg)) = (uint64_t)(_val));
+#define __ld64dw_d(_val, _disp)						\
+	((_val) = *((volatile uint64_t *)HOST_EA(_disp, 0)));
+#define __ld64dw_b(_val, _base_reg)					\
+	((_val) = *((volatile uint64_t *)HOST_EA(0, _base_reg)));
+#define __stw_d(_val, _disp)						\
+	(*((volatile uint32_t *)HOST_EA(_disp, 0)) = (uint32_t)(_val));
+#define __sthw_d(_val, _disp)						\
+	(*((volatile uint16_t *)HOST_EA(_disp, 0)) =			\
+		(uint16_t)(uintptr_t)(_val));
+#define __lbz_d(_val, _disp)						\
+	((_val) = *((volatile uint8_t *)HOST_EA(_disp, 0)));
+#define __stw(_val, _disp, _base_reg)					\
+	(*((volatile uint32_t *)HOST_EA(_disp, _base_reg)) = (uint32_t)(_val));
+#define __se_stb(_val, _base_reg)					\
+	(*((volatile uint8_t *)&(_base_reg)) = (uint8_t)(_val));
+#define __or(_res, _arg1, _arg2)					\
+	((_res) = (_arg1) | (_arg2));
+#define __e_or2is(_res, _arg1)						\
+	((_res) |= ((uint32_t)(uint16_t)(_arg1) << 16));
+
+#endif /* __INLINE_ASM_H_ */
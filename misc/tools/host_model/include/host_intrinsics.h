@@ -0,0 +1,176 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_intrinsics.h
+
+@Description	Host definitions of the CodeWarrior e200 built-ins used by the
+		AIOP service layer.
+
+		This file is force-included (-include) into every translation
+		unit of the host build. Accelerator calls are routed to the
+		host model engines; loads and stores keep the semantics of the
+		original instructions ("byte reversed" accesses are
+		little-endian accesses, plain accesses are native).
+*//***************************************************************************/
+
+#ifndef __HOST_INTRINSICS_H
+#define __HOST_INTRINSICS_H
+
+#include <stdint.h>
+
+/* CodeWarrior-only keyword. The SL section attributes (__COLD_CODE, __TASK,
+ * ...) are defined with it, so they are empty on the host. */
+#define __declspec(_x)
+
+/* CodeWarrior accepts an attribute after the declarator of a function
+ * definition (table 02_01 exception handlers), GCC does not. The
+ * declarations in table.h keep their noreturn attribute. */
+#define TABLE_HANDLER_NORETURN
+
+/* Accelerator calls - see src/host_model.c */
+int32_t host_model_hwaccel(uint32_t accel_id);
+int32_t host_model_ordhwaccel(uint32_t accel_id, uint32_t osm_op,
+			      uint32_t scope_id);
+int32_t host_model_osmcmd(uint32_t osm_op, uint32_t scope_id);
+void host_model_stqw(uint32_t arg1, uint32_t arg2, uint32_t arg3,
+		     uint32_t arg4, uintptr_t ea);
+
+#define __e_hwacceli_(_accel_id)	host_model_hwaccel((uint32_t)(_accel_id))
+#define __e_hwacceli(_accel_id)		((void)host_model_hwaccel((uint32_t)(_accel_id)))
+#define __e_hwaccel(_accel_id)		((void)host_model_hwaccel((uint32_t)(_accel_id)))
+#define __e_hwaccel_(_accel_id)		host_model_hwaccel((uint32_t)(_accel_id))
+#define __e_ordhwacceli_(_accel_id, _op, _scope_id)			\
+	host_model_ordhwaccel((uint32_t)(_accel_id), (uint32_t)(_op),	\
+			      (uint32_t)(_scope_id))
+#define __e_osmcmd_(_op, _scope_id)					\
+	host_model_osmcmd((uint32_t)(_op), (uint32_t)(_scope_id))
+#define __e_osmcmd(_op, _scope_id)					\
+	((void)host_model_osmcmd((uint32_t)(_op), (uint32_t)(_scope_id)))
+
+/* Effective address of a "displacement + base" access */
+#define HOST_EA(_disp, _base)	((uintptr_t)(_disp) + (uintptr_t)(_base))
+
+static inline uint32_t host_ld_le32(uintptr_t ea)
+{
+	const volatile uint8_t *p = (const volatile uint8_t *)ea;
+
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+		((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void host_st_le32(uint32_t val, uintptr_t ea)
+{
+	volatile uint8_t *p = (volatile uint8_t *)ea;
+
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+	p[2] = (uint8_t)(val >> 16);
+	p[3] = (uint8_t)(val >> 24);
+}
+
+static inline uint16_t host_ld_le16(uintptr_t ea)
+{
+	const volatile uint8_t *p = (const volatile uint8_t *)ea;
+
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline void host_st_le16(uint16_t val, uintptr_t ea)
+{
+	volatile uint8_t *p = (volatile uint8_t *)ea;
+
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+}
+
+/* Stores of 2/4 words; quad word stores may address an STE command
+ * register so they go through the model. */
+#define __stqw(_a1, _a2, _a3, _a4, _disp, _base)			\
+	host_model_stqw((uint32_t)(_a1), (uint32_t)(_a2),		\
+			(uint32_t)(_a3), (uint32_t)(_a4),		\
+			HOST_EA(_disp, _base))
+#define __stdw(_a1, _a2, _disp, _base)					\
+	do {								\
+		volatile uint32_t *__p =				\
+			(volatile uint32_t *)HOST_EA(_disp, _base);	\
+		__p[0] = (uint32_t)(_a1);				\
+		__p[1] = (uint32_t)(_a2);				\
+	} while (0)
+#define __ldw(_r1, _r2, _disp, _base)					\
+	do {								\
+		volatile uint32_t *__p =				\
+			(volatile uint32_t *)HOST_EA(_disp, _base);	\
+		*(_r1) = __p[0];					\
+		*(_r2) = __p[1];					\
+	} while (0)
+#define __llstdw(_val, _disp, _base)					\
+	(*((volatile uint64_t *)HOST_EA(_disp, _base)) = (uint64_t)(_val))
+#define __llldw(_r, _disp, _base)					\
+	(*(_r) = *((volatile uint64_t *)HOST_EA(_disp, _base)))
+
+/* Byte reversed (little-endian) accesses */
+#define __lwbr(_disp, _base)	host_ld_le32(HOST_EA(_disp, _base))
+#define __lhbr(_disp, _base)	host_ld_le16(HOST_EA(_disp, _base))
+#define __stwbr(_val, _disp, _base)					\
+	host_st_le32((uint32_t)(_val), HOST_EA(_disp, _base))
+#define __sthbr(_val, _disp, _base)					\
+	host_st_le16((uint16_t)(_val), HOST_EA(_disp, _base))
+#define __ldwbrw(_r1, _r2, _disp, _base)				\
+	do {								\
+		*(_r1) = host_ld_le32(HOST_EA(_disp, _base));		\
+		*(_r2) = host_ld_le32(HOST_EA(_disp, _base) + 4);	\
+	} while (0)
+#define __llldbrw(_r, _disp, _base)					\
+	(*(_r) = ((uint64_t)host_ld_le32(HOST_EA(_disp, _base) + 4) << 32) | \
+		host_ld_le32(HOST_EA(_disp, _base)))
+#define __llstdbrw(_val, _disp, _base)					\
+	do {								\
+		uint64_t __v = (uint64_t)(_val);			\
+		host_st_le32((uint32_t)__v, HOST_EA(_disp, _base));	\
+		host_st_le32((uint32_t)(__v >> 32),			\
+			     HOST_EA(_disp, _base) + 4);		\
+	} while (0)
+#define __byterevw(_val)	__builtin_bswap32((uint32_t)(_val))
+
+/* Rotate left word immediate then mask insert (IBM bit numbering) */
+static inline uint32_t host_rlwimi(uint32_t ra, uint32_t rs, uint32_t sh,
+				   uint32_t mb, uint32_t me)
+{
+	uint32_t rot = sh ? ((rs << sh) | (rs >> (32 - sh))) : rs;
+	uint32_t mask;
+
+	if (mb <= me)
+		mask = (0xFFFFFFFFu >> mb) & (0xFFFFFFFFu << (31 - me));
+	else
+		mask = (0xFFFFFFFFu >> mb) | (0xFFFFFFFFu << (31 - me));
+	return (rot & mask) | (ra & ~mask);
+}
+
+#define __e_rlwimi(_ra, _rs, _sh, _mb, _me)				\
+	host_rlwimi((uint32_t)(_ra), (uint32_t)(_rs), (_sh), (_mb), (_me))
+
+#endif /* __HOST_INTRINSICS_H */
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_model.h
+
+@Description	Host functional model of the AIOP accelerators.
+
+		The model executes unmodified service layer and netf code on a
+		Linux host. Every accelerator command issued by the code under
+		test (__e_hwacceli, __e_osmcmd, STE quad word stores) is
+		decoded and executed in software, and counted per engine,
+		per opcode and per module so "accelerator calls per packet"
+		can be compared between builds without hardware.
+
+		Modeled engines: CDMA, FDMA (FPDMA/FODMA), TMAN, OSM, STE and a
+		basic parser (Ethernet/VLAN/IPv4/IPv6/UDP/TCP). Other engines
+		(CTLU, MFLU, SEC, ...) are counted and return success.
+*//***************************************************************************/
+
+#ifndef __HOST_MODEL_H
+#define __HOST_MODEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**************************************************************************//**
+@Group		HOST_MODEL_Definitions Host model definitions
+@{
+*//***************************************************************************/
+
+/** Workspace is mapped at address 0, so HWC_*_ADDRESS can be used as-is */
+#define HOST_MODEL_WS_SIZE		0x10000
+/** Task stack inside the workspace (above the HWC/TLS/segment area) */
+#define HOST_MODEL_STACK_START		0x1000
+/** Peripheral window (TMAN/STE/CCSR registers) */
+#define HOST_MODEL_PERIPH_BASE		0x02000000
+#define HOST_MODEL_PERIPH_SIZE		0x00100000
+
+/** Default segment presentation (EP defaults) */
+#define HOST_MODEL_DEFAULT_SEG_ADDRESS	0x1C0
+#define HOST_MODEL_DEFAULT_SEG_SIZE	256
+
+/** Maximum length of a module name in the statistics */
+#define HOST_MODEL_MODULE_NAME_SIZE	32
+/** Maximum number of modules tracked by the statistics */
+#define HOST_MODEL_MAX_MODULES		32
+
+/** Engine indexes used by the statistics */
+enum host_model_engine {
+	HOST_MODEL_ENG_YIELD = 0,
+	HOST_MODEL_ENG_TMAN,
+	HOST_MODEL_ENG_MFLU,
+	HOST_MODEL_ENG_SEC,
+	HOST_MODEL_ENG_PARSER,
+	HOST_MODEL_ENG_CTLU,
+	HOST_MODEL_ENG_FPDMA,
+	HOST_MODEL_ENG_CDMA,
+	HOST_MODEL_ENG_FODMA,
+	HOST_MODEL_ENG_OSM,
+	HOST_MODEL_ENG_STE,
+	HOST_MODEL_ENG_OTHER,
+	HOST_MODEL_NUM_ENGINES
+};
+
+/** Number of opcode counters per engine */
+#define HOST_MODEL_NUM_OPCODES		256
+
+/** Per-module statistics */
+struct host_model_module_stats {
+	char name[HOST_MODEL_MODULE_NAME_SIZE];
+	/** Tasks (packets and timer callbacks) run for the module */
+	uint64_t tasks;
+	/** Accelerator calls per engine */
+	uint64_t calls[HOST_MODEL_NUM_ENGINES];
+	/** Accelerator calls per engine and opcode */
+	uint64_t ops[HOST_MODEL_NUM_ENGINES][HOST_MODEL_NUM_OPCODES];
+	/** Accelerator calls that returned a non-zero status */
+	uint64_t errors;
+	/** Tasks that ended with open frames / held mutexes */
+	uint64_t leaked_frames;
+	uint64_t leaked_mutexes;
+	/** CDMA mutexes taken in an order inverse to an earlier task's */
+	uint64_t lock_order_inversions;
+	/** Task entries ended by returning instead of terminating */
+	uint64_t implicit_terminations;
+};
+
+/** Frame enqueue callback.
+ * is_qd - 1 if qd_or_fqid is a queuing destination, 0 for an FQID.
+ * The frame data is owned by the model and only valid during the call. */
+typedef void (host_model_enqueue_cb)(uint32_t qd_or_fqid, int is_qd,
+				     const uint8_t *data, uint32_t length,
+				     void *arg);
+
+/** Task entry point (EP entry or callback) */
+typedef void (host_model_task_entry)(void);
+
+/** @} */ /* end of HOST_MODEL_Definitions */
+
+/**************************************************************************//**
+@Function	host_model_init
+
+@Description	Maps the workspace and peripheral window and resets all the
+		engines.
+
+@Param[in]	ext_mem_size	Size of the external memory arena used for
+				buffer pools and fsl_get_mem() allocations.
+
+@Return		0 on success, -ENOMEM / -EFAULT on failure.
+*//***************************************************************************/
+int host_model_init(uint32_t ext_mem_size);
+
+/**************************************************************************//**
+@Function	host_model_free
+
+@Description	Releases all the resources of the model.
+*//***************************************************************************/
+void host_model_free(void);
+
+/**************************************************************************//**
+@Function	host_model_ext_alloc
+
+@Description	Allocates external memory. Virtual and physical addresses are
+		identical in the model.
+
+@Return		Address of the allocated memory, 0 on failure.
+*//***************************************************************************/
+uint64_t host_model_ext_alloc(uint32_t size, uint32_t alignment);
+
+/**************************************************************************//**
+@Function	host_model_bpool_create
+
+@Description	Creates a buffer pool served by CDMA acquire context memory,
+		FDMA acquire/release buffer and frame storage.
+
+@Return		0 on success, -EEXIST / -EINVAL / -ENOMEM on failure.
+*//***************************************************************************/
+int host_model_bpool_create(uint16_t bpid, uint16_t buffer_size,
+			    uint32_t num_buffers);
+
+/**************************************************************************//**
+@Function	host_model_bpool_avail
+
+@Description	Returns the number of free buffers in a buffer pool.
+*//***************************************************************************/
+uint32_t host_model_bpool_avail(uint16_t bpid);
+
+/**************************************************************************//**
+@Function	host_model_set_enqueue_cb
+
+@Description	Registers the callback invoked for every enqueued frame.
+		Without a callback enqueued frames are counted and dropped.
+*//***************************************************************************/
+void host_model_set_enqueue_cb(host_model_enqueue_cb *cb, void *arg);
+
+/**************************************************************************//**
+@Function	host_model_run_task
+
+@Description	Runs one task to completion.
+
+		The frame is presented as the default frame (FD at
+		HWC_FD_ADDRESS, default segment at
+		HOST_MODEL_DEFAULT_SEG_ADDRESS), the parse result is generated
+		and the entry point is called on a stack located inside the
+		workspace, in concurrent mode of ordering scope level 1.
+		The task ends with fdma_terminate_task() or by returning.
+
+@Param[in]	module		Statistics bucket ("accelerator calls per
+				packet" is reported per module).
+@Param[in]	entry		Task entry point.
+@Param[in]	data		Frame data (may be NULL for a frameless task).
+@Param[in]	length		Frame length.
+@Param[in]	param		Value of the PRC parameter.
+
+@Return		0 on success, -EINVAL / -ENOMEM on failure.
+*//***************************************************************************/
+int host_model_run_task(const char *module, host_model_task_entry *entry,
+			const uint8_t *data, uint32_t length, uint32_t param);
+
+/**************************************************************************//**
+@Function	host_model_advance_time
+
+@Description	Advances the model time and runs a task (tman_timer_callback)
+		for every timer that expires on the way.
+*//***************************************************************************/
+void host_model_advance_time(uint64_t usec);
+
+/**************************************************************************//**
+@Function	host_model_get_time
+
+@Description	Returns the model time in microseconds.
+*//***************************************************************************/
+uint64_t host_model_get_time(void);
+
+/**************************************************************************//**
+@Function	host_model_set_print
+
+@Description	Enables (default) or disables the messages printed by the
+		code under test (pr_info(), pr_warn(), ...).
+*//***************************************************************************/
+void host_model_set_print(int enable);
+
+/**************************************************************************//**
+@Function	host_model_stats_get
+
+@Description	Returns the statistics of a module, NULL if unknown.
+*//***************************************************************************/
+const struct host_model_module_stats *host_model_stats_get(const char *module);
+
+/**************************************************************************//**
+@Function	host_model_stats_reset
+
+@Description	Clears the statistics of all modules.
+*//***************************************************************************/
+void host_model_stats_reset(void);
+
+/**************************************************************************//**
+@Function	host_model_stats_print
+
+@Description	Prints the accelerator calls per task of every module, per
+		engine, and the opcode histogram when verbose is set.
+*//***************************************************************************/
+void host_model_stats_print(FILE *f, int verbose);
+
+#endif /* __HOST_MODEL_H */
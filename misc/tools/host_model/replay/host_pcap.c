@@ -0,0 +1,181 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_pcap.c
+
+@Description	Classic pcap format reader/writer (see host_pcap.h).
+*//***************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+
+#include "host_pcap.h"
+
+#define HOST_PCAP_MAGIC_USEC		0xa1b2c3d4
+#define HOST_PCAP_MAGIC_NSEC		0xa1b23c4d
+#define HOST_PCAP_VERSION_MAJOR		2
+#define HOST_PCAP_VERSION_MINOR		4
+#define HOST_PCAP_GLOBAL_HDR_SIZE	24
+
+struct host_pcap_file_hdr {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct host_pcap_rec_hdr {
+	uint32_t ts_sec;
+	uint32_t ts_frac;
+	uint32_t caplen;
+	uint32_t len;
+};
+
+static uint32_t host_pcap_u32(const struct host_pcap *p, uint32_t val)
+{
+	return p->swapped ? __builtin_bswap32(val) : val;
+}
+
+int host_pcap_open_read(struct host_pcap *p, const char *path)
+{
+	struct host_pcap_file_hdr hdr;
+
+	memset(p, 0, sizeof(*p));
+	p->f = fopen(path, "rb");
+	if (!p->f)
+		return -ENOENT;
+	if (fread(&hdr, sizeof(hdr), 1, p->f) != 1)
+		goto invalid;
+
+	switch (hdr.magic) {
+	case HOST_PCAP_MAGIC_USEC:
+		break;
+	case HOST_PCAP_MAGIC_NSEC:
+		p->nsec = 1;
+		break;
+	default:
+		p->swapped = 1;
+		if (hdr.magic == __builtin_bswap32(HOST_PCAP_MAGIC_NSEC))
+			p->nsec = 1;
+		else if (hdr.magic != __builtin_bswap32(HOST_PCAP_MAGIC_USEC))
+			goto invalid;
+	}
+	p->snaplen = host_pcap_u32(p, hdr.snaplen);
+	p->linktype = host_pcap_u32(p, hdr.linktype);
+	return 0;
+
+invalid:
+	host_pcap_close(p);
+	return -EINVAL;
+}
+
+int host_pcap_read(struct host_pcap *p, struct host_pcap_record *rec,
+		   uint8_t *data, uint32_t size)
+{
+	struct host_pcap_rec_hdr hdr;
+	uint32_t frac, skip;
+
+	if (fread(&hdr, sizeof(hdr), 1, p->f) != 1)
+		return feof(p->f) ? 0 : -EINVAL;
+
+	frac = host_pcap_u32(p, hdr.ts_frac);
+	if (p->nsec)
+		frac /= 1000;
+	rec->ts_usec = (uint64_t)host_pcap_u32(p, hdr.ts_sec) * 1000000 + frac;
+	rec->caplen = host_pcap_u32(p, hdr.caplen);
+	rec->len = host_pcap_u32(p, hdr.len);
+	if (rec->caplen > HOST_PCAP_SNAPLEN)
+		return -EINVAL;
+
+	skip = 0;
+	if (rec->caplen > size) {
+		skip = rec->caplen - size;
+		rec->caplen = size;
+	}
+	if (rec->caplen && fread(data, rec->caplen, 1, p->f) != 1)
+		return -EINVAL;
+	if (skip && fseek(p->f, (long)skip, SEEK_CUR))
+		return -EINVAL;
+	return 1;
+}
+
+int host_pcap_rewind(struct host_pcap *p)
+{
+	if (fseek(p->f, HOST_PCAP_GLOBAL_HDR_SIZE, SEEK_SET))
+		return -EIO;
+	return 0;
+}
+
+int host_pcap_open_write(struct host_pcap *p, const char *path)
+{
+	struct host_pcap_file_hdr hdr;
+
+	memset(p, 0, sizeof(*p));
+	p->f = fopen(path, "wb");
+	if (!p->f)
+		return -EIO;
+	p->snaplen = HOST_PCAP_SNAPLEN;
+	p->linktype = HOST_PCAP_LINKTYPE_ETHERNET;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = HOST_PCAP_MAGIC_USEC;
+	hdr.version_major = HOST_PCAP_VERSION_MAJOR;
+	hdr.version_minor = HOST_PCAP_VERSION_MINOR;
+	hdr.snaplen = p->snaplen;
+	hdr.linktype = p->linktype;
+	if (fwrite(&hdr, sizeof(hdr), 1, p->f) != 1) {
+		host_pcap_close(p);
+		return -EIO;
+	}
+	return 0;
+}
+
+int host_pcap_write(struct host_pcap *p, uint64_t ts_usec,
+		    const uint8_t *data, uint32_t len)
+{
+	struct host_pcap_rec_hdr hdr;
+
+	hdr.ts_sec = (uint32_t)(ts_usec / 1000000);
+	hdr.ts_frac = (uint32_t)(ts_usec % 1000000);
+	hdr.len = len;
+	hdr.caplen = (len > p->snaplen) ? p->snaplen : len;
+	if (fwrite(&hdr, sizeof(hdr), 1, p->f) != 1)
+		return -EIO;
+	if (hdr.caplen && fwrite(data, hdr.caplen, 1, p->f) != 1)
+		return -EIO;
+	return 0;
+}
+
+void host_pcap_close(struct host_pcap *p)
+{
+	if (p->f)
+		fclose(p->f);
+	p->f = NULL;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_pcap.h
+
+@Description	Minimal reader/writer of the classic pcap capture format,
+		used by the host replay harness.
+*//***************************************************************************/
+
+#ifndef __HOST_PCAP_H
+#define __HOST_PCAP_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** Ethernet link type */
+#define HOST_PCAP_LINKTYPE_ETHERNET	1
+/** Maximum length of a frame written or read */
+#define HOST_PCAP_SNAPLEN		65535
+
+/** Open capture file */
+struct host_pcap {
+	FILE *f;
+	/** The file was written on a host of the other endianness */
+	int swapped;
+	/** Time stamps are in nanoseconds */
+	int nsec;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+/** Header of a captured frame */
+struct host_pcap_record {
+	/** Capture time, in microseconds */
+	uint64_t ts_usec;
+	/** Bytes captured (stored in the file) */
+	uint32_t caplen;
+	/** Length of the frame on the wire */
+	uint32_t len;
+};
+
+/**************************************************************************//**
+@Function	host_pcap_open_read
+
+@Description	Opens a capture file and reads its global header.
+
+@Return		0 on success, -ENOENT / -EINVAL on failure.
+*//***************************************************************************/
+int host_pcap_open_read(struct host_pcap *p, const char *path);
+
+/**************************************************************************//**
+@Function	host_pcap_read
+
+@Description	Reads the next frame. Frames longer than size are truncated
+		(rec->caplen is the number of bytes returned in data).
+
+@Return		1 if a frame was read, 0 at the end of the file, -EINVAL for
+		a corrupted file.
+*//***************************************************************************/
+int host_pcap_read(struct host_pcap *p, struct host_pcap_record *rec,
+		   uint8_t *data, uint32_t size);
+
+/**************************************************************************//**
+@Function	host_pcap_rewind
+
+@Description	Restarts the reading at the first frame.
+
+@Return		0 on success, -EIO on failure.
+*//***************************************************************************/
+int host_pcap_rewind(struct host_pcap *p);
+
+/**************************************************************************//**
+@Function	host_pcap_open_write
+
+@Description	Creates an Ethernet capture file with microseconds time
+		stamps.
+
+@Return		0 on success, -EIO on failure.
+*//***************************************************************************/
+int host_pcap_open_write(struct host_pcap *p, const char *path);
+
+/**************************************************************************//**
+@Function	host_pcap_write
+
+@Description	Appends a frame to a capture file.
+
+@Return		0 on success, -EIO on failure.
+*//***************************************************************************/
+int host_pcap_write(struct host_pcap *p, uint64_t ts_usec,
+		    const uint8_t *data, uint32_t len);
+
+/**************************************************************************//**
+@Function	host_pcap_close
+
+@Description	Closes a capture file.
+*//***************************************************************************/
+void host_pcap_close(struct host_pcap *p);
+
+#endif /* __HOST_PCAP_H */
@@ -0,0 +1,524 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_replay.c
+
+@Description	Pcap replay harness of the host model.
+
+		Runs the application linked with the harness (app_early_init()
+		and app_init(), as listed in the apps.c of the application) on
+		the host model, raises DPNI_EVENT_ADDED for one network
+		interface and replays a capture file through the receive
+		callback registered by the application. Every frame enqueued by
+		the application is written to an output capture file.
+
+		Reported: packets per second of the host run, accelerator
+		calls per packet and the distribution of the per packet host
+		run time.
+*//***************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fsl_types.h"
+#include "fsl_errors.h"
+#include "fsl_dpni_drv.h"
+#include "fsl_evmng.h"
+#include "drv.h"
+
+#include "host_model.h"
+#include "host_clock.h"
+#include "host_pcap.h"
+
+/* External memory of the model (buffer pools, SL and application memory) */
+#define HOST_REPLAY_EXT_MEM_SIZE	(256 * 1024 * 1024)
+/* Network interfaces known to the harness */
+#define HOST_REPLAY_MAX_NIS		16
+/* Queuing destination of a network interface */
+#define HOST_REPLAY_QD_BASE		0x100
+/* DPNI_EVENT_ADDED listeners */
+#define HOST_REPLAY_MAX_EVENT_CBS	8
+/* Model time given to the timers once the capture is replayed */
+#define HOST_REPLAY_DRAIN_USEC		(10 * 1000 * 1000)
+/* Statistics bucket of the application receive tasks */
+#define HOST_REPLAY_MODULE		"app"
+/* Latency histogram: power of 2 buckets, from 256 ns */
+#define HOST_REPLAY_HIST_MIN_SHIFT	8
+#define HOST_REPLAY_HIST_BUCKETS	20
+
+extern int app_early_init(void);
+extern int app_init(void);
+extern void app_free(void);
+
+extern struct dpni_drv *nis;
+
+struct host_replay_event_cb {
+	evmng_cb cb;
+	uint64_t app_ctx;
+};
+
+static struct dpni_drv hr_nis[HOST_REPLAY_MAX_NIS];
+static rx_cb_t *hr_rx_cb[HOST_REPLAY_MAX_NIS];
+static struct host_replay_event_cb hr_event_cbs[HOST_REPLAY_MAX_EVENT_CBS];
+static int hr_num_event_cbs;
+
+static struct host_pcap hr_out;
+static int hr_out_open;
+static uint64_t hr_out_time_base;
+static uint64_t hr_enqueued;
+static uint64_t hr_enqueued_bytes;
+
+static uint32_t *hr_latency;
+static uint64_t hr_num_latency;
+static uint64_t hr_max_latency;
+
+/*****************************************************************************/
+/* Network interface and event manager services used by the applications     */
+/*****************************************************************************/
+
+/* Only DPNI_EVENT_ADDED is raised by the harness */
+int evmng_register(uint8_t generator_id,
+		   uint8_t event_id,
+		   uint8_t priority,
+		   uint64_t app_ctx,
+		   evmng_cb cb)
+{
+	UNUSED(priority);
+
+	if (generator_id != EVMNG_GENERATOR_AIOPSL ||
+	    event_id != DPNI_EVENT_ADDED)
+		return 0;
+	if (hr_num_event_cbs == HOST_REPLAY_MAX_EVENT_CBS)
+		return -ENOMEM;
+	hr_event_cbs[hr_num_event_cbs].cb = cb;
+	hr_event_cbs[hr_num_event_cbs].app_ctx = app_ctx;
+	hr_num_event_cbs++;
+	return 0;
+}
+
+int dpni_drv_register_rx_cb(uint16_t ni_id, rx_cb_t *cb)
+{
+	if (ni_id >= HOST_REPLAY_MAX_NIS)
+		return -EINVAL;
+	hr_rx_cb[ni_id] = cb;
+	return 0;
+}
+
+int dpni_drv_enable(uint16_t ni_id)
+{
+	return (ni_id < HOST_REPLAY_MAX_NIS) ? 0 : -EINVAL;
+}
+
+int dpni_drv_set_max_frame_length(uint16_t ni_id, const uint16_t mfl)
+{
+	UNUSED(mfl);
+	return (ni_id < HOST_REPLAY_MAX_NIS) ? 0 : -EINVAL;
+}
+
+/* The model runs every task in the concurrent mode */
+int dpni_drv_set_concurrent(uint16_t ni_id)
+{
+	return (ni_id < HOST_REPLAY_MAX_NIS) ? 0 : -EINVAL;
+}
+
+int dpni_drv_set_exclusive(uint16_t ni_id)
+{
+	return (ni_id < HOST_REPLAY_MAX_NIS) ? 0 : -EINVAL;
+}
+
+int dpni_drv_register_rx_buffer_layout_requirements(uint16_t head_room,
+						    uint16_t tail_room,
+						    uint16_t private_data_size,
+						    uint32_t frame_anno)
+{
+	UNUSED(head_room);
+	UNUSED(tail_room);
+	UNUSED(private_data_size);
+	UNUSED(frame_anno);
+	return 0;
+}
+
+int dpni_drv_get_dpni_id(uint16_t ni_id, uint16_t *dpni_id)
+{
+	if (ni_id >= HOST_REPLAY_MAX_NIS)
+		return -EINVAL;
+	*dpni_id = hr_nis[ni_id].dpni_id;
+	return 0;
+}
+
+static void host_replay_nis_init(void)
+{
+	struct dpni_drv *ni;
+	int i;
+
+	memset(hr_nis, 0, sizeof(hr_nis));
+	for (i = 0; i < HOST_REPLAY_MAX_NIS; i++) {
+		ni = &hr_nis[i];
+		/* Parameters checked by sl_prolog() */
+		ni->dpni_drv_params_var.flags = DPNI_DRV_FLG_PARSE |
+						DPNI_DRV_FLG_PARSER_DIS;
+		ni->dpni_drv_tx_params_var.qdid =
+			(uint16_t)(HOST_REPLAY_QD_BASE + i);
+		ni->dpni_id = (uint16_t)i;
+		dpni_drv_get_primary_mac_addr((uint16_t)i, ni->mac_addr);
+	}
+	nis = hr_nis;
+}
+
+static int host_replay_ni_added(uint16_t ni_id)
+{
+	int i, err;
+
+	for (i = 0; i < hr_num_event_cbs; i++) {
+		err = hr_event_cbs[i].cb(EVMNG_GENERATOR_AIOPSL,
+					 DPNI_EVENT_ADDED,
+					 hr_event_cbs[i].app_ctx,
+					 (void *)(uintptr_t)ni_id);
+		if (err)
+			return err;
+	}
+	return 0;
+}
+
+/*****************************************************************************/
+/* Output frames                                                             */
+/*****************************************************************************/
+
+static void host_replay_enqueue_cb(uint32_t qd_or_fqid, int is_qd,
+				   const uint8_t *data, uint32_t length,
+				   void *arg)
+{
+	UNUSED(qd_or_fqid);
+	UNUSED(is_qd);
+	UNUSED(arg);
+
+	hr_enqueued++;
+	hr_enqueued_bytes += length;
+	if (hr_out_open &&
+	    host_pcap_write(&hr_out, hr_out_time_base + host_model_get_time(),
+			    data, length)) {
+		fprintf(stderr, "host_replay: output write error\n");
+		host_pcap_close(&hr_out);
+		hr_out_open = 0;
+	}
+}
+
+/*****************************************************************************/
+/* Statistics                                                                */
+/*****************************************************************************/
+
+static int host_replay_latency_add(uint64_t ns)
+{
+	uint32_t *latency;
+
+	if (hr_num_latency == hr_max_latency) {
+		hr_max_latency = hr_max_latency ? 2 * hr_max_latency : 4096;
+		latency = realloc(hr_latency,
+				  hr_max_latency * sizeof(*hr_latency));
+		if (!latency)
+			return -ENOMEM;
+		hr_latency = latency;
+	}
+	hr_latency[hr_num_latency++] = (ns > 0xFFFFFFFF) ? 0xFFFFFFFF :
+						(uint32_t)ns;
+	return 0;
+}
+
+static int host_replay_cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static uint32_t host_replay_percentile(uint32_t pct10)
+{
+	/* pct10 is in tenths of percent, the latencies are sorted */
+	return hr_latency[(hr_num_latency - 1) * pct10 / 1000];
+}
+
+static void host_replay_latency_print(void)
+{
+	uint64_t hist[HOST_REPLAY_HIST_BUCKETS];
+	uint64_t i, sum = 0;
+	uint32_t b, shift;
+
+	if (!hr_num_latency)
+		return;
+	qsort(hr_latency, hr_num_latency, sizeof(*hr_latency),
+	      host_replay_cmp_u32);
+
+	memset(hist, 0, sizeof(hist));
+	for (i = 0; i < hr_num_latency; i++) {
+		sum += hr_latency[i];
+		b = 0;
+		shift = HOST_REPLAY_HIST_MIN_SHIFT;
+		while ((b < HOST_REPLAY_HIST_BUCKETS - 1) &&
+		       (hr_latency[i] >= (1u << shift))) {
+			b++;
+			shift++;
+		}
+		hist[b]++;
+	}
+
+	printf("latency (ns)       min %u avg %llu p50 %u p90 %u p99 %u "
+	       "p99.9 %u max %u\n",
+	       hr_latency[0], (unsigned long long)(sum / hr_num_latency),
+	       host_replay_percentile(500), host_replay_percentile(900),
+	       host_replay_percentile(990), host_replay_percentile(999),
+	       hr_latency[hr_num_latency - 1]);
+	for (b = 0; b < HOST_REPLAY_HIST_BUCKETS; b++) {
+		if (!hist[b])
+			continue;
+		if (b < HOST_REPLAY_HIST_BUCKETS - 1)
+			printf("    < %-10u %-12llu %5.1f%%\n",
+			       1u << (HOST_REPLAY_HIST_MIN_SHIFT + b),
+			       (unsigned long long)hist[b],
+			       100.0 * (double)hist[b] /
+			       (double)hr_num_latency);
+		else
+			printf("    >= %-9u %-12llu %5.1f%%\n",
+			       1u << (HOST_REPLAY_HIST_MIN_SHIFT + b - 1),
+			       (unsigned long long)hist[b],
+			       100.0 * (double)hist[b] /
+			       (double)hr_num_latency);
+	}
+}
+
+/* Returns the accelerator calls per packet of the application */
+static double host_replay_report(uint64_t packets, uint64_t bytes,
+				 uint64_t run_ns, int verbose)
+{
+	const struct host_model_module_stats *s;
+	uint64_t calls = 0;
+	double calls_per_pkt = 0;
+	int e;
+
+	s = host_model_stats_get(HOST_REPLAY_MODULE);
+	if (s) {
+		for (e = 0; e < HOST_MODEL_NUM_ENGINES; e++)
+			calls += s->calls[e];
+		if (s->tasks)
+			calls_per_pkt = (double)calls / (double)s->tasks;
+	}
+
+	printf("packets            %llu (%llu bytes)\n",
+	       (unsigned long long)packets, (unsigned long long)bytes);
+	printf("enqueued           %llu (%llu bytes)\n",
+	       (unsigned long long)hr_enqueued,
+	       (unsigned long long)hr_enqueued_bytes);
+	if (run_ns)
+		printf("host run time      %.3f ms, %.0f packets/s\n",
+		       (double)run_ns / 1e6,
+		       (double)packets * 1e9 / (double)run_ns);
+	printf("accelerator calls  %.2f per packet\n", calls_per_pkt);
+	host_replay_latency_print();
+	printf("\n");
+	host_model_stats_print(stdout, verbose);
+
+	return calls_per_pkt;
+}
+
+/*****************************************************************************/
+/* Replay                                                                    */
+/*****************************************************************************/
+
+static void host_replay_usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s -i <in.pcap> [-o <out.pcap>] [-n <loops>] "
+		"[-N <ni>] [-c <max calls/packet>] [-v]\n"
+		"  -i  capture file replayed on the network interface\n"
+		"  -o  capture file of the enqueued frames\n"
+		"  -n  number of times the capture is replayed (1)\n"
+		"  -N  AIOP network interface of the received frames (0)\n"
+		"  -c  fail if the accelerator calls per packet exceed this\n"
+		"  -v  print the application messages and the opcodes\n",
+		prog);
+}
+
+int main(int argc, char **argv)
+{
+	const char *in_path = NULL, *out_path = NULL;
+	struct host_pcap in;
+	struct host_pcap_record rec;
+	uint8_t *data;
+	uint64_t prev_ts = 0, packets = 0, bytes = 0, run_ns = 0, start;
+	double max_calls = 0, calls;
+	long loops = 1, loop, ni = 0;
+	int verbose = 0, first = 1, opt, ret = 1, err;
+
+	while ((opt = getopt(argc, argv, "i:o:n:N:c:v")) != -1) {
+		switch (opt) {
+		case 'i':
+			in_path = optarg;
+			break;
+		case 'o':
+			out_path = optarg;
+			break;
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		case 'N':
+			ni = strtol(optarg, NULL, 0);
+			break;
+		case 'c':
+			max_calls = strtod(optarg, NULL);
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		default:
+			host_replay_usage(argv[0]);
+			return 1;
+		}
+	}
+	if (!in_path || loops < 1 || ni < 0 || ni >= HOST_REPLAY_MAX_NIS) {
+		host_replay_usage(argv[0]);
+		return 1;
+	}
+
+	err = host_pcap_open_read(&in, in_path);
+	if (err) {
+		fprintf(stderr, "host_replay: cannot read %s (%d)\n", in_path,
+			err);
+		return 1;
+	}
+	if (in.linktype != HOST_PCAP_LINKTYPE_ETHERNET) {
+		fprintf(stderr, "host_replay: %s is not an Ethernet capture\n",
+			in_path);
+		goto close_in;
+	}
+	if (out_path) {
+		err = host_pcap_open_write(&hr_out, out_path);
+		if (err) {
+			fprintf(stderr, "host_replay: cannot write %s (%d)\n",
+				out_path, err);
+			goto close_in;
+		}
+		hr_out_open = 1;
+	}
+	data = malloc(HOST_PCAP_SNAPLEN);
+	if (!data)
+		goto close_out;
+
+	err = host_model_init(HOST_REPLAY_EXT_MEM_SIZE);
+	if (err) {
+		fprintf(stderr, "host_replay: host_model_init failed (%d), "
+			"see README.txt\n", err);
+		goto free_data;
+	}
+	host_model_set_print(verbose);
+	host_model_set_enqueue_cb(host_replay_enqueue_cb, NULL);
+	host_replay_nis_init();
+
+	err = app_early_init();
+	if (!err)
+		err = app_init();
+	if (!err)
+		err = host_replay_ni_added((uint16_t)ni);
+	if (err) {
+		fprintf(stderr, "host_replay: application init failed (%d)\n",
+			err);
+		goto free_model;
+	}
+	if (!hr_rx_cb[ni]) {
+		fprintf(stderr, "host_replay: no receive callback registered "
+			"on NI %ld\n", ni);
+		goto free_model;
+	}
+	/* Application initialization is not part of the results */
+	host_model_stats_reset();
+
+	for (loop = 0; loop < loops; loop++) {
+		if (loop && host_pcap_rewind(&in))
+			break;
+		while ((err = host_pcap_read(&in, &rec, data,
+					     HOST_PCAP_SNAPLEN)) == 1) {
+			/* Timers expire as in the capture */
+			if (first) {
+				hr_out_time_base = rec.ts_usec -
+					host_model_get_time();
+				first = 0;
+			} else if (rec.ts_usec > prev_ts) {
+				host_model_advance_time(rec.ts_usec - prev_ts);
+			}
+			prev_ts = rec.ts_usec;
+
+			start = host_clock_ns();
+			err = host_model_run_task(HOST_REPLAY_MODULE,
+						  hr_rx_cb[ni], data,
+						  rec.caplen, (uint32_t)ni);
+			start = host_clock_ns() - start;
+			if (err) {
+				fprintf(stderr, "host_replay: packet %llu not "
+					"run (%d)\n",
+					(unsigned long long)packets, err);
+				goto free_model;
+			}
+			run_ns += start;
+			packets++;
+			bytes += rec.caplen;
+			if (host_replay_latency_add(start)) {
+				fprintf(stderr, "host_replay: no memory\n");
+				goto free_model;
+			}
+		}
+		if (err) {
+			fprintf(stderr, "host_replay: %s is corrupted\n",
+				in_path);
+			goto free_model;
+		}
+		/* The next loop is replayed right after the last frame */
+		first = 1;
+	}
+	host_model_advance_time(HOST_REPLAY_DRAIN_USEC);
+
+	calls = host_replay_report(packets, bytes, run_ns, verbose);
+	ret = 0;
+	if (max_calls > 0 && calls > max_calls) {
+		printf("FAILED: %.2f accelerator calls per packet, limit "
+		       "%.2f\n", calls, max_calls);
+		ret = 1;
+	}
+
+free_model:
+	app_free();
+	host_model_free();
+free_data:
+	free(data);
+	free(hr_latency);
+close_out:
+	if (hr_out_open)
+		host_pcap_close(&hr_out);
+close_in:
+	host_pcap_close(&in);
+	return ret;
+}
@@ -0,0 +1,461 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_cdma.c
+
+@Description	Host model of the CDMA: buffer pools, context memory
+		reference counts and mutexes.
+
+		Tasks run to completion one at a time, so a mutex can only be
+		contended by the task holding it. The model instead checks
+		the rules a task must obey on hardware: at most
+		HM_MAX_MUTEXES mutexes, no recursive lock, release only what
+		was taken, nothing held at task end, and the same lock order
+		in every task (an inversion is a deadlock on hardware).
+*//***************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_model_int.h"
+
+/* Commands (see cdma.h) */
+#define HM_CDMA_ACQUIRE			0x80
+#define HM_CDMA_ACCESS			0x81
+#define HM_CDMA_RELEASE			0x82
+#define HM_CDMA_MEMORY_INIT		0x83
+
+/* Access context memory flags */
+#define HM_CDMA_ERT			0x80000000
+#define HM_CDMA_ERR			0x40000000
+#define HM_CDMA_OFFSET_MASK		0x3FFF
+#define HM_CDMA_AA			0x8000
+#define HM_CDMA_MO			0x4000
+#define HM_CDMA_MUTEX_MASK		0x1800
+#define HM_CDMA_MUTEX_READ		0x0800
+#define HM_CDMA_MUTEX_WRITE		0x1000
+#define HM_CDMA_EPHEMERAL_SYNC		0x1800
+#define HM_CDMA_REFCNT_MASK		0x0600
+#define HM_CDMA_REFCNT_INC		0x0200
+#define HM_CDMA_REFCNT_DEC		0x0600
+#define HM_CDMA_REFCNT_DEC_REL		0x0400
+#define HM_CDMA_RM			0x0100
+#define HM_CDMA_DMA_READ		1
+#define HM_CDMA_DMA_WRITE		2
+#define HM_CDMA_DMA_READ_NO_CACHE	3
+#define HM_CDMA_DMA_SIZE_MASK		0x3FFF
+
+/* Status codes */
+#define HM_CDMA_SUCCESS			0x00
+#define HM_CDMA_POOL_DEPLETION		0x02
+#define HM_CDMA_DEC_TO_ZERO		0x03
+#define HM_CDMA_MUTEX_DEPLETION		0x84
+#define HM_CDMA_INVALID_CMD		0x87
+#define HM_CDMA_REFCNT_INC_ERR		0x90
+#define HM_CDMA_REFCNT_DEC_ERR		0x91
+#define HM_CDMA_REFCNT_INVALID_OP	0x92
+#define HM_CDMA_INVALID_LOCK_REQ	0x93
+#define HM_CDMA_INVALID_RELEASE		0x95
+
+#define HM_MAX_BPOOLS			64
+#define HM_MAX_LOCK_ORDER		1024
+
+struct hm_bpool {
+	uint16_t bpid;
+	uint16_t buffer_size;
+	uint32_t num_buffers;
+	uint8_t *mem;
+	uint32_t *free_stack;
+	uint32_t num_free;
+	uint32_t *refcount;
+};
+
+struct hm_lock_pair {
+	uint64_t first;
+	uint64_t second;
+	int reported;
+};
+
+static struct hm_bpool hm_bpools[HM_MAX_BPOOLS];
+static int hm_num_bpools;
+static struct hm_lock_pair hm_lock_order[HM_MAX_LOCK_ORDER];
+static int hm_num_lock_order;
+
+void hm_cdma_init(void)
+{
+	memset(hm_bpools, 0, sizeof(hm_bpools));
+	hm_num_bpools = 0;
+	hm_num_lock_order = 0;
+}
+
+void hm_cdma_free(void)
+{
+	int i;
+
+	for (i = 0; i < hm_num_bpools; i++) {
+		free(hm_bpools[i].free_stack);
+		free(hm_bpools[i].refcount);
+	}
+	hm_num_bpools = 0;
+}
+
+/*****************************************************************************/
+/* Buffer pools                                                              */
+/*****************************************************************************/
+
+static struct hm_bpool *hm_bpool_get(uint16_t bpid)
+{
+	int i;
+
+	for (i = 0; i < hm_num_bpools; i++)
+		if (hm_bpools[i].bpid == bpid)
+			return &hm_bpools[i];
+	return NULL;
+}
+
+static struct hm_bpool *hm_bpool_of(uint64_t addr, uint32_t *index)
+{
+	int i;
+
+	for (i = 0; i < hm_num_bpools; i++) {
+		struct hm_bpool *bp = &hm_bpools[i];
+		uint64_t base = (uint64_t)(uintptr_t)bp->mem;
+
+		if (addr >= base &&
+		    addr < base + (uint64_t)bp->num_buffers * bp->buffer_size) {
+			if ((addr - base) % bp->buffer_size)
+				return NULL;
+			*index = (uint32_t)((addr - base) / bp->buffer_size);
+			return bp;
+		}
+	}
+	return NULL;
+}
+
+int host_model_bpool_create(uint16_t bpid, uint16_t buffer_size,
+			    uint32_t num_buffers)
+{
+	struct hm_bpool *bp;
+	uint64_t mem;
+	uint32_t i;
+
+	if (!buffer_size || !num_buffers || (bpid & ~HM_FD_BPID_MASK))
+		return -EINVAL;
+	if (hm_bpool_get(bpid))
+		return -EEXIST;
+	if (hm_num_bpools == HM_MAX_BPOOLS)
+		return -ENOMEM;
+	/* Buffers are 64 byte aligned, as BMan buffers are */
+	buffer_size = (uint16_t)((buffer_size + 63) & ~63);
+	mem = host_model_ext_alloc(buffer_size * num_buffers, 64);
+	if (!mem)
+		return -ENOMEM;
+
+	bp = &hm_bpools[hm_num_bpools];
+	bp->free_stack = malloc(num_buffers * sizeof(uint32_t));
+	bp->refcount = calloc(num_buffers, sizeof(uint32_t));
+	if (!bp->free_stack || !bp->refcount) {
+		free(bp->free_stack);
+		free(bp->refcount);
+		return -ENOMEM;
+	}
+	bp->bpid = bpid;
+	bp->buffer_size = buffer_size;
+	bp->num_buffers = num_buffers;
+	bp->mem = (uint8_t *)(uintptr_t)mem;
+	for (i = 0; i < num_buffers; i++)
+		bp->free_stack[i] = num_buffers - 1 - i;
+	bp->num_free = num_buffers;
+	hm_num_bpools++;
+	return 0;
+}
+
+uint32_t host_model_bpool_avail(uint16_t bpid)
+{
+	struct hm_bpool *bp = hm_bpool_get(bpid);
+
+	return bp ? bp->num_free : 0;
+}
+
+int hm_bpool_acquire(uint16_t bpid, uint64_t *addr)
+{
+	struct hm_bpool *bp = hm_bpool_get(bpid);
+	uint32_t index;
+
+	if (!bp)
+		return -EINVAL;
+	if (!bp->num_free)
+		return -ENOMEM;
+	index = bp->free_stack[--bp->num_free];
+	bp->refcount[index] = 1;
+	*addr = (uint64_t)(uintptr_t)(bp->mem + index * bp->buffer_size);
+	return 0;
+}
+
+int hm_bpool_release(uint16_t bpid, uint64_t addr)
+{
+	struct hm_bpool *bp;
+	uint32_t index;
+
+	bp = hm_bpool_of(addr, &index);
+	if (!bp || bp->bpid != bpid || bp->num_free == bp->num_buffers)
+		return -EINVAL;
+	bp->refcount[index] = 0;
+	bp->free_stack[bp->num_free++] = index;
+	return 0;
+}
+
+int hm_bpool_find(uint64_t addr, uint16_t *bpid)
+{
+	struct hm_bpool *bp;
+	uint32_t index;
+
+	bp = hm_bpool_of(addr, &index);
+	if (!bp)
+		return -ENOENT;
+	*bpid = bp->bpid;
+	return 0;
+}
+
+/*****************************************************************************/
+/* Mutexes                                                                   */
+/*****************************************************************************/
+
+static int hm_mutex_find(uint64_t address)
+{
+	int i;
+
+	for (i = 0; i < hm_task.num_mutexes; i++)
+		if (hm_task.mutex[i].address == address)
+			return i;
+	return -1;
+}
+
+static void hm_lock_order_check(uint64_t held, uint64_t taken)
+{
+	int i, found = 0;
+
+	for (i = 0; i < hm_num_lock_order; i++) {
+		struct hm_lock_pair *p = &hm_lock_order[i];
+
+		if (p->first == held && p->second == taken)
+			found = 1;
+		if (p->first == taken && p->second == held) {
+			hm_task.stats->lock_order_inversions++;
+			if (!p->reported) {
+				fprintf(stderr, "host_model: %s: CDMA mutex "
+					"0x%llx taken while holding 0x%llx, "
+					"inverse order seen before\n",
+					hm_task.stats->name,
+					(unsigned long long)taken,
+					(unsigned long long)held);
+				p->reported = 1;
+			}
+		}
+	}
+	if (!found && hm_num_lock_order < HM_MAX_LOCK_ORDER) {
+		hm_lock_order[hm_num_lock_order].first = held;
+		hm_lock_order[hm_num_lock_order].second = taken;
+		hm_lock_order[hm_num_lock_order].reported = 0;
+		hm_num_lock_order++;
+	}
+}
+
+static uint8_t hm_mutex_lock(uint64_t address, int write)
+{
+	int i;
+
+	if (hm_mutex_find(address) >= 0)
+		return HM_CDMA_INVALID_LOCK_REQ;
+	if (hm_task.num_mutexes == HM_MAX_MUTEXES)
+		return HM_CDMA_MUTEX_DEPLETION;
+	for (i = 0; i < hm_task.num_mutexes; i++)
+		hm_lock_order_check(hm_task.mutex[i].address, address);
+	hm_task.mutex[hm_task.num_mutexes].address = address;
+	hm_task.mutex[hm_task.num_mutexes].write = write;
+	hm_task.num_mutexes++;
+	return HM_CDMA_SUCCESS;
+}
+
+static uint8_t hm_mutex_unlock(uint64_t address)
+{
+	int i = hm_mutex_find(address);
+
+	if (i < 0)
+		return HM_CDMA_INVALID_RELEASE;
+	hm_task.num_mutexes--;
+	hm_task.mutex[i] = hm_task.mutex[hm_task.num_mutexes];
+	return HM_CDMA_SUCCESS;
+}
+
+void hm_cdma_task_end(void)
+{
+	if (!hm_task.num_mutexes)
+		return;
+	fprintf(stderr, "host_model: %s: task ended holding %d CDMA "
+		"mutex(es), first 0x%llx\n", hm_task.stats->name,
+		hm_task.num_mutexes,
+		(unsigned long long)hm_task.mutex[0].address);
+	hm_task.stats->leaked_mutexes += (uint64_t)hm_task.num_mutexes;
+	hm_task.num_mutexes = 0;
+}
+
+/*****************************************************************************/
+/* Commands                                                                  */
+/*****************************************************************************/
+
+static uint8_t hm_cdma_refcount(uint32_t op, uint64_t addr)
+{
+	struct hm_bpool *bp;
+	uint32_t index;
+	uint8_t status = HM_CDMA_SUCCESS;
+
+	bp = hm_bpool_of(addr, &index);
+	if (!bp)
+		return (op == HM_CDMA_REFCNT_INC) ? HM_CDMA_REFCNT_INC_ERR :
+						    HM_CDMA_REFCNT_DEC_ERR;
+	if (op == HM_CDMA_REFCNT_INC) {
+		if (bp->refcount[index] == UINT32_MAX)
+			return HM_CDMA_REFCNT_INC_ERR;
+		bp->refcount[index]++;
+	} else {
+		if (bp->refcount[index] == 0) {
+			status = HM_CDMA_REFCNT_DEC_ERR;
+		} else if (--bp->refcount[index] == 0) {
+			status = HM_CDMA_DEC_TO_ZERO;
+			if (op == HM_CDMA_REFCNT_DEC_REL)
+				bp->free_stack[bp->num_free++] = index;
+		}
+	}
+	HM_WS32(HM_WS_ACC_OUT + 4) = bp->refcount[index];
+	return status;
+}
+
+static uint8_t hm_cdma_access(void)
+{
+	uint32_t arg1 = HM_WS32(HM_WS_ACC_IN);
+	uint32_t arg2 = HM_WS32(HM_WS_ACC_IN2);
+	uint64_t addr = ((uint64_t)HM_WS32(HM_WS_ACC_IN3) << 32) |
+			HM_WS32(HM_WS_ACC_IN4);
+	uint32_t offset = (arg1 >> 16) & HM_CDMA_OFFSET_MASK;
+	uint32_t mutex = arg1 & HM_CDMA_MUTEX_MASK;
+	uint32_t dma = arg2 >> 30;
+	uint32_t size = (arg2 >> 16) & HM_CDMA_DMA_SIZE_MASK;
+	uint8_t *ws = HM_PTR(arg2 & 0xFFFF);
+	uint8_t *ext = HM_PTR(addr + offset);
+	uint64_t mutex_addr = (arg1 & HM_CDMA_MO) ? addr + offset : addr;
+	uint8_t status = HM_CDMA_SUCCESS;
+
+	/* Ephemeral references are not modeled */
+	if (arg1 & (HM_CDMA_ERT | HM_CDMA_ERR) ||
+	    mutex == HM_CDMA_EPHEMERAL_SYNC)
+		return HM_CDMA_SUCCESS;
+
+	/* Command order: lock, DMA, reference count, release */
+	if (mutex) {
+		status = hm_mutex_lock(mutex_addr,
+				       mutex == HM_CDMA_MUTEX_WRITE);
+		if (status)
+			return status;
+	}
+
+	switch (dma) {
+	case HM_CDMA_DMA_READ:
+	case HM_CDMA_DMA_READ_NO_CACHE:
+		memcpy(ws, ext, size);
+		break;
+	case HM_CDMA_DMA_WRITE:
+		memcpy(ext, ws, size);
+		break;
+	default:
+		break;
+	}
+
+	if (arg1 & HM_CDMA_REFCNT_MASK) {
+		if (arg1 & HM_CDMA_AA)
+			return HM_CDMA_REFCNT_INVALID_OP;
+		status = hm_cdma_refcount(arg1 & HM_CDMA_REFCNT_MASK, addr);
+		if (status && status != HM_CDMA_DEC_TO_ZERO)
+			return status;
+	}
+
+	if (arg1 & HM_CDMA_RM) {
+		uint8_t rm_status = hm_mutex_unlock(mutex_addr);
+
+		if (rm_status)
+			return rm_status;
+	}
+	return status;
+}
+
+uint8_t hm_cdma_cmd(void)
+{
+	uint32_t arg1 = HM_WS32(HM_WS_ACC_IN);
+	uint32_t arg2 = HM_WS32(HM_WS_ACC_IN2);
+	uint32_t arg3 = HM_WS32(HM_WS_ACC_IN3);
+	uint64_t addr = ((uint64_t)arg3 << 32) | HM_WS32(HM_WS_ACC_IN4);
+	uint32_t i, size, refcount = 0;
+	uint16_t bpid;
+	uint8_t status;
+
+	HM_WS32(HM_WS_ACC_OUT + 4) = 0;
+	switch (arg1 & 0xFF) {
+	case HM_CDMA_ACQUIRE:
+		if (hm_bpool_acquire((uint16_t)arg2, &addr))
+			status = HM_CDMA_POOL_DEPLETION;
+		else {
+			HM_WS64(arg2 >> 16) = addr;
+			status = HM_CDMA_SUCCESS;
+		}
+		break;
+	case HM_CDMA_ACCESS:
+		status = hm_cdma_access();
+		refcount = HM_WS32(HM_WS_ACC_OUT + 4);
+		break;
+	case HM_CDMA_RELEASE:
+		if (hm_bpool_find(addr, &bpid) || hm_bpool_release(bpid, addr))
+			status = HM_CDMA_INVALID_CMD;
+		else
+			status = HM_CDMA_SUCCESS;
+		break;
+	case HM_CDMA_MEMORY_INIT:
+		size = arg2 >> 16;
+		for (i = 0; i < size; i++)
+			HM_WS8((arg2 & 0xFFFF) + i) =
+				(uint8_t)(arg3 >> (24 - 8 * (i & 3)));
+		status = HM_CDMA_SUCCESS;
+		break;
+	default:
+		status = HM_CDMA_INVALID_CMD;
+		break;
+	}
+	hm_set_status8(status);
+	HM_WS32(HM_WS_ACC_OUT + 4) = refcount;
+	return status;
+}
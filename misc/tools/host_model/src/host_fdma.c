@@ -0,0 +1,953 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_fdma.c
+
+@Description	Host model of the FDMA: working frames, presented segments,
+		frame storage, enqueue and data movement commands.
+
+		Working frames are kept in host memory; presented segments
+		are copies in the workspace, exactly as on hardware, so the
+		frame only changes through replace/insert/delete commands.
+		Stored frames live in model owned buffers whose address is
+		written in the FD; buffers of a model buffer pool are also
+		accepted as frame buffers. The PTA and ASA are not modeled.
+*//***************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_model_int.h"
+
+/* Commands (see fdma.h) */
+#define HM_FDMA_INIT			0x01
+#define HM_FDMA_PRESENT			0x02
+#define HM_FDMA_EXTEND			0x03
+#define HM_FDMA_STORE			0x10
+#define HM_FDMA_ENQUEUE_WF		0x11
+#define HM_FDMA_ENQUEUE_FRAME		0x12
+#define HM_FDMA_DISCARD			0x13
+#define HM_FDMA_TERMINATE		0x14
+#define HM_FDMA_REPLICATE		0x15
+#define HM_FDMA_CONCAT			0x16
+#define HM_FDMA_SPLIT			0x17
+#define HM_FDMA_TRIM			0x18
+#define HM_FDMA_REPLACE			0x19
+#define HM_FDMA_CKS			0x1A
+#define HM_FDMA_GWFL			0x1B
+#define HM_FDMA_COPY			0x40
+#define HM_FDMA_DMA			0x70
+#define HM_FDMA_ACQUIRE_BUFFER		0x72
+#define HM_FDMA_RELEASE_BUFFER		0x73
+
+/* Command flags (see fsl_fdma.h) */
+#define HM_FDMA_SR			0x0100
+#define HM_FDMA_INIT_NDS		0x0200
+#define HM_FDMA_ST_MASK			0x0C00
+#define HM_FDMA_EIS			0x0200
+#define HM_FDMA_TC_TERM			0x0400
+#define HM_FDMA_TC_CONDTERM		0x0800
+#define HM_FDMA_DIS_WF_TC		0x0100
+#define HM_FDMA_DIS_FS_FD		0x0200
+#define HM_FDMA_REPLIC_ENQ		0x0400
+#define HM_FDMA_REPLIC_DSF		0x0800
+#define HM_FDMA_CONCAT_SF		0x0100
+#define HM_FDMA_CONCAT_FS1		0x0200
+#define HM_FDMA_CONCAT_FS2		0x0400
+#define HM_FDMA_CONCAT_PCA		0x0800
+#define HM_FDMA_SPLIT_SM		0x0200
+#define HM_FDMA_SPLIT_PSA_PRESENT	0x0400
+#define HM_FDMA_SPLIT_PSA_CLOSE		0x0800
+#define HM_FDMA_REPLACE_SA_MASK		0x0300
+#define HM_FDMA_REPLACE_SA_REPRESENT	0x0100
+#define HM_FDMA_REPLACE_SA_CLOSE	0x0200
+#define HM_FDMA_DMA_DA_MASK		0x0300
+#define HM_FDMA_DMA_WS_TO_SYS		0x0100
+#define HM_FDMA_DMA_SRAM_TO_SYS		0x0300
+#define HM_FDMA_PTA_SEG_HANDLE		0xF
+#define HM_FDMA_ASA_SEG_HANDLE		0xE
+#define HM_FDMA_WHOLE_FRAME		0xFFFF
+
+/* Output offsets (in HM_WS_ACC_OUT2) */
+#define HM_FDMA_OUT_LENGTH		0x0
+#define HM_FDMA_OUT_CKS			0x2
+#define HM_FDMA_OUT_FRAME_HANDLE	0x2
+#define HM_FDMA_OUT_SEG_HANDLE		0x3
+
+/* Status codes (see enum fdma_hw_errors) */
+#define HM_FDMA_SUCCESS			0x00
+#define HM_FDMA_POOL_DEPLETION		0x02
+#define HM_FDMA_UNABLE_TO_SPLIT		0x04
+#define HM_FDMA_UNABLE_TO_TRIM		0x06
+#define HM_FDMA_UNABLE_TO_PRESENT_FULL	0x08
+#define HM_FDMA_FD_ERR			0x0E
+#define HM_FDMA_FRAME_HANDLE_DEPLETION	0x80
+#define HM_FDMA_INVALID_FRAME_HANDLE	0x81
+#define HM_FDMA_SEG_HANDLE_DEPLETION	0x82
+#define HM_FDMA_INVALID_SEG_HANDLE	0x83
+#define HM_FDMA_INVALID_DMA_ARGS	0x86
+#define HM_FDMA_INVALID_DMA_COMMAND	0x87
+
+#define HM_BUFFER_HASH_SIZE		1024
+
+/** Working frame */
+struct hm_frame {
+	int used;
+	uint8_t *data;
+	uint32_t length;
+	uint32_t capacity;
+	/** Workspace address of the FD the frame was opened from */
+	uint16_t fd;
+	/** Split marks set by concatenate (frame offsets) */
+	uint32_t sf[HM_MAX_SF_MARKS];
+	int num_sf;
+};
+
+/** Presented segment */
+struct hm_segment {
+	int used;
+	uint8_t frame;
+	uint16_t ws;
+	uint32_t start;
+	uint16_t length;
+};
+
+/** Model owned frame buffer */
+struct hm_buffer {
+	uint64_t addr;
+	struct hm_buffer *next;
+};
+
+static struct hm_frame hm_frames[HM_MAX_FRAMES];
+static struct hm_segment hm_segments[HM_MAX_SEGMENTS];
+static struct hm_buffer *hm_buffers[HM_BUFFER_HASH_SIZE];
+static host_model_enqueue_cb *hm_enqueue_cb;
+static void *hm_enqueue_arg;
+
+/*****************************************************************************/
+/* Frame buffers                                                             */
+/*****************************************************************************/
+
+static uint32_t hm_buffer_hash(uint64_t addr)
+{
+	return (uint32_t)((addr >> 6) ^ (addr >> 16)) &
+		(HM_BUFFER_HASH_SIZE - 1);
+}
+
+uint64_t hm_frame_buffer_create(const uint8_t *data, uint32_t length)
+{
+	struct hm_buffer *b = malloc(sizeof(*b));
+	uint8_t *mem = malloc(length ? length : 1);
+	uint32_t h;
+
+	if (!b || !mem) {
+		free(b);
+		free(mem);
+		return 0;
+	}
+	memcpy(mem, data, length);
+	b->addr = (uint64_t)(uintptr_t)mem;
+	h = hm_buffer_hash(b->addr);
+	b->next = hm_buffers[h];
+	hm_buffers[h] = b;
+	return b->addr;
+}
+
+/* Returns the buffer of a consumed frame to its owner */
+static void hm_frame_buffer_free(uint64_t addr)
+{
+	struct hm_buffer **pb = &hm_buffers[hm_buffer_hash(addr)];
+	uint16_t bpid;
+
+	for (; *pb; pb = &(*pb)->next) {
+		if ((*pb)->addr == addr) {
+			struct hm_buffer *b = *pb;
+
+			*pb = b->next;
+			free(HM_PTR(b->addr));
+			free(b);
+			return;
+		}
+	}
+	if (!hm_bpool_find(addr, &bpid))
+		hm_bpool_release(bpid, addr);
+}
+
+/* Frame data of an FD (buffer address + offset) */
+static uint8_t *hm_fd_data(uint16_t fd)
+{
+	return HM_PTR(hm_ld_le64(fd + HM_FD_ADDR) +
+		      ((hm_ld_le32(fd + HM_FD_BPID) >> 16) & HM_FD_OFFSET_MASK));
+}
+
+static uint32_t hm_fd_length(uint16_t fd)
+{
+	return hm_ld_le32(fd + HM_FD_LENGTH);
+}
+
+static void hm_fd_write(uint16_t fd, uint64_t addr, uint32_t length)
+{
+	hm_st_le64(fd + HM_FD_ADDR, addr);
+	hm_st_le32(fd + HM_FD_LENGTH, length);
+	/* BPID 0, offset 0, single buffer format */
+	hm_st_le32(fd + HM_FD_BPID, 0);
+}
+
+/*****************************************************************************/
+/* Working frames and segments                                               */
+/*****************************************************************************/
+
+static struct hm_frame *hm_frame_get(uint32_t handle)
+{
+	if (handle >= HM_MAX_FRAMES || !hm_frames[handle].used)
+		return NULL;
+	return &hm_frames[handle];
+}
+
+static int hm_frame_reserve(uint32_t length)
+{
+	int i;
+
+	for (i = 0; i < HM_MAX_FRAMES; i++)
+		if (!hm_frames[i].used)
+			break;
+	if (i == HM_MAX_FRAMES)
+		return -1;
+	hm_frames[i].capacity = length + 256;
+	hm_frames[i].data = malloc(hm_frames[i].capacity);
+	if (!hm_frames[i].data)
+		return -1;
+	hm_frames[i].used = 1;
+	hm_frames[i].length = 0;
+	hm_frames[i].fd = HM_NO_FD;
+	hm_frames[i].num_sf = 0;
+	return i;
+}
+
+static int hm_frame_open(const uint8_t *data, uint32_t length, uint16_t fd)
+{
+	int i = hm_frame_reserve(length);
+
+	if (i < 0)
+		return -1;
+	memcpy(hm_frames[i].data, data, length);
+	hm_frames[i].length = length;
+	hm_frames[i].fd = fd;
+	return i;
+}
+
+/* Opens a working frame from an FD, consuming its buffer */
+static int hm_frame_open_fd(uint16_t fd)
+{
+	uint64_t addr = hm_ld_le64(fd + HM_FD_ADDR);
+	int i;
+
+	if (!addr)
+		return -1;
+	i = hm_frame_open(hm_fd_data(fd), hm_fd_length(fd), fd);
+	if (i >= 0)
+		hm_frame_buffer_free(addr);
+	return i;
+}
+
+static void hm_frame_close(uint32_t handle)
+{
+	int i;
+
+	for (i = 0; i < HM_MAX_SEGMENTS; i++)
+		if (hm_segments[i].used && hm_segments[i].frame == handle)
+			hm_segments[i].used = 0;
+	free(hm_frames[handle].data);
+	hm_frames[handle].data = NULL;
+	hm_frames[handle].used = 0;
+}
+
+static int hm_frame_resize(struct hm_frame *f, uint32_t length)
+{
+	uint8_t *data;
+
+	if (length <= f->capacity)
+		return 0;
+	data = realloc(f->data, length + 256);
+	if (!data)
+		return -1;
+	f->data = data;
+	f->capacity = length + 256;
+	return 0;
+}
+
+/* Replaces 'size' bytes at 'offset' with 'new_size' bytes of 'src' */
+static int hm_frame_replace(struct hm_frame *f, uint32_t offset,
+			    uint32_t size, const uint8_t *src,
+			    uint32_t new_size)
+{
+	uint32_t tail;
+
+	if (offset > f->length)
+		return -1;
+	if (size > f->length - offset)
+		size = f->length - offset;
+	if (hm_frame_resize(f, f->length - size + new_size))
+		return -1;
+	tail = f->length - offset - size;
+	memmove(f->data + offset + new_size, f->data + offset + size, tail);
+	memcpy(f->data + offset, src, new_size);
+	f->length = f->length - size + new_size;
+	return 0;
+}
+
+static struct hm_segment *hm_segment_get(uint32_t frame, uint32_t handle)
+{
+	if (handle >= HM_MAX_SEGMENTS || !hm_segments[handle].used ||
+	    hm_segments[handle].frame != frame)
+		return NULL;
+	return &hm_segments[handle];
+}
+
+/* Presents a segment; returns the status, the handle in *seg */
+static uint8_t hm_segment_present(uint32_t frame, uint16_t ws,
+				  uint32_t offset, uint16_t size, int sr,
+				  uint8_t *seg)
+{
+	struct hm_frame *f = &hm_frames[frame];
+	struct hm_segment *s;
+	uint32_t start, len;
+	int i;
+
+	for (i = 0; i < HM_MAX_SEGMENTS; i++)
+		if (!hm_segments[i].used)
+			break;
+	if (i == HM_MAX_SEGMENTS)
+		return HM_FDMA_SEG_HANDLE_DEPLETION;
+
+	/* SR: the offset is counted from the end of the frame */
+	if (offset > f->length)
+		offset = f->length;
+	if (sr) {
+		len = (size < f->length - offset) ? size : f->length - offset;
+		start = f->length - offset - len;
+	} else {
+		start = offset;
+		len = f->length - offset;
+		if (len > size)
+			len = size;
+	}
+	memcpy(HM_PTR(ws), f->data + start, len);
+
+	s = &hm_segments[i];
+	s->used = 1;
+	s->frame = (uint8_t)frame;
+	s->ws = ws;
+	s->start = start;
+	s->length = (uint16_t)len;
+	*seg = (uint8_t)i;
+	HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_LENGTH) = (uint16_t)len;
+	return (len < size) ? HM_FDMA_UNABLE_TO_PRESENT_FULL : HM_FDMA_SUCCESS;
+}
+
+/*****************************************************************************/
+/* Enqueue                                                                   */
+/*****************************************************************************/
+
+void host_model_set_enqueue_cb(host_model_enqueue_cb *cb, void *arg)
+{
+	hm_enqueue_cb = cb;
+	hm_enqueue_arg = arg;
+}
+
+static void hm_enqueue(uint32_t flags, uint32_t arg2, const uint8_t *data,
+		       uint32_t length)
+{
+	if (!hm_enqueue_cb)
+		return;
+	if (flags & HM_FDMA_EIS)
+		hm_enqueue_cb(arg2, 0, data, length, hm_enqueue_arg);
+	else
+		hm_enqueue_cb(arg2 & 0xFFFF, 1, data, length, hm_enqueue_arg);
+}
+
+/* Enqueue never fails in the model: both terminate controls end the task */
+static void hm_enqueue_tc(uint32_t flags)
+{
+	if (flags & (HM_FDMA_TC_TERM | HM_FDMA_TC_CONDTERM))
+		hm_task_terminate();
+}
+
+/*****************************************************************************/
+/* Commands                                                                  */
+/*****************************************************************************/
+
+static uint8_t hm_fdma_init_cmd(uint32_t arg1, uint32_t arg2, uint32_t arg3)
+{
+	uint16_t fd = (uint16_t)(arg1 >> 16);
+	uint8_t seg = 0, status = HM_FDMA_SUCCESS;
+	int frame;
+
+	frame = hm_frame_open_fd(fd);
+	if (frame < 0)
+		return hm_ld_le64(fd + HM_FD_ADDR) ? HM_FDMA_FRAME_HANDLE_DEPLETION :
+						     HM_FDMA_FD_ERR;
+	if (!(arg1 & HM_FDMA_INIT_NDS)) {
+		status = hm_segment_present((uint32_t)frame,
+					    (uint16_t)(arg2 >> 16),
+					    arg2 & 0xFFFF,
+					    (uint16_t)(arg3 >> 16),
+					    !!(arg1 & HM_FDMA_SR), &seg);
+		if (status && status != HM_FDMA_UNABLE_TO_PRESENT_FULL) {
+			hm_frame_close((uint32_t)frame);
+			return status;
+		}
+	}
+	HM_WS8(HM_WS_ACC_OUT2 + HM_FDMA_OUT_FRAME_HANDLE) = (uint8_t)frame;
+	HM_WS8(HM_WS_ACC_OUT2 + HM_FDMA_OUT_SEG_HANDLE) = seg;
+	return status;
+}
+
+static uint8_t hm_fdma_present_cmd(uint32_t arg1, uint32_t arg2,
+				   uint32_t arg3)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+	uint8_t seg = 0, status;
+
+	if (!hm_frame_get(frame))
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	if (arg1 & HM_FDMA_ST_MASK) {
+		/* PTA/ASA are not modeled: present an empty segment */
+		HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_LENGTH) = 0;
+		return HM_FDMA_SUCCESS;
+	}
+	status = hm_segment_present(frame, (uint16_t)(arg2 >> 16),
+				    arg2 & 0xFFFF, (uint16_t)(arg3 >> 16),
+				    !!(arg1 & HM_FDMA_SR), &seg);
+	HM_WS8(HM_WS_ACC_OUT2 + HM_FDMA_OUT_SEG_HANDLE) = seg;
+	return status;
+}
+
+static uint8_t hm_fdma_extend_cmd(uint32_t arg1, uint32_t arg2)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+	uint32_t handle = arg1 >> 24;
+	uint32_t size = arg2 & 0xFFFF, avail;
+	struct hm_frame *f = hm_frame_get(frame);
+	struct hm_segment *s;
+
+	if (!f)
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	if (handle == HM_FDMA_ASA_SEG_HANDLE) {
+		HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_LENGTH) = 0;
+		return HM_FDMA_SUCCESS;
+	}
+	s = hm_segment_get(frame, handle);
+	if (!s)
+		return HM_FDMA_INVALID_SEG_HANDLE;
+	avail = f->length - (s->start + s->length);
+	if (avail > size)
+		avail = size;
+	memcpy(HM_PTR(arg2 >> 16), f->data + s->start + s->length, avail);
+	s->length = (uint16_t)(s->length + avail);
+	HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_LENGTH) = s->length;
+	return (avail < size) ? HM_FDMA_UNABLE_TO_PRESENT_FULL :
+				HM_FDMA_SUCCESS;
+}
+
+/* Stores a working frame in a new buffer described by the FD */
+static uint8_t hm_frame_store(uint32_t frame, uint16_t fd)
+{
+	struct hm_frame *f = &hm_frames[frame];
+	uint64_t addr;
+
+	if (fd == HM_NO_FD)
+		return HM_FDMA_FD_ERR;
+	addr = hm_frame_buffer_create(f->data, f->length);
+	if (!addr)
+		return HM_FDMA_POOL_DEPLETION;
+	hm_fd_write(fd, addr, f->length);
+	hm_frame_close(frame);
+	/* No AMQ attributes, ICID 0 */
+	HM_WS32(HM_WS_ACC_OUT2) = 0;
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_store_cmd(uint32_t arg1)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+
+	if (!hm_frame_get(frame))
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	return hm_frame_store(frame, hm_frames[frame].fd);
+}
+
+static uint8_t hm_fdma_enqueue_wf_cmd(uint32_t arg1, uint32_t arg2)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+	struct hm_frame *f = hm_frame_get(frame);
+
+	if (!f)
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	hm_enqueue(arg1, arg2, f->data, f->length);
+	hm_frame_close(frame);
+	hm_enqueue_tc(arg1);
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_enqueue_frame_cmd(uint32_t arg1, uint32_t arg2)
+{
+	uint16_t fd = (uint16_t)(arg1 >> 16);
+	uint64_t addr = hm_ld_le64(fd + HM_FD_ADDR);
+
+	if (!addr)
+		return HM_FDMA_FD_ERR;
+	hm_enqueue(arg1, arg2, hm_fd_data(fd), hm_fd_length(fd));
+	hm_frame_buffer_free(addr);
+	hm_enqueue_tc(arg1);
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_discard_cmd(uint32_t arg1)
+{
+	uint32_t handle = arg1 >> 16;
+	uint64_t addr;
+
+	if (arg1 & HM_FDMA_DIS_FS_FD) {
+		addr = hm_ld_le64(handle + HM_FD_ADDR);
+		if (!addr)
+			return HM_FDMA_FD_ERR;
+		hm_frame_buffer_free(addr);
+	} else {
+		if (!hm_frame_get(handle & 0xFF))
+			return HM_FDMA_INVALID_FRAME_HANDLE;
+		hm_frame_close(handle & 0xFF);
+	}
+	if (arg1 & HM_FDMA_DIS_WF_TC)
+		hm_task_terminate();
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_replicate_cmd(uint32_t arg1, uint32_t arg2,
+				     uint32_t arg3)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+	struct hm_frame *f = hm_frame_get(frame);
+	int copy;
+
+	if (!f)
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	if (arg1 & HM_FDMA_REPLIC_ENQ) {
+		hm_enqueue(arg1, arg2, f->data, f->length);
+	} else {
+		copy = hm_frame_open(f->data, f->length,
+				     (uint16_t)(arg3 >> 16));
+		if (copy < 0)
+			return HM_FDMA_FRAME_HANDLE_DEPLETION;
+		HM_WS8(HM_WS_ACC_OUT2 + HM_FDMA_OUT_SEG_HANDLE) =
+			(uint8_t)copy;
+	}
+	if (arg1 & HM_FDMA_REPLIC_DSF)
+		hm_frame_close(frame);
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_concat_cmd(uint32_t arg1, uint32_t arg2)
+{
+	uint32_t trim = (arg1 >> 16) & 0xFF;
+	uint32_t h1 = arg2 & 0xFFFF, h2 = arg2 >> 16;
+	struct hm_frame *f1, *f2;
+	uint32_t length1;
+	int i;
+
+	if (arg1 & HM_FDMA_CONCAT_FS1) {
+		i = hm_frame_open_fd((uint16_t)h1);
+		if (i < 0)
+			return HM_FDMA_FD_ERR;
+		h1 = (uint32_t)i;
+	}
+	if (arg1 & HM_FDMA_CONCAT_FS2) {
+		i = hm_frame_open_fd((uint16_t)h2);
+		if (i < 0)
+			return HM_FDMA_FD_ERR;
+		h2 = (uint32_t)i;
+	}
+	f1 = hm_frame_get(h1);
+	f2 = hm_frame_get(h2);
+	if (!f1 || !f2 || f1 == f2)
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	if (trim > f2->length)
+		return HM_FDMA_UNABLE_TO_TRIM;
+
+	length1 = f1->length;
+	if (hm_frame_replace(f1, length1, 0, f2->data + trim,
+			     f2->length - trim))
+		return HM_FDMA_POOL_DEPLETION;
+	if ((arg1 & HM_FDMA_CONCAT_SF) && f1->num_sf < HM_MAX_SF_MARKS)
+		f1->sf[f1->num_sf++] = length1;
+	for (i = 0; i < f2->num_sf && f1->num_sf < HM_MAX_SF_MARKS; i++)
+		if (f2->sf[i] > trim)
+			f1->sf[f1->num_sf++] = length1 + f2->sf[i] - trim;
+	hm_frame_close(h2);
+
+	if (arg1 & HM_FDMA_CONCAT_PCA)
+		return hm_frame_store(h1, f1->fd);
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_split_cmd(uint32_t arg1, uint32_t arg2, uint32_t arg3,
+				 uint32_t arg4)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+	struct hm_frame *f = hm_frame_get(frame);
+	struct hm_frame *n;
+	uint32_t split = arg4 & 0xFFFF;
+	uint16_t fd_dst = (uint16_t)(arg4 >> 16);
+	uint8_t seg = 0, status = HM_FDMA_SUCCESS;
+	int i, j, nf;
+
+	if (!f)
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	if (arg1 & HM_FDMA_SPLIT_SM) {
+		/* Split at the first split mark */
+		split = 0;
+		for (i = 0; i < f->num_sf; i++)
+			if (!split || f->sf[i] < split)
+				split = f->sf[i];
+	}
+	if (!split || split > f->length)
+		return HM_FDMA_UNABLE_TO_SPLIT;
+
+	/* The head becomes the split frame, the source keeps the tail */
+	nf = hm_frame_open(f->data, split, fd_dst);
+	if (nf < 0)
+		return HM_FDMA_FRAME_HANDLE_DEPLETION;
+	n = &hm_frames[nf];
+	memmove(f->data, f->data + split, f->length - split);
+	f->length -= split;
+	for (i = 0, j = 0; i < f->num_sf; i++) {
+		if (f->sf[i] < split)
+			n->sf[n->num_sf++] = f->sf[i];
+		else if (f->sf[i] > split)
+			f->sf[j++] = f->sf[i] - split;
+	}
+	f->num_sf = j;
+	for (i = 0; i < HM_MAX_SEGMENTS; i++)
+		if (hm_segments[i].used && hm_segments[i].frame == frame)
+			hm_segments[i].start = (hm_segments[i].start > split) ?
+				hm_segments[i].start - split : 0;
+
+	HM_WS8(HM_WS_ACC_OUT2 + HM_FDMA_OUT_SEG_HANDLE) = (uint8_t)nf;
+	if (arg1 & HM_FDMA_SPLIT_PSA_CLOSE) {
+		status = hm_frame_store((uint32_t)nf, fd_dst);
+		HM_WS8(HM_WS_ACC_OUT2 + HM_FDMA_OUT_SEG_HANDLE) = (uint8_t)nf;
+	} else if (arg1 & HM_FDMA_SPLIT_PSA_PRESENT) {
+		status = hm_segment_present((uint32_t)nf,
+					    (uint16_t)(arg2 >> 16),
+					    arg2 & 0xFFFF,
+					    (uint16_t)(arg3 >> 16),
+					    !!(arg1 & HM_FDMA_SR), &seg);
+		HM_WS8(HM_WS_ACC_OUT2 + HM_FDMA_OUT_FRAME_HANDLE) = seg;
+	}
+	return status;
+}
+
+static uint8_t hm_fdma_trim_cmd(uint32_t arg1, uint32_t arg2)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+	uint32_t offset = arg2 >> 16, size = arg2 & 0xFFFF;
+	struct hm_segment *s = hm_segment_get(frame, arg1 >> 24);
+
+	if (!s)
+		return HM_FDMA_INVALID_SEG_HANDLE;
+	if (offset + size > s->length)
+		return HM_FDMA_INVALID_DMA_ARGS;
+	s->ws = (uint16_t)(s->ws + offset);
+	s->start += offset;
+	s->length = (uint16_t)size;
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_replace_cmd(uint32_t arg1, uint32_t arg2,
+				   uint32_t arg3, uint32_t arg4)
+{
+	uint32_t frame = (arg1 >> 16) & 0xFF;
+	uint32_t handle = arg1 >> 24;
+	uint32_t sa = arg1 & HM_FDMA_REPLACE_SA_MASK;
+	uint32_t to_offset = arg2 >> 16, to_size = arg2 & 0xFFFF;
+	uint32_t from_size = arg3 & 0xFFFF;
+	uint32_t rs_size = arg4 & 0xFFFF;
+	struct hm_frame *f = hm_frame_get(frame);
+	struct hm_segment *s;
+	uint32_t len;
+
+	if (!f)
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	if (handle == HM_FDMA_PTA_SEG_HANDLE ||
+	    handle == HM_FDMA_ASA_SEG_HANDLE) {
+		HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_LENGTH) = 0;
+		return HM_FDMA_SUCCESS;
+	}
+	s = hm_segment_get(frame, handle);
+	if (!s)
+		return HM_FDMA_INVALID_SEG_HANDLE;
+	if (to_offset > s->length)
+		return HM_FDMA_INVALID_DMA_ARGS;
+	if (hm_frame_replace(f, s->start + to_offset, to_size,
+			     HM_PTR(arg3 >> 16), from_size))
+		return HM_FDMA_POOL_DEPLETION;
+	len = s->length + from_size - to_size;
+	s->length = (uint16_t)len;
+
+	if (sa == HM_FDMA_REPLACE_SA_CLOSE) {
+		s->used = 0;
+	} else if (sa == HM_FDMA_REPLACE_SA_REPRESENT) {
+		len = f->length - s->start;
+		if (len > rs_size)
+			len = rs_size;
+		s->ws = (uint16_t)(arg4 >> 16);
+		s->length = (uint16_t)len;
+		memcpy(HM_PTR(s->ws), f->data + s->start, len);
+		HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_LENGTH) = (uint16_t)len;
+		if (len < rs_size)
+			return HM_FDMA_UNABLE_TO_PRESENT_FULL;
+	}
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_cks_cmd(uint32_t arg1, uint32_t arg2)
+{
+	struct hm_frame *f = hm_frame_get((arg1 >> 16) & 0xFF);
+	uint32_t offset = arg2 >> 16, size = arg2 & 0xFFFF;
+	uint32_t sum = 0, i;
+
+	if (!f)
+		return HM_FDMA_INVALID_FRAME_HANDLE;
+	if (offset > f->length)
+		return HM_FDMA_INVALID_DMA_ARGS;
+	if (size == HM_FDMA_WHOLE_FRAME || size > f->length - offset)
+		size = f->length - offset;
+	/* Ones' complement sum of big-endian 16 bit words */
+	for (i = 0; i + 1 < size; i += 2)
+		sum += ((uint32_t)f->data[offset + i] << 8) |
+			f->data[offset + i + 1];
+	if (size & 1)
+		sum += (uint32_t)f->data[offset + size - 1] << 8;
+	while (sum >> 16)
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_CKS) = (uint16_t)sum;
+	return HM_FDMA_SUCCESS;
+}
+
+static uint8_t hm_fdma_dma_cmd(uint32_t arg1, uint32_t arg2)
+{
+	uint32_t size = arg2 >> 20;
+	uint8_t *ws = HM_PTR(arg2 & 0xFFFFF);
+	uint8_t *sys = HM_PTR(HM_WS64(HM_WS_ACC_IN3));
+
+	if (!size)
+		return HM_FDMA_INVALID_DMA_ARGS;
+	switch (arg1 & HM_FDMA_DMA_DA_MASK) {
+	case HM_FDMA_DMA_WS_TO_SYS:
+	case HM_FDMA_DMA_SRAM_TO_SYS:
+		memcpy(sys, ws, size);
+		break;
+	default:
+		memcpy(ws, sys, size);
+		break;
+	}
+	return HM_FDMA_SUCCESS;
+}
+
+uint8_t hm_fdma_cmd(uint32_t accel_id)
+{
+	uint32_t arg1 = HM_WS32(HM_WS_ACC_IN);
+	uint32_t arg2 = HM_WS32(HM_WS_ACC_IN2);
+	uint32_t arg3 = HM_WS32(HM_WS_ACC_IN3);
+	uint32_t arg4 = HM_WS32(HM_WS_ACC_IN4);
+	struct hm_frame *f;
+	uint64_t addr;
+	uint8_t status;
+
+	(void)accel_id;
+	HM_WS32(HM_WS_ACC_OUT2) = 0;
+	switch (arg1 & 0xFF) {
+	case HM_FDMA_INIT:
+		status = hm_fdma_init_cmd(arg1, arg2, arg3);
+		break;
+	case HM_FDMA_PRESENT:
+		status = hm_fdma_present_cmd(arg1, arg2, arg3);
+		break;
+	case HM_FDMA_EXTEND:
+		status = hm_fdma_extend_cmd(arg1, arg2);
+		break;
+	case HM_FDMA_STORE:
+		status = hm_fdma_store_cmd(arg1);
+		break;
+	case HM_FDMA_ENQUEUE_WF:
+		status = hm_fdma_enqueue_wf_cmd(arg1, arg2);
+		break;
+	case HM_FDMA_ENQUEUE_FRAME:
+		status = hm_fdma_enqueue_frame_cmd(arg1, arg2);
+		break;
+	case HM_FDMA_DISCARD:
+		status = hm_fdma_discard_cmd(arg1);
+		break;
+	case HM_FDMA_TERMINATE:
+		hm_task_terminate();
+		status = HM_FDMA_SUCCESS;
+		break;
+	case HM_FDMA_REPLICATE:
+		status = hm_fdma_replicate_cmd(arg1, arg2, arg3);
+		break;
+	case HM_FDMA_CONCAT:
+		status = hm_fdma_concat_cmd(arg1, arg2);
+		break;
+	case HM_FDMA_SPLIT:
+		status = hm_fdma_split_cmd(arg1, arg2, arg3, arg4);
+		break;
+	case HM_FDMA_TRIM:
+		status = hm_fdma_trim_cmd(arg1, arg2);
+		break;
+	case HM_FDMA_REPLACE:
+		status = hm_fdma_replace_cmd(arg1, arg2, arg3, arg4);
+		break;
+	case HM_FDMA_CKS:
+		status = hm_fdma_cks_cmd(arg1, arg2);
+		break;
+	case HM_FDMA_GWFL:
+		f = hm_frame_get((arg1 >> 16) & 0xFF);
+		if (f)
+			HM_WS32(HM_WS_ACC_OUT2) = f->length;
+		status = f ? HM_FDMA_SUCCESS : HM_FDMA_INVALID_FRAME_HANDLE;
+		break;
+	case HM_FDMA_COPY:
+		memmove(HM_PTR(arg3), HM_PTR(arg2), arg1 >> 16);
+		status = HM_FDMA_SUCCESS;
+		break;
+	case HM_FDMA_DMA:
+		status = hm_fdma_dma_cmd(arg1, arg2);
+		break;
+	case HM_FDMA_ACQUIRE_BUFFER:
+		if (hm_bpool_acquire((uint16_t)arg2, &addr)) {
+			status = HM_FDMA_POOL_DEPLETION;
+		} else {
+			HM_WS64(arg2 >> 16) = addr;
+			status = HM_FDMA_SUCCESS;
+		}
+		break;
+	case HM_FDMA_RELEASE_BUFFER:
+		status = hm_bpool_release((uint16_t)arg2,
+					  HM_WS64(HM_WS_ACC_IN3)) ?
+			HM_FDMA_INVALID_DMA_ARGS : HM_FDMA_SUCCESS;
+		break;
+	default:
+		status = HM_FDMA_INVALID_DMA_COMMAND;
+		break;
+	}
+	/* Keep the output words written by the command */
+	HM_WS32(HM_WS_ACC_OUT) = 0;
+	HM_WS8(HM_WS_ACC_OUT + 3) = status;
+	return status;
+}
+
+/*****************************************************************************/
+/* Task life cycle                                                           */
+/*****************************************************************************/
+
+void hm_fdma_init(void)
+{
+	memset(hm_frames, 0, sizeof(hm_frames));
+	memset(hm_segments, 0, sizeof(hm_segments));
+	memset(hm_buffers, 0, sizeof(hm_buffers));
+	hm_enqueue_cb = NULL;
+	hm_enqueue_arg = NULL;
+}
+
+void hm_fdma_free(void)
+{
+	struct hm_buffer *b, *next;
+	int i;
+
+	for (i = 0; i < HM_MAX_FRAMES; i++)
+		if (hm_frames[i].used)
+			hm_frame_close((uint32_t)i);
+	for (i = 0; i < HM_BUFFER_HASH_SIZE; i++) {
+		for (b = hm_buffers[i]; b; b = next) {
+			next = b->next;
+			free(HM_PTR(b->addr));
+			free(b);
+		}
+		hm_buffers[i] = NULL;
+	}
+}
+
+int hm_fdma_task_start(const uint8_t *data, uint32_t length)
+{
+	uint16_t seg_length;
+	uint64_t addr;
+	uint8_t seg;
+	int frame;
+
+	addr = hm_frame_buffer_create(data, length);
+	if (!addr)
+		return -ENOMEM;
+	memset(HM_PTR(HM_WS_FD), 0, HM_FD_SIZE);
+	hm_fd_write(HM_WS_FD, addr, length);
+
+	/* Initial presentation of the default frame and segment */
+	frame = hm_frame_open_fd(HM_WS_FD);
+	if (frame < 0)
+		return -ENOMEM;
+	if (hm_segment_present((uint32_t)frame,
+			       HOST_MODEL_DEFAULT_SEG_ADDRESS, 0,
+			       HOST_MODEL_DEFAULT_SEG_SIZE, 0, &seg) ==
+	    HM_FDMA_SEG_HANDLE_DEPLETION)
+		return -ENOMEM;
+	seg_length = HM_WS16(HM_WS_ACC_OUT2 + HM_FDMA_OUT_LENGTH);
+	HM_WS16(HM_WS_PRC + HM_PRC_SEG_LENGTH) = seg_length;
+	HM_WS16(HM_WS_PRC + HM_PRC_SEG_OFFSET) = 0;
+	HM_WS8(HM_WS_PRC + HM_PRC_SEG_HANDLE) = seg;
+	HM_WS8(HM_WS_PRC + HM_PRC_FRAME_HANDLE) = (uint8_t)frame;
+	HM_WS32(HM_WS_ACC_OUT2) = 0;
+	hm_parse_default_frame();
+	return 0;
+}
+
+void hm_fdma_task_end(void)
+{
+	int i, leaked = 0;
+
+	for (i = 0; i < HM_MAX_FRAMES; i++) {
+		if (hm_frames[i].used) {
+			hm_frame_close((uint32_t)i);
+			leaked++;
+		}
+	}
+	if (leaked) {
+		hm_task.stats->leaked_frames += (uint64_t)leaked;
+		fprintf(stderr, "host_model: %s: task ended with %d open "
+			"frame(s)\n", hm_task.stats->name, leaked);
+	}
+}
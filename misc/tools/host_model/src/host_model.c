@@ -0,0 +1,636 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_model.c
+
+@Description	Host model core: address space, accelerator dispatcher,
+		task runner, OSM/STE engines and statistics.
+*//***************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "host_model_int.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE	0x100000
+#endif
+
+/* OSM commands (see osm.h) */
+#define HM_OSM_EXIT_OP			0x02
+#define HM_OSM_STE_REQ_OP		0x04
+#define HM_OSM_RELINQUISH_EXCL_OP	0x05
+#define HM_OSM_TO_CONC_NEW_ID_OP	0x08
+#define HM_OSM_TO_EXCL_NEW_ID_OP	0x09
+#define HM_OSM_TO_CONC_OP		0x0c
+#define HM_OSM_TO_EXCL_OP		0x0d
+#define HM_OSM_ENTER_FIRST_OP		0x10
+#define HM_OSM_ENTER_LAST_OP		0x19
+#define HM_OSM_ENTER_EXCL_BIT		0x01
+#define HM_OSM_ERR			1
+
+/* STE commands (see ste.h / fsl_ste.h) */
+#define HM_STE_OP_MASK			0x0000000F
+#define HM_STE_SET			0x1
+#define HM_STE_SYNC			0x7
+#define HM_STE_ADD			0x8
+#define HM_STE_SUB			0x9
+#define HM_STE_INC_ADD			0xC
+#define HM_STE_INC_SUB			0xD
+#define HM_STE_DEC_ADD			0xE
+#define HM_STE_DEC_SUB			0xF
+#define HM_STE_CNTR_SIZE_MASK		0x30000000
+#define HM_STE_CNTR_64			0x30000000
+#define HM_STE_SATURATE			0x08000000
+#define HM_STE_ACC_SIZE_MASK		0xC0000000
+#define HM_STE_ACC_64			0xC0000000
+#define HM_STE_CMP_CNTR_SATURATE	0x04000000
+#define HM_STE_CMP_ACC_SATURATE		0x08000000
+
+struct hm_task hm_task;
+
+static uint8_t *hm_ws;
+static uint8_t *hm_periph;
+static uint8_t *hm_ext;
+static uint32_t hm_ext_size;
+static uint32_t hm_ext_used;
+
+static struct host_model_module_stats hm_modules[HOST_MODEL_MAX_MODULES];
+static int hm_num_modules;
+static struct host_model_module_stats *hm_init_stats;
+
+static ucontext_t hm_runner_ctx;
+static ucontext_t hm_task_ctx;
+
+static int hm_map_fixed(uintptr_t address, size_t size, uint8_t **map)
+{
+	void *p = mmap((void *)address, size, PROT_READ | PROT_WRITE,
+		       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+		       -1, 0);
+
+	if (p == MAP_FAILED)
+		return -EFAULT;
+	if ((uintptr_t)p != address) {
+		/* Old kernels ignore MAP_FIXED_NOREPLACE */
+		munmap(p, size);
+		return -EFAULT;
+	}
+	*map = p;
+	return 0;
+}
+
+int host_model_init(uint32_t ext_mem_size)
+{
+	if (hm_ext)
+		return -EEXIST;
+
+	if (hm_map_fixed(0, HOST_MODEL_WS_SIZE, &hm_ws)) {
+		fprintf(stderr, "host_model: cannot map the workspace at "
+			"address 0 (vm.mmap_min_addr must be 0)\n");
+		return -EFAULT;
+	}
+	if (hm_map_fixed(HOST_MODEL_PERIPH_BASE, HOST_MODEL_PERIPH_SIZE,
+			 &hm_periph)) {
+		fprintf(stderr, "host_model: cannot map the peripheral "
+			"window at 0x%08x\n", HOST_MODEL_PERIPH_BASE);
+		munmap(hm_ws, HOST_MODEL_WS_SIZE);
+		return -EFAULT;
+	}
+	hm_ext = mmap(NULL, ext_mem_size, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (hm_ext == MAP_FAILED) {
+		hm_ext = NULL;
+		munmap(hm_periph, HOST_MODEL_PERIPH_SIZE);
+		munmap(hm_ws, HOST_MODEL_WS_SIZE);
+		return -ENOMEM;
+	}
+	hm_ext_size = ext_mem_size;
+	hm_ext_used = 0;
+
+	memset(&hm_task, 0, sizeof(hm_task));
+	memset(hm_modules, 0, sizeof(hm_modules));
+	hm_num_modules = 0;
+	hm_init_stats = hm_stats_lookup("(init)");
+	hm_task.stats = hm_init_stats;
+
+	hm_cdma_init();
+	hm_fdma_init();
+	hm_tman_init();
+	if (hm_services_init()) {
+		host_model_free();
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+void host_model_free(void)
+{
+	if (!hm_ext)
+		return;
+	hm_tman_free();
+	hm_fdma_free();
+	hm_cdma_free();
+	munmap(hm_ext, hm_ext_size);
+	munmap(hm_periph, HOST_MODEL_PERIPH_SIZE);
+	munmap(hm_ws, HOST_MODEL_WS_SIZE);
+	hm_ext = NULL;
+}
+
+uint64_t host_model_ext_alloc(uint32_t size, uint32_t alignment)
+{
+	uint32_t start;
+
+	if (!hm_ext || size == 0)
+		return 0;
+	if (alignment == 0)
+		alignment = 8;
+	if (alignment & (alignment - 1))
+		return 0;
+	start = (((uint32_t)(uintptr_t)hm_ext + hm_ext_used + alignment - 1)
+		& ~(alignment - 1)) - (uint32_t)(uintptr_t)hm_ext;
+	if (start + size > hm_ext_size || start + size < start)
+		return 0;
+	hm_ext_used = start + size;
+	return (uint64_t)(uintptr_t)(hm_ext + start);
+}
+
+/*****************************************************************************/
+/* Statistics                                                                */
+/*****************************************************************************/
+
+struct host_model_module_stats *hm_stats_lookup(const char *module)
+{
+	int i;
+
+	for (i = 0; i < hm_num_modules; i++)
+		if (!strncmp(hm_modules[i].name, module,
+			     HOST_MODEL_MODULE_NAME_SIZE - 1))
+			return &hm_modules[i];
+	if (hm_num_modules == HOST_MODEL_MAX_MODULES)
+		return NULL;
+	strncpy(hm_modules[i].name, module, HOST_MODEL_MODULE_NAME_SIZE - 1);
+	hm_num_modules++;
+	return &hm_modules[i];
+}
+
+void hm_count(enum host_model_engine eng, uint32_t opcode)
+{
+	struct host_model_module_stats *stats = hm_task.stats;
+
+	stats->calls[eng]++;
+	stats->ops[eng][opcode & (HOST_MODEL_NUM_OPCODES - 1)]++;
+}
+
+const struct host_model_module_stats *host_model_stats_get(const char *module)
+{
+	int i;
+
+	for (i = 0; i < hm_num_modules; i++)
+		if (!strncmp(hm_modules[i].name, module,
+			     HOST_MODEL_MODULE_NAME_SIZE - 1))
+			return &hm_modules[i];
+	return NULL;
+}
+
+void host_model_stats_reset(void)
+{
+	int i;
+
+	for (i = 0; i < hm_num_modules; i++) {
+		char name[HOST_MODEL_MODULE_NAME_SIZE];
+
+		memcpy(name, hm_modules[i].name, sizeof(name));
+		memset(&hm_modules[i], 0, sizeof(hm_modules[i]));
+		memcpy(hm_modules[i].name, name, sizeof(name));
+	}
+}
+
+static const char *hm_engine_names[HOST_MODEL_NUM_ENGINES] = {
+	"YIELD", "TMAN", "MFLU", "SEC", "PARSER", "CTLU",
+	"FPDMA", "CDMA", "FODMA", "OSM", "STE", "OTHER"
+};
+
+void host_model_stats_print(FILE *f, int verbose)
+{
+	int i, e, op;
+
+	for (i = 0; i < hm_num_modules; i++) {
+		const struct host_model_module_stats *s = &hm_modules[i];
+		uint64_t total = 0;
+
+		for (e = 0; e < HOST_MODEL_NUM_ENGINES; e++)
+			total += s->calls[e];
+		if (!total && !s->tasks)
+			continue;
+		fprintf(f, "%-24s tasks %-10llu calls %-12llu",
+			s->name, (unsigned long long)s->tasks,
+			(unsigned long long)total);
+		if (s->tasks)
+			fprintf(f, " calls/task %.2f",
+				(double)total / (double)s->tasks);
+		fprintf(f, "\n");
+		for (e = 0; e < HOST_MODEL_NUM_ENGINES; e++) {
+			if (!s->calls[e])
+				continue;
+			fprintf(f, "    %-8s %-12llu", hm_engine_names[e],
+				(unsigned long long)s->calls[e]);
+			if (s->tasks)
+				fprintf(f, " per task %.2f",
+					(double)s->calls[e] /
+					(double)s->tasks);
+			fprintf(f, "\n");
+			if (!verbose)
+				continue;
+			for (op = 0; op < HOST_MODEL_NUM_OPCODES; op++)
+				if (s->ops[e][op])
+					fprintf(f, "        op 0x%02x %llu\n", op,
+						(unsigned long long)
+						s->ops[e][op]);
+		}
+		if (s->errors || s->leaked_frames || s->leaked_mutexes ||
+		    s->lock_order_inversions || s->implicit_terminations)
+			fprintf(f, "    errors %llu, open frames at end %llu, "
+				"held mutexes at end %llu, "
+				"mutex order inversions %llu, "
+				"tasks not terminated %llu\n",
+				(unsigned long long)s->errors,
+				(unsigned long long)s->leaked_frames,
+				(unsigned long long)s->leaked_mutexes,
+				(unsigned long long)s->lock_order_inversions,
+				(unsigned long long)s->implicit_terminations);
+	}
+}
+
+/*****************************************************************************/
+/* Tasks                                                                     */
+/*****************************************************************************/
+
+void hm_set_status8(uint8_t status)
+{
+	HM_WS32(HM_WS_ACC_OUT) = 0;
+	HM_WS8(HM_WS_ACC_OUT + 3) = status;
+}
+
+void hm_task_terminate(void)
+{
+	if (!hm_task.running) {
+		fprintf(stderr, "host_model: task termination outside of a "
+			"task\n");
+		abort();
+	}
+	hm_task.terminated = 1;
+	setcontext(&hm_runner_ctx);
+}
+
+int hm_run_task(struct host_model_module_stats *stats,
+		host_model_task_entry *entry)
+{
+	struct host_model_module_stats *prev = hm_task.stats;
+
+	if (hm_task.running)
+		return -EBUSY;
+
+	hm_task.stats = stats;
+	hm_task.terminated = 0;
+	hm_task.num_mutexes = 0;
+	memset(hm_task.osm_excl, 0, sizeof(hm_task.osm_excl));
+	memset(hm_task.osm_scope_id, 0, sizeof(hm_task.osm_scope_id));
+	hm_task.osm_level = HM_WS8(HM_WS_PRC + HM_PRC_OSM) >> 7;
+	stats->tasks++;
+
+	/* The stack must be in the workspace: the service layer passes the
+	 * address of local buffers to the accelerators as 16 bit values */
+	getcontext(&hm_task_ctx);
+	hm_task_ctx.uc_stack.ss_sp = hm_ws + HOST_MODEL_STACK_START;
+	hm_task_ctx.uc_stack.ss_size = HOST_MODEL_WS_SIZE -
+		HOST_MODEL_STACK_START;
+	hm_task_ctx.uc_link = &hm_runner_ctx;
+	makecontext(&hm_task_ctx, entry, 0);
+
+	hm_task.running = 1;
+	swapcontext(&hm_runner_ctx, &hm_task_ctx);
+	hm_task.running = 0;
+
+	if (!hm_task.terminated)
+		stats->implicit_terminations++;
+	hm_fdma_task_end();
+	hm_cdma_task_end();
+	hm_tman_task_end();
+	hm_task.stats = prev;
+	return 0;
+}
+
+void hm_ws_reset(uint32_t param)
+{
+	memset(hm_ws + HM_WS_SPID, 0, HOST_MODEL_STACK_START - HM_WS_SPID);
+	HM_WS32(HM_WS_PRC + HM_PRC_PARAM) = param;
+	HM_WS16(HM_WS_PRC + HM_PRC_SEG_ADDRESS) =
+		HOST_MODEL_DEFAULT_SEG_ADDRESS;
+	/* Scope level 1, concurrent entry point execution phase */
+	HM_WS8(HM_WS_PRC + HM_PRC_OSM) = HM_PRC_OSRC_BIT;
+}
+
+int host_model_run_task(const char *module, host_model_task_entry *entry,
+			const uint8_t *data, uint32_t length, uint32_t param)
+{
+	struct host_model_module_stats *stats;
+	int err;
+
+	if (!hm_ext || !entry)
+		return -EINVAL;
+	stats = hm_stats_lookup(module);
+	if (!stats)
+		return -ENOMEM;
+
+	hm_ws_reset(param);
+	if (data) {
+		err = hm_fdma_task_start(data, length);
+		if (err)
+			return err;
+	}
+	return hm_run_task(stats, entry);
+}
+
+void host_model_advance_time(uint64_t usec)
+{
+	hm_tman_advance(usec);
+}
+
+uint64_t host_model_get_time(void)
+{
+	return hm_tman_time();
+}
+
+/*****************************************************************************/
+/* OSM                                                                       */
+/*****************************************************************************/
+
+int32_t host_model_osmcmd(uint32_t osm_op, uint32_t scope_id)
+{
+	uint32_t status = 0;
+	int level = hm_task.osm_level;
+
+	switch (osm_op) {
+	case HM_OSM_EXIT_OP:
+		if (level == 0)
+			status = HM_OSM_ERR;
+		else
+			hm_task.osm_level--;
+		break;
+	case HM_OSM_STE_REQ_OP:
+		break;
+	case HM_OSM_RELINQUISH_EXCL_OP:
+		hm_task.osm_excl[level] = 0;
+		break;
+	case HM_OSM_TO_CONC_OP:
+	case HM_OSM_TO_CONC_NEW_ID_OP:
+	case HM_OSM_TO_EXCL_OP:
+	case HM_OSM_TO_EXCL_NEW_ID_OP:
+		if (level == 0) {
+			status = HM_OSM_ERR;
+			break;
+		}
+		hm_task.osm_excl[level] = (osm_op == HM_OSM_TO_EXCL_OP ||
+					   osm_op == HM_OSM_TO_EXCL_NEW_ID_OP);
+		if (osm_op == HM_OSM_TO_CONC_NEW_ID_OP ||
+		    osm_op == HM_OSM_TO_EXCL_NEW_ID_OP)
+			hm_task.osm_scope_id[level] = scope_id;
+		break;
+	default:
+		if (osm_op < HM_OSM_ENTER_FIRST_OP ||
+		    osm_op > HM_OSM_ENTER_LAST_OP) {
+			status = HM_OSM_ERR;
+			break;
+		}
+		if (level == HM_MAX_OSM_LEVEL) {
+			status = HM_OSM_ERR;
+			break;
+		}
+		level++;
+		hm_task.osm_level = level;
+		hm_task.osm_excl[level] = osm_op & HM_OSM_ENTER_EXCL_BIT;
+		hm_task.osm_scope_id[level] = scope_id;
+		break;
+	}
+	hm_count(HOST_MODEL_ENG_OSM, osm_op);
+	if (status)
+		hm_task.stats->errors++;
+	return (int32_t)status;
+}
+
+/*****************************************************************************/
+/* STE                                                                       */
+/*****************************************************************************/
+
+static uint64_t hm_ste_apply(uint64_t val, uint32_t delta, int sub, int is64,
+			     int saturate)
+{
+	uint64_t max = is64 ? UINT64_MAX : UINT32_MAX;
+	uint64_t res;
+
+	if (sub) {
+		if (saturate && val < delta)
+			return 0;
+		res = val - delta;
+	} else {
+		if (saturate && max - val < delta)
+			return max;
+		res = val + delta;
+	}
+	return res & max;
+}
+
+static uint64_t hm_ste_load(uintptr_t addr, int is64)
+{
+	return is64 ? HM_WS64(addr) : HM_WS32(addr);
+}
+
+static void hm_ste_store(uintptr_t addr, int is64, uint64_t val)
+{
+	if (is64)
+		HM_WS64(addr) = val;
+	else
+		HM_WS32(addr) = (uint32_t)val;
+}
+
+static void hm_ste_cmd(uint32_t cmd, uint32_t value, uintptr_t addr)
+{
+	uint32_t op = cmd & HM_STE_OP_MASK;
+	int cntr64 = ((cmd & HM_STE_CNTR_SIZE_MASK) == HM_STE_CNTR_64);
+	int acc64 = ((cmd & HM_STE_ACC_SIZE_MASK) == HM_STE_ACC_64);
+	uintptr_t acc_addr = addr + (cntr64 ? 8 : 4);
+	uint64_t v;
+
+	switch (op) {
+	case HM_STE_SET:
+		hm_ste_store(addr, cntr64, value);
+		break;
+	case HM_STE_SYNC:
+		break;
+	case HM_STE_ADD:
+	case HM_STE_SUB:
+		v = hm_ste_load(addr, cntr64);
+		v = hm_ste_apply(v, value, op == HM_STE_SUB, cntr64,
+				 cmd & HM_STE_SATURATE);
+		hm_ste_store(addr, cntr64, v);
+		break;
+	case HM_STE_INC_ADD:
+	case HM_STE_INC_SUB:
+	case HM_STE_DEC_ADD:
+	case HM_STE_DEC_SUB:
+		v = hm_ste_load(addr, cntr64);
+		v = hm_ste_apply(v, 1, op >= HM_STE_DEC_ADD, cntr64,
+				 cmd & HM_STE_CMP_CNTR_SATURATE);
+		hm_ste_store(addr, cntr64, v);
+		v = hm_ste_load(acc_addr, acc64);
+		v = hm_ste_apply(v, value, op & 1, acc64,
+				 cmd & HM_STE_CMP_ACC_SATURATE);
+		hm_ste_store(acc_addr, acc64, v);
+		break;
+	default:
+		break;
+	}
+}
+
+void host_model_stqw(uint32_t arg1, uint32_t arg2, uint32_t arg3,
+		     uint32_t arg4, uintptr_t ea)
+{
+	volatile uint32_t *p;
+
+	if (ea >= HM_STE_CMD_ADDRESS &&
+	    ea < HM_STE_CMD_ADDRESS + HM_STE_CMD_SIZE) {
+		/* Counters are in host memory: arg3 (address high) is 0 */
+		if (ea == HM_STE_CMD_ADDRESS + HM_STE_CMD_SET_8B) {
+			hm_count(HOST_MODEL_ENG_STE, HM_STE_SET);
+			HM_WS64(arg4) = ((uint64_t)arg1 << 32) | arg2;
+		} else {
+			hm_count(HOST_MODEL_ENG_STE, arg1 & HM_STE_OP_MASK);
+			hm_ste_cmd(arg1, arg2, arg4);
+		}
+		return;
+	}
+	p = (volatile uint32_t *)ea;
+	p[0] = arg1;
+	p[1] = arg2;
+	p[2] = arg3;
+	p[3] = arg4;
+}
+
+/*****************************************************************************/
+/* Dispatcher                                                                */
+/*****************************************************************************/
+
+static enum host_model_engine hm_engine(uint32_t accel_id)
+{
+	switch (accel_id) {
+	case HM_ACCEL_YIELD:
+		return HOST_MODEL_ENG_YIELD;
+	case HM_ACCEL_TMAN:
+		return HOST_MODEL_ENG_TMAN;
+	case HM_ACCEL_MFLU:
+		return HOST_MODEL_ENG_MFLU;
+	case HM_ACCEL_AAP_SEC:
+		return HOST_MODEL_ENG_SEC;
+	case HM_ACCEL_PARSE_CLASSIFY:
+		return HOST_MODEL_ENG_PARSER;
+	case HM_ACCEL_CTLU:
+		return HOST_MODEL_ENG_CTLU;
+	case HM_ACCEL_FPDMA:
+		return HOST_MODEL_ENG_FPDMA;
+	case HM_ACCEL_CDMA:
+		return HOST_MODEL_ENG_CDMA;
+	case HM_ACCEL_FODMA:
+		return HOST_MODEL_ENG_FODMA;
+	default:
+		return HOST_MODEL_ENG_OTHER;
+	}
+}
+
+int32_t host_model_hwaccel(uint32_t accel_id)
+{
+	enum host_model_engine eng = hm_engine(accel_id);
+	uint32_t in = HM_WS32(HM_WS_ACC_IN);
+	uint32_t opcode, status;
+
+	/* Count first: some commands (terminate, enqueue with terminate
+	 * control) do not return to the caller */
+	switch (eng) {
+	case HOST_MODEL_ENG_TMAN:
+		in &= 0xFFFF;
+		opcode = ((in >> 12) << 6) | (in & 0x3F);
+		break;
+	case HOST_MODEL_ENG_OTHER:
+		opcode = accel_id;
+		break;
+	default:
+		opcode = in;
+		break;
+	}
+	hm_count(eng, opcode);
+
+	switch (eng) {
+	case HOST_MODEL_ENG_FPDMA:
+	case HOST_MODEL_ENG_FODMA:
+		status = hm_fdma_cmd(accel_id);
+		break;
+	case HOST_MODEL_ENG_CDMA:
+		status = hm_cdma_cmd();
+		break;
+	case HOST_MODEL_ENG_TMAN:
+		status = hm_tman_cmd();
+		break;
+	case HOST_MODEL_ENG_PARSER:
+		status = hm_parser_cmd();
+		break;
+	case HOST_MODEL_ENG_YIELD:
+		status = 0;
+		break;
+	default:
+		/* Not modeled: tables, keygen, SEC, ... */
+		HM_WS32(HM_WS_ACC_OUT) = 0;
+		status = 0;
+		break;
+	}
+	if (status)
+		hm_task.stats->errors++;
+	return (int32_t)status;
+}
+
+int32_t host_model_ordhwaccel(uint32_t accel_id, uint32_t osm_op,
+			      uint32_t scope_id)
+{
+	int32_t status = host_model_osmcmd(osm_op, scope_id);
+
+	if (status)
+		return status;
+	return host_model_hwaccel(accel_id);
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_model_int.h
+
+@Description	Internal definitions shared by the host model engines.
+*//***************************************************************************/
+
+#ifndef __HOST_MODEL_INT_H
+#define __HOST_MODEL_INT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "host_model.h"
+
+/* Hardware context layout (see fsl_general.h) */
+#define HM_WS_SPID		0x07
+#define HM_WS_ACC_IN		0x20
+#define HM_WS_ACC_IN2		0x24
+#define HM_WS_ACC_IN3		0x28
+#define HM_WS_ACC_IN4		0x2C
+#define HM_WS_ACC_OUT		0x30
+#define HM_WS_ACC_OUT2		0x34
+#define HM_WS_ADC		0x40
+#define HM_WS_PRC		0x50
+#define HM_WS_FD		0x60
+#define HM_WS_PARSE_RES		0x80
+#define HM_WS_HWC_SIZE		0x100
+
+/* Presentation context fields (offsets in HM_WS_PRC) */
+#define HM_PRC_PARAM		0x0
+#define HM_PRC_SEG_ADDRESS	0x4
+#define HM_PRC_SEG_LENGTH	0x6
+#define HM_PRC_SEG_OFFSET	0x8
+#define HM_PRC_SR_NDS		0xA
+#define HM_PRC_SEG_HANDLE	0xB
+#define HM_PRC_OSM		0xC
+#define HM_PRC_FRAME_HANDLE	0xD
+#define HM_PRC_OSRC_BIT		0x80
+
+/* Frame descriptor fields (little-endian) */
+#define HM_FD_ADDR		0x0
+#define HM_FD_LENGTH		0x8
+#define HM_FD_BPID		0xC
+#define HM_FD_OFFSET		0xE
+#define HM_FD_SL_FMT		0xF
+#define HM_FD_FRC		0x10
+#define HM_FD_FLC		0x18
+#define HM_FD_HASH		0x1C
+#define HM_FD_SIZE		0x20
+#define HM_FD_OFFSET_MASK	0x0FFF
+#define HM_FD_BPID_MASK		0x3FFF
+
+/* Accelerator IDs (see fsl_aiop_common.h) */
+#define HM_ACCEL_YIELD		0x00
+#define HM_ACCEL_TMAN		0x01
+#define HM_ACCEL_MFLU		0x02
+#define HM_ACCEL_AAP_SEC	0x03
+#define HM_ACCEL_PARSE_CLASSIFY	0x04
+#define HM_ACCEL_CTLU		0x05
+#define HM_ACCEL_FPDMA		0x0C
+#define HM_ACCEL_CDMA		0x0D
+#define HM_ACCEL_FODMA		0x0E
+
+/* Peripheral registers */
+#define HM_STE_CMD_ADDRESS	0x02010000
+#define HM_STE_CMD_SET_8B	0x40
+#define HM_STE_CMD_SIZE		0x80
+#define HM_TMAN_TMCBCC		0x02020014
+#define HM_TMAN_TMTSTMP		0x02020020
+#define HM_TMAN_CCSR_TMSTATE	0x020a2018
+
+/* Host limits */
+#define HM_MAX_FRAMES		16
+#define HM_MAX_SEGMENTS		14	/* 0xE/0xF are the ASA/PTA handles */
+#define HM_MAX_SF_MARKS		32
+#define HM_MAX_MUTEXES		4
+#define HM_MAX_OSM_LEVEL	4
+#define HM_NO_FD		0xFFFF
+
+/* Workspace access */
+#define HM_WS8(_a)	(*(volatile uint8_t *)(uintptr_t)(_a))
+#define HM_WS16(_a)	(*(volatile uint16_t *)(uintptr_t)(_a))
+#define HM_WS32(_a)	(*(volatile uint32_t *)(uintptr_t)(_a))
+#define HM_WS64(_a)	(*(volatile uint64_t *)(uintptr_t)(_a))
+#define HM_PTR(_a)	((uint8_t *)(uintptr_t)(_a))
+
+/* Little-endian fields (frame descriptors) */
+static inline uint32_t hm_ld_le32(uintptr_t a)
+{
+	const uint8_t *p = HM_PTR(a);
+
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+		((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void hm_st_le32(uintptr_t a, uint32_t val)
+{
+	uint8_t *p = HM_PTR(a);
+
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+	p[2] = (uint8_t)(val >> 16);
+	p[3] = (uint8_t)(val >> 24);
+}
+
+static inline uint64_t hm_ld_le64(uintptr_t a)
+{
+	return ((uint64_t)hm_ld_le32(a + 4) << 32) | hm_ld_le32(a);
+}
+
+static inline void hm_st_le64(uintptr_t a, uint64_t val)
+{
+	hm_st_le32(a, (uint32_t)val);
+	hm_st_le32(a + 4, (uint32_t)(val >> 32));
+}
+
+/** Held CDMA mutex */
+struct hm_mutex {
+	uint64_t address;
+	int write;
+};
+
+/** State of the running task */
+struct hm_task {
+	struct host_model_module_stats *stats;
+	int running;
+	int terminated;
+	/* OSM */
+	int osm_level;
+	int osm_excl[HM_MAX_OSM_LEVEL + 1];
+	uint32_t osm_scope_id[HM_MAX_OSM_LEVEL + 1];
+	/* CDMA */
+	struct hm_mutex mutex[HM_MAX_MUTEXES];
+	int num_mutexes;
+};
+
+extern struct hm_task hm_task;
+
+/* host_model.c */
+void hm_count(enum host_model_engine eng, uint32_t opcode);
+void hm_task_terminate(void);
+struct host_model_module_stats *hm_stats_lookup(const char *module);
+int hm_run_task(struct host_model_module_stats *stats,
+		host_model_task_entry *entry);
+void hm_set_status8(uint8_t status);
+void hm_ws_reset(uint32_t param);
+
+/* host_cdma.c */
+void hm_cdma_init(void);
+void hm_cdma_free(void);
+uint8_t hm_cdma_cmd(void);
+void hm_cdma_task_end(void);
+int hm_bpool_acquire(uint16_t bpid, uint64_t *addr);
+int hm_bpool_release(uint16_t bpid, uint64_t addr);
+int hm_bpool_find(uint64_t addr, uint16_t *bpid);
+
+/* host_fdma.c */
+void hm_fdma_init(void);
+void hm_fdma_free(void);
+uint8_t hm_fdma_cmd(uint32_t accel_id);
+int hm_fdma_task_start(const uint8_t *data, uint32_t length);
+void hm_fdma_task_end(void);
+uint64_t hm_frame_buffer_create(const uint8_t *data, uint32_t length);
+
+/* host_tman.c */
+void hm_tman_init(void);
+void hm_tman_free(void);
+uint32_t hm_tman_cmd(void);
+void hm_tman_task_end(void);
+void hm_tman_advance(uint64_t usec);
+uint64_t hm_tman_time(void);
+
+/* host_parser.c */
+uint32_t hm_parser_cmd(void);
+void hm_parse_default_frame(void);
+
+/* host_services.c */
+int hm_services_init(void);
+
+#endif /* __HOST_MODEL_INT_H */
@@ -0,0 +1,408 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_parser.c
+
+@Description	Host model of the parser "generate parse result" command.
+
+		Covers the headers the networking functions depend on:
+		Ethernet, VLAN, IPv4, IPv6 with extension headers (fragment,
+		routing), IP in IP, UDP, TCP, ESP and AH. Soft parsing,
+		checksum validation and the other parse/classify commands
+		are not modeled.
+*//***************************************************************************/
+
+#include <string.h>
+
+#include "host_model_int.h"
+
+#define HM_PARSER_GEN_PARSE_RES_MTYPE	0x0015
+#define HM_PARSER_MTYPE_MASK		0x00FF
+#define HM_PARSER_HXS_SHIFT		13
+#define HM_PARSER_HXS_MASK		0x7FF
+#define HM_PARSER_OFFSET_SHIFT		24
+
+/* Starting HXS codes (enum parser_starting_hxs_code) */
+#define HM_HXS_ETH			0x0
+#define HM_HXS_VLAN			0x2
+#define HM_HXS_IP			0x6
+#define HM_HXS_IPV4			0x7
+#define HM_HXS_IPV6			0x8
+#define HM_HXS_TCP			0xC
+#define HM_HXS_UDP			0xD
+
+/* Parse result fields */
+#define HM_PR_FAF1			0x04
+#define HM_PR_FAF2			0x08
+#define HM_PR_FAF3			0x0C
+#define HM_PR_IP_1_PID_OFFSET		0x12
+#define HM_PR_ETH_OFFSET		0x13
+#define HM_PR_VLAN_TCI1_OFFSET		0x15
+#define HM_PR_VLAN_TCIN_OFFSET		0x16
+#define HM_PR_LAST_ETYPE_OFFSET		0x17
+#define HM_PR_L3_OFFSET			0x1B
+#define HM_PR_IPN_OFFSET		0x1C
+#define HM_PR_L4_OFFSET			0x1E
+#define HM_PR_L5_OFFSET			0x1F
+#define HM_PR_RH_OFFSET1		0x20
+#define HM_PR_NXT_HDR_OFFSET		0x22
+#define HM_PR_IPV6_FRAG_OFFSET		0x23
+#define HM_PR_IP_N_PID_OFFSET		0x2A
+#define HM_PR_SIZE			0x40
+#define HM_PR_NO_OFFSET			0xFF
+
+/* Frame attribute flags (fsl_parser.h) */
+#define HM_FAF1_ETH_MAC			0x00200000
+#define HM_FAF1_ETH_UNICAST		0x00100000
+#define HM_FAF1_ETH_MULTICAST		0x00080000
+#define HM_FAF1_ETH_BROADCAST		0x00040000
+#define HM_FAF1_VLAN_1			0x00000400
+#define HM_FAF1_VLAN_N			0x00000200
+#define HM_FAF1_ARP			0x00000002
+#define HM_FAF2_IPV4_1			0x20000000
+#define HM_FAF2_IPV4_1_UNICAST		0x10000000
+#define HM_FAF2_IPV4_1_MULTICAST	0x08000000
+#define HM_FAF2_IPV4_1_BROADCAST	0x04000000
+#define HM_FAF2_IPV4_N			0x02000000
+#define HM_FAF2_IPV4_N_UNICAST		0x01000000
+#define HM_FAF2_IPV6_1			0x00200000
+#define HM_FAF2_IPV6_1_UNICAST		0x00100000
+#define HM_FAF2_IPV6_1_MULTICAST	0x00080000
+#define HM_FAF2_IPV6_N			0x00040000
+#define HM_FAF2_IPV6_N_UNICAST		0x00020000
+#define HM_FAF2_IP_1_OPTIONS		0x00008000
+#define HM_FAF2_IP_1_FRAGMENT		0x00002000
+#define HM_FAF2_IP_1_INIT_FRAGMENT	0x00001000
+#define HM_FAF2_IP_N_OPTIONS		0x00000400
+#define HM_FAF2_IP_N_FRAGMENT		0x00000100
+#define HM_FAF2_IP_N_INIT_FRAGMENT	0x00000080
+#define HM_FAF2_ICMP			0x00000040
+#define HM_FAF2_ICMPV6			0x00000010
+#define HM_FAF3_UDP			0x02000000
+#define HM_FAF3_TCP			0x00800000
+#define HM_FAF3_TCP_OPTIONS		0x00400000
+#define HM_FAF3_IPSEC			0x00040000
+#define HM_FAF3_IPSEC_ESP		0x00020000
+#define HM_FAF3_IPSEC_AH		0x00010000
+
+#define HM_ETYPE_VLAN			0x8100
+#define HM_ETYPE_QINQ			0x88A8
+#define HM_ETYPE_IPV4			0x0800
+#define HM_ETYPE_IPV6			0x86DD
+#define HM_ETYPE_ARP			0x0806
+#define HM_IP_PROTO_HOPOPTS		0
+#define HM_IP_PROTO_ICMP		1
+#define HM_IP_PROTO_IPIP		4
+#define HM_IP_PROTO_TCP			6
+#define HM_IP_PROTO_UDP			17
+#define HM_IP_PROTO_IPV6		41
+#define HM_IP_PROTO_ROUTING		43
+#define HM_IP_PROTO_FRAGMENT		44
+#define HM_IP_PROTO_ESP			50
+#define HM_IP_PROTO_AH			51
+#define HM_IP_PROTO_ICMPV6		58
+#define HM_IP_PROTO_DSTOPTS		60
+
+struct hm_parse {
+	const uint8_t *p;
+	uint32_t len;
+	uint32_t faf1, faf2, faf3;
+};
+
+static uint16_t hm_be16(const uint8_t *p)
+{
+	return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void hm_pr_set(uint32_t field, uint32_t offset)
+{
+	HM_WS8(HM_WS_PARSE_RES + field) = (uint8_t)offset;
+}
+
+static void hm_parse_l4(struct hm_parse *ps, uint32_t off, uint8_t proto)
+{
+	switch (proto) {
+	case HM_IP_PROTO_UDP:
+		if (off + 8 > ps->len)
+			return;
+		ps->faf3 |= HM_FAF3_UDP;
+		hm_pr_set(HM_PR_L4_OFFSET, off);
+		hm_pr_set(HM_PR_L5_OFFSET, off + 8);
+		break;
+	case HM_IP_PROTO_TCP:
+		if (off + 20 > ps->len)
+			return;
+		ps->faf3 |= HM_FAF3_TCP;
+		if ((ps->p[off + 12] >> 4) > 5)
+			ps->faf3 |= HM_FAF3_TCP_OPTIONS;
+		hm_pr_set(HM_PR_L4_OFFSET, off);
+		hm_pr_set(HM_PR_L5_OFFSET, off + (ps->p[off + 12] >> 4) * 4);
+		break;
+	case HM_IP_PROTO_ESP:
+		ps->faf3 |= HM_FAF3_IPSEC | HM_FAF3_IPSEC_ESP;
+		hm_pr_set(HM_PR_L4_OFFSET, off);
+		break;
+	case HM_IP_PROTO_AH:
+		ps->faf3 |= HM_FAF3_IPSEC | HM_FAF3_IPSEC_AH;
+		hm_pr_set(HM_PR_L4_OFFSET, off);
+		break;
+	case HM_IP_PROTO_ICMP:
+		ps->faf2 |= HM_FAF2_ICMP;
+		hm_pr_set(HM_PR_L4_OFFSET, off);
+		break;
+	case HM_IP_PROTO_ICMPV6:
+		ps->faf2 |= HM_FAF2_ICMPV6;
+		hm_pr_set(HM_PR_L4_OFFSET, off);
+		break;
+	default:
+		break;
+	}
+}
+
+static void hm_parse_ip(struct hm_parse *ps, uint32_t off, int level);
+
+/* The last IP header is "IP N"; for a single header 1 and N are the same */
+static void hm_parse_ipv4(struct hm_parse *ps, uint32_t off, int level)
+{
+	const uint8_t *ip = ps->p + off;
+	uint32_t ihl, frag;
+	uint8_t proto;
+
+	if (off + 20 > ps->len)
+		return;
+	ihl = (ip[0] & 0xF) * 4;
+	proto = ip[9];
+	frag = hm_be16(ip + 6) & 0x3FFF;
+	ps->faf2 |= HM_FAF2_IPV4_N | HM_FAF2_IPV4_N_UNICAST;
+	ps->faf2 &= ~(HM_FAF2_IP_N_OPTIONS | HM_FAF2_IP_N_FRAGMENT |
+		      HM_FAF2_IP_N_INIT_FRAGMENT);
+	if (ihl > 20)
+		ps->faf2 |= HM_FAF2_IP_N_OPTIONS;
+	if (frag)
+		ps->faf2 |= HM_FAF2_IP_N_FRAGMENT;
+	if (frag && !(frag & 0x1FFF))
+		ps->faf2 |= HM_FAF2_IP_N_INIT_FRAGMENT;
+	hm_pr_set(HM_PR_IPN_OFFSET, off);
+	hm_pr_set(HM_PR_IP_N_PID_OFFSET, off + 9);
+	if (level == 0) {
+		ps->faf2 |= HM_FAF2_IPV4_1;
+		if (ip[16] >= 224 && ip[16] < 240)
+			ps->faf2 |= HM_FAF2_IPV4_1_MULTICAST;
+		else if (hm_be16(ip + 16) == 0xFFFF && hm_be16(ip + 18) == 0xFFFF)
+			ps->faf2 |= HM_FAF2_IPV4_1_BROADCAST;
+		else
+			ps->faf2 |= HM_FAF2_IPV4_1_UNICAST;
+		if (ihl > 20)
+			ps->faf2 |= HM_FAF2_IP_1_OPTIONS;
+		if (frag)
+			ps->faf2 |= HM_FAF2_IP_1_FRAGMENT;
+		if (frag && !(frag & 0x1FFF))
+			ps->faf2 |= HM_FAF2_IP_1_INIT_FRAGMENT;
+		hm_pr_set(HM_PR_L3_OFFSET, off);
+		hm_pr_set(HM_PR_IP_1_PID_OFFSET, off + 9);
+	}
+	/* Only the first fragment carries the upper layer headers */
+	if (frag & 0x1FFF)
+		return;
+	if ((proto == HM_IP_PROTO_IPIP || proto == HM_IP_PROTO_IPV6) &&
+	    level == 0)
+		hm_parse_ip(ps, off + ihl, level + 1);
+	else
+		hm_parse_l4(ps, off + ihl, proto);
+}
+
+static void hm_parse_ipv6(struct hm_parse *ps, uint32_t off, int level)
+{
+	const uint8_t *ip = ps->p + off;
+	uint32_t next_off = off + 40, pid_off = off + 6;
+	uint8_t proto = ip[6];
+	int frag = 0, init_frag = 0;
+
+	if (off + 40 > ps->len)
+		return;
+	ps->faf2 |= HM_FAF2_IPV6_N | HM_FAF2_IPV6_N_UNICAST;
+	hm_pr_set(HM_PR_IPN_OFFSET, off);
+	if (level == 0) {
+		ps->faf2 |= HM_FAF2_IPV6_1 | ((ip[24] == 0xFF) ?
+			HM_FAF2_IPV6_1_MULTICAST : HM_FAF2_IPV6_1_UNICAST);
+		hm_pr_set(HM_PR_L3_OFFSET, off);
+	}
+
+	/* Extension headers */
+	while (next_off + 8 <= ps->len) {
+		const uint8_t *ext = ps->p + next_off;
+
+		if (proto == HM_IP_PROTO_HOPOPTS ||
+		    proto == HM_IP_PROTO_DSTOPTS ||
+		    proto == HM_IP_PROTO_ROUTING) {
+			if (proto == HM_IP_PROTO_ROUTING)
+				hm_pr_set(HM_PR_RH_OFFSET1, next_off);
+			pid_off = next_off;
+			proto = ext[0];
+			next_off += (ext[1] + 1) * 8;
+		} else if (proto == HM_IP_PROTO_FRAGMENT) {
+			hm_pr_set(HM_PR_IPV6_FRAG_OFFSET, next_off);
+			frag = 1;
+			init_frag = !(hm_be16(ext + 2) & 0xFFF8);
+			pid_off = next_off;
+			proto = ext[0];
+			next_off += 8;
+		} else {
+			break;
+		}
+	}
+	hm_pr_set(HM_PR_IP_N_PID_OFFSET, pid_off);
+	if (level == 0)
+		hm_pr_set(HM_PR_IP_1_PID_OFFSET, pid_off);
+	if (frag) {
+		ps->faf2 |= HM_FAF2_IP_N_FRAGMENT |
+			(init_frag ? HM_FAF2_IP_N_INIT_FRAGMENT : 0);
+		if (level == 0)
+			ps->faf2 |= HM_FAF2_IP_1_FRAGMENT |
+				(init_frag ? HM_FAF2_IP_1_INIT_FRAGMENT : 0);
+		if (!init_frag)
+			return;
+	}
+	hm_pr_set(HM_PR_NXT_HDR_OFFSET, pid_off);
+	if ((proto == HM_IP_PROTO_IPIP || proto == HM_IP_PROTO_IPV6) &&
+	    level == 0)
+		hm_parse_ip(ps, next_off, level + 1);
+	else
+		hm_parse_l4(ps, next_off, proto);
+}
+
+static void hm_parse_ip(struct hm_parse *ps, uint32_t off, int level)
+{
+	if (off >= ps->len)
+		return;
+	if ((ps->p[off] >> 4) == 4)
+		hm_parse_ipv4(ps, off, level);
+	else if ((ps->p[off] >> 4) == 6)
+		hm_parse_ipv6(ps, off, level);
+}
+
+static void hm_parse_eth(struct hm_parse *ps, uint32_t off, int vlan)
+{
+	uint16_t etype;
+	int tags = 0;
+
+	if (!vlan) {
+		if (off + 14 > ps->len)
+			return;
+		ps->faf1 |= HM_FAF1_ETH_MAC;
+		if (!memcmp(ps->p + off, "\xff\xff\xff\xff\xff\xff", 6))
+			ps->faf1 |= HM_FAF1_ETH_BROADCAST;
+		else if (ps->p[off] & 1)
+			ps->faf1 |= HM_FAF1_ETH_MULTICAST;
+		else
+			ps->faf1 |= HM_FAF1_ETH_UNICAST;
+		hm_pr_set(HM_PR_ETH_OFFSET, off);
+		off += 12;
+	}
+	etype = hm_be16(ps->p + off);
+	/* A VLAN starting HXS points to a tag whatever its TPID */
+	while ((etype == HM_ETYPE_VLAN || etype == HM_ETYPE_QINQ || vlan) &&
+	       off + 6 <= ps->len) {
+		vlan = 0;
+		ps->faf1 |= tags ? HM_FAF1_VLAN_N : HM_FAF1_VLAN_1;
+		if (!tags)
+			hm_pr_set(HM_PR_VLAN_TCI1_OFFSET, off + 2);
+		hm_pr_set(HM_PR_VLAN_TCIN_OFFSET, off + 2);
+		tags++;
+		off += 4;
+		etype = hm_be16(ps->p + off);
+	}
+	hm_pr_set(HM_PR_LAST_ETYPE_OFFSET, off);
+	off += 2;
+	if (etype == HM_ETYPE_IPV4 || etype == HM_ETYPE_IPV6)
+		hm_parse_ip(ps, off, 0);
+	else if (etype == HM_ETYPE_ARP)
+		ps->faf1 |= HM_FAF1_ARP;
+}
+
+static void hm_parse(uint32_t hxs, uint32_t start)
+{
+	struct hm_parse ps;
+	uint16_t seg_addr = HM_WS16(HM_WS_PRC + HM_PRC_SEG_ADDRESS);
+	uint16_t seg_len = HM_WS16(HM_WS_PRC + HM_PRC_SEG_LENGTH);
+	uint16_t grs = HM_WS16(HM_WS_PARSE_RES + 0x24);
+
+	/* Offsets are relative to the start of the presented segment */
+	memset(&ps, 0, sizeof(ps));
+	ps.p = HM_PTR(seg_addr);
+	ps.len = seg_len;
+	memset(HM_PTR(HM_WS_PARSE_RES), 0, HM_PR_SIZE);
+	memset(HM_PTR(HM_WS_PARSE_RES + HM_PR_IP_1_PID_OFFSET),
+	       HM_PR_NO_OFFSET, HM_PR_IPV6_FRAG_OFFSET + 1 -
+	       HM_PR_IP_1_PID_OFFSET);
+	HM_WS8(HM_WS_PARSE_RES + HM_PR_IP_N_PID_OFFSET) = HM_PR_NO_OFFSET;
+	HM_WS16(HM_WS_PARSE_RES + 0x24) = grs;
+
+	switch (hxs) {
+	case HM_HXS_ETH:
+		hm_parse_eth(&ps, start, 0);
+		break;
+	case HM_HXS_VLAN:
+		hm_parse_eth(&ps, start, 1);
+		break;
+	case HM_HXS_IP:
+	case HM_HXS_IPV4:
+	case HM_HXS_IPV6:
+		hm_parse_ip(&ps, start, 0);
+		break;
+	case HM_HXS_TCP:
+		hm_parse_l4(&ps, start, HM_IP_PROTO_TCP);
+		break;
+	case HM_HXS_UDP:
+		hm_parse_l4(&ps, start, HM_IP_PROTO_UDP);
+		break;
+	default:
+		break;
+	}
+	HM_WS32(HM_WS_PARSE_RES + HM_PR_FAF1) = ps.faf1;
+	HM_WS32(HM_WS_PARSE_RES + HM_PR_FAF2) = ps.faf2;
+	HM_WS32(HM_WS_PARSE_RES + HM_PR_FAF3) = ps.faf3;
+}
+
+void hm_parse_default_frame(void)
+{
+	hm_parse(HM_HXS_ETH, 0);
+}
+
+uint32_t hm_parser_cmd(void)
+{
+	uint32_t arg1 = HM_WS32(HM_WS_ACC_IN);
+	uint32_t arg4 = HM_WS32(HM_WS_ACC_IN4);
+
+	HM_WS32(HM_WS_ACC_OUT) = 0;
+	/* Profile and soft parser management is not modeled */
+	if ((arg1 & HM_PARSER_MTYPE_MASK) != HM_PARSER_GEN_PARSE_RES_MTYPE)
+		return 0;
+	hm_parse((arg4 >> HM_PARSER_HXS_SHIFT) & HM_PARSER_HXS_MASK,
+		 arg4 >> HM_PARSER_OFFSET_SHIFT);
+	return 0;
+}
@@ -0,0 +1,403 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_services.c
+
+@Description	Host replacements of the AIOP SL kernel services (memory,
+		time, print, system globals) used by the accelerator drivers
+		and netf modules built into the model.
+
+		Only the services needed to run the data path are provided:
+		MC objects (DPRC/DPBP/DPNI) are reported as not present and
+		memory allocations are served from the model external memory.
+*//***************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fsl_types.h"
+#include "fsl_errors.h"
+#include "fsl_dbg.h"
+#include "fsl_malloc.h"
+#include "fsl_time.h"
+#include "fsl_stdlib.h"
+#include "fsl_icontext.h"
+#include "fsl_system.h"
+#include "fsl_platform.h"
+#include "fsl_aiop_common.h"
+#include "fsl_sl_slab.h"
+#include "fsl_bman.h"
+#include "fsl_dprc.h"
+#include "fsl_dpbp.h"
+#include "fsl_dpni_drv.h"
+#include "system.h"
+#include "general.h"
+
+#include "host_model.h"
+
+/* First BPID handed out by slab_find_and_reserve_bpid() */
+#define HM_SVC_FIRST_BPID	0x100
+/* Buffer pool backing the ID pools (see id_pool_init()) */
+#define HM_SVC_ID_POOL_SIZE	(3 + 256)
+
+/*****************************************************************************/
+/* System globals                                                            */
+/*****************************************************************************/
+
+t_system sys;
+struct icontext icontext_aiop;
+struct aiop_init_info g_init_data;
+struct platform_app_params g_app_params;
+struct dpni_drv *nis;
+struct storage_profile storage_profile[SP_NUM_OF_STORAGE_PROFILES];
+uint64_t ext_prpid_pool_address;
+uint64_t ext_keyid_pool_address;
+
+static uint16_t hm_svc_next_bpid = HM_SVC_FIRST_BPID;
+static uint32_t hm_svc_rand_seed = 1;
+static int hm_svc_print = 1;
+
+/* Builds an ID pool in the layout of id_pool_init(): a 16-bit index, the last
+ * ID and the IDs themselves. The index is read in host byte order by
+ * get_id(), so it is written in host byte order here. */
+static uint64_t hm_svc_id_pool_create(uint16_t num_of_ids)
+{
+	uint64_t addr;
+	uint8_t *pool;
+	int i;
+
+	addr = host_model_ext_alloc(HM_SVC_ID_POOL_SIZE, 64);
+	if (!addr)
+		return 0;
+	pool = (uint8_t *)(uintptr_t)addr;
+	*(uint16_t *)pool = 0;
+	pool[2] = (uint8_t)(num_of_ids - 1);
+	for (i = 0; i < num_of_ids; i++)
+		pool[3 + i] = (uint8_t)i;
+	return addr;
+}
+
+/**************************************************************************//**
+@Function	hm_services_init
+
+@Description	Initializes the system globals used by the drivers: the
+		PRPID/KeyID pools of the system accelerator module, the
+		storage profiles and the isolation context.
+
+@Return		0 on success, -ENOMEM on failure.
+*//***************************************************************************/
+int hm_services_init(void)
+{
+	hm_svc_next_bpid = HM_SVC_FIRST_BPID;
+	hm_svc_rand_seed = 1;
+	memset(storage_profile, 0, sizeof(storage_profile));
+	memset(&icontext_aiop, 0, sizeof(icontext_aiop));
+
+	ext_prpid_pool_address = hm_svc_id_pool_create(SYS_NUM_OF_PRPIDS);
+	ext_keyid_pool_address = hm_svc_id_pool_create(SYS_NUM_OF_KEYIDS);
+	if (!ext_prpid_pool_address || !ext_keyid_pool_address)
+		return -ENOMEM;
+	return 0;
+}
+
+/*****************************************************************************/
+/* Print and errors                                                          */
+/*****************************************************************************/
+
+void enable_print_protection()
+{
+}
+
+void disable_print_protection()
+{
+}
+
+void host_model_set_print(int enable)
+{
+	hm_svc_print = enable;
+}
+
+void dbg_print(char *format, ...)
+{
+	va_list args;
+
+	if (!hm_svc_print)
+		return;
+	va_start(args, format);
+	vfprintf(stdout, format, args);
+	va_end(args);
+}
+
+void exception_handler(char *filename,
+		       char *function_name,
+		       uint32_t line,
+		       char *message)
+{
+	fprintf(stderr, "host_model: exception in %s, %s():%u: %s\n",
+		filename, function_name, line, message);
+	abort();
+}
+
+uint32_t booke_get_id(void)
+{
+	return 0;
+}
+
+/*****************************************************************************/
+/* Memory                                                                    */
+/*****************************************************************************/
+
+int fsl_get_mem(uint64_t size, int mem_partition_id, uint64_t alignment,
+		uint64_t *paddr)
+{
+	UNUSED(mem_partition_id);
+
+	if ((size >> 32) || (alignment >> 32))
+		return -ENOMEM;
+	*paddr = host_model_ext_alloc((uint32_t)size, (uint32_t)alignment);
+	return *paddr ? 0 : -ENOMEM;
+}
+
+/* The external memory arena is released as a whole by host_model_free() */
+void fsl_put_mem(uint64_t paddr)
+{
+	UNUSED(paddr);
+}
+
+int fsl_mem_exists(int mem_partition_id)
+{
+	UNUSED(mem_partition_id);
+	return 1;
+}
+
+/* Virtual and physical addresses are identical in the model */
+void *sys_phys_to_virt(uint64_t phy_addr)
+{
+	return (void *)(uintptr_t)phy_addr;
+}
+
+void *sys_get_handle(enum fsl_module module, int num_of_ids, ...)
+{
+	UNUSED(module);
+	UNUSED(num_of_ids);
+	return NULL;
+}
+
+int slab_find_and_reserve_bpid(uint32_t num_buffs,
+			uint16_t buff_size,
+			uint16_t alignment,
+			enum memory_partition_id  mem_partition_id,
+			uint16_t *bpid_array_index,
+			uint16_t *bpid)
+{
+	int err;
+
+	UNUSED(alignment);
+	UNUSED(mem_partition_id);
+
+	err = host_model_bpool_create(hm_svc_next_bpid, buff_size, num_buffs);
+	if (err)
+		return err;
+	*bpid = hm_svc_next_bpid++;
+	if (bpid_array_index)
+		*bpid_array_index = 0;
+	return 0;
+}
+
+int slab_find_and_unreserve_bpid(int32_t num_buffs,
+                            uint16_t bpid)
+{
+	UNUSED(num_buffs);
+	UNUSED(bpid);
+	return 0;
+}
+
+int slab_register_context_buffer_requirements(uint32_t    committed_buffs,
+                                              uint32_t    max_buffs,
+                                              uint16_t    buff_size,
+                                              uint16_t    alignment,
+                                              enum memory_partition_id  mem_pid,
+                                              uint32_t    flags,
+                                              uint32_t    num_ddr_pools)
+{
+	UNUSED(committed_buffs);
+	UNUSED(max_buffs);
+	UNUSED(buff_size);
+	UNUSED(alignment);
+	UNUSED(mem_pid);
+	UNUSED(flags);
+	UNUSED(num_ddr_pools);
+	return 0;
+}
+
+int bman_fill_bpid(uint32_t num_buffs,
+                     uint16_t buff_size,
+                     uint16_t alignment,
+                     enum memory_partition_id  mem_partition_id,
+                     uint16_t bpid,
+                     uint16_t alignment_extension)
+{
+	UNUSED(alignment);
+	UNUSED(mem_partition_id);
+	UNUSED(alignment_extension);
+
+	return host_model_bpool_create(bpid, buff_size, num_buffs);
+}
+
+/*****************************************************************************/
+/* MC objects (not present in the model)                                     */
+/*****************************************************************************/
+
+int dprc_get_obj_count(struct fsl_mc_io	*mc_io,
+		       uint32_t		cmd_flags,
+		       uint16_t		token,
+		       int		*obj_count)
+{
+	UNUSED(mc_io);
+	UNUSED(cmd_flags);
+	UNUSED(token);
+	*obj_count = 0;
+	return 0;
+}
+
+int dprc_get_obj(struct fsl_mc_io	*mc_io,
+		 uint32_t		cmd_flags,
+		 uint16_t		token,
+		 int			obj_index,
+		 struct dprc_obj_desc	*obj_desc)
+{
+	UNUSED(mc_io);
+	UNUSED(cmd_flags);
+	UNUSED(token);
+	UNUSED(obj_index);
+	UNUSED(obj_desc);
+	return -ENODEV;
+}
+
+int dpbp_open(struct fsl_mc_io	*mc_io,
+	      uint32_t		cmd_flags,
+	      int		dpbp_id,
+	      uint16_t		*token)
+{
+	UNUSED(mc_io);
+	UNUSED(cmd_flags);
+	UNUSED(dpbp_id);
+	UNUSED(token);
+	return -ENODEV;
+}
+
+int dpbp_enable(struct fsl_mc_io	*mc_io,
+		uint32_t		cmd_flags,
+		uint16_t		token)
+{
+	UNUSED(mc_io);
+	UNUSED(cmd_flags);
+	UNUSED(token);
+	return -ENODEV;
+}
+
+int dpbp_get_attributes(struct fsl_mc_io	*mc_io,
+			uint32_t		cmd_flags,
+			uint16_t		token,
+			struct dpbp_attr	*attr)
+{
+	UNUSED(mc_io);
+	UNUSED(cmd_flags);
+	UNUSED(token);
+	UNUSED(attr);
+	return -ENODEV;
+}
+
+/* Locally administered address derived from the NI ID */
+int dpni_drv_get_primary_mac_addr(uint16_t ni_id,
+		uint8_t mac_addr[NET_HDR_FLD_ETH_ADDR_SIZE])
+{
+	mac_addr[0] = 0x02;
+	mac_addr[1] = 0x00;
+	mac_addr[2] = 0x00;
+	mac_addr[3] = 0x00;
+	mac_addr[4] = (uint8_t)(ni_id >> 8);
+	mac_addr[5] = (uint8_t)ni_id;
+	return 0;
+}
+
+/*****************************************************************************/
+/* Time and random numbers                                                   */
+/*****************************************************************************/
+
+/* Milliseconds since midnight; the model time starts at midnight */
+int fsl_get_time_ms(uint32_t *time)
+{
+	*time = (uint32_t)((host_model_get_time() / 1000) % 86400000);
+	return 0;
+}
+
+/* Deterministic, so runs can be compared between builds */
+uint32_t fsl_rand(void)
+{
+	hm_svc_rand_seed = hm_svc_rand_seed * 1103515245 + 12345;
+	return hm_svc_rand_seed;
+}
+
+/*****************************************************************************/
+/* Checksum (src/lib/util/checksum.c is core assembly)                       */
+/*****************************************************************************/
+
+uint16_t cksum_ones_complement_sum16(uint16_t arg1, uint16_t arg2)
+{
+	uint32_t tmp = (uint32_t)arg1 + (uint32_t)arg2;
+
+	return (uint16_t)(tmp + (tmp >> 16));
+}
+
+uint16_t cksum_ones_complement_dec16(uint16_t arg1, uint16_t arg2)
+{
+	uint32_t tmp = (uint32_t)arg1 + (uint16_t)~arg2;
+
+	return (uint16_t)(tmp + (tmp >> 16));
+}
+
+uint16_t cksum_accumulative_update_uint32(uint16_t cksum,
+					  uint32_t old_val,
+					  uint32_t new_val)
+{
+	uint64_t sum = (uint64_t)cksum + old_val + (uint32_t)~new_val;
+	uint32_t tmp;
+
+	sum = (sum & 0xFFFFFFFF) + (sum >> 32);
+	tmp = (uint32_t)((sum & 0xFFFFFFFF) + (sum >> 32));
+	return (uint16_t)((((tmp << 16) | (tmp >> 16)) + tmp) >> 16);
+}
+
+void cksum_update_uint32(register uint16_t *cs_ptr,
+			 register uint32_t old_val,
+			 register uint32_t new_val)
+{
+	*cs_ptr = cksum_accumulative_update_uint32(*cs_ptr, old_val, new_val);
+}
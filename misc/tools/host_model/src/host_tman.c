@@ -0,0 +1,490 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_tman.c
+
+@Description	Host model of the TMAN: timer instances, timers and the
+		model time base.
+
+		Time only moves in host_model_advance_time(); every timer
+		that expires on the way runs the timer event entry point
+		(tman_timer_callback) as a task of the module that created
+		the timer. Completion confirmations written to TMCBCC are
+		collected at the next TMAN command and at task end.
+*//***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_model_int.h"
+
+/* Commands (see tman.h) */
+#define HM_TMAN_TMI_CREATE		0x1000
+#define HM_TMAN_TMI_DELETE		0x1011
+#define HM_TMAN_TMI_DELETE_FORCE	0x1012
+#define HM_TMAN_TMI_QUERY		0x1023
+#define HM_TMAN_TIMER_CREATE		0x2010
+#define HM_TMAN_TIMER_DELETE		0x2001
+#define HM_TMAN_TIMER_DELETE_FORCE	0x2002
+#define HM_TMAN_TIMER_DELETE_FORCE_WAIT	0x2003
+#define HM_TMAN_TIMER_MODIFY		0x2004
+#define HM_TMAN_TIMER_RECHARGE		0x2005
+#define HM_TMAN_TIMER_QUERY		0x2006
+
+/* Command fields */
+#define HM_TMAN_EXT_ADDRESS		0xA
+#define HM_TMAN_FLAGS_DURATION		0xC
+#define HM_TMAN_DURATION_MASK		0x0000FFFF
+#define HM_TMAN_GRANULARITY_MASK	0x00070000
+#define HM_TMAN_GRANULARITY_SHIFT	16
+#define HM_TMAN_ONE_SHOT		0x10000000
+#define HM_TMAN_MIN_DURATION		10
+
+/* Results (see tman.h) */
+#define HM_TMAN_SUCCESS			0
+#define HM_TMAN_TMIID_DEPLETION		0x814000C0
+#define HM_TMAN_TMI_CMD_ERR		0x81400000
+#define HM_TMAN_ILLEGAL_DURATION	0x81800010
+#define HM_TMAN_TMR_TMI_STATE_ERR	0x81C00010
+#define HM_TMAN_TMR_DEPLETION		0x81C00020
+#define HM_TMAN_DEL_NOT_ACTIVE		0x81800050
+#define HM_TMAN_DEL_CCP_WAIT		0x81800051
+#define HM_TMAN_DEL_PERIODIC_CCP_WAIT	0x81800055
+#define HM_TMAN_DEL_ISSUED		0x81800056
+/* Modify and recharge errors are the delete errors + 0x10 / + 0x20 */
+#define HM_TMAN_MOD_ERR_DELTA		0x10
+#define HM_TMAN_REC_ERR_DELTA		0x20
+
+/* TMI states */
+#define HM_TMI_NOT_ACTIVE		0
+#define HM_TMI_ACTIVE			1
+
+/* Timer query states (enum e_tman_query_timer) */
+#define HM_TIMER_NON_ACTIVE		0
+#define HM_TIMER_WAIT_CONF		1
+#define HM_TIMER_RUNNING		4
+#define HM_TIMER_BEING_DELETED		6
+
+#define HM_MAX_TMIS			64
+#define HM_MAX_TIMERS_PER_TMI		0x10000
+#define HM_TMI_STATE_STRIDE_SHIFT	5
+
+/** Input extension of the create timer / delete TMI commands */
+struct hm_tman_ext {
+	uint64_t opaque_data1;
+	uint32_t hash;
+	uint32_t opaque_data2_epid;
+};
+
+struct hm_timer {
+	int active;
+	int ccp;
+	int deleting;
+	int one_shot;
+	uint64_t period;
+	uint64_t deadline;
+	uint32_t missed;
+	struct hm_tman_ext ext;
+	struct host_model_module_stats *stats;
+};
+
+struct hm_tmi {
+	int active;
+	uint32_t max_timers;
+	struct hm_timer *timers;
+	/* Pending delete confirmation */
+	int conf_pending;
+	struct hm_tman_ext conf;
+	struct host_model_module_stats *conf_stats;
+};
+
+/* Timer event entry point of the service layer; the model calls the
+ * callback itself when tman.c is not linked */
+extern void tman_timer_callback(void) __attribute__((weak));
+
+static struct hm_tmi hm_tmis[HM_MAX_TMIS];
+static uint64_t hm_now;
+
+static const uint64_t hm_tick_usec[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 1000000
+};
+
+static void hm_tman_set_time(uint64_t now)
+{
+	hm_now = now;
+	HM_WS64(HM_TMAN_TMTSTMP) = now;
+}
+
+static volatile uint32_t *hm_tmi_state(uint32_t tmi)
+{
+	return (volatile uint32_t *)(uintptr_t)(HM_TMAN_CCSR_TMSTATE +
+		(tmi << HM_TMI_STATE_STRIDE_SHIFT));
+}
+
+void hm_tman_init(void)
+{
+	memset(hm_tmis, 0, sizeof(hm_tmis));
+	hm_tman_set_time(0);
+}
+
+void hm_tman_free(void)
+{
+	int i;
+
+	for (i = 0; i < HM_MAX_TMIS; i++)
+		free(hm_tmis[i].timers);
+	memset(hm_tmis, 0, sizeof(hm_tmis));
+}
+
+uint64_t hm_tman_time(void)
+{
+	return hm_now;
+}
+
+static struct hm_timer *hm_timer_get(uint32_t handle)
+{
+	uint32_t tmi = handle >> 24, idx = (handle & 0xFFFFFF) - 1;
+
+	if (tmi >= HM_MAX_TMIS || !hm_tmis[tmi].active ||
+	    idx >= hm_tmis[tmi].max_timers)
+		return NULL;
+	return &hm_tmis[tmi].timers[idx];
+}
+
+static void hm_timer_confirm(uint32_t handle)
+{
+	struct hm_timer *t = hm_timer_get(handle);
+
+	if (!t || !t->ccp) {
+		fprintf(stderr, "host_model: invalid completion confirmation "
+			"of timer 0x%x\n", handle);
+		return;
+	}
+	t->ccp = 0;
+}
+
+/* Completion confirmations are plain stores to TMCBCC */
+static void hm_tman_collect_confirmation(void)
+{
+	uint32_t handle = HM_WS32(HM_TMAN_TMCBCC);
+
+	if (handle) {
+		HM_WS32(HM_TMAN_TMCBCC) = 0;
+		hm_timer_confirm(handle);
+	}
+}
+
+void hm_tman_task_end(void)
+{
+	hm_tman_collect_confirmation();
+}
+
+/*****************************************************************************/
+/* Commands                                                                  */
+/*****************************************************************************/
+
+static uint32_t hm_tmi_create(void)
+{
+	uint32_t max = HM_WS32(HM_WS_ACC_IN2) & 0x00FFFFFF;
+	uint32_t i;
+
+	for (i = 0; i < HM_MAX_TMIS; i++)
+		if (!hm_tmis[i].active && !hm_tmis[i].conf_pending)
+			break;
+	if (i == HM_MAX_TMIS)
+		return HM_TMAN_TMIID_DEPLETION;
+	if (max > HM_MAX_TIMERS_PER_TMI)
+		max = HM_MAX_TIMERS_PER_TMI;
+	free(hm_tmis[i].timers);
+	hm_tmis[i].timers = calloc(max ? max : 1, sizeof(struct hm_timer));
+	if (!hm_tmis[i].timers)
+		return HM_TMAN_TMIID_DEPLETION;
+	hm_tmis[i].max_timers = max;
+	hm_tmis[i].active = 1;
+	*hm_tmi_state(i) = HM_TMI_ACTIVE;
+	HM_WS32(HM_WS_ACC_OUT + 4) = i;
+	return HM_TMAN_SUCCESS;
+}
+
+static uint32_t hm_tmi_delete(void)
+{
+	uint32_t tmi = HM_WS32(HM_WS_ACC_IN2) & 0xFF;
+	struct hm_tman_ext *ext =
+		(struct hm_tman_ext *)HM_PTR(HM_WS16(HM_WS_ACC_IN +
+						     HM_TMAN_EXT_ADDRESS));
+
+	if (tmi >= HM_MAX_TMIS || !hm_tmis[tmi].active)
+		return HM_TMAN_TMI_CMD_ERR | HM_TMI_NOT_ACTIVE;
+	hm_tmis[tmi].active = 0;
+	*hm_tmi_state(tmi) = HM_TMI_NOT_ACTIVE;
+	/* The confirmation task runs at the next time advance */
+	hm_tmis[tmi].conf = *ext;
+	hm_tmis[tmi].conf_stats = hm_task.stats;
+	hm_tmis[tmi].conf_pending = 1;
+	return HM_TMAN_SUCCESS;
+}
+
+static uint32_t hm_tmi_query(void)
+{
+	uint32_t tmi = HM_WS32(HM_WS_ACC_IN2) & 0xFF;
+	uint16_t out = HM_WS16(HM_WS_ACC_IN3);
+
+	if (tmi >= HM_MAX_TMIS || !hm_tmis[tmi].active)
+		return HM_TMAN_TMI_CMD_ERR | HM_TMI_NOT_ACTIVE;
+	HM_WS32(out) = 0;
+	HM_WS32(out + 4) = hm_tmis[tmi].max_timers;
+	HM_WS64(out + 8) = 0;
+	return HM_TMAN_SUCCESS;
+}
+
+static uint32_t hm_timer_create(void)
+{
+	uint32_t tmi = HM_WS32(HM_WS_ACC_IN2) & 0xFF;
+	uint32_t flags = HM_WS32(HM_WS_ACC_IN + HM_TMAN_FLAGS_DURATION);
+	uint32_t duration = flags & HM_TMAN_DURATION_MASK;
+	uint32_t gran = (flags & HM_TMAN_GRANULARITY_MASK) >>
+		HM_TMAN_GRANULARITY_SHIFT;
+	struct hm_timer *t;
+	uint32_t i;
+
+	if (tmi >= HM_MAX_TMIS || !hm_tmis[tmi].active)
+		return HM_TMAN_TMR_TMI_STATE_ERR | HM_TMI_NOT_ACTIVE;
+	if (duration < HM_TMAN_MIN_DURATION ||
+	    duration > HM_TMAN_DURATION_MASK - HM_TMAN_MIN_DURATION)
+		return HM_TMAN_ILLEGAL_DURATION;
+	for (i = 0; i < hm_tmis[tmi].max_timers; i++) {
+		t = &hm_tmis[tmi].timers[i];
+		if (!t->active && !t->ccp)
+			break;
+	}
+	if (i == hm_tmis[tmi].max_timers)
+		return HM_TMAN_TMR_DEPLETION;
+
+	memset(t, 0, sizeof(*t));
+	t->ext = *(struct hm_tman_ext *)HM_PTR(HM_WS16(HM_WS_ACC_IN +
+						       HM_TMAN_EXT_ADDRESS));
+	t->active = 1;
+	t->one_shot = !!(flags & HM_TMAN_ONE_SHOT);
+	t->period = duration * hm_tick_usec[gran];
+	t->deadline = hm_now + t->period;
+	t->stats = hm_task.stats;
+	HM_WS32(HM_WS_ACC_OUT + 4) = (tmi << 24) | (i + 1);
+	return HM_TMAN_SUCCESS;
+}
+
+/* Common state checks of delete/modify/recharge */
+static uint32_t hm_timer_check(struct hm_timer *t, uint32_t delta)
+{
+	if (!t)
+		return HM_TMAN_TMR_TMI_STATE_ERR | HM_TMI_NOT_ACTIVE;
+	if (t->deleting)
+		return HM_TMAN_DEL_ISSUED + delta;
+	if (!t->active)
+		return (t->ccp ? HM_TMAN_DEL_CCP_WAIT : HM_TMAN_DEL_NOT_ACTIVE) +
+			delta;
+	if (t->ccp)
+		return HM_TMAN_DEL_PERIODIC_CCP_WAIT + delta;
+	return HM_TMAN_SUCCESS;
+}
+
+static uint32_t hm_timer_cmd(uint32_t cmd)
+{
+	uint32_t handle = HM_WS32(HM_WS_ACC_IN2);
+	struct hm_timer *t = hm_timer_get(handle);
+	uint32_t flags, res;
+
+	switch (cmd) {
+	case HM_TMAN_TIMER_DELETE:
+	case HM_TMAN_TIMER_DELETE_FORCE:
+	case HM_TMAN_TIMER_DELETE_FORCE_WAIT:
+		res = hm_timer_check(t, 0);
+		if (res)
+			return res;
+		if (cmd == HM_TMAN_TIMER_DELETE) {
+			t->active = 0;
+		} else {
+			/* Forced expiration: the callback runs once more */
+			t->deleting = 1;
+			t->deadline = hm_now;
+		}
+		return HM_TMAN_SUCCESS;
+	case HM_TMAN_TIMER_MODIFY:
+		res = hm_timer_check(t, HM_TMAN_MOD_ERR_DELTA);
+		if (res)
+			return res;
+		flags = HM_WS32(HM_WS_ACC_IN + HM_TMAN_FLAGS_DURATION);
+		if ((flags & HM_TMAN_DURATION_MASK) < HM_TMAN_MIN_DURATION)
+			return HM_TMAN_ILLEGAL_DURATION;
+		t->period = (flags & HM_TMAN_DURATION_MASK) *
+			hm_tick_usec[(flags & HM_TMAN_GRANULARITY_MASK) >>
+				     HM_TMAN_GRANULARITY_SHIFT];
+		t->deadline = hm_now + t->period;
+		return HM_TMAN_SUCCESS;
+	case HM_TMAN_TIMER_RECHARGE:
+		res = hm_timer_check(t, HM_TMAN_REC_ERR_DELTA);
+		if (res)
+			return res;
+		t->deadline = hm_now + t->period;
+		return HM_TMAN_SUCCESS;
+	case HM_TMAN_TIMER_QUERY:
+		if (!t)
+			return HM_TMAN_TMR_TMI_STATE_ERR | HM_TMI_NOT_ACTIVE;
+		if (t->deleting)
+			res = HM_TIMER_BEING_DELETED;
+		else if (t->active)
+			res = HM_TIMER_RUNNING;
+		else
+			res = HM_TIMER_NON_ACTIVE;
+		/* The query result is the state, not a failure */
+		HM_WS32(HM_WS_ACC_OUT) = res | (t->ccp ? HM_TIMER_WAIT_CONF : 0);
+		return HM_TMAN_SUCCESS;
+	default:
+		return HM_TMAN_TMR_TMI_STATE_ERR;
+	}
+}
+
+uint32_t hm_tman_cmd(void)
+{
+	uint32_t cmd = HM_WS32(HM_WS_ACC_IN) & 0xFFFF;
+	uint32_t res;
+
+	hm_tman_collect_confirmation();
+	HM_WS32(HM_WS_ACC_OUT) = 0;
+	switch (cmd) {
+	case HM_TMAN_TMI_CREATE:
+		res = hm_tmi_create();
+		break;
+	case HM_TMAN_TMI_DELETE:
+	case HM_TMAN_TMI_DELETE_FORCE:
+		res = hm_tmi_delete();
+		break;
+	case HM_TMAN_TMI_QUERY:
+		res = hm_tmi_query();
+		break;
+	case HM_TMAN_TIMER_CREATE:
+		res = hm_timer_create();
+		break;
+	default:
+		res = hm_timer_cmd(cmd);
+		if (cmd == HM_TMAN_TIMER_QUERY)
+			return res;
+		break;
+	}
+	HM_WS32(HM_WS_ACC_OUT) = res;
+	return res;
+}
+
+/*****************************************************************************/
+/* Expiration                                                                */
+/*****************************************************************************/
+
+/* Used when the service layer timer entry point is not linked */
+static void hm_tman_callback_task(void)
+{
+	void (*cb)(uint64_t, uint16_t) = (void (*)(uint64_t, uint16_t))
+		(uintptr_t)hm_ld_le32(HM_WS_FD + HM_FD_HASH);
+
+	cb(hm_ld_le64(HM_WS_FD + HM_FD_ADDR),
+	   (uint16_t)(hm_ld_le32(HM_WS_FD + HM_FD_FLC) >> 10));
+}
+
+static void hm_tman_run_callback(const struct hm_tman_ext *ext,
+				 uint32_t handle, uint32_t missed,
+				 struct host_model_module_stats *stats)
+{
+	hm_ws_reset(0);
+	hm_st_le64(HM_WS_FD + HM_FD_ADDR, ext->opaque_data1);
+	hm_st_le32(HM_WS_FD + HM_FD_BPID, missed & 0xFF);
+	hm_st_le32(HM_WS_FD + HM_FD_FRC, handle);
+	hm_st_le32(HM_WS_FD + HM_FD_FLC, ext->opaque_data2_epid);
+	hm_st_le32(HM_WS_FD + HM_FD_HASH, ext->hash);
+	hm_run_task(stats, tman_timer_callback ? tman_timer_callback :
+						 hm_tman_callback_task);
+}
+
+/* Earliest expiration up to 'limit', NULL if none */
+static struct hm_timer *hm_tman_next(uint64_t limit, uint32_t *handle)
+{
+	struct hm_timer *next = NULL;
+	uint32_t i, j;
+
+	for (i = 0; i < HM_MAX_TMIS; i++) {
+		if (!hm_tmis[i].active)
+			continue;
+		for (j = 0; j < hm_tmis[i].max_timers; j++) {
+			struct hm_timer *t = &hm_tmis[i].timers[j];
+
+			if ((t->active || t->deleting) &&
+			    t->deadline <= limit &&
+			    (!next || t->deadline < next->deadline)) {
+				next = t;
+				*handle = (i << 24) | (j + 1);
+			}
+		}
+	}
+	return next;
+}
+
+void hm_tman_advance(uint64_t usec)
+{
+	uint64_t target = hm_now + usec;
+	struct hm_timer *t;
+	uint32_t handle = 0, i;
+
+	if (hm_task.running) {
+		fprintf(stderr, "host_model: time advanced inside a task\n");
+		abort();
+	}
+	for (i = 0; i < HM_MAX_TMIS; i++) {
+		if (hm_tmis[i].conf_pending) {
+			hm_tmis[i].conf_pending = 0;
+			hm_tman_run_callback(&hm_tmis[i].conf, i, 0,
+					     hm_tmis[i].conf_stats);
+		}
+	}
+
+	while ((t = hm_tman_next(target, &handle)) != NULL) {
+		hm_tman_set_time(t->deadline);
+		if (t->ccp) {
+			/* Previous expiration not confirmed yet */
+			t->missed++;
+			t->deadline += t->period;
+			continue;
+		}
+		t->ccp = 1;
+		if (t->one_shot || t->deleting) {
+			t->active = 0;
+			t->deleting = 0;
+		} else {
+			t->deadline += t->period;
+		}
+		hm_tman_run_callback(&t->ext, handle, t->missed, t->stats);
+		t->missed = 0;
+	}
+	hm_tman_set_time(target);
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		host_model_test.c
+
+@Description	Self check of the host model: runs packet and timer tasks
+		through the unmodified CDMA/FDMA/OSM/STE/TMAN inline API and
+		checks the results and the accelerator call statistics.
+*//***************************************************************************/
+
+#include <stdio.h>
+
+#include "fsl_types.h"
+#include "fsl_errors.h"
+#include "general.h"
+#include "fsl_general.h"
+#include "fsl_cdma.h"
+#include "fsl_fdma.h"
+#include "fsl_osm.h"
+#include "fsl_ste.h"
+#include "fsl_tman.h"
+
+#include "host_model.h"
+
+#define TEST_EXT_MEM_SIZE	(16 * 1024 * 1024)
+#define TEST_BPID		1
+#define TEST_NUM_PACKETS	100
+#define TEST_FQID		0x55
+#define TEST_MAX_TIMERS		16
+#define TEST_TIMER_OPAQUE	0x1234
+
+static uint64_t test_ctx;
+static uint64_t test_ctx2;
+static uint64_t test_cntr;
+static uint8_t test_tmi_id;
+static int test_enqueued;
+static int test_bad_frames;
+static int test_expired;
+static int test_err;
+
+#define TEST_CHECK(_cond)						\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAILED: %s:%d: %s\n", __FILE__,	\
+			       __LINE__, #_cond);			\
+			test_err++;					\
+		}							\
+	} while (0)
+
+static void test_enqueue_cb(uint32_t qd_or_fqid, int is_qd,
+			    const uint8_t *data, uint32_t length, void *arg)
+{
+	UNUSED(arg);
+
+	test_enqueued++;
+	if (is_qd || qd_or_fqid != TEST_FQID || length < 64 ||
+	    data[0] != 0xAA)
+		test_bad_frames++;
+}
+
+/* Packet task: context update under mutex in the exclusive scope, statistics
+ * counter, segment modification and enqueue */
+static void test_packet_task(void)
+{
+	uint32_t val;
+	uint8_t *seg = (uint8_t *)(uintptr_t)PRC_GET_SEGMENT_ADDRESS();
+
+	osm_scope_transition_to_exclusive_with_increment_scope_id();
+	cdma_read_with_mutex(test_ctx, CDMA_PREDMA_MUTEX_WRITE_LOCK, &val, 4);
+	val++;
+	cdma_write_with_mutex(test_ctx, CDMA_POSTDMA_MUTEX_RM_BIT, &val, 4);
+	osm_scope_relinquish_exclusivity();
+
+	ste_inc_counter(test_cntr, 1,
+			STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+
+	seg[0] = 0xAA;
+	fdma_modify_default_segment_data(0, 1);
+	fdma_store_and_enqueue_default_frame_fqid(TEST_FQID, FDMA_ENWF_NO_FLAGS);
+	fdma_terminate_task();
+}
+
+static void test_timer_cb(tman_arg_8B_t arg1, tman_arg_2B_t arg2)
+{
+	UNUSED(arg2);
+
+	if (arg1 == TEST_TIMER_OPAQUE)
+		test_expired++;
+	tman_timer_completion_confirmation(
+			TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
+	fdma_terminate_task();
+}
+
+static void test_timer_task(void)
+{
+	uint32_t handle;
+	int err;
+
+	err = tman_create_timer(test_tmi_id,
+				TMAN_CREATE_TIMER_MODE_MSEC_GRANULARITY |
+				TMAN_CREATE_TIMER_ONE_SHOT,
+				10, TEST_TIMER_OPAQUE, 0, &test_timer_cb,
+				&handle);
+	TEST_CHECK(err == 0);
+	fdma_terminate_task();
+}
+
+/* Mutex order: A then B, then B then A in a later task */
+static void test_lock_ab_task(void)
+{
+	cdma_mutex_lock_take(test_ctx, CDMA_MUTEX_WRITE_LOCK);
+	cdma_mutex_lock_take(test_ctx2, CDMA_MUTEX_WRITE_LOCK);
+	cdma_mutex_lock_release(test_ctx2);
+	cdma_mutex_lock_release(test_ctx);
+	fdma_terminate_task();
+}
+
+static void test_lock_ba_task(void)
+{
+	cdma_mutex_lock_take(test_ctx2, CDMA_MUTEX_WRITE_LOCK);
+	cdma_mutex_lock_take(test_ctx, CDMA_MUTEX_WRITE_LOCK);
+	cdma_mutex_lock_release(test_ctx);
+	cdma_mutex_lock_release(test_ctx2);
+	fdma_terminate_task();
+}
+
+int main(void)
+{
+	const struct host_model_module_stats *s;
+	uint8_t frame[128];
+	uint64_t tmi_mem;
+	int i, err;
+
+	err = host_model_init(TEST_EXT_MEM_SIZE);
+	if (err) {
+		printf("host_model_init failed (%d)\n", err);
+		return 1;
+	}
+	host_model_set_enqueue_cb(test_enqueue_cb, NULL);
+
+	TEST_CHECK(host_model_bpool_create(TEST_BPID, 256, 16) == 0);
+	test_ctx = host_model_ext_alloc(64, 64);
+	test_ctx2 = host_model_ext_alloc(64, 64);
+	test_cntr = host_model_ext_alloc(8, 8);
+	TEST_CHECK(test_ctx && test_ctx2 && test_cntr);
+	tmi_mem = host_model_ext_alloc(64 * (TEST_MAX_TIMERS + 1), 64);
+	TEST_CHECK(tman_create_tmi(tmi_mem, TEST_MAX_TIMERS,
+				   &test_tmi_id) == 0);
+
+	/* Packets */
+	for (i = 0; i < (int)sizeof(frame); i++)
+		frame[i] = (uint8_t)i;
+	for (i = 0; i < TEST_NUM_PACKETS; i++)
+		TEST_CHECK(host_model_run_task("packet", test_packet_task,
+					       frame, sizeof(frame), 0) == 0);
+	TEST_CHECK(*(uint32_t *)(uintptr_t)test_ctx == TEST_NUM_PACKETS);
+	TEST_CHECK(*(uint32_t *)(uintptr_t)test_cntr == TEST_NUM_PACKETS);
+	TEST_CHECK(test_enqueued == TEST_NUM_PACKETS);
+	TEST_CHECK(test_bad_frames == 0);
+	s = host_model_stats_get("packet");
+	TEST_CHECK(s && s->tasks == TEST_NUM_PACKETS);
+	TEST_CHECK(s && !s->errors && !s->leaked_frames && !s->leaked_mutexes);
+	TEST_CHECK(s && s->calls[HOST_MODEL_ENG_CDMA] == 2 * TEST_NUM_PACKETS);
+	TEST_CHECK(s && s->calls[HOST_MODEL_ENG_STE] == TEST_NUM_PACKETS);
+
+	/* Timers */
+	TEST_CHECK(host_model_run_task("timer", test_timer_task,
+				       NULL, 0, 0) == 0);
+	host_model_advance_time(5000);
+	TEST_CHECK(test_expired == 0);
+	host_model_advance_time(10000);
+	TEST_CHECK(test_expired == 1);
+	host_model_advance_time(100000);
+	TEST_CHECK(test_expired == 1);
+
+	/* Mutex order checker */
+	TEST_CHECK(host_model_run_task("lock", test_lock_ab_task,
+				       NULL, 0, 0) == 0);
+	TEST_CHECK(host_model_run_task("lock", test_lock_ba_task,
+				       NULL, 0, 0) == 0);
+	s = host_model_stats_get("lock");
+	TEST_CHECK(s && s->lock_order_inversions == 1);
+
+	host_model_stats_print(stdout, 0);
+	host_model_free();
+
+	printf("%s\n", test_err ? "FAILED" : "PASSED");
+	return test_err ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		cmdif.h
+
+@Description	Host environment for building the shared buffer pool flib
+		outside of the GPP cmdif library. The buffer addresses are
+		host virtual addresses, there is no physical mapping.
+*//***************************************************************************/
+
+#ifndef __CMDIF_H
+#define __CMDIF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define CPU_TO_LE16(val)	__builtin_bswap16(val)
+#define CPU_TO_LE32(val)	__builtin_bswap32(val)
+#define CPU_TO_LE64(val)	__builtin_bswap64(val)
+#else
+#define CPU_TO_LE16(val)	(val)
+#define CPU_TO_LE32(val)	(val)
+#define CPU_TO_LE64(val)	(val)
+#endif
+
+#define IS_ALIGNED(ADDRESS, ALIGNMENT) \
+	(!(((uintptr_t)(ADDRESS)) & (((uintptr_t)(ALIGNMENT)) - 1)))
+
+#define SHBP_BUF_TO_PTR(BUF)	((void *)(uintptr_t)(BUF))
+#define SHBP_PTR_TO_BUF(PTR)	((uint64_t)(uintptr_t)(PTR))
+
+/* The test may run more producer threads than there are cores */
+#define SHBP_CPU_RELAX()	sched_yield()
+
+#endif /* __CMDIF_H */
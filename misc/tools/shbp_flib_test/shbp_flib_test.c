@@ -0,0 +1,294 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**************************************************************************//**
+@File		shbp_flib_test.c
+
+@Description	Host stress and throughput test of the shared buffer pool
+		flib: single buffer versus burst acquire/release, and
+		several producer threads releasing into one #SHBP_HOST_MP
+		pool while one consumer drains it.
+*//***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <fsl_shbp_flib.h>
+#include <fsl_shbp_host.h>
+
+#define TEST_POOL_BUFS		1024
+#define TEST_SMALL_POOL_BUFS	64
+#define TEST_PERF_BUFS		(1 << 22)
+#define TEST_MAX_BURST		64
+#define TEST_MAX_PRODUCERS	16
+#define TEST_MP_BUFS		(1 << 18)	/* Per producer */
+
+#define TEST_TOKEN(TID, SEQ) \
+	((void *)(uintptr_t)((((uintptr_t)(TID) + 1) << 24) | (SEQ)))
+#define TEST_TOKEN_TID(TOKEN)	((uint32_t)((uintptr_t)(TOKEN) >> 24) - 1)
+#define TEST_TOKEN_SEQ(TOKEN)	((uint32_t)((uintptr_t)(TOKEN) & 0xFFFFFF))
+
+static int test_err;
+
+#define TEST_CHECK(_cond)						\
+	do {								\
+		if (!(_cond)) {						\
+			printf("FAILED: %s:%d: %s\n", __FILE__,	\
+			       __LINE__, #_cond);			\
+			test_err++;					\
+		}							\
+	} while (0)
+
+struct test_producer {
+	pthread_t thread;
+	uint64_t bp;
+	uint32_t tid;
+	uint32_t burst;
+};
+
+static double test_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t test_pool_create(uint32_t num_bufs, uint32_t flags)
+{
+	uint32_t size = shbp_flib_mem_ptr_size(num_bufs);
+	void *mem = NULL;
+	uint64_t bp = 0;
+
+	if (posix_memalign(&mem, 64, size) ||
+	    shbp_flib_create(mem, size, flags, &bp))
+		return 0;
+	return bp;
+}
+
+/* What AIOP shbp_release() does: one BD into the free queue */
+static void test_aiop_release(uint64_t _bp, void *buf)
+{
+	struct shbp *bp = (struct shbp *)_bp;
+	uint32_t enq = CPU_TO_LE32(bp->free.enq);
+	uint64_t *bd = SHBP_BUF_TO_PTR(CPU_TO_LE64(bp->free.base));
+
+	bd[SHBP_BD_IND(bp, enq)] = CPU_TO_LE64(SHBP_PTR_TO_BUF(buf));
+	bp->free.enq = CPU_TO_LE32(enq + 1);
+}
+
+static void test_functional(uint32_t flags)
+{
+	void *bufs[TEST_SMALL_POOL_BUFS + 8];
+	void *ptr;
+	uint64_t bp;
+	uint32_t i;
+	int n;
+
+	bp = test_pool_create(TEST_SMALL_POOL_BUFS, flags);
+	TEST_CHECK(bp != 0);
+	if (!bp)
+		return;
+
+	for (i = 0; i < TEST_SMALL_POOL_BUFS + 8; i++)
+		bufs[i] = TEST_TOKEN(0, i);
+
+	/* Burst is cut at the queue size */
+	n = shbp_flib_release_burst(bp, bufs, TEST_SMALL_POOL_BUFS + 8);
+	TEST_CHECK(n == TEST_SMALL_POOL_BUFS);
+	TEST_CHECK(shbp_flib_release(bp, bufs[0]) == -ENOSPC);
+
+	/* FIFO order, single and burst acquire see the same queue */
+	TEST_CHECK(shbp_flib_acquire(bp) == TEST_TOKEN(0, 0));
+	n = shbp_flib_acquire_burst(bp, bufs, TEST_SMALL_POOL_BUFS + 8);
+	TEST_CHECK(n == TEST_SMALL_POOL_BUFS - 1);
+	for (i = 0; i < (uint32_t)n; i++)
+		TEST_CHECK(bufs[i] == TEST_TOKEN(0, i + 1));
+	TEST_CHECK(shbp_flib_acquire(bp) == NULL);
+	TEST_CHECK(shbp_flib_acquire_burst(bp, bufs, 1) == 0);
+
+	/* Buffers returned by AIOP are moved back by refill */
+	for (i = 0; i < 10; i++)
+		test_aiop_release(bp, TEST_TOKEN(1, i));
+	TEST_CHECK(shbp_flib_refill(bp) == 10);
+	TEST_CHECK(shbp_flib_refill(bp) == 0);
+	n = shbp_flib_acquire_burst(bp, bufs, 4);
+	TEST_CHECK(n == 4);
+	TEST_CHECK(bufs[3] == TEST_TOKEN(1, 3));
+
+	/* Destroy drains what is left */
+	test_aiop_release(bp, TEST_TOKEN(2, 0));
+	for (i = 0; shbp_flib_destroy(bp, &ptr) == -EACCES; i++)
+		TEST_CHECK(ptr != NULL);
+	TEST_CHECK(i == 7);
+
+	free((void *)(uintptr_t)bp);
+}
+
+static void test_perf(void)
+{
+	void *bufs[TEST_MAX_BURST];
+	uint32_t burst, i, j;
+	uint64_t bp;
+	double t;
+
+	bp = test_pool_create(TEST_POOL_BUFS, SHBP_HOST_IS_MASTER);
+	TEST_CHECK(bp != 0);
+	if (!bp)
+		return;
+
+	for (i = 0; i < TEST_MAX_BURST; i++)
+		bufs[i] = TEST_TOKEN(0, i);
+
+	t = test_time();
+	for (i = 0; i < TEST_PERF_BUFS; i++) {
+		shbp_flib_release(bp, bufs[0]);
+		bufs[0] = shbp_flib_acquire(bp);
+	}
+	t = test_time() - t;
+	printf("single:   %8.2f Mbufs/sec\n", TEST_PERF_BUFS / t / 1e6);
+
+	for (burst = 1; burst <= TEST_MAX_BURST; burst <<= 1) {
+		t = test_time();
+		for (i = 0; i < TEST_PERF_BUFS; i += burst) {
+			j = (uint32_t)shbp_flib_release_burst(bp, bufs, burst);
+			j = (uint32_t)shbp_flib_acquire_burst(bp, bufs, j);
+			TEST_CHECK(j == burst);
+		}
+		t = test_time() - t;
+		printf("burst %2d: %8.2f Mbufs/sec\n", burst,
+		       TEST_PERF_BUFS / t / 1e6);
+	}
+
+	free((void *)(uintptr_t)bp);
+}
+
+static void *test_producer_thread(void *arg)
+{
+	struct test_producer *p = arg;
+	void *bufs[TEST_MAX_BURST];
+	uint32_t seq = 0, i, n;
+
+	while (seq < TEST_MP_BUFS) {
+		n = p->burst;
+		if (n > TEST_MP_BUFS - seq)
+			n = TEST_MP_BUFS - seq;
+		for (i = 0; i < n; i++)
+			bufs[i] = TEST_TOKEN(p->tid, seq + i);
+
+		n = (uint32_t)shbp_flib_release_burst(p->bp, bufs, n);
+		if (n == 0)
+			sched_yield(); /* Queue is full */
+		seq += n;
+	}
+	return NULL;
+}
+
+/* Each producer releases an increasing sequence, the single consumer must
+ * see every sequence in order with no loss and no duplicates */
+static void test_mp(uint32_t num_producers, uint32_t burst)
+{
+	struct test_producer p[TEST_MAX_PRODUCERS];
+	uint32_t next[TEST_MAX_PRODUCERS] = {0};
+	void *bufs[TEST_MAX_BURST];
+	uint32_t total = num_producers * TEST_MP_BUFS;
+	uint32_t got = 0, tid, i;
+	uint64_t bp;
+	double t;
+	int n;
+
+	bp = test_pool_create(TEST_POOL_BUFS,
+	                      SHBP_HOST_IS_MASTER | SHBP_HOST_MP);
+	TEST_CHECK(bp != 0);
+	if (!bp)
+		return;
+
+	t = test_time();
+	for (i = 0; i < num_producers; i++) {
+		p[i].bp = bp;
+		p[i].tid = i;
+		p[i].burst = burst;
+		pthread_create(&p[i].thread, NULL, test_producer_thread, &p[i]);
+	}
+
+	while (got < total) {
+		n = shbp_flib_acquire_burst(bp, bufs, TEST_MAX_BURST);
+		if (n == 0) {
+			sched_yield();
+			continue;
+		}
+		for (i = 0; i < (uint32_t)n; i++) {
+			tid = TEST_TOKEN_TID(bufs[i]);
+			if (tid >= num_producers ||
+			    TEST_TOKEN_SEQ(bufs[i]) != next[tid]) {
+				printf("FAILED: unexpected buffer %p\n", bufs[i]);
+				test_err++;
+				got = total;
+				break;
+			}
+			next[tid]++;
+		}
+		got += (uint32_t)n;
+	}
+
+	for (i = 0; i < num_producers; i++)
+		pthread_join(p[i].thread, NULL);
+	t = test_time() - t;
+
+	for (i = 0; i < num_producers; i++)
+		TEST_CHECK(next[i] == TEST_MP_BUFS);
+	TEST_CHECK(shbp_flib_acquire(bp) == NULL);
+
+	printf("MP %2d producers, burst %2d: %8.2f Mbufs/sec\n",
+	       num_producers, burst, total / t / 1e6);
+
+	free((void *)(uintptr_t)bp);
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t num_producers = 4;
+	uint32_t burst;
+
+	if (argc > 1)
+		num_producers = (uint32_t)atoi(argv[1]);
+	if (num_producers == 0 || num_producers > TEST_MAX_PRODUCERS) {
+		printf("usage: %s [producers 1..%d]\n", argv[0],
+		       TEST_MAX_PRODUCERS);
+		return 1;
+	}
+
+	test_functional(SHBP_HOST_IS_MASTER);
+	test_functional(SHBP_HOST_IS_MASTER | SHBP_HOST_MP);
+	test_perf();
+	for (burst = 1; burst <= TEST_MAX_BURST; burst <<= 2)
+		test_mp(num_producers, burst);
+
+	printf("%s\n", test_err ? "FAILED" : "PASSED");
+	return test_err ? 1 : 0;
+}
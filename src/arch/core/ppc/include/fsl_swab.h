@@ -224,6 +224,22 @@ static uint64_t swap_uint64(uint64_t val)
 #define STORE_CPU_TO_BE32(val, addr)	({ *addr = val; })
 #define STORE_CPU_TO_BE64(val, addr)	({ *addr = val; })
 
+#if __COVERITY__
+static inline void STORE_16_WT(uint16_t val, volatile uint16_t *addr)
+{
+	*addr = val;
+}
+
+static inline void STORE_32_WT(uint32_t val, volatile uint32_t *addr)
+{
+	*addr = val;
+}
+
+static inline void STORE_64_WT(uint64_t val, volatile uint64_t *addr)
+{
+	*addr = val;
+}
+#else
 asm static void STORE_16_WT(register uint16_t val, register volatile uint16_t *addr)
 {
 	nofralloc
@@ -246,6 +262,7 @@ asm static void STORE_64_WT(register uint64_t val, register volatile uint64_t *a
 	stwwtx val@loword, 0, addr   /* store LSB part of val to addr + 4*/
     blr
 }
+#endif
 
 #define STORE_CPU_TO_BE16_WT(val, addr)	STORE_16_WT(val,addr)
 #define STORE_CPU_TO_BE32_WT(val, addr)	STORE_32_WT(val,addr)
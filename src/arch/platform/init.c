@@ -58,6 +58,20 @@ extern int rcu_init();                    extern void rcu_free();
 extern int rcu_default_early_init();
 extern int ipsec_drv_init(void);
 extern int cwap_dtls_drv_init(void);
+#ifdef CDMA_MUTEX_PROFILE
+extern int cdma_mutex_prof_init(void);    extern void cdma_mutex_prof_free(void);
+#define CDMA_MUTEX_PROF_MODULE						\
+	{NULL, cdma_mutex_prof_init, NULL, cdma_mutex_prof_free},
+#else
+#define CDMA_MUTEX_PROF_MODULE
+#endif
+#ifdef LOG_PER_CORE_STAGING
+extern int log_flush_timer_init(void);    extern void log_flush_timer_free(void);
+#define LOG_FLUSH_TIMER_MODULE						\
+	{NULL, log_flush_timer_init, NULL, log_flush_timer_free},
+#else
+#define LOG_FLUSH_TIMER_MODULE
+#endif
 
 extern void build_apps_array(struct sys_module_desc *apps);
 
@@ -65,6 +79,8 @@ extern void build_apps_array(struct sys_module_desc *apps);
 {									\
 	/* Slab must be before any module with buffer request */	\
 	{NULL, time_init, NULL, time_free},				\
+	CDMA_MUTEX_PROF_MODULE						\
+	LOG_FLUSH_TIMER_MODULE						\
 	{NULL, ep_mng_init, NULL, ep_mng_free},				\
 	{NULL, dprc_drv_init, dprc_drv_scan, dprc_drv_free},		\
 	/* Must be before EVM */					\
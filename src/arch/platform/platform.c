@@ -41,6 +41,10 @@
 
 #define __ERR_MODULE__  MODULE_SOC_PLATFORM
 extern __TASK uint32_t seed_32bit;
+#ifdef CDMA_MUTEX_PROFILE
+extern void cdma_mutex_prof_task_init(uint32_t num_of_tasks,
+				      uint32_t task_area_size);
+#endif
 extern struct aiop_init_info g_init_data;
 extern const uint8_t AIOP_DDR_START[],AIOP_DDR_END[],_ssram_heap_start[],\
                      _ssram_addr[];
@@ -220,6 +224,13 @@ __COLD_CODE static int init_random_seed(uint32_t num_of_tasks)
 		iowrite32be(seed, seed_mem_ptr);
 	}
 
+#ifdef CDMA_MUTEX_PROFILE
+	/* The task areas are not initialized (NO_INIT_BSS), clear the
+	 * per-task CDMA mutex profile variables the same way */
+	cdma_mutex_prof_task_init(num_of_tasks,
+				  task_stack_size * sizeof(uint32_t));
+#endif
+
 	return 0;
 }
 /*****************************************************************************/
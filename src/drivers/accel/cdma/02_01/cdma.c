@@ -34,6 +34,52 @@
 #include "fsl_types.h"
 
 #include "fsl_cdma.h"
+#ifdef CDMA_MUTEX_PROFILE
+#include "fsl_core_booke.h"
+#include "fsl_malloc.h"
+#include "fsl_spinlock.h"
+#include "fsl_dbg.h"
+#include "fsl_string.h"
+
+/* Mutex profile entry in DDR, one per mutex address */
+struct cdma_mutex_prof_entry {
+	/* Mutex address, 0 - free entry */
+	uint64_t mutex_id;
+	/* Sampled takes */
+	uint32_t takes;
+	/* Longest wait for the take, in time base ticks */
+	uint32_t wait_max;
+	/* Total wait for the sampled takes */
+	uint64_t wait_total;
+	/* Total hold of the sampled takes */
+	uint64_t hold_total;
+	/* Longest hold */
+	uint32_t hold_max;
+	uint32_t reserved;
+};
+
+/* Sampled take, held by the task until the mutex is released */
+struct cdma_mutex_prof_held {
+	uint64_t mutex_id;
+	uint32_t taken;
+	uint32_t wait;
+};
+
+struct cdma_mutex_prof {
+	/* Profile table in DDR, 0 - profiling disabled */
+	uint64_t table;
+	/* Sampled takes not accounted, the table probes were in use */
+	int32_t dropped;
+};
+
+static struct cdma_mutex_prof g_cdma_mutex_prof;
+/* Sampled takes held by the task, 0 entries are free */
+__TASK struct cdma_mutex_prof_held cdma_mutex_prof_held[
+						CDMA_MUTEX_PROFILE_HELD];
+__TASK uint32_t cdma_mutex_prof_nheld;
+/* Takes of the task, drives the sampling */
+__TASK uint32_t cdma_mutex_prof_takes;
+#endif /* CDMA_MUTEX_PROFILE */
 
 
 /*void cdma_write(
@@ -164,6 +210,10 @@ void cdma_write_lock_dma_read_and_increment(
 	uint32_t arg1, arg2, arg3, arg4;
 	uint8_t res1;
 
+#ifdef CDMA_MUTEX_PROFILE
+	uint32_t prof_start = cdma_mutex_prof_start();
+#endif
+
 	/* prepare command parameters */
 	arg1 = CDMA_WRITE_LOCK_DMA_READ_AND_INC_CMD_ARG1();
 	arg2 = CDMA_WRITE_LOCK_DMA_READ_AND_INC_CMD_ARG2(size,
@@ -175,8 +225,12 @@ void cdma_write_lock_dma_read_and_increment(
 	__stqw(arg1, arg2, arg3, arg4, HWC_ACC_IN_ADDRESS, 0);
 
 	/* call CDMA */
-	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS)
+	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS) {
+#ifdef CDMA_MUTEX_PROFILE
+		cdma_mutex_prof_taken(context_address, prof_start);
+#endif
 		return;
+	}
 
 	/* load command results */
 	res1 = *((uint8_t *)(HWC_ACC_OUT_ADDRESS+CDMA_STATUS_OFFSET));
@@ -204,14 +258,22 @@ int cdma_write_release_lock_and_decrement(
 	__stqw(arg1, arg2, arg3, arg4, HWC_ACC_IN_ADDRESS, 0);
 
 	/* call CDMA */
-	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS)
+	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS) {
+#ifdef CDMA_MUTEX_PROFILE
+		cdma_mutex_prof_released(context_address);
+#endif
 		return 0;
+	}
 
 	/* load command results */
 	res1 = *((uint8_t *)(HWC_ACC_OUT_ADDRESS+CDMA_STATUS_OFFSET));
 
-	if (((int32_t)res1) == CDMA_REFCOUNT_DECREMENT_TO_ZERO)
+	if (((int32_t)res1) == CDMA_REFCOUNT_DECREMENT_TO_ZERO) {
+#ifdef CDMA_MUTEX_PROFILE
+		cdma_mutex_prof_released(context_address);
+#endif
 		return (int32_t)(res1);
+	}
 	cdma_exception_handler(CDMA_WRITE_RELEASE_LOCK_AND_DECREMENT,__LINE__,
 			(int32_t)res1);
 	return -1;
@@ -291,6 +353,211 @@ void cdma_write_wrp(uint64_t ext_address, void *ws_src, uint16_t size)
 	cdma_write(ext_address, ws_src, size);
 }
 
+#ifdef CDMA_MUTEX_PROFILE
+static inline uint32_t cdma_mutex_prof_hash(uint64_t mutex_id)
+{
+	uint32_t h = (uint32_t)(mutex_id >> 3) ^ (uint32_t)(mutex_id >> 32);
+
+	h *= 0x9E3779B1;
+	return (h ^ (h >> 16)) & (CDMA_MUTEX_PROFILE_ENTRIES - 1);
+}
+
+static void cdma_mutex_prof_update(uint64_t mutex_id, uint32_t wait,
+				   uint32_t hold)
+{
+	struct cdma_mutex_prof_entry entry;
+	uint64_t addr, id;
+	uint32_t i, idx;
+
+	idx = cdma_mutex_prof_hash(mutex_id);
+	for (i = 0; i < CDMA_MUTEX_PROFILE_PROBES; i++) {
+		addr = g_cdma_mutex_prof.table +
+			idx * sizeof(struct cdma_mutex_prof_entry);
+		idx = (idx + 1) & (CDMA_MUTEX_PROFILE_ENTRIES - 1);
+		/* Lock only the entries of this mutex or free */
+		cdma_read(&id, addr, sizeof(id));
+		if (id && (id != mutex_id))
+			continue;
+		/* The entry mutex take is not profiled, so the entry
+		 * releases below find no sampled take */
+		cdma_read_with_mutex_cache_wrp(addr,
+				CDMA_PREDMA_MUTEX_WRITE_LOCK,
+				CDMA_READ_WITH_MUTEX_CMD_ARG2(sizeof(entry),
+						(uint32_t)&entry));
+		if (!entry.mutex_id) {
+			memset(&entry, 0, sizeof(entry));
+			entry.mutex_id = mutex_id;
+		} else if (entry.mutex_id != mutex_id) {
+			/* Claimed by another mutex meanwhile */
+			cdma_mutex_lock_release(addr);
+			continue;
+		}
+		entry.takes++;
+		entry.wait_total += wait;
+		entry.hold_total += hold;
+		if (wait > entry.wait_max)
+			entry.wait_max = wait;
+		if (hold > entry.hold_max)
+			entry.hold_max = hold;
+		cdma_write_with_mutex(addr, CDMA_POSTDMA_MUTEX_RM_BIT, &entry,
+				      sizeof(entry));
+		return;
+	}
+	atomic_incr32(&g_cdma_mutex_prof.dropped, 1);
+}
+
+uint32_t cdma_mutex_prof_start(void)
+{
+	return (uint32_t)booke_get_time_base_time();
+}
+
+void cdma_mutex_prof_taken(uint64_t mutex_id, uint32_t start)
+{
+	uint32_t now, i;
+
+	if (!g_cdma_mutex_prof.table ||
+	    (++cdma_mutex_prof_takes & (CDMA_MUTEX_PROFILE_SAMPLE - 1)))
+		return;
+	now = (uint32_t)booke_get_time_base_time();
+	for (i = 0; i < CDMA_MUTEX_PROFILE_HELD; i++) {
+		/* A stale take of the same mutex (released by a command
+		 * which is not profiled) is replaced */
+		if (!cdma_mutex_prof_held[i].mutex_id ||
+		    (cdma_mutex_prof_held[i].mutex_id == mutex_id)) {
+			if (!cdma_mutex_prof_held[i].mutex_id)
+				cdma_mutex_prof_nheld++;
+			cdma_mutex_prof_held[i].mutex_id = mutex_id;
+			cdma_mutex_prof_held[i].taken = now;
+			cdma_mutex_prof_held[i].wait = now - start;
+			return;
+		}
+	}
+}
+
+void cdma_mutex_prof_released(uint64_t mutex_id)
+{
+	uint32_t i;
+
+	if (!cdma_mutex_prof_nheld)
+		return;
+	for (i = 0; i < CDMA_MUTEX_PROFILE_HELD; i++) {
+		if (cdma_mutex_prof_held[i].mutex_id == mutex_id) {
+			cdma_mutex_prof_held[i].mutex_id = 0;
+			cdma_mutex_prof_nheld--;
+			/* Updated after the release, so the entry mutex
+			 * stays within the mutexes a task may hold */
+			cdma_mutex_prof_update(mutex_id,
+				cdma_mutex_prof_held[i].wait,
+				(uint32_t)booke_get_time_base_time() -
+				cdma_mutex_prof_held[i].taken);
+			return;
+		}
+	}
+}
+
+void cdma_mutex_prof_reset(void)
+{
+	struct cdma_mutex_prof_entry entry;
+	uint64_t addr;
+	uint32_t i;
+
+	if (!g_cdma_mutex_prof.table)
+		return;
+	for (i = 0; i < CDMA_MUTEX_PROFILE_ENTRIES; i++) {
+		addr = g_cdma_mutex_prof.table +
+			i * sizeof(struct cdma_mutex_prof_entry);
+		cdma_read_with_mutex_cache_wrp(addr,
+				CDMA_PREDMA_MUTEX_WRITE_LOCK,
+				CDMA_READ_WITH_MUTEX_CMD_ARG2(sizeof(entry),
+						(uint32_t)&entry));
+		memset(&entry, 0, sizeof(entry));
+		cdma_write_with_mutex(addr, CDMA_POSTDMA_MUTEX_RM_BIT, &entry,
+				      sizeof(entry));
+	}
+	g_cdma_mutex_prof.dropped = 0;
+}
+
+void cdma_mutex_prof_dump(void)
+{
+	struct cdma_mutex_prof_entry entry;
+	uint32_t i;
+
+	if (!g_cdma_mutex_prof.table) {
+		pr_warn("No CDMA mutex profile\n");
+		return;
+	}
+	fsl_print("\nCDMA mutex profile (1/%d takes sampled, time base "
+		  "ticks)\n", CDMA_MUTEX_PROFILE_SAMPLE);
+	for (i = 0; i < CDMA_MUTEX_PROFILE_ENTRIES; i++) {
+		cdma_read(&entry, g_cdma_mutex_prof.table +
+			  i * sizeof(struct cdma_mutex_prof_entry),
+			  sizeof(entry));
+		if (!entry.takes)
+			continue;
+		fsl_print("\t mutex 0x%08x%08x\n",
+			  (uint32_t)(entry.mutex_id >> 32),
+			  (uint32_t)entry.mutex_id);
+		fsl_print("\t\t takes = %d (sampled %d)\n",
+			  entry.takes * CDMA_MUTEX_PROFILE_SAMPLE, entry.takes);
+		fsl_print("\t\t wait  = avg %d, max %d\n",
+			  (uint32_t)(entry.wait_total / entry.takes),
+			  entry.wait_max);
+		fsl_print("\t\t hold  = avg %d, max %d\n",
+			  (uint32_t)(entry.hold_total / entry.takes),
+			  entry.hold_max);
+	}
+	fsl_print("\t dropped samples = %d\n", g_cdma_mutex_prof.dropped);
+}
+
+__COLD_CODE void cdma_mutex_prof_task_init(uint32_t num_of_tasks,
+					    uint32_t task_area_size)
+{
+	uint32_t i, offset;
+
+	for (i = 0, offset = 0; i < num_of_tasks;
+	     i++, offset += task_area_size) {
+		memset((uint8_t *)cdma_mutex_prof_held + offset, 0,
+		       sizeof(cdma_mutex_prof_held));
+		*(volatile uint32_t *)((uint8_t *)&cdma_mutex_prof_nheld +
+				       offset) = 0;
+		*(volatile uint32_t *)((uint8_t *)&cdma_mutex_prof_takes +
+				       offset) = 0;
+	}
+}
+
+__COLD_CODE int cdma_mutex_prof_init(void)
+{
+	int mem_heap, err;
+
+	if (fsl_mem_exists(MEM_PART_DP_DDR)) {
+		mem_heap = MEM_PART_DP_DDR;
+	} else if (fsl_mem_exists(MEM_PART_SYSTEM_DDR)) {
+		mem_heap = MEM_PART_SYSTEM_DDR;
+	} else {
+		pr_warn("DDR memory not found, no CDMA mutex profile\n");
+		return 0;
+	}
+
+	err = fsl_get_mem(CDMA_MUTEX_PROFILE_ENTRIES *
+			  sizeof(struct cdma_mutex_prof_entry), mem_heap, 64,
+			  &g_cdma_mutex_prof.table);
+	if (err) {
+		pr_warn("No memory for the CDMA mutex profile\n");
+		g_cdma_mutex_prof.table = 0;
+		return 0;
+	}
+	cdma_mutex_prof_reset();
+	return 0;
+}
+
+__COLD_CODE void cdma_mutex_prof_free(void)
+{
+	if (g_cdma_mutex_prof.table)
+		fsl_put_mem(g_cdma_mutex_prof.table);
+	g_cdma_mutex_prof.table = 0;
+}
+#endif /* CDMA_MUTEX_PROFILE */
+
 #pragma push
 	/* make all following data go into .exception_data */
 #pragma section data_type ".exception_data"
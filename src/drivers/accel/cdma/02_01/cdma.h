@@ -851,6 +851,73 @@ void cdma_exception_handler(enum cdma_function_identifier func_id,
 			     uint32_t line,
 			     int32_t status);
 
+#ifdef CDMA_MUTEX_PROFILE
+#ifndef CDMA_MUTEX_PROFILE_ENTRIES
+/** Entries of the mutex profile table in DDR (power of 2) */
+#define CDMA_MUTEX_PROFILE_ENTRIES	256
+#endif
+#ifndef CDMA_MUTEX_PROFILE_SAMPLE
+/** One of CDMA_MUTEX_PROFILE_SAMPLE mutex takes of a task is profiled
+ * (power of 2) */
+#define CDMA_MUTEX_PROFILE_SAMPLE	16
+#endif
+/** Entries probed in the profile table for a mutex address */
+#define CDMA_MUTEX_PROFILE_PROBES	8
+/** Sampled mutex takes held by a task (the CDMA mutex limit of a task) */
+#define CDMA_MUTEX_PROFILE_HELD		4
+
+/**************************************************************************//**
+@Function	cdma_mutex_prof_start
+
+@Description	Return the time base before a mutex take command.
+
+@Return		Time base, lower 32 bits.
+*//***************************************************************************/
+uint32_t cdma_mutex_prof_start(void);
+
+/**************************************************************************//**
+@Function	cdma_mutex_prof_taken
+
+@Description	Account a mutex take of the task. The take is sampled and
+		kept until the mutex is released.
+
+@Param[in]	mutex_id - Mutex address.
+@Param[in]	start - Time base returned by cdma_mutex_prof_start() before
+		the take command.
+
+@Return		None.
+*//***************************************************************************/
+void cdma_mutex_prof_taken(uint64_t mutex_id, uint32_t start);
+
+/**************************************************************************//**
+@Function	cdma_mutex_prof_released
+
+@Description	Account a mutex release of the task. If the take of the mutex
+		was sampled, its wait and hold times are added to the mutex
+		entry of the profile table.
+
+@Param[in]	mutex_id - Mutex address.
+
+@Return		None.
+
+@Cautions	In this function the task may yield.
+*//***************************************************************************/
+void cdma_mutex_prof_released(uint64_t mutex_id);
+
+/**************************************************************************//**
+@Function	cdma_mutex_prof_task_init
+
+@Description	Clear the per-task profile variables in all the task areas of
+		the core. Called at core init, the task areas are not
+		initialized.
+
+@Param[in]	num_of_tasks - Number of tasks of the core.
+@Param[in]	task_area_size - Size of a task area, in bytes.
+
+@Return		None.
+*//***************************************************************************/
+void cdma_mutex_prof_task_init(uint32_t num_of_tasks, uint32_t task_area_size);
+#endif /* CDMA_MUTEX_PROFILE */
 
 /** @} end of group CDMA_Internal_Functions */
 
@@ -191,8 +191,16 @@ inline void cdma_read_with_mutex_no_cache(
 		uint16_t size) {
 
 	uint32_t arg2;
+#ifdef CDMA_MUTEX_PROFILE
+	uint32_t prof_start = cdma_mutex_prof_start();
+#endif
 	arg2 = CDMA_READ_WITH_MUTEX_NO_CACHE_CMD_ARG2(size, (uint32_t)ws_dst);
 	cdma_read_with_mutex_cache_wrp(ext_address, flags, arg2);
+#ifdef CDMA_MUTEX_PROFILE
+	if (flags & (CDMA_PREDMA_MUTEX_READ_LOCK |
+			CDMA_PREDMA_MUTEX_WRITE_LOCK))
+		cdma_mutex_prof_taken(ext_address, prof_start);
+#endif
 }
 
 inline void cdma_read_with_mutex(
@@ -202,8 +210,16 @@ inline void cdma_read_with_mutex(
 		uint16_t size) {
 
 	uint32_t arg2;
+#ifdef CDMA_MUTEX_PROFILE
+	uint32_t prof_start = cdma_mutex_prof_start();
+#endif
 	arg2 = CDMA_READ_WITH_MUTEX_CMD_ARG2(size, (uint32_t)ws_dst);
 	cdma_read_with_mutex_cache_wrp(ext_address, flags, arg2);
+#ifdef CDMA_MUTEX_PROFILE
+	if (flags & (CDMA_PREDMA_MUTEX_READ_LOCK |
+			CDMA_PREDMA_MUTEX_WRITE_LOCK))
+		cdma_mutex_prof_taken(ext_address, prof_start);
+#endif
 }
 
 inline void cdma_read_cache_wrp(uint64_t ext_address,
@@ -297,8 +313,13 @@ inline void cdma_write_with_mutex(
 	__stqw(arg1, arg2, arg3, arg4, HWC_ACC_IN_ADDRESS, 0);
 
 	/* call CDMA */
-	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS)
+	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS) {
+#ifdef CDMA_MUTEX_PROFILE
+		if (flags & CDMA_POSTDMA_MUTEX_RM_BIT)
+			cdma_mutex_prof_released(ext_address);
+#endif
 		return;
+	}
 
 	/* load command results */
 	res1 = *((uint8_t *)(HWC_ACC_OUT_ADDRESS+CDMA_STATUS_OFFSET));
@@ -313,6 +334,9 @@ inline void cdma_mutex_lock_take(
 	/* command parameters and results */
 	uint32_t arg1, arg2, arg3, arg4;
 	uint8_t res1;
+#ifdef CDMA_MUTEX_PROFILE
+	uint32_t prof_start = cdma_mutex_prof_start();
+#endif
 
 	/* prepare command parameters */
 	arg1 = CDMA_EXT_MUTEX_LOCK_TAKE_CMD_ARG1(flags);
@@ -324,8 +348,12 @@ inline void cdma_mutex_lock_take(
 	__stqw(arg1, arg2, arg3, arg4, HWC_ACC_IN_ADDRESS, 0);
 
 	/* call CDMA */
-	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS)
+	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS) {
+#ifdef CDMA_MUTEX_PROFILE
+		cdma_mutex_prof_taken(mutex_id, prof_start);
+#endif
 		return;
+	}
 
 	/* load command results */
 	res1 = *((uint8_t *)(HWC_ACC_OUT_ADDRESS+CDMA_STATUS_OFFSET));
@@ -349,8 +377,12 @@ inline void cdma_mutex_lock_release(
 	__stqw(arg1, arg2, arg3, arg4, HWC_ACC_IN_ADDRESS, 0);
 
 	/* call CDMA */
-	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS)
+	if ((__e_hwacceli_(CDMA_ACCEL_ID)) == CDMA_SUCCESS) {
+#ifdef CDMA_MUTEX_PROFILE
+		cdma_mutex_prof_released(mutex_id);
+#endif
 		return;
+	}
 
 	/* load command results */
 	res1 = *((uint8_t *)(HWC_ACC_OUT_ADDRESS+CDMA_STATUS_OFFSET));
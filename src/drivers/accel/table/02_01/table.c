@@ -79,7 +79,12 @@ int table_create(enum table_hw_accel_id acc_id,
 	/*************************/
 	/* Count leading zeroes */
 	timestamp_accuracy = tbl_params->timestamp_accuracy;
+#if __COVERITY__
+	agt = timestamp_accuracy ?
+		(uint16_t)__builtin_clz(timestamp_accuracy) : 32;
+#else
 	asm { cntlzw agt, timestamp_accuracy }
+#endif
 
 	/* Enable timestamp accuracy if needed*/
 	if(agt < 30) {
@@ -375,7 +380,7 @@ void table_c_exception_handler(enum table_function_identifier func_id,
 			       uint32_t line,
 			       int32_t status,
 			       enum table_entity entity)
-					__attribute__ ((noreturn)) {
+					TABLE_HANDLER_NORETURN {
 	table_exception_handler(__FILE__, func_id, line, status, entity);
 }
 
@@ -386,7 +391,7 @@ void table_exception_handler(char *file_path,
 			     uint32_t line,
 			     int32_t status_id,
 			     enum table_entity entity)
-				__attribute__ ((noreturn)) {
+				TABLE_HANDLER_NORETURN {
 	char *func_name, *status;
 	
 	/* Translate function ID to function name string */
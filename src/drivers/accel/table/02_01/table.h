@@ -428,6 +428,14 @@
 
 /** @} */ /* end of TABLE_STATUS */
 
+/**
+ * Attribute of the exception handler definitions, placed after the
+ * declarator. The compilers which do not accept it there define it empty.
+ */
+#ifndef TABLE_HANDLER_NORETURN
+#define TABLE_HANDLER_NORETURN		__attribute__ ((noreturn))
+#endif
+
 /** @} */ /* end of TABLE_MACROS */
 
 /**************************************************************************//**
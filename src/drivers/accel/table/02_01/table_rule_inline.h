@@ -784,7 +784,7 @@ inline void table_rule_inline_exception_handler(
 				uint32_t line,
 				int32_t status,
 				enum table_entity entity)
-					__attribute__ ((noreturn)) {
+					TABLE_HANDLER_NORETURN {
 	table_exception_handler(__FILE__, func_id, line, status, entity);
 }
 
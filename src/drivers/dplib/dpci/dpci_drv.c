@@ -56,6 +56,12 @@
 #define DPCI_LOW_PR		1
 #define DPCI_ID_FLG_SCANNED	1
 
+/* Index slots of g_dpci_tbl.id_hash and g_dpci_tbl.peer_hash */
+#define DPCI_HASH_FREE		0
+#define DPCI_HASH_DELETED	0xFF
+#define DPCI_HASH_NEXT(H)	(((H) + 1) & (DPCI_HASH_SIZE - 1))
+#define DPCI_HASH_PREV(H)	(((H) - 1) & (DPCI_HASH_SIZE - 1))
+
 /*clear the bit for exclusive / concurrent mode*/
 #define ORDER_MODE_CLEAR_BIT      0xFEFFFFFF
 
@@ -152,52 +158,102 @@ __COLD_CODE static void dpci_tbl_dump()
 #endif
 }
 
-__HOT_CODE int dpci_mng_find(uint32_t dpci_id)
+static inline uint32_t dpci_hash(uint32_t id)
 {
-	int i = 0;
-	int count = 0;
+	return (id * 0x9E3779B1) >> (32 - DPCI_HASH_BITS);
+}
 
-	ASSERT_COND(dpci_id != DPCI_FQID_NOT_VALID);
-	ASSERT_COND(g_dpci_tbl.count <= g_dpci_tbl.max);
+/*
+ * Open addressing index over the DPCI table, linear probing.
+ * The index is updated only under DPCI_DT_LOCK_W, like the table itself.
+ * Lookups are not protected, therefore each index hit is validated against
+ * the table entry: an entry is added to the index after it was written and
+ * it is removed from the index before it is cleared.
+ * Deleted slots are kept as DPCI_HASH_DELETED so that probe chains stay
+ * unbroken for the lookups in progress.
+ */
+static inline int dpci_hash_find(const uint8_t *hash, const uint32_t *ids,
+                                 uint32_t id)
+{
+	uint32_t h = dpci_hash(id);
+	int i;
+	int ind;
 
-	/* If in the middle of ADD or REMOVE then g_dpci_tbl.count be 1 higher
-	 * than the number of valid entries, but it can't be lower */
-	while ((count < g_dpci_tbl.count) && (i < g_dpci_tbl.max)) {
+	for (i = 0; i < DPCI_HASH_SIZE; i++) {
+		ind = hash[h];
+		if (ind == DPCI_HASH_FREE)
+			break;
 
-		if (g_dpci_tbl.dpci_id[i] != DPCI_FQID_NOT_VALID) {
-			if (g_dpci_tbl.dpci_id[i] == dpci_id) {
-				return i;
-			}
-			count++;
+		if (ind != DPCI_HASH_DELETED) {
+			ind--;
+			if ((ids[ind] == id) &&
+			    (g_dpci_tbl.dpci_id[ind] != DPCI_FQID_NOT_VALID))
+				return ind;
 		}
-		i++;
+		h = DPCI_HASH_NEXT(h);
 	}
 
 	return -ENOENT;
 }
 
-__HOT_CODE int dpci_mng_peer_find(uint32_t dpci_id)
+__COLD_CODE static void dpci_hash_add(uint8_t *hash, uint32_t id, int ind)
 {
-	int i = 0;
-	int count = 0;
+	uint32_t h = dpci_hash(id);
+	int i;
 
-	ASSERT_COND(dpci_id != DPCI_FQID_NOT_VALID);
-	ASSERT_COND(g_dpci_tbl.count <= g_dpci_tbl.max);
+	for (i = 0; i < DPCI_HASH_SIZE; i++) {
+		if ((hash[h] == DPCI_HASH_FREE) ||
+		    (hash[h] == DPCI_HASH_DELETED)) {
+			hash[h] = (uint8_t)(ind + 1);
+			return;
+		}
+		h = DPCI_HASH_NEXT(h);
+	}
 
-	/* If in the middle of ADD or REMOVE then g_dpci_tbl.count be 1 higher
-	 * than the number of valid entries, but it can't be lower */
-	while ((count < g_dpci_tbl.count) && (i < g_dpci_tbl.max)) {
+	/* The index has twice the entries of the table */
+	ASSERT_COND(0);
+}
 
-		if (g_dpci_tbl.dpci_id[i] != DPCI_FQID_NOT_VALID) {
-			if (g_dpci_tbl.dpci_id_peer[i] == dpci_id) {
-				return i;
-			}
-			count++;
+__COLD_CODE static void dpci_hash_remove(uint8_t *hash, uint32_t id, int ind)
+{
+	uint32_t h = dpci_hash(id);
+	int i;
+
+	for (i = 0; i < DPCI_HASH_SIZE; i++) {
+		if (hash[h] == DPCI_HASH_FREE)
+			return;
+
+		if (hash[h] == (uint8_t)(ind + 1)) {
+			hash[h] = DPCI_HASH_DELETED;
+			break;
 		}
-		i++;
+		h = DPCI_HASH_NEXT(h);
 	}
 
-	return -ENOENT;
+	/* Deleted slots at the end of a probe chain are not needed anymore */
+	for (i = 0; (i < DPCI_HASH_SIZE) &&
+		(hash[h] == DPCI_HASH_DELETED) &&
+		(hash[DPCI_HASH_NEXT(h)] == DPCI_HASH_FREE); i++) {
+		hash[h] = DPCI_HASH_FREE;
+		h = DPCI_HASH_PREV(h);
+	}
+}
+
+__HOT_CODE int dpci_mng_find(uint32_t dpci_id)
+{
+	ASSERT_COND(dpci_id != DPCI_FQID_NOT_VALID);
+	ASSERT_COND(g_dpci_tbl.count <= g_dpci_tbl.max);
+
+	return dpci_hash_find(g_dpci_tbl.id_hash, g_dpci_tbl.dpci_id, dpci_id);
+}
+
+__HOT_CODE int dpci_mng_peer_find(uint32_t dpci_id)
+{
+	ASSERT_COND(dpci_id != DPCI_FQID_NOT_VALID);
+	ASSERT_COND(g_dpci_tbl.count <= g_dpci_tbl.max);
+
+	return dpci_hash_find(g_dpci_tbl.peer_hash, g_dpci_tbl.dpci_id_peer,
+	                      dpci_id);
 }
 
 static int dpci_entry_get()
@@ -221,6 +277,12 @@ __COLD_CODE static void dpci_entry_delete(int ind)
 
 	int i;
 
+	/* Remove from the index first because the search is not protected */
+	if (g_dpci_tbl.dpci_id_peer[ind] != DPCI_FQID_NOT_VALID)
+		dpci_hash_remove(g_dpci_tbl.peer_hash,
+		                 g_dpci_tbl.dpci_id_peer[ind], ind);
+	dpci_hash_remove(g_dpci_tbl.id_hash, g_dpci_tbl.dpci_id[ind], ind);
+
 	g_dpci_tbl.dpci_id[ind] = DPCI_FQID_NOT_VALID;
 	g_dpci_tbl.ic[ind] = DPCI_FQID_NOT_VALID;
 	g_dpci_tbl.dpci_id_peer[ind] = DPCI_FQID_NOT_VALID;
@@ -269,6 +331,9 @@ __COLD_CODE static int tx_peer_set(uint32_t ind, uint16_t token)
 	ASSERT_COND(tx);
 	ASSERT_COND(dprc);
 
+	if (g_dpci_tbl.dpci_id_peer[ind] != DPCI_FQID_NOT_VALID)
+		dpci_hash_remove(g_dpci_tbl.peer_hash,
+		                 g_dpci_tbl.dpci_id_peer[ind], (int)ind);
 	g_dpci_tbl.dpci_id_peer[ind] = DPCI_FQID_NOT_VALID;
 	for (i = 0; i < DPCI_PRIO_NUM; i++) {
 		tx[i] = DPCI_FQID_NOT_VALID;
@@ -286,6 +351,8 @@ __COLD_CODE static int tx_peer_set(uint32_t ind, uint16_t token)
 	}
 
 	g_dpci_tbl.dpci_id_peer[ind] = (uint32_t)peer_attr.peer_id;
+	dpci_hash_add(g_dpci_tbl.peer_hash, g_dpci_tbl.dpci_id_peer[ind],
+	              (int)ind);
 
 	for (i = 0; i < peer_attr.num_of_priorities; i++) {
 		err = dpci_get_tx_queue(&dprc->io, 0, token, (uint8_t)i, &tx_attr);
@@ -360,6 +427,9 @@ __COLD_CODE static int dpci_entry_init(uint32_t dpci_id, uint16_t token)
 	g_dpci_tbl.dpci_id[ind] = dpci_id;
 	g_dpci_tbl.ic[ind] = amq_bdi;
 	g_dpci_tbl.flags[ind] = 0;
+	/* Must be after the entry is written because the search
+	 * is not protected */
+	dpci_hash_add(g_dpci_tbl.id_hash, dpci_id, ind);
 
 	/* Updated DPCI peer if possible
 	 * error is possible */
@@ -36,6 +36,8 @@
 #include "fsl_dpci.h"
 
 #define DPCI_DYNAMIC_MAX	64
+#define DPCI_HASH_BITS		7	/**< At least 2 x DPCI_DYNAMIC_MAX slots */
+#define DPCI_HASH_SIZE		(1 << DPCI_HASH_BITS)
 
 #define DPCI_DT_LOCK_R_TAKE \
 	do { \
@@ -61,6 +63,8 @@ struct dpci_mng_tbl {
 	uint32_t dpci_id_peer[DPCI_DYNAMIC_MAX];		/**< dpci ids not tokens */
 	uint32_t tx_queue[DPCI_DYNAMIC_MAX][DPCI_PRIO_NUM];	/**< Use DPCI_PRIO_NUM between DPCI jumps */
 	uint8_t  flags[DPCI_DYNAMIC_MAX];
+	uint8_t  id_hash[DPCI_HASH_SIZE];	/**< index + 1 by dpci_id, 0 is free */
+	uint8_t  peer_hash[DPCI_HASH_SIZE];	/**< index + 1 by dpci_id_peer, 0 is free */
 };
 
 /**************************************************************************//**
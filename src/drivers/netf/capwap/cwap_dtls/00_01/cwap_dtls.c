@@ -32,9 +32,12 @@
 *//***************************************************************************/
 
 #include "fsl_types.h"
+#include "kernel/fsl_spinlock.h"
 #include "fsl_cdma.h"
 #include "fsl_parser.h"
 #include "fsl_fdma.h"
+#include "fsl_ste.h"
+#include "fsl_tman.h"
 #include "fsl_osm.h"
 #include "osm_inline.h"
 #include "fsl_checksum.h"
@@ -61,6 +64,223 @@
 
 uint16_t cwap_dtls_bpid;
 
+#ifdef CWAP_DTLS_SA_CACHE
+/* SA cache, indexed by a hash of the SA descriptor address */
+struct cwap_dtls_sa_cache_entry g_cwap_dtls_sa_cache[CWAP_DTLS_SA_CACHE_SIZE];
+#endif
+
+#ifdef CWAP_DTLS_STATS_BATCH
+/*
+ * Processed frames staged per core, indexed by a hash of the SA descriptor
+ * address. A stage is only accessed by the tasks of its core.
+ */
+struct cwap_dtls_stats_stage
+	g_cwap_dtls_stats_stage[INTG_MAX_NUM_OF_CORES][CWAP_DTLS_STATS_BATCH_SLOTS];
+#endif
+
+static inline uint32_t cwap_dtls_desc_hash(cwap_dtls_sa_handle_t desc_addr)
+{
+	/* SA descriptors are 64 bytes aligned */
+	return (uint32_t)(desc_addr >> 6) ^ (uint32_t)(desc_addr >> 16);
+}
+
+#ifdef CWAP_DTLS_SA_CACHE
+static inline struct cwap_dtls_sa_cache_entry *cwap_dtls_sa_cache_entry_get(
+		cwap_dtls_sa_handle_t desc_addr)
+{
+	return &g_cwap_dtls_sa_cache[cwap_dtls_desc_hash(desc_addr) &
+				     (CWAP_DTLS_SA_CACHE_SIZE - 1)];
+}
+
+/*
+ * Reads the SA parameters used by the encrypt/decrypt functions from the SA
+ * cache. On a miss the parameters are read from the SA descriptor and cached.
+ */
+static void cwap_dtls_sa_cache_read(cwap_dtls_sa_handle_t desc_addr,
+				    struct cwap_dtls_sa_params *sap)
+{
+	struct cwap_dtls_sa_cache_entry *entry;
+	uint32_t gen;
+
+	entry = cwap_dtls_sa_cache_entry_get(desc_addr);
+
+	lock_spinlock(&entry->lock);
+	if (entry->desc_addr == desc_addr) {
+		sap->flags = entry->flags;
+		sap->bpid = entry->bpid;
+		sap->sec_buffer_mode = entry->sec_buffer_mode;
+		sap->output_spid = entry->output_spid;
+		unlock_spinlock(&entry->lock);
+		return;
+	}
+	gen = entry->gen;
+	unlock_spinlock(&entry->lock);
+
+	cdma_read(sap, desc_addr, sizeof(*sap));
+
+	lock_spinlock(&entry->lock);
+	/* Do not cache parameters read before an invalidation of the entry */
+	if (entry->gen == gen) {
+		entry->flags = sap->flags;
+		entry->bpid = sap->bpid;
+		entry->sec_buffer_mode = sap->sec_buffer_mode;
+		entry->output_spid = sap->output_spid;
+		entry->desc_addr = desc_addr;
+	}
+	unlock_spinlock(&entry->lock);
+}
+
+/* Invalidates the SA cache entry of an SA descriptor */
+static void cwap_dtls_sa_cache_invalidate(cwap_dtls_sa_handle_t desc_addr)
+{
+	struct cwap_dtls_sa_cache_entry *entry;
+
+	entry = cwap_dtls_sa_cache_entry_get(desc_addr);
+	lock_spinlock(&entry->lock);
+	if (entry->desc_addr == desc_addr)
+		entry->desc_addr = 0;
+	/* Parameters being read from the descriptor by other tasks are not
+	 * cached */
+	entry->gen++;
+	unlock_spinlock(&entry->lock);
+}
+#else
+#define cwap_dtls_sa_cache_invalidate(desc_addr)
+#endif /* CWAP_DTLS_SA_CACHE */
+
+/* Clears the SA statistics counters, also in the STE internal cache */
+static void cwap_dtls_clear_counters(cwap_dtls_sa_handle_t desc_addr)
+{
+	ste_set_64bit_counter(CWAP_DTLS_PACKETS_CNTR_ADDR(desc_addr), 0);
+	ste_set_64bit_counter(CWAP_DTLS_BYTES_CNTR_ADDR(desc_addr), 0);
+	ste_set_64bit_counter(CWAP_DTLS_AR_DROPPED_CNTR_ADDR(desc_addr), 0);
+	ste_set_64bit_counter(CWAP_DTLS_ICV_FAILED_CNTR_ADDR(desc_addr), 0);
+	ste_set_64bit_counter(CWAP_DTLS_ERRORS_CNTR_ADDR(desc_addr), 0);
+}
+
+/* Counts a frame failed with the given status */
+static void cwap_dtls_count_error(cwap_dtls_sa_handle_t desc_addr, int status)
+{
+	uint32_t bits = CWAP_DTLS_STATUS_BITS(status);
+	uint64_t cntr_addr;
+
+	if (bits & CWAP_DTLS_STATUS_BITS(CWAP_DTLS_AR_LATE_PACKET |
+					 CWAP_DTLS_AR_REPLAY_PACKET))
+		cntr_addr = CWAP_DTLS_AR_DROPPED_CNTR_ADDR(desc_addr);
+	else if (bits & CWAP_DTLS_STATUS_BITS(CWAP_DTLS_ICV_CHK_FAIL))
+		cntr_addr = CWAP_DTLS_ICV_FAILED_CNTR_ADDR(desc_addr);
+	else
+		cntr_addr = CWAP_DTLS_ERRORS_CNTR_ADDR(desc_addr);
+
+	ste_inc_counter(cntr_addr, 1,
+			STE_MODE_SATURATE | STE_MODE_64_BIT_CNTR_SIZE);
+}
+
+#ifdef CWAP_DTLS_STATS_BATCH
+static inline struct cwap_dtls_stats_stage *cwap_dtls_stats_stage_get(
+		uint32_t core_id, cwap_dtls_sa_handle_t desc_addr)
+{
+	return &g_cwap_dtls_stats_stage[core_id][cwap_dtls_desc_hash(desc_addr) &
+					(CWAP_DTLS_STATS_BATCH_SLOTS - 1)];
+}
+
+/* Adds staged frames to the SA counters */
+static void cwap_dtls_stats_flush(cwap_dtls_sa_handle_t desc_addr,
+				  uint32_t packets, uint32_t bytes)
+{
+	ste_inc_counter(CWAP_DTLS_PACKETS_CNTR_ADDR(desc_addr), packets,
+			STE_MODE_SATURATE | STE_MODE_64_BIT_CNTR_SIZE);
+	ste_inc_counter(CWAP_DTLS_BYTES_CNTR_ADDR(desc_addr), bytes,
+			STE_MODE_SATURATE | STE_MODE_64_BIT_CNTR_SIZE);
+}
+
+/*
+ * Adds the frames of an SA staged on all the cores. The stages of the other
+ * cores are read while they may be updated.
+ */
+static void cwap_dtls_stats_pending(cwap_dtls_sa_handle_t desc_addr,
+				    uint64_t *packets, uint64_t *bytes)
+{
+	struct cwap_dtls_stats_stage *stage;
+	uint32_t i;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+		stage = cwap_dtls_stats_stage_get(i, desc_addr);
+		if (stage->desc_addr == desc_addr) {
+			*packets += stage->packets;
+			*bytes += stage->bytes;
+		}
+	}
+}
+
+/* Drops the frames of a deleted SA staged on all the cores */
+static void cwap_dtls_stats_discard(cwap_dtls_sa_handle_t desc_addr)
+{
+	struct cwap_dtls_stats_stage *stage;
+	uint32_t i;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+		stage = cwap_dtls_stats_stage_get(i, desc_addr);
+		if (stage->desc_addr == desc_addr) {
+			stage->packets = 0;
+			stage->bytes = 0;
+			stage->desc_addr = 0;
+		}
+	}
+}
+#endif /* CWAP_DTLS_STATS_BATCH */
+
+/* Counts a frame processed by the SA */
+static void cwap_dtls_count_frame(cwap_dtls_sa_handle_t desc_addr,
+				  uint32_t byte_count)
+{
+#ifdef CWAP_DTLS_STATS_BATCH
+	struct cwap_dtls_stats_stage *stage;
+	cwap_dtls_sa_handle_t evict_addr = 0;
+	uint32_t evict_packets = 0, evict_bytes = 0;
+	uint32_t packets = 0, bytes = 0;
+	uint64_t now;
+
+	tman_get_timestamp(&now);
+	stage = cwap_dtls_stats_stage_get(core_get_id(), desc_addr);
+
+	/* The stage is updated without accelerator call (no task switch) */
+	if (stage->desc_addr != desc_addr) {
+		if (stage->packets) {
+			evict_addr = stage->desc_addr;
+			evict_packets = stage->packets;
+			evict_bytes = stage->bytes;
+		}
+		stage->desc_addr = desc_addr;
+		stage->packets = 0;
+		stage->bytes = 0;
+		stage->timestamp = now;
+	}
+	stage->packets++;
+	stage->bytes += byte_count;
+	if ((stage->packets >= CWAP_DTLS_STATS_BATCH_PKTS) ||
+	    ((now - stage->timestamp) >= CWAP_DTLS_STATS_BATCH_USEC)) {
+		packets = stage->packets;
+		bytes = stage->bytes;
+		stage->packets = 0;
+		stage->bytes = 0;
+		stage->timestamp = now;
+	}
+
+	if (evict_packets)
+		cwap_dtls_stats_flush(evict_addr, evict_packets, evict_bytes);
+	if (packets)
+		cwap_dtls_stats_flush(desc_addr, packets, bytes);
+#else
+	ste_inc_and_acc_counters(CWAP_DTLS_PACKETS_CNTR_ADDR(desc_addr),
+				 byte_count,
+				 STE_MODE_COMPOUND_64_BIT_CNTR_SIZE |
+				 STE_MODE_COMPOUND_64_BIT_ACC_SIZE |
+				 STE_MODE_COMPOUND_CNTR_SATURATE |
+				 STE_MODE_COMPOUND_ACC_SATURATE);
+#endif
+}
+
 int cwap_dtls_drv_init(void)
 {
 	struct mc_dprc *dprc = sys_get_unique_handle(FSL_MOD_AIOP_RC);
@@ -74,6 +294,13 @@ int cwap_dtls_drv_init(void)
 	uint8_t bkp_pool_disable = (g_app_params.app_config_flags &
 				    DPNI_BACKUP_POOL_DISABLE) ? 1 : 0;
 
+#ifdef CWAP_DTLS_SA_CACHE
+	memset(g_cwap_dtls_sa_cache, 0, sizeof(g_cwap_dtls_sa_cache));
+#endif
+#ifdef CWAP_DTLS_STATS_BATCH
+	memset(g_cwap_dtls_stats_stage, 0, sizeof(g_cwap_dtls_stats_stage));
+#endif
+
 	/* If the new buffer is not brought by user, do nothing */
 	if (!(g_app_params.app_config_flags & CWAP_DTLS_BUFFER_ALLOCATE_ENABLE))
 		return 0;
@@ -792,6 +1019,10 @@ int cwap_dtls_add_sa_descriptor(struct cwap_dtls_sa_descriptor_params *params,
 	/* Initialize the debug area */
 	cwap_dtls_init_debug_info(desc_addr);
 
+	/* Clear the statistics counters of a possibly reused descriptor */
+	cwap_dtls_clear_counters(desc_addr);
+	cwap_dtls_sa_cache_invalidate(desc_addr);
+
 	return SUCCESS;
 }
 
@@ -806,6 +1037,17 @@ int cwap_dtls_del_sa_descriptor(cwap_dtls_sa_handle_t sa_handle)
 	cdma_read(&instance_handle, CWAP_DTLS_INSTANCE_HANDLE_ADDR(desc_addr),
 		  sizeof(instance_handle));
 
+	/*
+	 * Wait for the counter updates of the last frames and clear the
+	 * counters, so the STE does not write them after the buffer is reused
+	 */
+	ste_barrier();
+	cwap_dtls_clear_counters(desc_addr);
+	cwap_dtls_sa_cache_invalidate(desc_addr);
+#ifdef CWAP_DTLS_STATS_BATCH
+	cwap_dtls_stats_discard(desc_addr);
+#endif
+
 	/* Release the buffer */
 	return cwap_dtls_release_buffer(instance_handle, sa_handle);
 }
@@ -904,7 +1146,11 @@ int cwap_dtls_frame_encrypt(cwap_dtls_sa_handle_t sa_handle)
 	desc_addr = CWAP_DTLS_SA_DESC_ADDR(sa_handle);
 
 	/* 2. Read relevant descriptor fields with CDMA. */
+#ifdef CWAP_DTLS_SA_CACHE
+	cwap_dtls_sa_cache_read(desc_addr, &sap);
+#else
 	cdma_read(&sap, desc_addr, sizeof(sap));
+#endif
 
 	/* 5. Save original FD[FLC], FD[FRC] (to stack) */
 	orig_flc = LDPAA_FD_GET_FLC(HWC_FD_ADDRESS);
@@ -1020,6 +1266,7 @@ int cwap_dtls_frame_encrypt(cwap_dtls_sa_handle_t sa_handle)
 				buffer_pool_depleted(sec_frc);
 			case SEC_TABLE_BP0_DEPLETION_COMPRESSED:
 				enc_status |= CWAP_DTLS_BUFFER_POOL_DEPLETION;
+				cwap_dtls_count_error(desc_addr, enc_status);
 				return enc_status;
 			default:
 				enc_status |= CWAP_DTLS_GEN_ENCR_ERR;
@@ -1035,6 +1282,7 @@ int cwap_dtls_frame_encrypt(cwap_dtls_sa_handle_t sa_handle)
 				buffer_pool_depleted(sec_frc);
 			case SEC_TABLE_BP0_DEPLETION:
 				enc_status |= CWAP_DTLS_BUFFER_POOL_DEPLETION;
+				cwap_dtls_count_error(desc_addr, enc_status);
 				return enc_status;
 			default:
 				enc_status |= CWAP_DTLS_GEN_ENCR_ERR;
@@ -1044,6 +1292,7 @@ int cwap_dtls_frame_encrypt(cwap_dtls_sa_handle_t sa_handle)
 		cwap_dtls_error_handler(sa_handle, CWAP_DTLS_FRAME_ENCRYPT,
 					CWAP_DTLS_SEC_HW, __LINE__,
 					(int)sec_frc);
+		cwap_dtls_count_error(desc_addr, enc_status);
 		return enc_status;
 	}
 
@@ -1105,6 +1354,8 @@ int cwap_dtls_frame_encrypt(cwap_dtls_sa_handle_t sa_handle)
 	LDPAA_FD_SET_FLC(HWC_FD_ADDRESS, orig_flc);
 	LDPAA_FD_SET_FRC(HWC_FD_ADDRESS, orig_frc);
 
+	cwap_dtls_count_frame(desc_addr, LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS));
+
 	return SUCCESS;
 }
 
@@ -1130,7 +1381,11 @@ int cwap_dtls_frame_decrypt(cwap_dtls_sa_handle_t sa_handle)
 	desc_addr = CWAP_DTLS_SA_DESC_ADDR(sa_handle);
 
 	/*  2. Read relevant descriptor fields with CDMA. */
+#ifdef CWAP_DTLS_SA_CACHE
+	cwap_dtls_sa_cache_read(desc_addr, &sap);
+#else
 	cdma_read(&sap, desc_addr, sizeof(sap));
+#endif
 
 	/* Save the original segment address */
 	orig_seg_addr = PRC_GET_SEGMENT_ADDRESS();
@@ -1260,6 +1515,8 @@ int cwap_dtls_frame_decrypt(cwap_dtls_sa_handle_t sa_handle)
 				case SEC_TABLE_BP0_DEPLETION_COMPRESSED:
 					dec_status |=
 						CWAP_DTLS_BUFFER_POOL_DEPLETION;
+					cwap_dtls_count_error(desc_addr,
+							      dec_status);
 					return dec_status;
 
 				default:
@@ -1288,6 +1545,7 @@ int cwap_dtls_frame_decrypt(cwap_dtls_sa_handle_t sa_handle)
 			case SEC_TABLE_BP0_DEPLETION:
 				dec_status |=
 					CWAP_DTLS_BUFFER_POOL_DEPLETION;
+				cwap_dtls_count_error(desc_addr, dec_status);
 				return dec_status;
 
 			default:
@@ -1298,6 +1556,7 @@ int cwap_dtls_frame_decrypt(cwap_dtls_sa_handle_t sa_handle)
 		cwap_dtls_error_handler(sa_handle, CWAP_DTLS_FRAME_DECRYPT,
 					CWAP_DTLS_SEC_HW, __LINE__,
 					(int)sec_frc);
+		cwap_dtls_count_error(desc_addr, dec_status);
 		return dec_status;
 	}
 
@@ -1512,6 +1771,8 @@ int cwap_dtls_frame_decrypt(cwap_dtls_sa_handle_t sa_handle)
 	LDPAA_FD_SET_FLC(HWC_FD_ADDRESS, orig_flc);
 	LDPAA_FD_SET_FRC(HWC_FD_ADDRESS, orig_frc);
 
+	cwap_dtls_count_frame(desc_addr, LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS));
+
 	return SUCCESS;
 }
 
@@ -1575,9 +1836,18 @@ void cwap_dtls_get_ar_info(cwap_dtls_sa_handle_t sa_handle,
 {
 	cwap_dtls_sa_handle_t desc_addr = CWAP_DTLS_SA_DESC_ADDR(sa_handle);
 	uint32_t params_flags;
+#ifdef CWAP_DTLS_SA_CACHE
+	struct cwap_dtls_sa_params sap;
+#endif
 
+#ifdef CWAP_DTLS_SA_CACHE
+	cwap_dtls_sa_cache_read(desc_addr, &sap);
+	params_flags = sap.flags;
+#else
 	cdma_read(&params_flags, CWAP_DTLS_FLAGS_ADDR(desc_addr),
 		  sizeof(params_flags));
+#endif
+
 
 	if (params_flags & CWAP_DTLS_FLG_CIPHER_GCM)
 		cwap_dtls_get_ar_info_gcm(desc_addr, params_flags,
@@ -1587,6 +1857,30 @@ void cwap_dtls_get_ar_info(cwap_dtls_sa_handle_t sa_handle,
 					  sequence_number, anti_replay_bitmap);
 }
 
+int cwap_dtls_get_sa_stats(cwap_dtls_sa_handle_t sa_handle,
+			   struct cwap_dtls_sa_stats *stats)
+{
+	cwap_dtls_sa_handle_t desc_addr = CWAP_DTLS_SA_DESC_ADDR(sa_handle);
+	struct cwap_dtls_sa_counters ctrs;
+
+	/* Wait for the pending counter updates of the statistics engine */
+	ste_barrier();
+
+	fsl_read_external_data(&ctrs, CWAP_DTLS_SA_COUNTERS_ADDR(desc_addr),
+			       sizeof(ctrs), READ_DATA_USING_CDMA);
+#ifdef CWAP_DTLS_STATS_BATCH
+	cwap_dtls_stats_pending(desc_addr, &ctrs.packets, &ctrs.bytes);
+#endif
+
+	stats->packets = ctrs.packets;
+	stats->bytes = ctrs.bytes;
+	stats->ar_dropped = ctrs.ar_dropped;
+	stats->icv_failed = ctrs.icv_failed;
+	stats->errors = ctrs.errors;
+
+	return SUCCESS;
+}
+
 void cwap_dtls_error_handler(cwap_dtls_sa_handle_t sa_handle,
 			     enum cwap_dtls_function_identifier func_id,
 			     enum cwap_dtls_service_identifier service_id,
@@ -142,6 +142,84 @@ struct cwap_dtls_sa_params {
 	 */
 };
 
+/**************************************************************************//**
+ @Description	CAPWAP DTLS SA statistics counters (STE counters), in the
+		internal parameters area at CWAP_DTLS_SA_COUNTERS_OFFSET
+*//***************************************************************************/
+struct cwap_dtls_sa_counters {
+	/** Processed frames (compound counter) */
+	uint64_t packets;
+	/** Processed bytes (accumulator of the packets counter) */
+	uint64_t bytes;
+	/** Frames dropped by the anti-replay check */
+	uint64_t ar_dropped;
+	/** Frames with failed ICV check */
+	uint64_t icv_failed;
+	/** Frames failed for another SEC or buffer depletion error */
+	uint64_t errors;
+	/* Total size = 5*8 (40) bytes */
+};
+
+#ifdef CWAP_DTLS_SA_CACHE
+/* Number of SA cache entries in shared RAM (power of 2) */
+#ifndef CWAP_DTLS_SA_CACHE_SIZE
+#define CWAP_DTLS_SA_CACHE_SIZE		64
+#endif
+
+/**************************************************************************//**
+ @Description	CAPWAP DTLS SA cache entry. Copy of the cwap_dtls_sa_params
+		fields used by the encrypt/decrypt functions.
+*//***************************************************************************/
+struct cwap_dtls_sa_cache_entry {
+	/** SA descriptor address, 0 if free */
+	cwap_dtls_sa_handle_t desc_addr;
+	/** Incremented on every invalidation */
+	uint32_t gen;
+	uint32_t flags;
+	uint16_t bpid;
+	uint8_t sec_buffer_mode;
+	uint8_t output_spid;
+	/** Entry spinlock */
+	uint8_t lock;
+	uint8_t pad[3];
+	/* Total size = 8 + 2*4 (8) + 2 + 3*1 (3) + 3 = 24 bytes */
+};
+#endif /* CWAP_DTLS_SA_CACHE */
+
+#ifdef CWAP_DTLS_STATS_BATCH
+/* SAs staged per core (power of 2) */
+#ifndef CWAP_DTLS_STATS_BATCH_SLOTS
+#define CWAP_DTLS_STATS_BATCH_SLOTS	4
+#endif
+
+/*
+ * The frames staged for an SA on a core are added to the SA counters after
+ * CWAP_DTLS_STATS_BATCH_PKTS frames or after CWAP_DTLS_STATS_BATCH_USEC micro
+ * seconds, checked when a frame is staged.
+ */
+#ifndef CWAP_DTLS_STATS_BATCH_PKTS
+#define CWAP_DTLS_STATS_BATCH_PKTS	32
+#endif
+
+#ifndef CWAP_DTLS_STATS_BATCH_USEC
+#define CWAP_DTLS_STATS_BATCH_USEC	1000
+#endif
+
+/**************************************************************************//**
+ @Description	CAPWAP DTLS processed frames of an SA staged on a core
+*//***************************************************************************/
+struct cwap_dtls_stats_stage {
+	/** SA descriptor address */
+	cwap_dtls_sa_handle_t desc_addr;
+	/** TMAN timestamp of the first staged frame */
+	uint64_t timestamp;
+	/** Staged frames */
+	uint32_t packets;
+	/** Staged bytes */
+	uint32_t bytes;
+};
+#endif /* CWAP_DTLS_STATS_BATCH */
+
 /**************************************************************************//**
  @Description   CAPWAP DTLS per SA debug information
 *//***************************************************************************/
@@ -261,6 +339,38 @@ struct cwap_dtls_debug_info {
 #define CWAP_DTLS_INSTANCE_HANDLE_ADDR(ADDRESS) \
 	(ADDRESS + (offsetof(struct cwap_dtls_sa_params, instance_handle)))
 
+/* Status bits of a return code, without the module status ID */
+#define CWAP_DTLS_STATUS_BITS(STATUS)	((uint32_t)(STATUS) & 0x00FFFFFF)
+
+/*
+ * SA statistics counters offset (from params start). The counters are written
+ * by STE, in a different cache line than the parameters read per frame.
+ */
+#define CWAP_DTLS_SA_COUNTERS_OFFSET	64
+
+#define CWAP_DTLS_SA_COUNTERS_ADDR(ADDRESS) \
+	((ADDRESS) + CWAP_DTLS_SA_COUNTERS_OFFSET)
+
+#define CWAP_DTLS_PACKETS_CNTR_ADDR(ADDRESS) \
+	(CWAP_DTLS_SA_COUNTERS_ADDR(ADDRESS) + \
+	 offsetof(struct cwap_dtls_sa_counters, packets))
+
+#define CWAP_DTLS_BYTES_CNTR_ADDR(ADDRESS) \
+	(CWAP_DTLS_SA_COUNTERS_ADDR(ADDRESS) + \
+	 offsetof(struct cwap_dtls_sa_counters, bytes))
+
+#define CWAP_DTLS_AR_DROPPED_CNTR_ADDR(ADDRESS) \
+	(CWAP_DTLS_SA_COUNTERS_ADDR(ADDRESS) + \
+	 offsetof(struct cwap_dtls_sa_counters, ar_dropped))
+
+#define CWAP_DTLS_ICV_FAILED_CNTR_ADDR(ADDRESS) \
+	(CWAP_DTLS_SA_COUNTERS_ADDR(ADDRESS) + \
+	 offsetof(struct cwap_dtls_sa_counters, icv_failed))
+
+#define CWAP_DTLS_ERRORS_CNTR_ADDR(ADDRESS) \
+	(CWAP_DTLS_SA_COUNTERS_ADDR(ADDRESS) + \
+	 offsetof(struct cwap_dtls_sa_counters, errors))
+
 /* PDB address */
 #define CWAP_DTLS_PDB_ADDR(ADDRESS)	(CWAP_DTLS_SD_ADDR(ADDRESS) + 4)
 
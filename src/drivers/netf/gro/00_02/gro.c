@@ -42,6 +42,12 @@
 #include "fsl_fdma.h"
 #include "fsl_checksum.h"
 #include "fsl_sl_dpni_drv.h"
+#include "fsl_keygen.h"
+#include "fsl_malloc.h"
+#ifdef GRO_CTX_DMA_STATS
+#include "fsl_platform.h"
+#include "fsl_core_booke.h"
+#endif
 /*#include "cdma.h"*/
 
 #ifdef GRO_NO_METADATA
@@ -52,6 +58,35 @@
 #define GRO_CTX_PTR__SEG_NUM gro_ctx->metadata.seg_num
 #endif
 
+#ifdef GRO_CTX_DMA_STATS
+/* GRO context bytes transferred per core (the update has no task switch) */
+uint64_t g_gro_ctx_dma_bytes[INTG_MAX_NUM_OF_CORES];
+#define GRO_CTX_DMA_ACCOUNT(_size)					\
+	(g_gro_ctx_dma_bytes[core_get_id()] += (uint64_t)(_size))
+#else
+#define GRO_CTX_DMA_ACCOUNT(_size)
+#endif
+
+#ifdef GRO_NO_METADATA
+#define GRO_CTX_READ_AGG_PART(_addr, _gro_ctx)				\
+	do {								\
+		cdma_read((uint8_t *)(_gro_ctx) + GRO_CTX_SEG_SIZE,	\
+			  (_addr) + GRO_CTX_SEG_SIZE,			\
+			  (uint16_t)GRO_CTX_AGG_SIZE);			\
+		GRO_CTX_DMA_ACCOUNT(GRO_CTX_AGG_SIZE);			\
+	} while (0)
+#define GRO_CTX_WRITE_AGG_PART(_addr, _gro_ctx)				\
+	do {								\
+		cdma_write((_addr) + GRO_CTX_SEG_SIZE,			\
+			   (uint8_t *)(_gro_ctx) + GRO_CTX_SEG_SIZE,	\
+			   (uint16_t)GRO_CTX_AGG_SIZE);			\
+		GRO_CTX_DMA_ACCOUNT(GRO_CTX_AGG_SIZE);			\
+	} while (0)
+#else
+#define GRO_CTX_READ_AGG_PART(_addr, _gro_ctx)
+#define GRO_CTX_WRITE_AGG_PART(_addr, _gro_ctx)
+#endif
+
 /* New Aggregation */
 GRO_CODE_PLACEMENT int tcp_gro_aggregate_seg(
 		uint64_t tcp_gro_context_addr,
@@ -74,24 +109,26 @@ GRO_CODE_PLACEMENT int tcp_gro_aggregate_seg(
 
 	seg_size = (uint16_t)LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS);
 
-	/* read GRO context*/
+	/* read the segment part of the GRO context */
 	cdma_read_with_mutex(tcp_gro_context_addr,
 			CDMA_PREDMA_MUTEX_WRITE_LOCK,
 			(void *)(&gro_ctx),
-			(uint16_t)sizeof(struct tcp_gro_context));
+			(uint16_t)GRO_CTX_SEG_SIZE);
+	GRO_CTX_DMA_ACCOUNT(GRO_CTX_SEG_SIZE);
 
 	/* add segment to an existing aggregation */
 	if (GRO_CTX__SEG_NUM != 0) {
 		status = tcp_gro_add_seg_to_aggregation(
 				tcp_gro_context_addr, params, &gro_ctx);
-		/* write entire gro context back to DDR + release
-		 * mutex */
+		/* write the segment part of the gro context back to DDR +
+		 * release mutex (the aggregation part is written when a new
+		 * aggregation is opened) */
 		cdma_write_with_mutex(
 			tcp_gro_context_addr,
 			CDMA_POSTDMA_MUTEX_RM_BIT,
 			(void *)&gro_ctx,
-			(uint16_t)
-				sizeof(struct tcp_gro_context));
+			(uint16_t)GRO_CTX_SEG_SIZE);
+		GRO_CTX_DMA_ACCOUNT(GRO_CTX_SEG_SIZE);
 		return status;
 	}
 
@@ -214,6 +251,7 @@ GRO_CODE_PLACEMENT int tcp_gro_aggregate_seg(
 			CDMA_POSTDMA_MUTEX_RM_BIT,
 			(void *)&gro_ctx,
 			(uint16_t)sizeof(struct tcp_gro_context));
+	GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
 
 	/* update statistics */
 	ste_inc_counter(gro_ctx.stats_addr +
@@ -622,6 +660,9 @@ GRO_CODE_PLACEMENT int tcp_gro_close_aggregation_and_open_new_aggregation(
 	seg_size = (uint16_t)LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS);
 	tcp = (struct tcphdr *)(PARSER_GET_L4_POINTER_DEFAULT());
 
+	/* read the aggregation part of the context (the mutex is held) */
+	GRO_CTX_READ_AGG_PART(tcp_gro_context_addr, gro_ctx);
+
 	/* We save the prc segment length for future use. The size may be
 	 * different due to headers size differences.
 	 * We do not save prc segment offset since each segment arrives with
@@ -877,6 +918,9 @@ GRO_CODE_PLACEMENT int tcp_gro_close_aggregation_and_open_new_aggregation(
 	}
 #endif
 
+	/* write the aggregation part of the new aggregation */
+	GRO_CTX_WRITE_AGG_PART(tcp_gro_context_addr, gro_ctx);
+
 	/* Clear gross running sum in parse results */
 	pr->gross_running_sum = 0;
 
@@ -901,6 +945,7 @@ GRO_CODE_PLACEMENT int tcp_gro_flush_aggregation(
 			CDMA_PREDMA_MUTEX_WRITE_LOCK,
 			(void *)(&gro_ctx),
 			(uint16_t)sizeof(struct tcp_gro_context));
+	GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
 	/* no aggregation */
 	if (GRO_CTX__SEG_NUM == 0) {
 		cdma_mutex_lock_release(tcp_gro_context_addr);
@@ -920,6 +965,7 @@ GRO_CODE_PLACEMENT int tcp_gro_flush_aggregation(
 				CDMA_POSTDMA_MUTEX_RM_BIT,
 				(void *)&gro_ctx,
 				(uint16_t)sizeof(struct tcp_gro_context));
+			GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
 			return TCP_GRO_FLUSH_TIMER_IN_PROCESS;
 		}
 
@@ -960,6 +1006,7 @@ GRO_CODE_PLACEMENT int tcp_gro_flush_aggregation(
 				CDMA_POSTDMA_MUTEX_RM_BIT,
 				(void *)&gro_ctx,
 				(uint16_t)sizeof(struct tcp_gro_context));
+		GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
 		/* Copy aggregated FD to default FD location and prepare
 		 * aggregated FD parameters in Presentation Context */
 		*((struct ldpaa_fd *)HWC_FD_ADDRESS) = gro_ctx.agg_fd;
@@ -1030,6 +1077,7 @@ GRO_CODE_PLACEMENT int tcp_gro_flush_aggregation(
 				CDMA_POSTDMA_MUTEX_RM_BIT,
 				(void *)&gro_ctx,
 				(uint16_t)sizeof(struct tcp_gro_context));
+	GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
 
 	/* update statistics */
 	ste_inc_counter(gro_ctx.stats_addr + GRO_STAT_AGG_NUM_CNTR_OFFSET
@@ -1063,6 +1111,7 @@ GRO_CODE_PLACEMENT void tcp_gro_timeout_callback(uint64_t tcp_gro_context_addr,
 			CDMA_PREDMA_MUTEX_WRITE_LOCK,
 			(void *)(&gro_ctx),
 			(uint16_t)sizeof(struct tcp_gro_context));
+	GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
 
 	/* confirm timer expiration */
 	tman_timer_completion_confirmation(gro_ctx.timer_handle);
@@ -1161,6 +1210,7 @@ GRO_CODE_PLACEMENT void tcp_gro_timeout_callback(uint64_t tcp_gro_context_addr,
 				CDMA_POSTDMA_MUTEX_RM_BIT,
 				(void *)&gro_ctx,
 				(uint16_t)sizeof(struct tcp_gro_context));
+	GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
 
 	/* update statistics */
 	ste_inc_counter(gro_ctx.stats_addr + GRO_STAT_AGG_NUM_CNTR_OFFSET
@@ -1221,3 +1271,453 @@ GRO_CODE_PLACEMENT void tcp_gro_calc_tcp_header_cksum()
 			(uint16_t)offsetof(struct tcphdr, checksum),
 			(uint16_t)(sizeof(tcp->checksum)));
 }
+
+/* Build the flow key of the presented segment */
+GRO_CODE_PLACEMENT static void gro_flow_build_key(
+		struct gro_flow_key *key,
+		uint16_t tag)
+{
+	struct ipv4hdr *ipv4;
+	struct ipv6hdr *ipv6;
+	struct tcphdr *tcp;
+	int i;
+
+	if (PARSER_IS_OUTER_IPV6_DEFAULT()) {
+		ipv6 = (struct ipv6hdr *)PARSER_GET_OUTER_IP_POINTER_DEFAULT();
+		for (i = 0; i < 4; i++) {
+			key->src_addr[i] = ipv6->src_addr[i];
+			key->dst_addr[i] = ipv6->dst_addr[i];
+		}
+		key->ipv6 = 1;
+	} else {
+		ipv4 = (struct ipv4hdr *)PARSER_GET_OUTER_IP_POINTER_DEFAULT();
+		key->src_addr[0] = ipv4->src_addr;
+		key->dst_addr[0] = ipv4->dst_addr;
+		for (i = 1; i < 4; i++) {
+			key->src_addr[i] = 0;
+			key->dst_addr[i] = 0;
+		}
+		key->ipv6 = 0;
+	}
+	tcp = (struct tcphdr *)PARSER_GET_L4_POINTER_DEFAULT();
+	key->src_port = tcp->src_port;
+	key->dst_port = tcp->dst_port;
+	key->tag = tag;
+}
+
+GRO_CODE_PLACEMENT static int gro_flow_key_equal(
+		struct gro_flow_key *key1,
+		struct gro_flow_key *key2)
+{
+	uint32_t *k1 = (uint32_t *)key1;
+	uint32_t *k2 = (uint32_t *)key2;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(struct gro_flow_key) / sizeof(uint32_t); i++)
+		if (k1[i] != k2[i])
+			return 0;
+	return 1;
+}
+
+/* Reclaim the GRO context of a flow for a new flow.
+ * Returns 0 when the context had no aggregation and was cleared, -EBUSY when
+ * the aggregation is returned by the (forced) timer expiration.
+ * A draining flow is reclaimed only when its aggregation was flushed and its
+ * timer deleted (tcp_gro_flush_aggregation()); otherwise the timer expiration
+ * releases the way. */
+GRO_CODE_PLACEMENT static int gro_flow_reclaim(uint64_t tcp_gro_context_addr,
+		int draining)
+{
+	struct tcp_gro_context gro_ctx;
+
+	cdma_read_with_mutex(tcp_gro_context_addr,
+			CDMA_PREDMA_MUTEX_WRITE_LOCK,
+			(void *)(&gro_ctx),
+			(uint16_t)sizeof(struct tcp_gro_context));
+	GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
+
+	if (draining) {
+		if ((GRO_CTX__SEG_NUM != 0) ||
+		    (gro_ctx.timer_handle != TCP_GRO_INVALID_TMAN_HANDLE)) {
+			cdma_mutex_lock_release(tcp_gro_context_addr);
+			return -EBUSY;
+		}
+	} else if (GRO_CTX__SEG_NUM != 0) {
+		/* the expired timer flushes the aggregation */
+		if (!(gro_ctx.internal_flags & GRO_AGG_TIMER_IN_PROCESS))
+			tman_delete_timer(gro_ctx.timer_handle,
+					TMAN_TIMER_DELETE_MODE_FORCE_EXP);
+		cdma_mutex_lock_release(tcp_gro_context_addr);
+		return -EBUSY;
+	}
+
+	cdma_ws_memory_init((void *)&gro_ctx,
+			(uint16_t)sizeof(struct tcp_gro_context), 0);
+	cdma_write_with_mutex(tcp_gro_context_addr,
+			CDMA_POSTDMA_MUTEX_RM_BIT,
+			(void *)&gro_ctx,
+			(uint16_t)sizeof(struct tcp_gro_context));
+	GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
+	return 0;
+}
+
+/* Find a way for a new flow in the bucket: a free way, a drained way, or the
+ * LRU among the ways which are not draining. Returns the way, or -EBUSY if
+ * the bucket has no way available */
+GRO_CODE_PLACEMENT static int gro_flow_alloc_way(
+		struct tcp_gro_flow_table *table,
+		struct gro_flow_bucket *bucket,
+		uint32_t bucket_idx)
+{
+	struct gro_flow_way *way;
+	uint16_t age, oldest = 0;
+	int i, victim = -1, draining = 0;
+	uint32_t slot;
+
+	for (i = 0; i < GRO_FLOW_WAYS; i++) {
+		way = &bucket->way[i];
+		if (way->state == GRO_FLOW_FREE)
+			return i;
+		if (way->state == GRO_FLOW_DRAINING) {
+			draining = 1;
+			continue;
+		}
+		/* idle flows are reused before the open ones */
+		age = (uint16_t)(bucket->clock - way->stamp);
+		if ((victim < 0) ||
+		    ((way->state == GRO_FLOW_IDLE) &&
+		     (bucket->way[victim].state == GRO_FLOW_OPEN)) ||
+		    ((way->state == bucket->way[victim].state) &&
+		     (age > oldest))) {
+			victim = i;
+			oldest = age;
+		}
+	}
+
+	/* an evicted flow flushed by tcp_gro_flush_aggregation() gets no
+	 * timer expiration, its way is released here */
+	for (i = 0; draining && (i < GRO_FLOW_WAYS); i++) {
+		if (bucket->way[i].state != GRO_FLOW_DRAINING)
+			continue;
+		slot = bucket_idx * GRO_FLOW_WAYS + (uint32_t)i;
+		if (!gro_flow_reclaim(table->ctx_addr +
+				(uint64_t)slot * TCP_GRO_CONTEXT_SIZE, 1)) {
+			bucket->way[i].state = GRO_FLOW_FREE;
+			return i;
+		}
+	}
+
+	if (victim < 0)
+		return -EBUSY;
+
+	slot = bucket_idx * GRO_FLOW_WAYS + (uint32_t)victim;
+	if (gro_flow_reclaim(table->ctx_addr +
+			(uint64_t)slot * TCP_GRO_CONTEXT_SIZE, 0)) {
+		bucket->way[victim].state = GRO_FLOW_DRAINING;
+		ste_inc_counter(table->stats_addr +
+				GRO_FLOW_STAT_EVICTIONS_OFFSET,
+				1, STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+		return -EBUSY;
+	}
+	return victim;
+}
+
+GRO_CODE_PLACEMENT int tcp_gro_flow_aggregate_seg(
+		struct tcp_gro_flow_table *table,
+		uint16_t tag,
+		struct tcp_gro_context_params *params,
+		uint32_t flags,
+		uint64_t *tcp_gro_context_addr)
+{
+	struct gro_flow_key key __attribute__((aligned(16)));
+	struct gro_flow_record record;
+	struct gro_flow_bucket bucket;
+	struct tcp_gro_context_params flow_params;
+	struct gro_flow_way *way;
+	uint64_t bucket_addr, record_addr;
+	uint32_t hash, bucket_idx, slot;
+	int i, status;
+
+	if (LDPAA_FD_GET_ERR(HWC_FD_ADDRESS))
+		return -EIO;
+
+	gro_flow_build_key(&key, tag);
+	keygen_gen_hash(&key, (uint8_t)sizeof(struct gro_flow_key), &hash);
+	bucket_idx = hash & table->bucket_mask;
+	bucket_addr = table->buckets_addr +
+			(uint64_t)bucket_idx * sizeof(struct gro_flow_bucket);
+
+	cdma_read_with_mutex(bucket_addr,
+			CDMA_PREDMA_MUTEX_WRITE_LOCK,
+			(void *)&bucket,
+			(uint16_t)sizeof(struct gro_flow_bucket));
+
+	/* lookup */
+	for (i = 0; i < GRO_FLOW_WAYS; i++) {
+		way = &bucket.way[i];
+		if ((way->state == GRO_FLOW_FREE) || (way->hash != hash))
+			continue;
+		slot = bucket_idx * GRO_FLOW_WAYS + (uint32_t)i;
+		cdma_read((void *)&record, table->records_addr +
+				(uint64_t)slot * sizeof(struct gro_flow_record),
+				(uint16_t)sizeof(struct gro_flow_key));
+		if (gro_flow_key_equal(&record.key, &key))
+			break;
+	}
+
+	if (i < GRO_FLOW_WAYS) {
+		ste_inc_counter(table->stats_addr + GRO_FLOW_STAT_HITS_OFFSET,
+				1, STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+	} else {
+		ste_inc_counter(table->stats_addr + GRO_FLOW_STAT_MISSES_OFFSET,
+				1, STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+		i = gro_flow_alloc_way(table, &bucket, bucket_idx);
+	}
+
+	/* no way for a new flow: the aggregation of an evicted flow is being
+	 * returned by its timer. The flow of the segment holds no segments,
+	 * return it as is */
+	if (i < 0) {
+		cdma_write_with_mutex(bucket_addr,
+				CDMA_POSTDMA_MUTEX_RM_BIT,
+				(void *)&bucket,
+				(uint16_t)sizeof(struct gro_flow_bucket));
+		ste_inc_and_acc_counters(table->stats_addr +
+				GRO_FLOW_STAT_SEG_NUM_OFFSET, 1,
+				STE_MODE_COMPOUND_32_BIT_CNTR_SIZE |
+				STE_MODE_COMPOUND_32_BIT_ACC_SIZE |
+				STE_MODE_COMPOUND_CNTR_SATURATE |
+				STE_MODE_COMPOUND_ACC_SATURATE);
+		ste_inc_counter(table->stats_addr +
+				GRO_FLOW_STAT_BYPASSED_OFFSET,
+				1, STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+		*tcp_gro_context_addr = 0;
+		return TCP_GRO_SEG_AGG_DONE;
+	}
+
+	way = &bucket.way[i];
+	slot = bucket_idx * GRO_FLOW_WAYS + (uint32_t)i;
+	record_addr = table->records_addr +
+			(uint64_t)slot * sizeof(struct gro_flow_record);
+	if (way->state == GRO_FLOW_FREE) {
+		record.key = key;
+		record.gro_timeout_cb = params->timeout_params.gro_timeout_cb;
+		record.gro_timeout_cb_arg =
+				params->timeout_params.gro_timeout_cb_arg;
+		record.table = (uint32_t)table;
+		record.slot = slot;
+		cdma_write(record_addr, (void *)&record,
+				(uint16_t)sizeof(struct gro_flow_record));
+		way->hash = hash;
+		way->state = GRO_FLOW_IDLE;
+	}
+	way->stamp = ++bucket.clock;
+
+	/* A segment of a draining flow is aggregated to the evicted
+	 * aggregation (the base GRO holds it until the timer returns the
+	 * aggregation), so the flow segments are not reordered. The timer
+	 * expiration releases the way. */
+
+	/* the flow timeouts go through the flow table */
+	flow_params = *params;
+	flow_params.timeout_params.gro_timeout_cb =
+			&tcp_gro_flow_timeout_callback;
+	flow_params.timeout_params.gro_timeout_cb_arg = record_addr;
+
+	*tcp_gro_context_addr = table->ctx_addr +
+			(uint64_t)slot * TCP_GRO_CONTEXT_SIZE;
+	status = tcp_gro_aggregate_seg(*tcp_gro_context_addr,
+			&flow_params, flags);
+
+	if ((status > 0) && (way->state != GRO_FLOW_DRAINING) &&
+	    !((status & TCP_GRO_SEG_AGG_TIMER_IN_PROCESS) ==
+			    TCP_GRO_SEG_AGG_TIMER_IN_PROCESS)) {
+		if (((status & TCP_GRO_SEG_AGG_NOT_DONE) ==
+				TCP_GRO_SEG_AGG_NOT_DONE) ||
+		    ((status & TCP_GRO_SEG_AGG_DONE_AGG_OPEN) ==
+				TCP_GRO_SEG_AGG_DONE_AGG_OPEN))
+			way->state = GRO_FLOW_OPEN;
+		else
+			way->state = GRO_FLOW_IDLE;
+	}
+
+	cdma_write_with_mutex(bucket_addr,
+			CDMA_POSTDMA_MUTEX_RM_BIT,
+			(void *)&bucket,
+			(uint16_t)sizeof(struct gro_flow_bucket));
+
+	/* update statistics: segments and returned packets */
+	if ((status > 0) &&
+	    (((status & TCP_GRO_SEG_AGG_DONE) == TCP_GRO_SEG_AGG_DONE) ||
+	     ((status & TCP_GRO_SEG_AGG_DONE_AGG_OPEN) ==
+			     TCP_GRO_SEG_AGG_DONE_AGG_OPEN)))
+		ste_inc_and_acc_counters(table->stats_addr +
+				GRO_FLOW_STAT_SEG_NUM_OFFSET, 1,
+				STE_MODE_COMPOUND_32_BIT_CNTR_SIZE |
+				STE_MODE_COMPOUND_32_BIT_ACC_SIZE |
+				STE_MODE_COMPOUND_CNTR_SATURATE |
+				STE_MODE_COMPOUND_ACC_SATURATE);
+	else
+		ste_inc_counter(table->stats_addr +
+				GRO_FLOW_STAT_SEG_NUM_OFFSET,
+				1, STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+	if ((status > 0) &&
+	    ((status & TCP_GRO_FLUSH_REQUIRED) == TCP_GRO_FLUSH_REQUIRED))
+		ste_inc_counter(table->stats_addr +
+				GRO_FLOW_STAT_PKT_NUM_OFFSET,
+				1, STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+
+	return status;
+}
+
+/* TCP GRO flow table timeout callback */
+GRO_CODE_PLACEMENT void tcp_gro_flow_timeout_callback(uint64_t record_addr)
+{
+	struct gro_flow_record record;
+	struct gro_flow_bucket bucket;
+	struct gro_flow_way *way;
+	struct tcp_gro_flow_table *table;
+	struct tcp_gro_context gro_ctx;
+	uint64_t bucket_addr, tcp_gro_context_addr;
+
+	cdma_read((void *)&record, record_addr,
+			(uint16_t)sizeof(struct gro_flow_record));
+	table = (struct tcp_gro_flow_table *)record.table;
+	bucket_addr = table->buckets_addr +
+			(uint64_t)(record.slot / GRO_FLOW_WAYS) *
+			sizeof(struct gro_flow_bucket);
+
+	cdma_read_with_mutex(bucket_addr,
+			CDMA_PREDMA_MUTEX_WRITE_LOCK,
+			(void *)&bucket,
+			(uint16_t)sizeof(struct gro_flow_bucket));
+	way = &bucket.way[record.slot % GRO_FLOW_WAYS];
+	/* an evicted flow releases its way once its aggregation is out. A
+	 * segment which arrived after the flush started a new aggregation,
+	 * the flow keeps its way. */
+	if (way->state == GRO_FLOW_DRAINING) {
+		tcp_gro_context_addr = table->ctx_addr +
+				(uint64_t)record.slot * TCP_GRO_CONTEXT_SIZE;
+		cdma_read_with_mutex(tcp_gro_context_addr,
+				CDMA_PREDMA_MUTEX_WRITE_LOCK,
+				(void *)(&gro_ctx),
+				(uint16_t)sizeof(struct tcp_gro_context));
+		GRO_CTX_DMA_ACCOUNT(sizeof(struct tcp_gro_context));
+		way->state = (GRO_CTX__SEG_NUM == 0) ? GRO_FLOW_FREE :
+				GRO_FLOW_OPEN;
+		cdma_mutex_lock_release(tcp_gro_context_addr);
+	} else if (way->state == GRO_FLOW_OPEN)
+		way->state = GRO_FLOW_IDLE;
+	cdma_write_with_mutex(bucket_addr,
+			CDMA_POSTDMA_MUTEX_RM_BIT,
+			(void *)&bucket,
+			(uint16_t)sizeof(struct gro_flow_bucket));
+
+	ste_inc_counter(table->stats_addr + GRO_FLOW_STAT_PKT_NUM_OFFSET,
+			1, STE_MODE_SATURATE | STE_MODE_32_BIT_CNTR_SIZE);
+
+	/* call user callback function */
+	record.gro_timeout_cb(record.gro_timeout_cb_arg);
+}
+
+/* Clear DDR memory of the flow table */
+GRO_CODE_PLACEMENT static void gro_flow_clear_mem(uint64_t addr, uint32_t size)
+{
+	uint8_t zero[GRO_FLOW_CLEAR_CHUNK];
+	uint32_t len;
+
+	cdma_ws_memory_init((void *)zero, GRO_FLOW_CLEAR_CHUNK, 0);
+	while (size) {
+		len = (size > GRO_FLOW_CLEAR_CHUNK) ? GRO_FLOW_CLEAR_CHUNK :
+				size;
+		cdma_write(addr, (void *)zero, (uint16_t)len);
+		addr += len;
+		size -= len;
+	}
+}
+
+GRO_CODE_PLACEMENT int tcp_gro_flow_table_init(
+		struct tcp_gro_flow_table *table,
+		uint32_t max_flows,
+		int mem_pid)
+{
+	uint32_t buckets = 1, flows;
+	int err;
+
+	if ((max_flows == 0) || (max_flows > 0x100000))
+		return -EINVAL;
+	while (buckets * GRO_FLOW_WAYS < max_flows)
+		buckets <<= 1;
+	flows = buckets * GRO_FLOW_WAYS;
+
+	table->buckets_addr = 0;
+	table->ctx_addr = 0;
+	table->records_addr = 0;
+	table->stats_addr = 0;
+	table->bucket_mask = buckets - 1;
+
+	err = fsl_get_mem(buckets * sizeof(struct gro_flow_bucket), mem_pid,
+			GRO_FLOW_MEM_ALIGN, &table->buckets_addr);
+	if (!err)
+		err = fsl_get_mem(flows * TCP_GRO_CONTEXT_SIZE, mem_pid,
+				GRO_FLOW_MEM_ALIGN, &table->ctx_addr);
+	if (!err)
+		err = fsl_get_mem(flows * sizeof(struct gro_flow_record),
+				mem_pid, GRO_FLOW_MEM_ALIGN,
+				&table->records_addr);
+	if (!err)
+		err = fsl_get_mem(GRO_FLOW_STATS_SIZE, mem_pid,
+				GRO_FLOW_MEM_ALIGN, &table->stats_addr);
+	if (err) {
+		tcp_gro_flow_table_free(table);
+		return -ENOMEM;
+	}
+
+	gro_flow_clear_mem(table->buckets_addr,
+			buckets * sizeof(struct gro_flow_bucket));
+	gro_flow_clear_mem(table->ctx_addr, flows * TCP_GRO_CONTEXT_SIZE);
+	gro_flow_clear_mem(table->stats_addr, GRO_FLOW_STATS_SIZE);
+	return 0;
+}
+
+GRO_CODE_PLACEMENT void tcp_gro_flow_table_free(
+		struct tcp_gro_flow_table *table)
+{
+	if (table->buckets_addr)
+		fsl_put_mem(table->buckets_addr);
+	if (table->ctx_addr)
+		fsl_put_mem(table->ctx_addr);
+	if (table->records_addr)
+		fsl_put_mem(table->records_addr);
+	if (table->stats_addr)
+		fsl_put_mem(table->stats_addr);
+	table->buckets_addr = 0;
+	table->ctx_addr = 0;
+	table->records_addr = 0;
+	table->stats_addr = 0;
+}
+
+GRO_CODE_PLACEMENT void tcp_gro_flow_table_get_stats(
+		struct tcp_gro_flow_table *table,
+		struct tcp_gro_flow_stats *stats)
+{
+	ste_barrier();
+	cdma_read((void *)stats, table->stats_addr,
+			(uint16_t)offsetof(struct tcp_gro_flow_stats,
+					agg_ratio));
+	stats->agg_ratio = stats->pkt_num ?
+		(uint32_t)(((uint64_t)stats->seg_num * 100) / stats->pkt_num) :
+		0;
+}
+
+#ifdef GRO_CTX_DMA_STATS
+GRO_CODE_PLACEMENT uint64_t tcp_gro_get_ctx_dma_bytes(void)
+{
+	uint64_t bytes = 0;
+	int i;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++)
+		bytes += g_gro_ctx_dma_bytes[i];
+	return bytes;
+}
+#endif
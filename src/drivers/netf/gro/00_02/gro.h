@@ -44,6 +44,11 @@
 
 #define GRO_NO_METADATA
 
+/* Flow contexts per flow table bucket */
+#define GRO_FLOW_WAYS		4
+/* Flow table bucket size (one CDMA access) */
+#define GRO_FLOW_BUCKET_SIZE	64
+
 /**************************************************************************//**
 @Group		AIOP_TCP_GRO_INTERNAL AIOP TCP GRO Internal
 
@@ -85,14 +90,55 @@ struct tcp_gro_last_seg_header_fields {
  * Modify the fixed size
  * OR
  * Remove unneeded fields (e.g. the metadata structure takes 4 bytes for
- * alignment only). */
-
+ * alignment only).
+ *
+ * The context is split in a segment part (the first GRO_CTX_SEG_SIZE bytes)
+ * and an aggregation part. The segment part holds the fields which are
+ * checked or updated by each aggregated segment and it is the only part
+ * which is transferred for a segment added to an open aggregation. The
+ * aggregation part is set when an aggregation is opened and used when it is
+ * closed. */
 struct tcp_gro_context {
 		/** Aggregated packet FD.
 		 * This field must remain at the beginning of the structure due
 		 * to alignment restrictions for FD in workspace (The FD adress
 		 * in Workspace must be aligned to 32 bytes). */
 	struct ldpaa_fd agg_fd;
+		/** Address (in HW buffers) of the TCP GRO statistics counters
+		 *  (\ref tcp_gro_stats_cntrs).
+		 *  The user should zero the statistics once it is allocated. */
+	uint64_t stats_addr;
+		/** Last Segment header fields which we need to update in the
+		 * aggregated packet. */
+	struct tcp_gro_last_seg_header_fields last_seg_fields;
+		/** Next expected sequence number. */
+	uint32_t next_seq;
+		/** Aggregated packet timestamp value. */
+	uint32_t timestamp;
+		/** TCP GRO aggregation flags */
+	uint32_t flags;
+		/** TMAN Instance ID. */
+	uint32_t timer_handle;
+#ifdef GRO_NO_METADATA
+		/** Number of segments in the aggregation. */
+	uint16_t seg_num;
+#endif
+		/** Internal TCP GRO flags */
+	uint16_t internal_flags;
+		/** Maximum aggregated packet size limit (The size refers to the
+		 * packet headers + payload).
+		 * A single segment size cannot oversize this limit. */
+	uint16_t packet_size_limit;
+		/** Maximum aggregated segments per packet limit.
+		 * 0/1 are an illegal values. */
+	uint8_t	seg_num_limit;
+		/* padding of the segment part */
+#ifdef GRO_NO_METADATA
+	uint8_t seg_pad[1];
+#else
+	uint8_t seg_pad[3];
+#endif
+	/* End of the segment part */
 #ifndef GRO_NO_METADATA
 		/** Address (in HW buffers) of the TCP GRO aggregation metadata
 		 * buffer (\ref tcp_gro_context_metadata)
@@ -104,63 +150,34 @@ struct tcp_gro_context {
 		 * metadata buffer.
 		 * */
 	uint64_t metadata_addr;
+		/** Aggregated packet metadata  */
+	struct tcp_gro_context_metadata metadata;
 #endif
-		/** Address (in HW buffers) of the TCP GRO statistics counters
-		 *  (\ref tcp_gro_stats_cntrs).
-		 *  The user should zero the statistics once it is allocated. */
-	uint64_t stats_addr;
 		/** Address (in HW buffers) of the callback function parameter
 		 * argument on timeout.
 		 * On timeout, GRO will call upper layer callback function with
 		 * this parameter. */
 	uint64_t gro_timeout_cb_arg;
-#ifndef GRO_NO_METADATA
-		/** Aggregated packet metadata  */
-	struct tcp_gro_context_metadata metadata;
-#else
-		/** Number of segments in the aggregation. */
-	uint16_t seg_num;
-#endif
-		/** Last Segment header fields which we need to update in the
-		 * aggregated packet. */
-	struct tcp_gro_last_seg_header_fields last_seg_fields;
 		/** Function to call upon Time Out occurrence.
 			 * This function takes one argument. */
 	gro_timeout_cb_t *gro_timeout_cb;
-		/** Aggregated packet timestamp value. */
-	uint32_t timestamp;
-		/** Next expected sequence number. */
-	uint32_t next_seq;
-		/** TCP GRO aggregation flags */
-	uint32_t flags;
-		/** TMAN Instance ID. */
-	uint32_t timer_handle;
-		/** Internal TCP GRO flags */
-	uint16_t internal_flags;
 		/** First segment presentation size */
 	uint16_t prc_segment_length;
 		/** First segment presentation offset */
 	uint16_t prc_segment_offset;
 		/** First segment presentation address */
 	uint16_t prc_segment_addr;
-	/** Maximum aggregated packet size limit (The size refers to the
-		 * packet headers + payload).
-		 * A single segment size cannot oversize this limit. */
-	uint16_t packet_size_limit;
 		/* Network Interface ID */
 	uint16_t	niid;
 		/** Queueing Destination Priority */
 	uint8_t qd_priority;
-		/** Maximum aggregated segments per packet limit.
-		 * 0/1 are an illegal values. */
-	uint8_t	seg_num_limit;
 		/** Storage profile ID */
 	uint8_t spid;
 		/* padding*/
 #ifndef GRO_NO_METADATA
-	uint8_t pad[13];
+	uint8_t pad[10];
 #else
-	uint8_t pad[31];
+	uint8_t pad[34];
 #endif
 };
 
@@ -226,6 +243,80 @@ struct tcphdr_gro_opt {
 };
 #pragma pack(pop)
 
+/**************************************************************************//**
+@Description	TCP GRO Flow Table Way.
+
+		One flow context slot of a flow table bucket.
+*//***************************************************************************/
+struct gro_flow_way {
+		/** Hash of the flow key (\ref gro_flow_key). */
+	uint32_t hash;
+		/** Bucket clock value of the last access (LRU). */
+	uint16_t stamp;
+		/** Flow state \ref TCP_GRO_FLOW_STATES. */
+	uint8_t state;
+		/* padding */
+	uint8_t pad;
+};
+
+/**************************************************************************//**
+@Description	TCP GRO Flow Table Bucket.
+
+		The bucket is protected by a CDMA mutex on its address. The
+		mutex is held across the aggregation of the segment, so that
+		the flow context of a way is not reclaimed while it is in use.
+*//***************************************************************************/
+struct gro_flow_bucket {
+		/** Flow context slots. */
+	struct gro_flow_way way[GRO_FLOW_WAYS];
+		/** Bucket access clock. */
+	uint16_t clock;
+		/* padding */
+	uint8_t pad[GRO_FLOW_BUCKET_SIZE - 2 -
+		    GRO_FLOW_WAYS * sizeof(struct gro_flow_way)];
+};
+
+/**************************************************************************//**
+@Description	TCP GRO Flow Key.
+
+		The key is hashed by keygen, it must be located in the
+		workspace at a 16 bytes aligned address.
+*//***************************************************************************/
+struct gro_flow_key {
+		/** Source IP address (IPv4 address in the first word). */
+	uint32_t src_addr[4];
+		/** Destination IP address (IPv4 address in the first word). */
+	uint32_t dst_addr[4];
+		/** TCP source port. */
+	uint16_t src_port;
+		/** TCP destination port. */
+	uint16_t dst_port;
+		/** User tag of the flow (e.g. interface). */
+	uint16_t tag;
+		/** Set for IPv6 flows. */
+	uint16_t ipv6;
+};
+
+/**************************************************************************//**
+@Description	TCP GRO Flow Record.
+
+		Kept per flow context slot, next to the table GRO contexts.
+*//***************************************************************************/
+struct gro_flow_record {
+		/** Flow key. */
+	struct gro_flow_key key;
+		/** User callback function on timeout. */
+	gro_timeout_cb_t *gro_timeout_cb;
+		/** Flow table (\ref tcp_gro_flow_table) of the slot. */
+	uint32_t table;
+		/** User callback function argument on timeout. */
+	uint64_t gro_timeout_cb_arg;
+		/** Slot index in the flow table. */
+	uint32_t slot;
+		/* padding */
+	uint8_t pad[4];
+};
+
 /** @} */ /* end of TCP_GRO_INTERNAL_STRUCTS */
 
 
@@ -254,6 +345,18 @@ ASSERT_STRUCT_SIZE(SIZEOF_GRO_CONTEXT, TCP_GRO_CONTEXT_SIZE);
 #pragma warning_errors off
 #endif
 
+#ifdef GRO_NO_METADATA
+	/** Size of the GRO Context part transferred per aggregated segment.
+	 * With metadata the segment count is in the aggregation part, the
+	 * entire context is transferred. */
+#define GRO_CTX_SEG_SIZE	offsetof(struct tcp_gro_context, \
+					 gro_timeout_cb_arg)
+#else
+#define GRO_CTX_SEG_SIZE	SIZEOF_GRO_CONTEXT
+#endif
+	/** Size of the GRO Context aggregation part. */
+#define GRO_CTX_AGG_SIZE	(SIZEOF_GRO_CONTEXT - GRO_CTX_SEG_SIZE)
+
 /** @} */ /* end of TCP_GRO_GENERAL_INT_DEFINITIONS */
 
 
@@ -400,6 +503,65 @@ ASSERT_STRUCT_SIZE(SIZEOF_GRO_CONTEXT, TCP_GRO_CONTEXT_SIZE);
 
 /** @} */ /* end of TCP_GRO_AGGREGATE_DEFINITIONS */
 
+/**************************************************************************//**
+ @Group	TCP_GRO_FLOW_DEFINITIONS TCP GRO Flow Table Definitions
+
+ @Description TCP GRO Flow Table Definitions.
+
+ @{
+*//***************************************************************************/
+
+	/* hits counter offset in flow table statistics */
+#define GRO_FLOW_STAT_HITS_OFFSET					\
+	offsetof(struct tcp_gro_flow_stats, hits)
+	/* misses counter offset in flow table statistics */
+#define GRO_FLOW_STAT_MISSES_OFFSET					\
+	offsetof(struct tcp_gro_flow_stats, misses)
+	/* evictions counter offset in flow table statistics */
+#define GRO_FLOW_STAT_EVICTIONS_OFFSET					\
+	offsetof(struct tcp_gro_flow_stats, evictions)
+	/* bypassed counter offset in flow table statistics */
+#define GRO_FLOW_STAT_BYPASSED_OFFSET					\
+	offsetof(struct tcp_gro_flow_stats, bypassed)
+	/* seg_num counter offset in flow table statistics */
+#define GRO_FLOW_STAT_SEG_NUM_OFFSET					\
+	offsetof(struct tcp_gro_flow_stats, seg_num)
+	/* pkt_num counter offset in flow table statistics */
+#define GRO_FLOW_STAT_PKT_NUM_OFFSET					\
+	offsetof(struct tcp_gro_flow_stats, pkt_num)
+	/* Size of the statistics counters block in DDR */
+#define GRO_FLOW_STATS_SIZE		32
+	/* Chunk used to clear the flow table memory */
+#define GRO_FLOW_CLEAR_CHUNK		256
+	/* Flow table memory alignment */
+#define GRO_FLOW_MEM_ALIGN		64
+
+/** @} */ /* end of TCP_GRO_FLOW_DEFINITIONS */
+
+/**************************************************************************//**
+ @Group	TCP_GRO_FLOW_STATES TCP GRO Flow States
+
+ @Description State of a flow table way.
+
+ @{
+*//***************************************************************************/
+
+	/** The way is not used. */
+#define GRO_FLOW_FREE			0
+	/** The flow has no open aggregation. */
+#define GRO_FLOW_IDLE			1
+	/** The flow may have an open aggregation (a timer is armed). */
+#define GRO_FLOW_OPEN			2
+	/** The flow was evicted; its aggregation is flushed by the forced
+	 * timer expiration, after which the way is free. Segments of the flow
+	 * are aggregated meanwhile; if one starts a new aggregation, the flow
+	 * keeps the way (open). A way whose
+	 * aggregation was flushed by tcp_gro_flush_aggregation() is freed by
+	 * the next allocation in the bucket. */
+#define GRO_FLOW_DRAINING		3
+
+/** @} */ /* end of TCP_GRO_FLOW_STATES */
+
 
 /** @} */ /* end of TCP_GRO_AGGREGATE_INTERNAL_STATUS */
 
@@ -502,6 +664,22 @@ void tcp_gro_timeout_callback(
 *//***************************************************************************/
 void tcp_gro_calc_tcp_header_cksum();
 
+/**************************************************************************//**
+@Function	tcp_gro_flow_timeout_callback
+
+@Description	TCP GRO timeout callback of the flows of a flow table.
+		It updates the way state of the flow and calls the user
+		callback function.
+
+@Param[in]	record_addr - Address (in HW buffers) of the flow record
+		(\ref gro_flow_record).
+
+@Return		None.
+
+@Cautions	None.
+*//***************************************************************************/
+void tcp_gro_flow_timeout_callback(uint64_t record_addr);
+
 /** @} */ /* end of TCP_GRO_INTERNAL_FUNCTIONS */
 
 
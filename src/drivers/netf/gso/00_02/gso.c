@@ -44,6 +44,101 @@
 
 extern __TASK struct aiop_default_task_params default_task_params;
 
+/* Data offset/reserved and flags of the TCP header, as one 16 bit word */
+static inline uint16_t tcp_gso_flags_word(struct tcphdr *tcp_ptr)
+{
+	return *((uint16_t *)&tcp_ptr->data_offset_reserved);
+}
+
+static inline uint16_t tcp_gso_cksum_fold(uint32_t sum)
+{
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+static inline uint32_t tcp_gso_cksum_add(uint16_t *words, uint32_t num,
+					uint32_t sum)
+{
+	while (num--)
+		sum += *words++;
+	return sum;
+}
+
+GSO_CODE_PLACEMENT static void tcp_gso_build_hdr_template(
+		struct tcp_gso_context *gso_ctx,
+		struct tcp_gso_hdr_template *tmpl)
+{
+	struct ipv4hdr *ipv4_ptr;
+	struct ipv6hdr *ipv6_ptr;
+	struct tcphdr *tcp_ptr;
+	uint32_t sum;
+
+	ipv4_ptr = (struct ipv4hdr *)(
+			gso_ctx->ip_offset + PRC_GET_SEGMENT_ADDRESS());
+	ipv6_ptr = (struct ipv6hdr *)(
+			gso_ctx->ip_offset + PRC_GET_SEGMENT_ADDRESS());
+	tcp_ptr = (struct tcphdr *)(
+			gso_ctx->tcp_offset + PRC_GET_SEGMENT_ADDRESS());
+
+	/* TCP header, without the fields stamped per segment */
+	sum = tcp_gso_cksum_add((uint16_t *)tcp_ptr,
+			(uint32_t)(gso_ctx->headers_size -
+					gso_ctx->tcp_offset) >> 1,
+			TCP_GSO_PSEUDO_HDR_PROTOCOL);
+	sum += (uint16_t)~(tcp_ptr->sequence_number >> 16);
+	sum += (uint16_t)~tcp_ptr->sequence_number;
+	sum += (uint16_t)~tcp_gso_flags_word(tcp_ptr);
+	sum += (uint16_t)~tcp_ptr->checksum;
+	sum += (uint16_t)~tcp_ptr->urgent_pointer;
+
+	if (gso_ctx->ipv4) {
+		/* Pseudo header addresses */
+		sum = tcp_gso_cksum_add((uint16_t *)&ipv4_ptr->src_addr, 4,
+					sum);
+		/* IPv4 header, without the fields stamped per segment */
+		tmpl->ipv4_sum = tcp_gso_cksum_add((uint16_t *)ipv4_ptr,
+			(uint32_t)(ipv4_ptr->vsn_and_ihl &
+					IPV4_HDR_IHL_MASK) << 1, 0);
+		tmpl->ipv4_sum += (uint16_t)~ipv4_ptr->total_length;
+		tmpl->ipv4_sum += (uint16_t)~ipv4_ptr->id;
+		tmpl->ipv4_sum += (uint16_t)~ipv4_ptr->hdr_cksum;
+	} else {
+		/* Pseudo header addresses */
+		sum = tcp_gso_cksum_add((uint16_t *)ipv6_ptr->src_addr, 16,
+					sum);
+		tmpl->ipv4_sum = 0;
+	}
+
+	tmpl->tcp_sum = sum;
+}
+
+GSO_CODE_PLACEMENT static void tcp_gso_stamp_checksums(
+		struct tcp_gso_context *gso_ctx,
+		struct tcp_gso_hdr_template *tmpl,
+		struct ipv4hdr *ipv4_ptr,
+		struct tcphdr *tcp_ptr)
+{
+	uint32_t sum;
+	uint16_t payload_sum;
+
+	fdma_calculate_default_frame_checksum(gso_ctx->headers_size, 0xFFFF,
+			&payload_sum);
+
+	sum = tmpl->tcp_sum + payload_sum +
+		(tcp_ptr->sequence_number >> 16) +
+		(tcp_ptr->sequence_number & 0xFFFF) +
+		tcp_gso_flags_word(tcp_ptr) + tcp_ptr->urgent_pointer +
+		/* Pseudo header TCP length */
+		(LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS) - gso_ctx->tcp_offset);
+	tcp_ptr->checksum = (uint16_t)~tcp_gso_cksum_fold(sum);
+
+	if (gso_ctx->ipv4)
+		ipv4_ptr->hdr_cksum = (uint16_t)~tcp_gso_cksum_fold(
+				tmpl->ipv4_sum + ipv4_ptr->total_length +
+				ipv4_ptr->id);
+}
+
 GSO_CODE_PLACEMENT int tcp_gso_generate_seg(
 		tcp_gso_ctx_t tcp_gso_context_addr)
 {
@@ -69,7 +164,7 @@ GSO_CODE_PLACEMENT int tcp_gso_generate_seg(
 		PRC_SET_SEGMENT_OFFSET(gso_ctx->seg_offset);
 
 		/* Call to tcp_gso_split_segment */
-		return tcp_gso_split_segment(gso_ctx);
+		return tcp_gso_split_segment(gso_ctx, NULL);
 	}
 
 	/* save ip_offset */
@@ -139,10 +234,11 @@ GSO_CODE_PLACEMENT int tcp_gso_generate_seg(
 		(FD.err != 0).*/
 
 	/* Call to tcp_gso_split_segment */
-	return tcp_gso_split_segment(gso_ctx);
+	return tcp_gso_split_segment(gso_ctx, NULL);
 }
 
-GSO_CODE_PLACEMENT int32_t tcp_gso_split_segment(struct tcp_gso_context *gso_ctx)
+GSO_CODE_PLACEMENT int32_t tcp_gso_split_segment(struct tcp_gso_context *gso_ctx,
+		struct tcp_gso_hdr_template *tmpl)
 {
 	int32_t	status, sr_status, split_sr_status;
 	uint16_t updated_ipv4_outer_total_length, l3checksum, ip_header_length;
@@ -320,6 +416,16 @@ GSO_CODE_PLACEMENT int32_t tcp_gso_split_segment(struct tcp_gso_context *gso_ctx
 			outer_ipv4_ptr->id = (uint16_t)fsl_rand();
 		}
 
+	if (tmpl) {
+		/* Update checksums from the header template, no parser run */
+		tcp_gso_stamp_checksums(gso_ctx, tmpl, outer_ipv4_ptr,
+					tcp_ptr);
+		/* Modify default segment (headers + checksums) */
+		fdma_modify_default_segment_data((uint16_t)outer_ip_offset,
+			(uint16_t)(gso_ctx->headers_size - outer_ip_offset));
+		return status;
+	}
+
 	/* Modify default segment */
 	fdma_modify_default_segment_data((uint16_t)outer_ip_offset,
 			(uint16_t)(gso_ctx->headers_size - outer_ip_offset));
@@ -366,6 +472,72 @@ GSO_CODE_PLACEMENT int32_t tcp_gso_split_segment(struct tcp_gso_context *gso_ctx
 	return status; /* Todo - return valid status*/
 	}
 
+GSO_CODE_PLACEMENT int tcp_gso_segment_and_enqueue(
+		tcp_gso_ctx_t tcp_gso_context_addr,
+		uint32_t flags,
+		struct tcp_gso_enqueue_params *enqueue_params,
+		struct tcp_gso_enqueue_stats *stats)
+{
+	struct tcp_gso_context *gso_ctx =
+			(struct tcp_gso_context *)tcp_gso_context_addr;
+	struct fdma_queueing_destination_params qdp;
+	struct tcp_gso_hdr_template tmpl;
+	uint32_t seg_length;
+	int32_t status;
+	int err;
+
+	stats->segments = 0;
+	stats->bytes = 0;
+
+	/* First segment, parser results of the source packet are used */
+	status = tcp_gso_generate_seg(tcp_gso_context_addr);
+	if (status == (-ENOMEM))
+		fdma_discard_default_frame(FDMA_DIS_NO_FLAGS);
+	if ((status < 0) || (status == TCP_GSO_GEN_SEG_STATUS_SYN_RST_SET))
+		return status;
+
+	/* The headers of the first segment are the template of the others */
+	if (status == TCP_GSO_GEN_SEG_STATUS_IN_PROCESS)
+		tcp_gso_build_hdr_template(gso_ctx, &tmpl);
+
+	qdp.qd = enqueue_params->qd;
+	qdp.qdbin = enqueue_params->qdbin;
+	qdp.qd_priority = enqueue_params->qd_priority;
+
+	while (1) {
+		seg_length = LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS);
+
+		if (flags & TCP_GSO_ENQUEUE_FQID)
+			err = fdma_store_and_enqueue_default_frame_fqid(
+					enqueue_params->fqid,
+					FDMA_ENWF_NO_FLAGS);
+		else
+			err = fdma_store_and_enqueue_default_frame_qd(&qdp,
+					FDMA_ENWF_NO_FLAGS);
+		if (err) {
+			if (err == -ENOMEM)
+				fdma_discard_default_frame(FDMA_DIS_NO_FLAGS);
+			else /* (err == -EBUSY) */
+				fdma_discard_fd(
+					(struct ldpaa_fd *)HWC_FD_ADDRESS,
+					0, FDMA_DIS_AS_BIT);
+			if (status == TCP_GSO_GEN_SEG_STATUS_IN_PROCESS)
+				fdma_discard_frame(gso_ctx->rem_frame_handle,
+						FDMA_DIS_NO_FLAGS);
+			return err;
+		}
+		stats->segments++;
+		stats->bytes += seg_length;
+
+		if (status != TCP_GSO_GEN_SEG_STATUS_IN_PROCESS)
+			return TCP_GSO_GEN_SEG_STATUS_DONE;
+
+		/* Task defaults and PRC were not changed since the previous
+		 * segment, no need to restore them */
+		status = tcp_gso_split_segment(gso_ctx, &tmpl);
+	}
+}
+
 int tcp_gso_discard_frame_remainder(
 		tcp_gso_ctx_t tcp_gso_context_addr)
 {
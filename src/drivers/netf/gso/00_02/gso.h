@@ -100,6 +100,19 @@ struct tcp_gso_context {
 	uint8_t	pad[2];
 };
 
+/**************************************************************************//**
+@Description	TCP GSO header template, built once per packet by
+		tcp_gso_segment_and_enqueue().
+*//***************************************************************************/
+struct tcp_gso_hdr_template {
+	/** Unfolded one's complement sum of the TCP header and pseudo header
+	 * fields which are the same in all the segments. */
+	uint32_t tcp_sum;
+	/** Unfolded one's complement sum of the IPv4 header fields which are
+	 * the same in all the segments. */
+	uint32_t ipv4_sum;
+};
+
 /** @} */ /* end of TCP_GSO_INTERNAL_STRUCTS */
 
 
@@ -156,6 +169,8 @@ ASSERT_STRUCT_SIZE(SIZEOF_GSO_CONTEXT, TCP_GSO_CONTEXT_SIZE);
 	/** Size of modification in IP header of the source frame in the first
 	 * iteration. */
 #define TCP_GSO_IP_MODIFICATION_SIZE	12
+	/** Protocol field of the TCP pseudo header. */
+#define TCP_GSO_PSEUDO_HDR_PROTOCOL	6
 
 
 /** @} */ /* end of TCP_GSO_INTERNAL_DEFINITIONS */
@@ -197,13 +212,17 @@ int32_t tcp_gso_return_frame_remainder_as_default_frame(
 		structure.
 
 @Param[in]	tcp_gso_context_addr - Address to the TCP GSO internal context.
+@Param[in]	tmpl - Header template. When NULL, the checksums of the
+		segment are generated by the parser. Otherwise they are updated
+		from the template and the parser is not run.
 
 @Return		Status of the operation (\ref FDMA_DISCARD_FRAME_ERRORS).
 
-@Cautions	None.
+@Cautions	tmpl must be NULL for the first segment.
 *//***************************************************************************/
 int32_t tcp_gso_split_segment(
-		struct tcp_gso_context *gso_ctx);
+		struct tcp_gso_context *gso_ctx,
+		struct tcp_gso_hdr_template *tmpl);
 
 /** @} */ /* end of TCP_GSO_INTERNAL_FUNCTIONS */
 
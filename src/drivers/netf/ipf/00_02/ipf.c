@@ -36,6 +36,7 @@
 #include "fsl_cdma.h"
 #include "fsl_ldpaa.h"
 #include "fsl_checksum.h"
+#include "osm_inline.h"
 #include "ipf.h"
 #include "net.h"
 #include "fsl_stdlib.h"
@@ -143,7 +144,8 @@ IPF_CODE_PLACEMENT void ipf_after_split_ipv4_fragment(struct ipf_context *ipf_ct
 	ipv4_hdr->flags_and_offset = flags_and_offset;
 
 	/* Run parser */
-	parse_result_generate_default(PARSER_NO_FLAGS);
+	if (!(ipf_ctx->flags & IPF_ENQUEUE_BURST))
+		parse_result_generate_default(PARSER_NO_FLAGS);
 
 	/* Modify 12 first header fields in FDMA */
 	fdma_modify_default_segment_data(ipv4_offset, 12);
@@ -312,7 +314,8 @@ IPF_CODE_PLACEMENT void ipf_after_split_ipv6_fragment(struct ipf_context *ipf_ct
 		}
 	}
 	/* Run parser */
-	parse_result_generate_default(PARSER_NO_FLAGS);
+	if (!(ipf_ctx->flags & IPF_ENQUEUE_BURST))
+		parse_result_generate_default(PARSER_NO_FLAGS);
 
 	present_segment_params.flags = FDMA_PRES_NO_FLAGS;
 	present_segment_params.frame_handle = ipf_ctx->rem_frame_handle;
@@ -389,7 +392,8 @@ IPF_CODE_PLACEMENT int ipf_ipv4_last_frag(struct ipf_context *ipf_ctx)
 	ipv4_hdr->total_length = ip_total_length;
 
 	/* Run parser */
-	parse_result_generate_default(PARSER_NO_FLAGS);
+	if (!(ipf_ctx->flags & IPF_ENQUEUE_BURST))
+		parse_result_generate_default(PARSER_NO_FLAGS);
 
 	/* Modify 12 first header fields in FDMA */
 	fdma_modify_default_segment_data((uint16_t)ipv4_offset, 12);
@@ -504,7 +508,8 @@ IPF_CODE_PLACEMENT int ipf_ipv6_last_frag(struct ipf_context *ipf_ctx)
 			LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS) -
 			ipv6_offset - sizeof(struct ipv6hdr) - ipf_ctx->prc_seg_offset;
 	/* Run parser */
-	parse_result_generate_default(PARSER_NO_FLAGS);
+	if (!(ipf_ctx->flags & IPF_ENQUEUE_BURST))
+		parse_result_generate_default(PARSER_NO_FLAGS);
 
 	/* Modify header fields in FDMA */
 	modify_size = (uint16_t)(ipf_ctx->ipv6_frag_hdr_offset) +
@@ -749,6 +754,77 @@ IPF_CODE_PLACEMENT int ipf_generate_frag(ipf_ctx_t ipf_context_addr)
 	}
 }
 
+IPF_CODE_PLACEMENT int ipf_fragment_and_enqueue(ipf_ctx_t ipf_context_addr,
+		uint32_t flags, struct ipf_enqueue_params *enqueue_params)
+{
+	struct ipf_context *ipf_ctx = (struct ipf_context *)ipf_context_addr;
+	struct parse_result *pr = (struct parse_result *)HWC_PARSE_RES_ADDRESS;
+	struct fdma_queueing_destination_params qdp;
+	struct scope_status_params scope_status;
+	int status, err, frag_count;
+
+	ipf_ctx->flags |= IPF_ENQUEUE_BURST;
+
+	/* First fragment: builds the header template */
+	status = ipf_generate_frag(ipf_context_addr);
+	if (status < 0)
+		return status;
+	if (status == IPF_GEN_FRAG_STATUS_DF_SET)
+		return 0;
+
+	qdp.qd = enqueue_params->qd;
+	qdp.qdbin = enqueue_params->qdbin;
+	qdp.qd_priority = enqueue_params->qd_priority;
+	frag_count = 0;
+
+	while (1) {
+		/* transition to exclusive just before last fragment enqueue */
+		if ((status == IPF_GEN_FRAG_STATUS_DONE) &&
+				(flags & IPF_ENQUEUE_EXCLUSIVE_LAST)) {
+			osm_get_scope(&scope_status);
+			if (scope_status.scope_mode == CONCURRENT)
+				osm_scope_transition_to_exclusive_with_increment_scope_id();
+		}
+
+		if (flags & IPF_ENQUEUE_FQID)
+			err = fdma_store_and_enqueue_default_frame_fqid(
+					enqueue_params->fqid,
+					FDMA_ENWF_NO_FLAGS);
+		else
+			err = fdma_store_and_enqueue_default_frame_qd(&qdp,
+					FDMA_ENWF_NO_FLAGS);
+		if (err) {
+			if (err == -ENOMEM)
+				fdma_discard_default_frame(FDMA_DIS_NO_FLAGS);
+			else /* (err == -EBUSY) */
+				fdma_discard_fd(
+					(struct ldpaa_fd *)HWC_FD_ADDRESS,
+					0, FDMA_DIS_AS_BIT);
+			if (status == IPF_GEN_FRAG_STATUS_IN_PROCESS)
+				ipf_discard_frame_remainder(ipf_context_addr);
+			return err;
+		}
+		frag_count++;
+
+		if (status != IPF_GEN_FRAG_STATUS_IN_PROCESS)
+			return frag_count;
+
+		/* Next fragment. Task defaults and PRC were not changed since
+		 * the previous one, no need to restore them. The header at
+		 * the head of the remaining frame is stamped in place. */
+		pr->gross_running_sum = 0;
+		if (ipf_ctx->ipv4)
+			status = ipf_split_ipv4_fragment(ipf_ctx);
+		else
+			status = ipf_split_ipv6_fragment(ipf_ctx, 0);
+		if (status < 0) {
+			/* Last fragment cannot be stored */
+			ipf_discard_frame_remainder(ipf_context_addr);
+			return status;
+		}
+	}
+}
+
 int ipf_discard_frame_remainder(ipf_ctx_t ipf_context_addr)
 {
 	struct ipf_context *ipf_ctx = (struct ipf_context *)ipf_context_addr;
@@ -123,6 +123,10 @@ struct ipf_context {
 /** Fragmentation of fragment indication. */
 #define	FRAGMENTATION_OF_FRAG	0x80000000
 
+/** Fragments are enqueued by ipf_fragment_and_enqueue(), the parser is not
+ * run on them. */
+#define	IPF_ENQUEUE_BURST	0x40000000
+
 #pragma warning_errors on
 /** IPF internal struct size assertion check. */
 ASSERT_STRUCT_SIZE(SIZEOF_IPF_CONTEXT, IPF_CONTEXT_SIZE);
@@ -70,31 +70,26 @@ extern __TASK struct aiop_default_task_params default_task_params;
 static enum memory_partition_id g_mem_pid = MEM_PART_SYSTEM_DDR;
 
 #ifdef USE_IPR_SW_TABLE
-static IPR_CODE_PLACEMENT int sw_table_key_delete(uint32_t table_id,
-						  uint32_t line, uint8_t pos,
-						  uint8_t lock_with_OSM_enter)
+static inline struct sw_table_bin *sw_table_bin_get(uint32_t table_id,
+						    uint32_t line)
 {
-	struct sw_table_entry keys[FRAGS_PER_BIN] __attribute__((aligned(16)));
-	uint64_t *sw_tbl;
-	int status;
-
-	sw_tbl = (uint64_t *)(table_id + line * IPR_MEM_ALIGN);
+	return (struct sw_table_bin *)(table_id + line * IPR_MEM_ALIGN);
+}
 
-	/* get exclusive access to the line in IPR_SW_TABLE.
-	   We use virtual addresses for scope_id since they are unique */
-	if (lock_with_OSM_enter)
-		osm_scope_enter(OSM_SCOPE_ENTER_CHILD_TO_EXCLUSIVE,
-				(uint32_t)sw_tbl);
-	else
-		osm_scope_transition_to_exclusive_with_new_scope_id(
-							(uint32_t)sw_tbl);
+static IPR_CODE_PLACEMENT int sw_table_entry_clear(struct sw_table_bin *sw_tbl,
+						   uint32_t pos,
+						   uint16_t line_size)
+{
+	struct sw_table_entry keys[IPR_SW_TABLE_MAX_WAYS]
+					__attribute__((aligned(16)));
+	int status;
 
-	if (*sw_tbl == 0)
+	if (sw_tbl->line == 0)
 		/* the line is not allocated */
 		return -EIO;
 
 	/* get the line */
-	cdma_read(keys, *sw_tbl, sizeof(keys));
+	cdma_read(keys, sw_tbl->line, line_size);
 
 	if (keys[pos].virt_addr == 0)
 		/* invalid entry */
@@ -105,15 +100,15 @@ static IPR_CODE_PLACEMENT int sw_table_key_delete(uint32_t table_id,
 
 	/* copy the table line into IPR_SW_TABLE and
 	   decrement the reference counter for the line */
-	status = cdma_access_context_memory(*sw_tbl,
+	status = cdma_access_context_memory(sw_tbl->line,
 				CDMA_ACCESS_CONTEXT_MEM_DEC_REFCOUNT_AND_REL,
 				0, keys,
 				CDMA_ACCESS_CONTEXT_MEM_DMA_WRITE |
-				sizeof(keys),
+				line_size,
 				(uint32_t *)REF_COUNT_ADDR_DUMMY);
 	if (status == CDMA_REFCOUNT_DECREMENT_TO_ZERO) {
 		/* it was the last entry */
-		*sw_tbl = 0;
+		sw_tbl->line = 0;
 		return 0;
 	}
 	if (status == 0)
@@ -122,23 +117,68 @@ static IPR_CODE_PLACEMENT int sw_table_key_delete(uint32_t table_id,
 	return -EIO;
 }
 
-static IPR_CODE_PLACEMENT void sw_table_delete(uint32_t table_id)
+static IPR_CODE_PLACEMENT int sw_table_key_delete(
+					struct ipr_instance *instance_params_ptr,
+					uint32_t table_id,
+					uint32_t line, uint32_t pos,
+					uint8_t lock_with_OSM_enter)
 {
-	int id;
-	uint64_t *sw_table;
+	struct sw_table_bin *bin, *sw_tbl;
+	uint32_t ways = instance_params_ptr->sw_ways;
+	int status;
+
+	bin = sw_table_bin_get(table_id, line);
+
+	/* get exclusive access to the line in IPR_SW_TABLE.
+	   We use virtual addresses for scope_id since they are unique */
+	if (lock_with_OSM_enter)
+		osm_scope_enter(OSM_SCOPE_ENTER_CHILD_TO_EXCLUSIVE,
+				(uint32_t)bin);
+	else
+		osm_scope_transition_to_exclusive_with_new_scope_id(
+							(uint32_t)bin);
+
+	if (pos < ways)
+		/* the entry is on the home line */
+		return sw_table_entry_clear(bin, pos,
+				(uint16_t)(ways * sizeof(struct sw_table_entry)));
+
+	/* the entry is on an overflow line, shared with other bins */
+	pos -= ways;
+	sw_tbl = sw_table_bin_get(table_id,
+				  (1 << instance_params_ptr->sw_bins_log2) +
+				  pos / ways);
+
+	cdma_mutex_lock_take((uint64_t)(uint32_t)sw_tbl,
+			     CDMA_MUTEX_WRITE_LOCK);
+	status = sw_table_entry_clear(sw_tbl, pos % ways,
+				(uint16_t)(ways * sizeof(struct sw_table_entry)));
+	cdma_mutex_lock_release((uint64_t)(uint32_t)sw_tbl);
+
+	if (!status)
+		bin->overflow_cnt--;
+
+	return status;
+}
+
+static IPR_CODE_PLACEMENT void sw_table_delete(uint32_t table_id,
+					       uint32_t nbr_of_lines)
+{
+	uint32_t id;
+	struct sw_table_bin *sw_table;
 	uint64_t paddr = sys_virt_to_phys((void *)table_id);
 
 	if (INVALID_PHY_ADDR == paddr)
 		return;
 
-	/* release all the lines */
-	for (id = 0; id < FRAG_BINS; id++) {
-		sw_table = (uint64_t *)(table_id + id * IPR_MEM_ALIGN);
+	/* release all the lines, including the overflow ones */
+	for (id = 0; id < nbr_of_lines; id++) {
+		sw_table = sw_table_bin_get(table_id, id);
 
-		if (*sw_table == 0)
+		if (sw_table->line == 0)
 			continue;
 
-		while (cdma_refcount_decrement_and_release(*sw_table) !=
+		while (cdma_refcount_decrement_and_release(sw_table->line) !=
 		       CDMA_REFCOUNT_DECREMENT_TO_ZERO) {
 		}
 	}
@@ -147,11 +187,13 @@ static IPR_CODE_PLACEMENT void sw_table_delete(uint32_t table_id)
 }
 
 static IPR_CODE_PLACEMENT int sw_table_create(uint32_t *table_id,
-					      uint32_t table_location)
+					      uint32_t table_location,
+					      uint32_t nbr_of_lines)
 {
-	int id, err;
+	uint32_t id;
+	int err;
 	uint64_t paddr = 0;
-	uint64_t *sw_table;
+	struct sw_table_bin *sw_table;
 	enum memory_partition_id mem_pid;
 
 	if (table_location == IPR_MODE_TABLE_LOCATION_PEB)
@@ -164,8 +206,8 @@ static IPR_CODE_PLACEMENT int sw_table_create(uint32_t *table_id,
 		return -EINVAL;
 
 	/* IPR_SW_TABLE uses physical addresses for each line.
-	   Each line has FRAGS_PER_BIN entries. */
-	err = fsl_get_mem(FRAG_BINS * IPR_MEM_ALIGN,
+	   The bins are followed by the overflow lines. */
+	err = fsl_get_mem(nbr_of_lines * IPR_MEM_ALIGN,
 			  mem_pid, IPR_MEM_ALIGN, &paddr);
 	if (err)
 		return err;
@@ -175,9 +217,10 @@ static IPR_CODE_PLACEMENT int sw_table_create(uint32_t *table_id,
 		return -ENOMEM;
 
 	/* Clear the table */
-	for (id = 0; id < FRAG_BINS; id++) {
-		sw_table = (uint64_t *)(*table_id + id * IPR_MEM_ALIGN);
-		*sw_table = 0;
+	for (id = 0; id < nbr_of_lines; id++) {
+		sw_table = sw_table_bin_get(*table_id, id);
+		sw_table->line = 0;
+		sw_table->overflow_cnt = 0;
 	}
 	return 0;
 }
@@ -217,6 +260,117 @@ static inline int sw_table_key_equal(uint8_t is_ipv4_key,
 		(fk1->ipv6_fk.id == fk2->ipv6_fk.id));
 }
 
+/* Search the key on a table line. Returns the virtual address of the RFDC,
+   0 if not found. first_free is set to the first free column, if any. */
+static inline uint32_t sw_table_line_search(struct sw_table_entry *keys,
+					    uint8_t ways, uint8_t is_ipv4_key,
+					    union ip_fragment_key *fk,
+					    uint8_t *first_free)
+{
+	uint8_t cnt;
+
+	for (cnt = 0; cnt < ways; cnt++) {
+		if (keys[cnt].virt_addr == 0) {
+			if (*first_free == (uint8_t)-1)
+				*first_free = cnt;
+		} else if (sw_table_key_equal(is_ipv4_key, &keys[cnt].fk, fk)) {
+			return keys[cnt].virt_addr;
+		}
+	}
+	return 0;
+}
+
+/* Search the key on the overflow lines, starting with the first line probed
+   at insert. Must be called with exclusive access to the home line. */
+static IPR_CODE_PLACEMENT uint32_t sw_table_overflow_lookup(
+		struct ipr_instance *instance_params_ptr,
+		uint32_t table_id, uint32_t line,
+		uint8_t frame_is_ipv4, union ip_fragment_key *fk)
+{
+	struct sw_table_entry keys[IPR_SW_TABLE_MAX_WAYS]
+					__attribute__((aligned(16)));
+	struct sw_table_bin *ovf, *sw_tbl;
+	uint32_t cnt, id, virt_addr = 0;
+	uint32_t nbr_of_lines = instance_params_ptr->sw_overflow_lines;
+	uint8_t ways = instance_params_ptr->sw_ways;
+	uint8_t first_free;
+
+	if (!nbr_of_lines)
+		return 0;
+
+	ovf = sw_table_bin_get(table_id,
+			       1 << instance_params_ptr->sw_bins_log2);
+	id = line % nbr_of_lines;
+
+	for (cnt = 0; !virt_addr && (cnt < nbr_of_lines); cnt++) {
+		sw_tbl = &ovf[id];
+
+		cdma_mutex_lock_take((uint64_t)(uint32_t)sw_tbl,
+				     CDMA_MUTEX_WRITE_LOCK);
+		if (sw_tbl->line) {
+			cdma_read(keys, sw_tbl->line,
+				  (uint16_t)(ways *
+					     sizeof(struct sw_table_entry)));
+			first_free = (uint8_t)-1;
+			virt_addr = sw_table_line_search(keys, ways,
+							 frame_is_ipv4, fk,
+							 &first_free);
+		}
+		cdma_mutex_lock_release((uint64_t)(uint32_t)sw_tbl);
+
+		if (++id == nbr_of_lines)
+			id = 0;
+	}
+	return virt_addr;
+}
+
+/* Find an overflow line with a free column. On success the overflow line
+   mutex is kept and the line is returned, with keys holding its content
+   and first_free set to the free column. Returns NULL if all the overflow
+   lines are full. */
+static IPR_CODE_PLACEMENT struct sw_table_bin *sw_table_overflow_reserve(
+		struct ipr_instance *instance_params_ptr,
+		uint32_t table_id, uint32_t line,
+		struct sw_table_entry *keys, uint8_t *first_free)
+{
+	struct sw_table_bin *ovf, *sw_tbl;
+	uint32_t cnt, id;
+	uint32_t nbr_of_lines = instance_params_ptr->sw_overflow_lines;
+	uint8_t ways = instance_params_ptr->sw_ways;
+
+	/* no overflow lines configured */
+	if (!nbr_of_lines)
+		return NULL;
+
+	ovf = sw_table_bin_get(table_id,
+			       1 << instance_params_ptr->sw_bins_log2);
+	id = line % nbr_of_lines;
+
+	for (cnt = 0; cnt < nbr_of_lines; cnt++) {
+		sw_tbl = &ovf[id];
+
+		cdma_mutex_lock_take((uint64_t)(uint32_t)sw_tbl,
+				     CDMA_MUTEX_WRITE_LOCK);
+		if (sw_tbl->line == 0) {
+			/* the line will be allocated by the caller */
+			*first_free = 0;
+			return sw_tbl;
+		}
+
+		cdma_read(keys, sw_tbl->line,
+			  (uint16_t)(ways * sizeof(struct sw_table_entry)));
+		for (*first_free = 0; *first_free < ways; (*first_free)++)
+			if (keys[*first_free].virt_addr == 0)
+				return sw_tbl;
+
+		cdma_mutex_lock_release((uint64_t)(uint32_t)sw_tbl);
+
+		if (++id == nbr_of_lines)
+			id = 0;
+	}
+	return NULL;
+}
+
 static IPR_CODE_PLACEMENT int sw_ipr_lookup_or_insert(
 		struct ipr_instance *instance_params_ptr,
 		uint8_t frame_is_ipv4, uint32_t osm_status,
@@ -226,11 +380,13 @@ static IPR_CODE_PLACEMENT int sw_ipr_lookup_or_insert(
 		union ip_fragment_key *fk)
 {
 	uint8_t cnt;
-	uint32_t h, t;
-	uint64_t *sw_table;
-	struct sw_table_entry keys[FRAGS_PER_BIN] __attribute__((aligned(16)));
+	uint32_t h, t, pos, flags;
+	struct sw_table_bin *bin, *sw_tbl;
+	struct sw_table_entry keys[IPR_SW_TABLE_MAX_WAYS]
+					__attribute__((aligned(16)));
+	uint8_t ways = instance_params_ptr->sw_ways;
+	uint16_t line_size = (uint16_t)(ways * sizeof(struct sw_table_entry));
 	uint8_t first_free = 0;
-	union ip_fragment_key *tmp_fk;
 
 	if (frame_is_ipv4) {
 		/* IPR_SW_TABLE */
@@ -251,58 +407,90 @@ static IPR_CODE_PLACEMENT int sw_ipr_lookup_or_insert(
 	keygen_gen_hash(fk, cnt, &h);
 
 	/* pick the line table */
-	h &= (FRAG_BINS - 1);
-	sw_table = (uint64_t *)(t + h * IPR_MEM_ALIGN);
+	h &= ((1 << instance_params_ptr->sw_bins_log2) - 1);
+	bin = sw_table_bin_get(t, h);
 
 	/* get exclusive access to the line table.
 	   We use virtual addresses for scope_id since they are unique */
-	sw_osm_scope_enter_to_exclusive(osm_status, (uint32_t)sw_table);
+	sw_osm_scope_enter_to_exclusive(osm_status, (uint32_t)bin);
 
-	if (*sw_table == 0)
-		/* the line is not allocated. It's the first access to it. */
-		t = TRUE;
-	else {
-		/* the line was allocated */
-		cdma_read(keys, *sw_table, sizeof(keys));
+	pos = 0;
+	if (bin->line) {
+		/* the line was allocated. Search the key */
+		cdma_read(keys, bin->line, line_size);
 		first_free = (uint8_t)-1;
-		t = FALSE;
+		pos = sw_table_line_search(keys, ways, frame_is_ipv4, fk,
+					   &first_free);
 	}
 
-	/* search the key */
-	for (cnt = 0; !t && (cnt < FRAGS_PER_BIN); cnt++) {
-		tmp_fk = &keys[cnt].fk;
-
-		if (keys[cnt].virt_addr == 0) {
-			if (first_free == (uint8_t)-1)
-				first_free = cnt;
-		} else if (sw_table_key_equal(frame_is_ipv4, tmp_fk, fk)) {
-			/* found the key. Get the RFDC */
-			t = keys[cnt].virt_addr;
-			*rfdc_ext_addr_ptr = sys_fast_virt_to_phys((void *)t,
-								   g_mem_pid);
-
-			/* get exclusive access to the RDFC
-			   Use virtual addresses for scope_id since
-			   they are unique */
-			osm_scope_transition_to_exclusive_with_new_scope_id(t);
-			return TABLE_STATUS_SUCCESS;
-		}
+	if (!pos && bin->overflow_cnt)
+		/* some keys of this line were stored in the overflow lines */
+		pos = sw_table_overflow_lookup(instance_params_ptr, t, h,
+					       frame_is_ipv4, fk);
+
+	if (pos) {
+		/* found the key. Get the RFDC */
+		*rfdc_ext_addr_ptr = sys_fast_virt_to_phys((void *)pos,
+							   g_mem_pid);
+
+		/* get exclusive access to the RDFC
+		   Use virtual addresses for scope_id since
+		   they are unique */
+		osm_scope_transition_to_exclusive_with_new_scope_id(pos);
+		return TABLE_STATUS_SUCCESS;
 	}
 
+	sw_tbl = bin;
+	pos = first_free;
+
 	if (first_free == (uint8_t)-1) {
 		/* line table is full */
-		return -ENOSPC;
+		if (frame_is_ipv4)
+			ste_inc_counter(instance_handle +
+					sizeof(struct ipr_instance) +
+					offsetof(struct ipr_instance_extension,
+						 ipv4_line_full_cntr),
+					1, STE_MODE_32_BIT_CNTR_SIZE);
+		else
+			ste_inc_counter(instance_handle +
+					sizeof(struct ipr_instance) +
+					offsetof(struct ipr_instance_extension,
+						 ipv6_line_full_cntr),
+					1, STE_MODE_32_BIT_CNTR_SIZE);
+
+		sw_tbl = sw_table_overflow_reserve(instance_params_ptr, t, h,
+						   keys, &first_free);
+		if (!sw_tbl)
+			/* the overflow lines are full too */
+			return -ENOSPC;
+
+		/* the overflow entries are numbered after the home columns */
+		pos = ways + first_free + ways * (uint32_t)(sw_tbl -
+			sw_table_bin_get(t,
+				1 << instance_params_ptr->sw_bins_log2));
 	}
 
 	/* add a new entry */
-	if (t) {
+	if (sw_tbl->line == 0) {
 		/* the 2nd parameter must be in the workspace */
 		if (cdma_acquire_context_memory(instance_params_ptr->bpid_fk,
-						rfdc_ext_addr_ptr))
+						rfdc_ext_addr_ptr)) {
 			/* Can't create a new line */
+			if (sw_tbl != bin)
+				cdma_mutex_lock_release(
+						(uint64_t)(uint32_t)sw_tbl);
 			return -ENOSPC;
+		}
 
-		*sw_table = *rfdc_ext_addr_ptr;
+		sw_tbl->line = *rfdc_ext_addr_ptr;
+
+		/* init the whole table line */
+		memset(keys, 0, line_size);
+		flags = 0;
+	} else {
+		/* there is a new entry on the line => increment the reference
+		   counter. It should be decremented at delete */
+		flags = CDMA_ACCESS_CONTEXT_MEM_INC_REFCOUNT;
 	}
 
 	/* create a new RFDC */
@@ -311,16 +499,7 @@ static IPR_CODE_PLACEMENT int sw_ipr_lookup_or_insert(
 
 	/* store key in RDFC, to know what to delete from the table */
 	rfdc_ptr->ipv4_key[0] = h;		/* line */
-	rfdc_ptr->ipv4_key[1] = first_free;	/* column */
-
-	if (t) {
-		/* init the whole table line */
-		memset(keys, 0, sizeof(keys));
-		h = 0;
-	} else
-		/* there is a new entry on the line => increment the reference
-		   counter. It should be decremented at delete */
-		h = CDMA_ACCESS_CONTEXT_MEM_INC_REFCOUNT;
+	rfdc_ptr->ipv4_key[1] = pos;		/* column */
 
 	/* the virtual address is also used as a scope id */
 	t = (uint32_t)sys_fast_phys_to_virt(*rfdc_ext_addr_ptr, g_mem_pid);
@@ -330,11 +509,16 @@ static IPR_CODE_PLACEMENT int sw_ipr_lookup_or_insert(
 	keys[first_free].fk = *fk;
 
 	/* copy the table line into IPR_SW_TABLE */
-	cdma_access_context_memory(*sw_table, h, 0, keys,
+	cdma_access_context_memory(sw_tbl->line, flags, 0, keys,
 				   CDMA_ACCESS_CONTEXT_MEM_DMA_WRITE |
-				   sizeof(keys),
+				   line_size,
 				   (uint32_t *)REF_COUNT_ADDR_DUMMY);
 
+	if (sw_tbl != bin) {
+		cdma_mutex_lock_release((uint64_t)(uint32_t)sw_tbl);
+		bin->overflow_cnt++;
+	}
+
 	/* get exclusive access to the RDFC.
 	   Use virtual addresses for scope_id since they are unique */
 	osm_scope_transition_to_exclusive_with_new_scope_id(t);
@@ -372,7 +556,8 @@ int ipr_early_init(uint32_t nbr_of_instances, uint32_t nbr_of_context_buffers)
 	ASSERT_COND(SW_IPR_OSM_MASK == IPR_MEM_ALIGN - 1);
 
 	/* reserve memory for ipv4_fragment_key & ipv6_fragment_key
-	   There are FRAGS_PER_BIN keys per line in the sw hash table */
+	   There are up to IPR_SW_TABLE_MAX_WAYS keys per line in the sw
+	   hash table */
 	err = slab_register_context_buffer_requirements(
 							nbr_of_context_buffers,
 							nbr_of_context_buffers,
@@ -457,6 +642,28 @@ int ipr_create_instance(struct ipr_params *ipr_params_ptr,
 					ipr_params_ptr->max_open_frames_ipv6;
 
 #ifdef USE_IPR_SW_TABLE
+	/* IPR_SW_TABLE geometry */
+	if (ipr_params_ptr->flags & IPR_MODE_SW_TABLE_GEOMETRY) {
+		if (!ipr_params_ptr->sw_table_bins ||
+		    !is_power_of_2(ipr_params_ptr->sw_table_bins) ||
+		    (ipr_params_ptr->sw_table_bins > IPR_SW_TABLE_MAX_BINS) ||
+		    !ipr_params_ptr->sw_table_ways ||
+		    (ipr_params_ptr->sw_table_ways > IPR_SW_TABLE_MAX_WAYS) ||
+		    (ipr_params_ptr->sw_table_overflow_lines >
+		     IPR_SW_TABLE_MAX_OVERFLOW_LINES))
+			ipr_exception_handler(IPR_CREATE_INSTANCE, __LINE__,
+					      EINVAL_TABLE);
+
+		LOG2(ipr_params_ptr->sw_table_bins, ipr_instance.sw_bins_log2);
+		ipr_instance.sw_ways = ipr_params_ptr->sw_table_ways;
+		ipr_instance.sw_overflow_lines =
+				ipr_params_ptr->sw_table_overflow_lines;
+	} else {
+		LOG2(FRAG_BINS, ipr_instance.sw_bins_log2);
+		ipr_instance.sw_ways = FRAGS_PER_BIN;
+		ipr_instance.sw_overflow_lines = FRAG_OVERFLOW_LINES;
+	}
+
 	/* reservation for the ip fragment key */
 	sr_status = slab_find_and_reserve_bpid(aggregate_open_frames,
 					       IPR_SW_TABLE_LINE_SIZE,
@@ -472,7 +679,9 @@ int ipr_create_instance(struct ipr_params *ipr_params_ptr,
 	/* allocate the IPR_SW_TABLE */
 	if (ipr_params_ptr->max_open_frames_ipv4) {
 		sr_status = sw_table_create(&ipr_instance.table_id_ipv4,
-					    table_location);
+					    table_location,
+					    IPR_SW_TABLE_NBR_OF_LINES(
+							&ipr_instance));
 
 		if (sr_status != TABLE_STATUS_SUCCESS) {
 			ipr_exception_handler(IPR_CREATE_INSTANCE, __LINE__,
@@ -481,11 +690,15 @@ int ipr_create_instance(struct ipr_params *ipr_params_ptr,
 	}
 	if (ipr_params_ptr->max_open_frames_ipv6) {
 		sr_status = sw_table_create(&ipr_instance.table_id_ipv6,
-					    table_location);
+					    table_location,
+					    IPR_SW_TABLE_NBR_OF_LINES(
+							&ipr_instance));
 
 		if (sr_status != TABLE_STATUS_SUCCESS) {
 			if (ipr_params_ptr->max_open_frames_ipv4)
-				sw_table_delete(ipr_instance.table_id_ipv4);
+				sw_table_delete(ipr_instance.table_id_ipv4,
+						IPR_SW_TABLE_NBR_OF_LINES(
+							&ipr_instance));
 
 			ipr_exception_handler(IPR_CREATE_INSTANCE, __LINE__,
 					      ENOMEM_TABLE);
@@ -638,6 +851,8 @@ int ipr_create_instance(struct ipr_params *ipr_params_ptr,
 	ipr_instance_ext.num_of_open_reass_frames_ipv6 = 0;
 	ipr_instance_ext.ipv4_reass_frm_cntr = 0;
 	ipr_instance_ext.ipv6_reass_frm_cntr = 0;
+	ipr_instance_ext.ipv4_line_full_cntr = 0;
+	ipr_instance_ext.ipv6_line_full_cntr = 0;
 
 	/* Write ipr instance extension data structure */
 	cdma_write((*ipr_instance_ptr)+sizeof(struct ipr_instance),
@@ -740,7 +955,9 @@ void ipr_delete_instance_after_time_out(ipr_instance_handle_t ipr_instance_ptr)
 	if (ipr_instance_and_extension.ipr_instance.flags & IPV4_VALID)
 #ifdef USE_IPR_SW_TABLE
 		sw_table_delete(
-			ipr_instance_and_extension.ipr_instance.table_id_ipv4);
+			ipr_instance_and_extension.ipr_instance.table_id_ipv4,
+			IPR_SW_TABLE_NBR_OF_LINES(
+				&ipr_instance_and_extension.ipr_instance));
 #else
 		table_delete(TABLE_ACCEL_ID_CTLU,
 			 ipr_instance_and_extension.ipr_instance.table_id_ipv4);
@@ -749,7 +966,9 @@ void ipr_delete_instance_after_time_out(ipr_instance_handle_t ipr_instance_ptr)
 	if (ipr_instance_and_extension.ipr_instance.flags & IPV6_VALID)
 #ifdef USE_IPR_SW_TABLE
 		sw_table_delete(
-			ipr_instance_and_extension.ipr_instance.table_id_ipv6);
+			ipr_instance_and_extension.ipr_instance.table_id_ipv6,
+			IPR_SW_TABLE_NBR_OF_LINES(
+				&ipr_instance_and_extension.ipr_instance));
 #else
 		table_delete(TABLE_ACCEL_ID_CTLU,
 			ipr_instance_and_extension.ipr_instance.table_id_ipv6);
@@ -1164,13 +1383,15 @@ IPR_CODE_PLACEMENT int ipr_reassemble(ipr_instance_handle_t instance_handle)
 	/* delete this late the key from IPR_SW_TABLE because
 	   of OSM transition */
 	if (frame_is_ipv4)
-		sw_table_key_delete(instance_params.table_id_ipv4,
+		sw_table_key_delete(&instance_params,
+				    instance_params.table_id_ipv4,
 				    (uint32_t)rfdc.ipv4_key[0],
-				    (uint8_t)rfdc.ipv4_key[1], FALSE);
+				    (uint32_t)rfdc.ipv4_key[1], FALSE);
 	else
-		sw_table_key_delete(instance_params.table_id_ipv6,
+		sw_table_key_delete(&instance_params,
+				    instance_params.table_id_ipv6,
 				    (uint32_t)rfdc.ipv4_key[0],
-				    (uint8_t)rfdc.ipv4_key[1], FALSE);
+				    (uint32_t)rfdc.ipv4_key[1], FALSE);
 #endif	/* USE_IPR_SW_TABLE */
 
 	move_to_correct_ordering_scope2(osm_status);
@@ -2329,13 +2550,15 @@ void ipr_time_out(uint64_t rfdc_ext_addr, uint16_t opaque_not_used)
 
 	/* first delete the key from IPR_SW_TABLE because of OSM */
 	if (rfdc.status & IPV6_FRAME)
-		sw_table_key_delete(instance_params.table_id_ipv6,
+		sw_table_key_delete(&instance_params,
+				    instance_params.table_id_ipv6,
 				    (uint32_t)rfdc.ipv4_key[0],
-				    (uint8_t)rfdc.ipv4_key[1], TRUE);
+				    (uint32_t)rfdc.ipv4_key[1], TRUE);
 	else
-		sw_table_key_delete(instance_params.table_id_ipv4,
+		sw_table_key_delete(&instance_params,
+				    instance_params.table_id_ipv4,
 				    (uint32_t)rfdc.ipv4_key[0],
-				    (uint8_t)rfdc.ipv4_key[1], TRUE);
+				    (uint32_t)rfdc.ipv4_key[1], TRUE);
 
 	/* get exclusive access to the RDFC */
 	osm_scope_transition_to_exclusive_with_new_scope_id(flags);
@@ -2971,6 +3194,23 @@ void ipr_get_reass_frm_cntr(ipr_instance_handle_t ipr_instance,
 	return;
 }
 
+void ipr_get_sw_table_line_full_cntr(ipr_instance_handle_t ipr_instance,
+				     uint32_t flags, uint32_t *line_full_cntr)
+{
+	if (flags & IPR_STATS_IP_VERSION)
+		cdma_read(line_full_cntr,
+			  ipr_instance+sizeof(struct ipr_instance)+
+			  offsetof(struct ipr_instance_extension,
+				   ipv4_line_full_cntr),
+			  sizeof(*line_full_cntr));
+	else
+		cdma_read(line_full_cntr,
+			  ipr_instance+sizeof(struct ipr_instance)+
+			  offsetof(struct ipr_instance_extension,
+				   ipv6_line_full_cntr),
+			  sizeof(*line_full_cntr));
+}
+
 #pragma push
 	/* make all following data go into .exception_data */
 #pragma section data_type ".exception_data"
@@ -3019,6 +3259,9 @@ void ipr_exception_handler(enum ipr_function_identifier func_id,
 				err_msg = "Not enough memory available to create\
 					   table\n";
 				break;
+			case EINVAL_TABLE:
+				err_msg = "Invalid IPR_SW_TABLE geometry\n";
+				break;
 			default:
 				err_msg = "Unknown or Invalid status Error.\n";
 
@@ -54,19 +54,38 @@
 /* IPR_SW_TABLE */
 #ifdef USE_IPR_SW_TABLE
 
-/* size of the IPR_SW_TABLE */
+/* default size of the IPR_SW_TABLE */
 #define FRAG_BINS		2048
 #define FRAGS_PER_BIN	8
+#define FRAG_OVERFLOW_LINES	16
+
+/* limits of the IPR_SW_TABLE geometry selected at ipr_create_instance().
+   IPR_SW_TABLE_MAX_WAYS sizes the table line buffers and the line copy kept
+   on the task stack, so it may be raised only if the stack allows it. */
+#ifndef IPR_SW_TABLE_MAX_WAYS
+#define IPR_SW_TABLE_MAX_WAYS	FRAGS_PER_BIN
+#endif
+#define IPR_SW_TABLE_MAX_BINS	0x10000
+#define IPR_SW_TABLE_MAX_OVERFLOW_LINES	1024
 
 /*
  * IPR module uses software hash tables instead of CTLU ones.
  *
  * The table lines are created on demand.
- * With the default values a table has 128kB and a line 512 bytes.
+ * With the default values a table has 129kB and a line 320 bytes.
  * The table lines are obtained from SLAB so a new DPBP is needed for IPR.
  *
+ * The number of lines (bins), entries per line (ways) and overflow lines
+ * can be set per instance with IPR_MODE_SW_TABLE_GEOMETRY.
+ *
  * The lookup key is SW extracted. From it a hash is generated
- * and reduced to a line number.
+ * and reduced to a line number (home line).
+ * When the home line is full the entry is stored in one of the overflow
+ * lines placed after the bins. The overflow lines are shared by all the
+ * bins, so their accesses are serialized with a CDMA mutex on top of the
+ * OSM scope of the home line. Each bin counts its entries stored in the
+ * overflow lines, so that a lookup searches them only when needed.
+ * Entries are never moved, because the RFDC records their position.
  *
  * We protect the IPR resources with OSM transitions in exclusive mode.
  * scope_id (uint32_t) has a portion (0x3F) reserved for OSM infrastructure.
@@ -76,7 +95,6 @@
  *
  * Possible improvements:
  * - separate line size for ipv4 and ipv6
- * - extend the table line when it's full
  * - compact table line
  */
 
@@ -114,7 +132,23 @@ struct sw_table_entry {
 };	/* 40 byte */
 #pragma pack(pop)
 
-#define IPR_SW_TABLE_LINE_SIZE	(FRAGS_PER_BIN * sizeof(struct sw_table_entry))
+#pragma pack(push, 1)
+struct sw_table_bin {
+	/* physical address of the table line. 0 if it's not allocated */
+	uint64_t line;
+	/* number of entries of this bin stored in the overflow lines */
+	uint16_t overflow_cnt;
+	uint8_t res[IPR_MEM_ALIGN - 10];
+};	/* IPR_MEM_ALIGN byte */
+#pragma pack(pop)
+
+/* size of a table line buffer, for the largest supported line */
+#define IPR_SW_TABLE_LINE_SIZE	\
+	(IPR_SW_TABLE_MAX_WAYS * sizeof(struct sw_table_entry))
+
+/* number of IPR_SW_TABLE lines, bins and overflow lines, of an instance */
+#define IPR_SW_TABLE_NBR_OF_LINES(_ins)	\
+	((1 << (_ins)->sw_bins_log2) + (_ins)->sw_overflow_lines)
 #endif	/* USE_IPR_SW_TABLE */
 
 /***************************************************************************/
@@ -190,6 +224,7 @@ static inline int GET_IPR_ERR(uint32_t stat)
 #define IPV6_ECN		0x00300000
 #define ENOSPC_TIMER		2
 #define ENOMEM_TABLE		3
+#define EINVAL_TABLE		4
 #define IPR_ERROR		1
 
 /* todo should move to general or OSM include file */
@@ -241,7 +276,13 @@ struct ipr_instance {
 #ifdef USE_IPR_SW_TABLE
 	/* BPID to fetch buffers for ip fragment key */
 	uint16_t	bpid_fk;
-	uint8_t		res[5];
+	/* log2 of the number of bins of IPR_SW_TABLE */
+	uint8_t		sw_bins_log2;
+	/* number of entries on a IPR_SW_TABLE line */
+	uint8_t		sw_ways;
+	/* number of IPR_SW_TABLE overflow lines */
+	uint16_t	sw_overflow_lines;
+	uint8_t		res[1];
 #else
 	uint8_t		res[11];
 #endif	/* USE_IPR_SW_TABLE */
@@ -263,6 +304,10 @@ struct ipr_instance_extension{
 	/* Address to the memory used for the timers
 	 * associated with the TMI */
 	uint64_t	tmi_mem_base_addr;
+	/** Number of IPv4 frames that found their IPR_SW_TABLE line full */
+	uint32_t	ipv4_line_full_cntr;
+	/** Number of IPv6 frames that found their IPR_SW_TABLE line full */
+	uint32_t	ipv6_line_full_cntr;
 };
 #pragma pack(pop)
 
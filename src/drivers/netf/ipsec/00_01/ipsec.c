@@ -72,6 +72,413 @@
 /* Global parameters */
 uint16_t ipsec_bpid;
 
+#ifdef IPSEC_SA_CACHE
+/* SA cache, indexed by a hash of the SA descriptor address */
+struct ipsec_sa_cache_entry g_ipsec_sa_cache[IPSEC_SA_CACHE_SIZE];
+#endif
+
+#ifdef IPSEC_LIFETIME_BATCH
+/* Lifetime counters staged per core, indexed by a hash of the SA descriptor
+ * address. A stage is updated by the tasks of its core and taken by the
+ * lifetime statistics and timer paths of any core, under its lock. */
+struct ipsec_lifetime_stage
+	g_ipsec_lifetime_stage[INTG_MAX_NUM_OF_CORES][IPSEC_LIFETIME_BATCH_SLOTS];
+#endif
+
+/******************************************************************************/
+static inline uint32_t ipsec_desc_hash(ipsec_handle_t desc_addr)
+{
+	/* SA descriptors are 64 bytes aligned */
+	return (uint32_t)(desc_addr >> 6) ^ (uint32_t)(desc_addr >> 16);
+}
+
+/******************************************************************************/
+/* Checks the lifetime limits of the SA. Returns IPSEC_ERROR if a hard limit
+ * expired. */
+static inline int ipsec_check_lifetime(struct ipsec_sa_params_part1 *sap1,
+				       uint32_t *status)
+{
+	/* The seconds lifetime status is checked in the params[status]
+	 * and the kilobyte/packet status is checked from the params[counters].
+	 * This is done to avoid doing mutex lock for kilobyte/packet status */
+
+	/* Seconds Lifetime */
+	if (sap1->soft_sec_expired &&
+	    (sap1->flags & IPSEC_FLG_LIFETIME_SEC_CNTR_EN)) {
+		*status |= IPSEC_STATUS_SOFT_SEC_EXPIRED;
+		if (sap1->hard_sec_expired) {
+			*status |= IPSEC_STATUS_HARD_SEC_EXPIRED;
+			return IPSEC_ERROR;
+		}
+	}
+
+#ifdef IPSEC_LIFETIME_BATCH
+	/* Kilobytes/packets lifetime status of the last counters flush */
+	*status |= sap1->lifetime_status;
+	if (sap1->lifetime_status & (IPSEC_STATUS_HARD_KB_EXPIRED |
+				     IPSEC_STATUS_HARD_PACKET_EXPIRED))
+		return IPSEC_ERROR;
+#else
+	/* KB lifetime counters */
+	if (sap1->flags & IPSEC_FLG_LIFETIME_KB_CNTR_EN) {
+		if (sap1->byte_counter >= sap1->soft_byte_limit) {
+			*status |= IPSEC_STATUS_SOFT_KB_EXPIRED;
+			if (sap1->byte_counter >= sap1->hard_byte_limit) {
+				*status |= IPSEC_STATUS_HARD_KB_EXPIRED;
+				return IPSEC_ERROR;
+			}
+		}
+	}
+
+	/* Packets lifetime counters*/
+	if (sap1->flags & IPSEC_FLG_LIFETIME_PKT_CNTR_EN) {
+		if (sap1->packet_counter >= sap1->soft_packet_limit) {
+			*status |= IPSEC_STATUS_SOFT_PACKET_EXPIRED;
+			if (sap1->packet_counter >= sap1->hard_packet_limit) {
+				*status |= IPSEC_STATUS_HARD_PACKET_EXPIRED;
+				return IPSEC_ERROR;
+			}
+		}
+	}
+#endif /* IPSEC_LIFETIME_BATCH */
+
+	return IPSEC_SUCCESS;
+}
+
+#ifdef IPSEC_SA_CACHE
+/******************************************************************************/
+static inline struct ipsec_sa_cache_entry *ipsec_sa_cache_entry_get(
+		ipsec_handle_t desc_addr)
+{
+	return &g_ipsec_sa_cache[ipsec_desc_hash(desc_addr) &
+				 (IPSEC_SA_CACHE_SIZE - 1)];
+}
+
+/******************************************************************************/
+/* Consumes a frame of the entry credit. Returns 1 if the lifetime counters
+ * must be checked. Called with the entry lock taken. */
+static inline int ipsec_sa_cache_check_due(struct ipsec_sa_cache_entry *entry)
+{
+#ifdef IPSEC_LIFETIME_BATCH
+	/* The lifetime status is evaluated on the counters flush, which
+	 * invalidates the entry when the status changes */
+	UNUSED(entry);
+	return 0;
+#else
+	return (--entry->credit <= 0);
+#endif
+}
+
+/******************************************************************************/
+/* Number of frames that can be processed before the next soft or hard
+ * kilobytes/packets limit may be crossed. */
+static inline int32_t ipsec_sa_cache_credit(struct ipsec_sa_params_part1 *sap1)
+{
+	uint64_t credit = IPSEC_SA_CACHE_CHECK_INTERVAL;
+	uint64_t left;
+
+	if (sap1->flags & IPSEC_FLG_LIFETIME_KB_CNTR_EN) {
+		if (sap1->byte_counter < sap1->soft_byte_limit)
+			left = sap1->soft_byte_limit - sap1->byte_counter;
+		else
+			left = sap1->hard_byte_limit - sap1->byte_counter;
+		left /= IPSEC_MAX_FRAME_SIZE;
+		if (left < credit)
+			credit = left;
+	}
+
+	if (sap1->flags & IPSEC_FLG_LIFETIME_PKT_CNTR_EN) {
+		if (sap1->packet_counter < sap1->soft_packet_limit)
+			left = sap1->soft_packet_limit - sap1->packet_counter;
+		else
+			left = sap1->hard_packet_limit - sap1->packet_counter;
+		if (left < credit)
+			credit = left;
+	}
+
+	return (int32_t)credit;
+}
+
+/******************************************************************************/
+/* Reads the SA parameters used by the encrypt/decrypt functions from the SA
+ * cache and checks the lifetime limits. On a miss the parameters are read
+ * from the SA descriptor and cached. The lifetime counters are read from the
+ * SA descriptor only when the credit of the cache entry is consumed.
+ * Returns IPSEC_ERROR if a hard limit expired. */
+static int ipsec_sa_cache_read(ipsec_handle_t desc_addr,
+			       struct ipsec_sa_params_part1 *sap1,
+			       uint32_t *status)
+{
+	struct ipsec_sa_cache_entry *entry;
+	uint32_t lifetime_status = 0;
+	uint32_t gen;
+	int hit, ret;
+
+	entry = ipsec_sa_cache_entry_get(desc_addr);
+
+	lock_spinlock(&entry->lock);
+	hit = (entry->desc_addr == desc_addr);
+	if (hit) {
+		sap1->soft_byte_limit = entry->soft_byte_limit;
+		sap1->soft_packet_limit = entry->soft_packet_limit;
+		sap1->hard_byte_limit = entry->hard_byte_limit;
+		sap1->hard_packet_limit = entry->hard_packet_limit;
+		sap1->flags = entry->flags;
+		sap1->outer_hdr_dscp = entry->outer_hdr_dscp;
+		sap1->udp_src_port = entry->udp_src_port;
+		sap1->udp_dst_port = entry->udp_dst_port;
+		sap1->bpid = entry->bpid;
+		sap1->encap_header_length = entry->encap_header_length;
+		sap1->sec_buffer_mode = entry->sec_buffer_mode;
+		sap1->output_spid = entry->output_spid;
+		sap1->soft_sec_expired = entry->soft_sec_expired;
+		sap1->hard_sec_expired = entry->hard_sec_expired;
+		if (!ipsec_sa_cache_check_due(entry)) {
+			*status |= entry->lifetime_status;
+			ret = entry->hard_expired ? IPSEC_ERROR : IPSEC_SUCCESS;
+			unlock_spinlock(&entry->lock);
+			return ret;
+		}
+	}
+	gen = entry->gen;
+	unlock_spinlock(&entry->lock);
+
+	if (hit)
+		/* Credit consumed : read only the lifetime counters */
+		fsl_read_external_data(sap1, desc_addr,
+				       IPSEC_LIFETIME_COUNTERS_SIZE,
+				       READ_METHOD);
+	else
+		fsl_read_external_data(sap1, desc_addr, (uint16_t)sizeof(*sap1),
+				       READ_METHOD);
+
+	ret = ipsec_check_lifetime(sap1, &lifetime_status);
+	*status |= lifetime_status;
+
+	lock_spinlock(&entry->lock);
+	/* Do not cache parameters read before an invalidation of the entry */
+	if ((entry->gen == gen) && (!hit || (entry->desc_addr == desc_addr))) {
+		if (!hit) {
+			entry->soft_byte_limit = sap1->soft_byte_limit;
+			entry->soft_packet_limit = sap1->soft_packet_limit;
+			entry->hard_byte_limit = sap1->hard_byte_limit;
+			entry->hard_packet_limit = sap1->hard_packet_limit;
+			entry->flags = sap1->flags;
+			entry->outer_hdr_dscp = sap1->outer_hdr_dscp;
+			entry->udp_src_port = sap1->udp_src_port;
+			entry->udp_dst_port = sap1->udp_dst_port;
+			entry->bpid = sap1->bpid;
+			entry->encap_header_length = sap1->encap_header_length;
+			entry->sec_buffer_mode = sap1->sec_buffer_mode;
+			entry->output_spid = sap1->output_spid;
+			entry->soft_sec_expired = sap1->soft_sec_expired;
+			entry->hard_sec_expired = sap1->hard_sec_expired;
+			entry->desc_addr = desc_addr;
+		}
+		entry->lifetime_status = lifetime_status;
+		entry->hard_expired = (uint8_t)(ret != IPSEC_SUCCESS);
+		/* An expired SA is not checked again until it is invalidated */
+		entry->credit = entry->hard_expired ?
+				IPSEC_SA_CACHE_CHECK_INTERVAL :
+				ipsec_sa_cache_credit(sap1);
+	}
+	unlock_spinlock(&entry->lock);
+
+	return ret;
+}
+
+/******************************************************************************/
+/* Invalidates the SA cache entry of an SA descriptor. Must be called after
+ * the SA descriptor parameters are updated. */
+static void ipsec_sa_cache_invalidate(ipsec_handle_t desc_addr)
+{
+	struct ipsec_sa_cache_entry *entry;
+
+	entry = ipsec_sa_cache_entry_get(desc_addr);
+	lock_spinlock(&entry->lock);
+	if (entry->desc_addr == desc_addr)
+		entry->desc_addr = 0;
+	/* Parameters being read from the descriptor by other tasks are not
+	 * cached */
+	entry->gen++;
+	unlock_spinlock(&entry->lock);
+}
+#else
+#define ipsec_sa_cache_invalidate(desc_addr)
+#endif /* IPSEC_SA_CACHE */
+
+#ifdef IPSEC_LIFETIME_BATCH
+/******************************************************************************/
+static inline struct ipsec_lifetime_stage *ipsec_lifetime_stage_get(
+		uint32_t core_id, ipsec_handle_t desc_addr)
+{
+	return &g_ipsec_lifetime_stage[core_id][ipsec_desc_hash(desc_addr) &
+					(IPSEC_LIFETIME_BATCH_SLOTS - 1)];
+}
+
+/******************************************************************************/
+/* Returns the safety margin used for a limit: the configured margin, capped
+ * at a fraction of the limit so that small limits do not expire on the first
+ * flush. */
+static inline uint64_t ipsec_lifetime_margin(uint64_t margin, uint64_t limit)
+{
+	limit >>= IPSEC_LIFETIME_BATCH_MARGIN_SHIFT;
+	return (margin < limit) ? margin : limit;
+}
+
+/******************************************************************************/
+/* Adds staged frames to the lifetime counters of the SA and evaluates the
+ * kilobytes/packets limits, with a safety margin for the frames staged on the
+ * other cores. */
+static void ipsec_lifetime_flush(ipsec_handle_t desc_addr, uint32_t packets,
+				 uint32_t bytes)
+{
+	struct ipsec_sa_params_part1 sap1;
+	uint64_t margin;
+	uint8_t lifetime_status = 0;
+
+	/* Counters before this update */
+	fsl_read_external_data(&sap1, desc_addr, (uint16_t)sizeof(sap1),
+			       READ_METHOD);
+
+	ste_inc_counter(IPSEC_PACKET_COUNTER_ADDR(desc_addr), packets,
+			STE_MODE_SATURATE | STE_MODE_64_BIT_CNTR_SIZE);
+	ste_inc_counter(IPSEC_BYTES_COUNTER_ADDR(desc_addr), bytes,
+			STE_MODE_SATURATE | STE_MODE_64_BIT_CNTR_SIZE);
+
+	sap1.byte_counter += bytes;
+	sap1.packet_counter += packets;
+
+	if (sap1.flags & IPSEC_FLG_LIFETIME_KB_CNTR_EN) {
+		margin = ipsec_lifetime_margin(
+				IPSEC_LIFETIME_BATCH_MARGIN_BYTES,
+				sap1.soft_byte_limit);
+		if ((sap1.byte_counter + margin) >= sap1.soft_byte_limit)
+			lifetime_status |= IPSEC_STATUS_SOFT_KB_EXPIRED;
+		margin = ipsec_lifetime_margin(
+				IPSEC_LIFETIME_BATCH_MARGIN_BYTES,
+				sap1.hard_byte_limit);
+		if ((sap1.byte_counter + margin) >= sap1.hard_byte_limit)
+			lifetime_status |= IPSEC_STATUS_HARD_KB_EXPIRED;
+	}
+	if (sap1.flags & IPSEC_FLG_LIFETIME_PKT_CNTR_EN) {
+		margin = ipsec_lifetime_margin(
+				IPSEC_LIFETIME_BATCH_MARGIN_PKTS,
+				sap1.soft_packet_limit);
+		if ((sap1.packet_counter + margin) >= sap1.soft_packet_limit)
+			lifetime_status |= IPSEC_STATUS_SOFT_PACKET_EXPIRED;
+		margin = ipsec_lifetime_margin(
+				IPSEC_LIFETIME_BATCH_MARGIN_PKTS,
+				sap1.hard_packet_limit);
+		if ((sap1.packet_counter + margin) >= sap1.hard_packet_limit)
+			lifetime_status |= IPSEC_STATUS_HARD_PACKET_EXPIRED;
+	}
+
+	/* Nothing to do if no new limit was crossed */
+	if (!(lifetime_status & ~sap1.lifetime_status))
+		return;
+
+	cdma_read_with_mutex(IPSEC_LIFETIME_STATUS_ADDR(desc_addr),
+			     CDMA_PREDMA_MUTEX_WRITE_LOCK,
+			     &sap1.lifetime_status, 1);
+	sap1.lifetime_status |= lifetime_status;
+	cdma_write_with_mutex(IPSEC_LIFETIME_STATUS_ADDR(desc_addr),
+			      CDMA_POSTDMA_MUTEX_RM_BIT,
+			      &sap1.lifetime_status, 1);
+	ipsec_sa_cache_invalidate(desc_addr);
+}
+
+/******************************************************************************/
+/* Stages a processed frame in the lifetime counters of the core. The stage
+ * is flushed when it is full, too old, or used by another SA. */
+static void ipsec_lifetime_account(ipsec_handle_t desc_addr,
+				   uint32_t byte_count)
+{
+	struct ipsec_lifetime_stage *stage;
+	ipsec_handle_t evict_addr = 0;
+	uint32_t evict_packets = 0, evict_bytes = 0;
+	uint32_t packets = 0, bytes = 0;
+	uint64_t now;
+
+	tman_get_timestamp(&now);
+	stage = ipsec_lifetime_stage_get(core_get_id(), desc_addr);
+
+	/* The stage is updated without accelerator call (no task switch) */
+	lock_spinlock(&stage->lock);
+	if (stage->desc_addr != desc_addr) {
+		if (stage->packets) {
+			evict_addr = stage->desc_addr;
+			evict_packets = stage->packets;
+			evict_bytes = stage->bytes;
+		}
+		stage->desc_addr = desc_addr;
+		stage->packets = 0;
+		stage->bytes = 0;
+		stage->timestamp = now;
+	}
+	stage->packets++;
+	stage->bytes += byte_count;
+	if ((stage->packets >= IPSEC_LIFETIME_BATCH_PKTS) ||
+	    ((now - stage->timestamp) >= IPSEC_LIFETIME_BATCH_USEC)) {
+		packets = stage->packets;
+		bytes = stage->bytes;
+		stage->packets = 0;
+		stage->bytes = 0;
+		stage->timestamp = now;
+	}
+	unlock_spinlock(&stage->lock);
+
+	if (evict_packets)
+		ipsec_lifetime_flush(evict_addr, evict_packets, evict_bytes);
+	if (packets)
+		ipsec_lifetime_flush(desc_addr, packets, bytes);
+}
+
+/******************************************************************************/
+/* Flushes the frames of an SA staged on all the cores, so that an SA which
+ * went idle is still accounted against its limits */
+static void ipsec_lifetime_flush_pending(ipsec_handle_t desc_addr)
+{
+	struct ipsec_lifetime_stage *stage;
+	uint32_t packets = 0, bytes = 0;
+	uint32_t i;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+		stage = ipsec_lifetime_stage_get(i, desc_addr);
+		lock_spinlock(&stage->lock);
+		if (stage->desc_addr == desc_addr) {
+			packets += stage->packets;
+			bytes += stage->bytes;
+			stage->packets = 0;
+			stage->bytes = 0;
+		}
+		unlock_spinlock(&stage->lock);
+	}
+
+	if (packets)
+		ipsec_lifetime_flush(desc_addr, packets, bytes);
+}
+
+/******************************************************************************/
+/* Drops the frames of a deleted SA staged on all the cores */
+static void ipsec_lifetime_discard(ipsec_handle_t desc_addr)
+{
+	struct ipsec_lifetime_stage *stage;
+	uint32_t i;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+		stage = ipsec_lifetime_stage_get(i, desc_addr);
+		lock_spinlock(&stage->lock);
+		if (stage->desc_addr == desc_addr) {
+			stage->packets = 0;
+			stage->bytes = 0;
+			stage->desc_addr = 0;
+		}
+		unlock_spinlock(&stage->lock);
+	}
+}
+#endif /* IPSEC_LIFETIME_BATCH */
+
 int ipsec_drv_init(void)
 {
 	struct mc_dprc *dprc = sys_get_unique_handle(FSL_MOD_AIOP_RC);
@@ -85,6 +492,13 @@ int ipsec_drv_init(void)
 	uint8_t bkp_pool_disable = g_app_params.app_config_flags &
 					DPNI_BACKUP_POOL_DISABLE ? 1 : 0;
 
+#ifdef IPSEC_SA_CACHE
+	memset(g_ipsec_sa_cache, 0, sizeof(g_ipsec_sa_cache));
+#endif
+#ifdef IPSEC_LIFETIME_BATCH
+	memset(g_ipsec_lifetime_stage, 0, sizeof(g_ipsec_lifetime_stage));
+#endif
+
 	/* If the new buffer is not brought by user, do nothing */
 	if (!(g_app_params.app_config_flags & IPSEC_BUFFER_ALLOCATE_ENABLE))
 		return 0;
@@ -1370,6 +1784,7 @@ int ipsec_generate_sa_params(
 	//sap.sap1.status = 0; /* 	lifetime expiry, semaphores	*/
 	sap.sap1.soft_sec_expired = 0; /* soft seconds lifetime expired */
 	sap.sap1.hard_sec_expired = 0; /* hard seconds lifetime expired */
+	sap.sap1.lifetime_status = 0; /* kilobytes/packets lifetime status */
 		
 	/* new/reuse mode */
 	if (sap.sap1.flags & IPSEC_FLG_BUFFER_REUSE) {
@@ -1685,6 +2100,12 @@ int ipsec_del_sa_descriptor(
 	ste_set_64bit_counter(IPSEC_BYTES_COUNTER_ADDR(desc_addr), 0);
 	ste_set_64bit_counter(IPSEC_DROPPED_PACKETS_ADDR(desc_addr), 0);
 
+	/* Drop the cached SA parameters */
+	ipsec_sa_cache_invalidate(desc_addr);
+#ifdef IPSEC_LIFETIME_BATCH
+	ipsec_lifetime_discard(desc_addr);
+#endif
+
 	/* Read the instance handle from params area */
 	cdma_read(
 			&instance_handle, /* void *ws_dst */
@@ -1851,53 +2272,18 @@ IPSEC_CODE_PLACEMENT int ipsec_frame_encrypt(
 	desc_addr = IPSEC_DESC_ADDR(ipsec_handle);
 
 	/*	2.	Read relevant descriptor fields with READ_METHOD. */
+	/* 	3.	Check that hard kilobyte/packet/seconds lifetime limits have 
+	 * not expired. If expired, return with error and go to END */
+#ifdef IPSEC_SA_CACHE
+	if (ipsec_sa_cache_read(desc_addr, &sap1, enc_status))
+		return IPSEC_ERROR;
+#else
 	fsl_read_external_data(&sap1, desc_addr, (uint16_t)sizeof(sap1),
 			       READ_METHOD);
 
-	/*---------------------*/
-	/* ipsec_frame_encrypt */
-	/*---------------------*/
-	
-	/* 	3.	Check that hard kilobyte/packet/seconds lifetime limits have 
-	 * not expired. If expired, return with error and go to END */
-	/* The seconds lifetime status is checked in the params[status] 
-	 * and the kilobyte/packet status is checked from the params[counters].
-	 * This is done to avoid doing mutex lock for kilobyte/packet status */
-	
-	/* Seconds Lifetime */
-	if (sap1.soft_sec_expired) {
-		if (sap1.flags & IPSEC_FLG_LIFETIME_SEC_CNTR_EN) {
-			if (sap1.soft_sec_expired) {
-				*enc_status |= IPSEC_STATUS_SOFT_SEC_EXPIRED;
-			}
-			if (sap1.hard_sec_expired) {
-				*enc_status |= IPSEC_STATUS_HARD_SEC_EXPIRED;
-				return IPSEC_ERROR;
-			}
-		}
-	}
-	
-	/* KB lifetime counters */
-	if (sap1.flags & IPSEC_FLG_LIFETIME_KB_CNTR_EN) {
-		if (sap1.byte_counter >= sap1.soft_byte_limit) {
-			*enc_status |= IPSEC_STATUS_SOFT_KB_EXPIRED;
-			if (sap1.byte_counter >= sap1.hard_byte_limit) {
-				*enc_status |= IPSEC_STATUS_HARD_KB_EXPIRED;
-				return IPSEC_ERROR;
-			}
-		}
-	}
-	
-	/* Packets lifetime counters*/
-	if (sap1.flags & IPSEC_FLG_LIFETIME_PKT_CNTR_EN) {
-		if (sap1.packet_counter >= sap1.soft_packet_limit) {
-			*enc_status |= IPSEC_STATUS_SOFT_PACKET_EXPIRED;
-			if (sap1.packet_counter >= sap1.hard_packet_limit) {
-				*enc_status |= IPSEC_STATUS_HARD_PACKET_EXPIRED;
-				return IPSEC_ERROR;
-			}
-		}
-	}
+	if (ipsec_check_lifetime(&sap1, enc_status))
+		return IPSEC_ERROR;
+#endif
 	// TODO: check if packet counter can be 32 bit
 	
 		/*---------------------*/
@@ -2497,6 +2883,9 @@ skip_l2_remove:
 		 * (STE increment + accumulate). */
 	
 	/* always count */
+#ifdef IPSEC_LIFETIME_BATCH
+	ipsec_lifetime_account(desc_addr, byte_count);
+#else
 	ste_inc_and_acc_counters(
 			IPSEC_PACKET_COUNTER_ADDR(desc_addr), /* uint64_t counter_addr */
 			byte_count,	/* uint32_t acc_value */
@@ -2505,6 +2894,7 @@ skip_l2_remove:
 			STE_MODE_COMPOUND_64_BIT_ACC_SIZE |
 			STE_MODE_COMPOUND_CNTR_SATURATE |
 			STE_MODE_COMPOUND_ACC_SATURATE));
+#endif
 	
 	/* 	19.	END */
 	return IPSEC_SUCCESS;
@@ -2550,53 +2940,18 @@ IPSEC_CODE_PLACEMENT int ipsec_frame_decrypt(
 	desc_addr = IPSEC_DESC_ADDR(ipsec_handle);
 
 	/*	2.	Read relevant descriptor fields with READ_METHOD. */
-	fsl_read_external_data(&sap1, desc_addr, (uint16_t)sizeof(sap1),
-			       READ_METHOD);
-
-	/*---------------------*/
-	/* ipsec_frame_decrypt */
-	/*---------------------*/
-	
 	/* 	3.	Check that hard kilobyte/packet/seconds lifetime limits 
 	 * have expired. If expired, return with error. go to END */
+#ifdef IPSEC_SA_CACHE
+	if (ipsec_sa_cache_read(desc_addr, &sap1, dec_status))
+		return IPSEC_ERROR;
+#else
+	fsl_read_external_data(&sap1, desc_addr, (uint16_t)sizeof(sap1),
+			       READ_METHOD);
 
-	/* The seconds lifetime status is checked in the params[status] 
-	 * and the kilobyte/packet status is checked from the params[counters].
-	 * This is done to avoid doing mutex lock for kilobyte/packet status */
-	/* Seconds Lifetime */
-	if (sap1.soft_sec_expired) {
-		if (sap1.flags & IPSEC_FLG_LIFETIME_SEC_CNTR_EN) {
-			if (sap1.soft_sec_expired) {
-				*dec_status |= IPSEC_STATUS_SOFT_SEC_EXPIRED;
-				if (sap1.hard_sec_expired) {
-					*dec_status |= IPSEC_STATUS_HARD_SEC_EXPIRED;
-					return IPSEC_ERROR;
-				}
-			}
-		}
-	}
-	
-	/* KB lifetime counters */
-	if (sap1.flags & IPSEC_FLG_LIFETIME_KB_CNTR_EN) {
-		if (sap1.byte_counter >= sap1.soft_byte_limit) {
-			*dec_status |= IPSEC_STATUS_SOFT_KB_EXPIRED;
-			if (sap1.byte_counter >= sap1.hard_byte_limit) {
-				*dec_status |= IPSEC_STATUS_HARD_KB_EXPIRED;
-				return IPSEC_ERROR;
-			}
-		}
-	}
-
-	/* Packets lifetime counters*/
-	if (sap1.flags & IPSEC_FLG_LIFETIME_PKT_CNTR_EN) {
-		if (sap1.packet_counter >= sap1.soft_packet_limit) {
-			*dec_status |= IPSEC_STATUS_SOFT_PACKET_EXPIRED;
-			if (sap1.packet_counter >= sap1.hard_packet_limit) {
-				*dec_status |= IPSEC_STATUS_HARD_PACKET_EXPIRED;
-				return IPSEC_ERROR;
-			}
-		}	 
-	}
+	if (ipsec_check_lifetime(&sap1, dec_status))
+		return IPSEC_ERROR;
+#endif
 	
 			/*---------------------*/
 			/* ipsec_frame_decrypt */
@@ -3273,6 +3628,9 @@ IPSEC_CODE_PLACEMENT int ipsec_frame_decrypt(
 	/* 20.4.	Update the bytes and/or packets lifetime counters
 	 * (STE increment + accumulate). */
 	/* always count */
+#ifdef IPSEC_LIFETIME_BATCH
+	ipsec_lifetime_account(desc_addr, byte_count);
+#else
 	ste_inc_and_acc_counters(
 			IPSEC_PACKET_COUNTER_ADDR(desc_addr), /* uint64_t counter_addr */
 			byte_count,	/* uint32_t acc_value */
@@ -3280,6 +3638,7 @@ IPSEC_CODE_PLACEMENT int ipsec_frame_decrypt(
 			STE_MODE_COMPOUND_64_BIT_ACC_SIZE |
 			STE_MODE_COMPOUND_CNTR_SATURATE |
 			STE_MODE_COMPOUND_ACC_SATURATE)); /* uint32_t flags */
+#endif
 	
 	/* END */
 	return IPSEC_SUCCESS;
@@ -3309,6 +3668,11 @@ int ipsec_get_lifetime_stats(
 	
 	desc_addr = IPSEC_DESC_ADDR(ipsec_handle);
 
+#ifdef IPSEC_LIFETIME_BATCH
+	/* Add the frames staged on all the cores to the counters */
+	ipsec_lifetime_flush_pending(desc_addr);
+#endif
+
 	/* Flush all the counter updates that are pending in the 
 	 * statistics engine request queue. */
 	ste_barrier();
@@ -3349,6 +3713,9 @@ int ipsec_decr_lifetime_counters(ipsec_handle_t ipsec_handle,
 	/* Note: there is no check of counters enable, nor current value.
 	 * Assuming that it is only called appropriately by the upper layer */
 	ipsec_handle_t desc_addr;
+#ifdef IPSEC_LIFETIME_BATCH
+	uint8_t lifetime_status = 0;
+#endif
 
 	desc_addr = IPSEC_DESC_ADDR(ipsec_handle);
 
@@ -3372,6 +3739,15 @@ int ipsec_decr_lifetime_counters(ipsec_handle_t ipsec_handle,
 				dropped_pkts_decr_val,
 				(STE_MODE_SATURATE |
 				 STE_MODE_64_BIT_CNTR_SIZE));
+
+#ifdef IPSEC_LIFETIME_BATCH
+	/* The kilobytes/packets limits are evaluated again on the next counters
+	 * flush */
+	cdma_write(IPSEC_LIFETIME_STATUS_ADDR(desc_addr), &lifetime_status, 1);
+#endif
+	/* Check the lifetime counters again */
+	ipsec_sa_cache_invalidate(desc_addr);
+
 	return IPSEC_SUCCESS;	
 } /* End of ipsec_decr_lifetime_counters */
 
@@ -3689,6 +4065,10 @@ void ipsec_tman_callback(uint64_t desc_addr, uint16_t indicator)
 		seconds_addr = IPSEC_HARD_SEC_LIMIT_ADDR(desc_addr);
 		seconds_limit_addr = &sap2.hard_seconds_limit;
 	}
+#ifdef IPSEC_LIFETIME_BATCH
+	/* Account the frames staged on all the cores, also for an idle SA */
+	ipsec_lifetime_flush_pending(desc_addr);
+#endif
 	/* Lock the soft/hard seconds expire indicator */
 	cdma_read_with_mutex(expired_addr, CDMA_PREDMA_MUTEX_WRITE_LOCK,
 			     &expired_indicator, 1);
@@ -3716,6 +4096,7 @@ void ipsec_tman_callback(uint64_t desc_addr, uint16_t indicator)
 		expired_indicator = 1;
 		cdma_write_with_mutex(expired_addr, CDMA_POSTDMA_MUTEX_RM_BIT,
 				      &expired_indicator, 1);
+		ipsec_sa_cache_invalidate(desc_addr);
 		/* Call the user call-back */
 		if (sap2.sec_callback_func)
 			sap2.sec_callback_func(sap2.sec_callback_arg,
@@ -3799,6 +4180,7 @@ static inline void ipsec_delete_timer(uint32_t indicator,
 		cdma_write_with_mutex(expired_addr,
 				      CDMA_POSTDMA_MUTEX_RM_BIT,
 				      &expired_indicator, 1);
+		ipsec_sa_cache_invalidate(desc_addr);
 		if (sap2->sec_callback_func != NULL)
 			sap2->sec_callback_func(sap2->sec_callback_arg,
 						(uint8_t)indicator);
@@ -552,6 +552,9 @@ struct ipsec_instance_params {
 #define IPSEC_HARD_SEC_EXPIRED_ADDR(ADDRESS) \
 	(ADDRESS + (offsetof(struct ipsec_sa_params_part1, hard_sec_expired)))
 
+#define IPSEC_LIFETIME_STATUS_ADDR(ADDRESS) \
+	(ADDRESS + (offsetof(struct ipsec_sa_params_part1, lifetime_status)))
+
 #define IPSEC_SOFT_SEC_LIMIT_ADDR(ADDRESS) \
 	(ADDRESS + (offsetof(struct ipsec_sa_params, sap2.soft_seconds_limit)))
 
@@ -635,8 +638,12 @@ struct ipsec_sa_params_part1 {
 	uint8_t soft_sec_expired;	/* Soft seconds lifetime expired */
 	uint8_t hard_sec_expired;	/* Hard seconds lifetime expired */
 
+	uint8_t lifetime_status;	/* Kilobytes/packets lifetime expired
+					status, evaluated on the counters
+					flush (IPSEC_LIFETIME_BATCH) */
+
 	/* Total size = */
-	/* 9*8 (72) + 2*4 (8) + 4*2 (8) + 5*1 (5) = 93 bytes */
+	/* 9*8 (72) + 2*4 (8) + 4*2 (8) + 6*1 (6) = 94 bytes */
 	/* Aligned size = 96 bytes */
 };
 /* Part 2 */
@@ -664,13 +671,113 @@ struct ipsec_sa_params_part2 {
 	/* Aligned size = 32 bytes */
 };
 
-/* Total aligned size for part 1 + part 2 = 93 + 32 = 125 bytes */
-/* Remaining = 128 - 125 = 3 bytes */
+/* Total aligned size for part 1 + part 2 = 94 + 32 = 126 bytes */
+/* Remaining = 128 - 126 = 2 bytes */
 struct ipsec_sa_params {
 		struct ipsec_sa_params_part1 sap1;
 		struct ipsec_sa_params_part2 sap2;
 };
 
+/* Largest frame, in bytes, assumed when a number of bytes is converted to a
+ * number of frames */
+#define IPSEC_MAX_FRAME_SIZE 10240
+
+/* Size of the lifetime counters at the head of the SA descriptor */
+#define IPSEC_LIFETIME_COUNTERS_SIZE 16
+
+#ifdef IPSEC_SA_CACHE
+/* Number of SA cache entries in shared RAM (power of 2) */
+#ifndef IPSEC_SA_CACHE_SIZE
+#define IPSEC_SA_CACHE_SIZE 32
+#endif
+
+/* Maximum number of frames processed with an SA cache entry between two
+ * checks of the lifetime counters */
+#ifndef IPSEC_SA_CACHE_CHECK_INTERVAL
+#define IPSEC_SA_CACHE_CHECK_INTERVAL 64
+#endif
+
+/* SA cache entry. Hot fields of ipsec_sa_params_part1, read by the
+ * encrypt/decrypt functions without accessing the SA descriptor.
+ * The lifetime counters are not cached, they are read from the SA descriptor
+ * only when the credit of frames is consumed. */
+struct ipsec_sa_cache_entry {
+	uint64_t soft_byte_limit;	/* Soft byte count limit */
+	uint64_t soft_packet_limit;	/* Soft packet limit */
+	uint64_t hard_byte_limit;	/* Hard byte count limit */
+	uint64_t hard_packet_limit;	/* Hard packet limit */
+
+	ipsec_handle_t desc_addr;	/* SA descriptor address, 0 if free */
+
+	uint32_t gen;			/* Incremented on every invalidation */
+	int32_t credit;			/* Frames until the next check of the
+					lifetime counters */
+	uint32_t lifetime_status;	/* Lifetime status of the last check */
+
+	uint32_t flags;			/* Copy of the descriptor fields */
+	uint32_t outer_hdr_dscp;
+	uint16_t udp_src_port;
+	uint16_t udp_dst_port;
+	uint16_t bpid;
+	uint16_t encap_header_length;
+	uint8_t sec_buffer_mode;
+	uint8_t output_spid;
+	uint8_t soft_sec_expired;
+	uint8_t hard_sec_expired;
+
+	uint8_t hard_expired;		/* A hard limit expired */
+	uint8_t lock;			/* Entry spinlock */
+	uint8_t pad[6];
+
+	/* Total size = 5*8 (40) + 5*4 (20) + 4*2 (8) + 12*1 (12) = 80 bytes */
+};
+#endif /* IPSEC_SA_CACHE */
+
+#ifdef IPSEC_LIFETIME_BATCH
+/* SAs staged per core (power of 2) */
+#ifndef IPSEC_LIFETIME_BATCH_SLOTS
+#define IPSEC_LIFETIME_BATCH_SLOTS 4
+#endif
+
+/* The counters staged for an SA on a core are flushed after
+ * IPSEC_LIFETIME_BATCH_PKTS frames or after IPSEC_LIFETIME_BATCH_USEC micro
+ * seconds, checked when a frame is staged */
+#ifndef IPSEC_LIFETIME_BATCH_PKTS
+#define IPSEC_LIFETIME_BATCH_PKTS 32
+#endif
+
+#ifndef IPSEC_LIFETIME_BATCH_USEC
+#define IPSEC_LIFETIME_BATCH_USEC 1000
+#endif
+
+/* Safety margin added to the counters when the limits are evaluated. The
+ * default covers the frames staged on the other cores. */
+#ifndef IPSEC_LIFETIME_BATCH_MARGIN_PKTS
+#define IPSEC_LIFETIME_BATCH_MARGIN_PKTS \
+	(IPSEC_LIFETIME_BATCH_PKTS * INTG_MAX_NUM_OF_CORES)
+#endif
+
+#ifndef IPSEC_LIFETIME_BATCH_MARGIN_BYTES
+#define IPSEC_LIFETIME_BATCH_MARGIN_BYTES \
+	((uint64_t)IPSEC_LIFETIME_BATCH_MARGIN_PKTS * IPSEC_MAX_FRAME_SIZE)
+#endif
+
+/* The margin used for a limit is at most
+ * limit >> IPSEC_LIFETIME_BATCH_MARGIN_SHIFT (default 1/16 of the limit) */
+#ifndef IPSEC_LIFETIME_BATCH_MARGIN_SHIFT
+#define IPSEC_LIFETIME_BATCH_MARGIN_SHIFT 4
+#endif
+
+/* Lifetime counters of an SA staged on a core */
+struct ipsec_lifetime_stage {
+	ipsec_handle_t desc_addr;	/* SA descriptor address */
+	uint64_t timestamp;		/* TMAN timestamp of the first frame */
+	uint32_t packets;		/* Staged packets */
+	uint32_t bytes;			/* Staged bytes */
+	uint8_t lock;			/* Stage spinlock */
+};
+#endif /* IPSEC_LIFETIME_BATCH */
+
 /* DPOVRD for Tunnel Encap mode */
 //struct dpovrd_tunnel_encap {
 //	uint8_t reserved; /* 7-0 Reserved */
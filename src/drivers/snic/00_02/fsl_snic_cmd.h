@@ -49,6 +49,9 @@ struct snic_cmd_data {
 #define SNIC_VLAN_ADD_EN		0x0004
 #define SNIC_IPF_EN			0x0008
 #define SNIC_IPSEC_EN			0x0010
+/* TCP GRO (ingress) and TCP GSO (egress) are done unless disabled */
+#define SNIC_TCP_GRO_DIS		0x0020
+#define SNIC_TCP_GSO_DIS		0x0040
 
 /* snic_cmds */
 #define SNIC_SET_MTU               0
@@ -102,7 +102,7 @@ uint64_t snic_tmi_mem_base_addr;
 
 struct tcp_gro_context_params snic_tcp_gro_param[MAX_SNIC_NO];
 uint64_t snic_gro_stats_addr;
-uint64_t snic_gro_addr;
+struct tcp_gro_flow_table snic_gro_flow_table;
 
 __HOT_CODE static inline void snic_set_enqueue_param(uint16_t snic_id,
 			struct fdma_queueing_destination_params *enqueue_params)
@@ -166,32 +166,32 @@ static void snic_set_tcp_gro_param(int id, uint64_t stats_addr, uint8_t tmi_id)
 	param->stats_addr = stats_addr;
 }
 
-static void snic_reset_tcp_gro_ctx(uint16_t id)
+static void snic_reset_tcp_gro(uint16_t id)
 {
-	tcp_gro_ctx_t tmp;
+	struct tcp_gro_stats_cntrs tmp;
 
-	snic_params[id].tcp_gro_ctx = snic_gro_addr + id * TCP_GRO_CONTEXT_SIZE;
 	snic_tcp_gro_param[id].timeout_params.gro_timeout_cb_arg = id;
 
-	/* clear GRO context */
-	cdma_ws_memory_init(tmp, TCP_GRO_CONTEXT_SIZE, 0);
-	cdma_write(snic_params[id].tcp_gro_ctx, tmp, TCP_GRO_CONTEXT_SIZE);
-
 	/* clear GRO stats */
-	cdma_write(snic_tcp_gro_param[id].stats_addr, tmp,
+	cdma_ws_memory_init(&tmp, sizeof(struct tcp_gro_stats_cntrs), 0);
+	cdma_write(snic_tcp_gro_param[id].stats_addr, &tmp,
 		   sizeof(struct tcp_gro_stats_cntrs));
 }
 
 __HOT_CODE static inline void snic_tcp_gro(uint16_t snic_id,
 			struct fdma_queueing_destination_params *enqueue_params)
 {
-	uint64_t tcp_gro_ctx = snic_params[snic_id].tcp_gro_ctx;
+	uint64_t tcp_gro_ctx;
 	struct tcp_gro_context_params *params = &snic_tcp_gro_param[snic_id];
 
-	int status = tcp_gro_aggregate_seg(tcp_gro_ctx, params,
-					   TCP_GRO_CALCULATE_TCP_CHECKSUM |
-					   TCP_GRO_CALCULATE_IP_CHECKSUM |
-					   TCP_GRO_USE_HWC_SPID);
+	/* flows of all the snics are aggregated in parallel, each in its
+	 * own context of the flow table */
+	int status = tcp_gro_flow_aggregate_seg(&snic_gro_flow_table, snic_id,
+						params,
+						TCP_GRO_CALCULATE_TCP_CHECKSUM |
+						TCP_GRO_CALCULATE_IP_CHECKSUM |
+						TCP_GRO_USE_HWC_SPID,
+						&tcp_gro_ctx);
 	if (status < 0) {
 		fdma_discard_default_frame(FDMA_DIS_FRAME_TC_BIT);
 		fdma_terminate_task();
@@ -217,8 +217,9 @@ __HOT_CODE static inline void snic_tcp_gso(uint16_t snic_id,
 #define TCP_MSS 1220
 	uint32_t total_length = (LDPAA_FD_GET_LENGTH(HWC_FD_ADDRESS));
 	tcp_gso_ctx_t tcp_gso_ctx;
+	struct tcp_gso_enqueue_params gso_enqueue_params;
+	struct tcp_gso_enqueue_stats gso_stats;
 	int status;
-	int err;
 
 	if (total_length <= TCP_MSS)
 		return;
@@ -226,50 +227,33 @@ __HOT_CODE static inline void snic_tcp_gso(uint16_t snic_id,
 	snic_set_enqueue_param(snic_id, enqueue_params);
 	tcp_gso_context_init(0, TCP_MSS, tcp_gso_ctx);
 
-	do {
-		status = tcp_gso_generate_seg(tcp_gso_ctx);
-		if (status == TCP_GSO_GEN_SEG_STATUS_SYN_RST_SET)
-			return;
-
-		err = snic_send(enqueue_params, FDMA_DIS_NO_FLAGS);
-		if (err)
-		{
-			if (status == TCP_GSO_GEN_SEG_STATUS_IN_PROCESS)
-				tcp_gso_discard_frame_remainder(tcp_gso_ctx);
-			break;
-		}
-	} while (status == TCP_GSO_GEN_SEG_STATUS_IN_PROCESS);
+	gso_enqueue_params.qd = enqueue_params->qd;
+	gso_enqueue_params.qdbin = enqueue_params->qdbin;
+	gso_enqueue_params.qd_priority = enqueue_params->qd_priority;
+	status = tcp_gso_segment_and_enqueue(tcp_gso_ctx,
+			TCP_GSO_ENQUEUE_NO_FLAGS, &gso_enqueue_params,
+			&gso_stats);
+	/* Not segmented, the packet is sent as is */
+	if ((status == TCP_GSO_GEN_SEG_STATUS_SYN_RST_SET) ||
+			(status == (-EIO)))
+		return;
 
 	fdma_terminate_task();
 	return;
 #undef TCP_MSS
 }
 
-__HOT_CODE ENTRY_POINT void snic_process_packet(void)
+__HOT_CODE static inline void snic_parse(uint16_t snic_id)
 {
 	struct parse_result *pr;
-	struct fdma_queueing_destination_params enqueue_params;
 	int32_t parse_status;
-	uint16_t snic_id;
-#if defined(ENABLE_SNIC_IPSEC) || defined(ENABLE_SNIC_VLAN)
-	uint16_t asa_length;
-#endif
-#ifdef ENABLE_SNIC_OSM
-	struct scope_status_params scope_status;
-#endif
-
-	/* get sNIC ID */
-	snic_id = SNIC_ID_GET;
-	ASSERT_COND(snic_id < MAX_SNIC_NO);
 
 	pr = (struct parse_result *)HWC_PARSE_RES_ADDRESS;
 
 	/* Need to save running-sum in parse-results LE-> BE */
 	pr->gross_running_sum = LH_SWAP(HWC_FD_ADDRESS + FD_FLC_RUNNING_SUM, 0);
 
-	osm_task_init();
 	/* todo: prpid=0?, starting HXS=0?*/
-	*((uint8_t *)HWC_SPID_ADDRESS) = snic_params[snic_id].spid;
 	default_task_params.parser_profile_id = SNIC_PRPID;
 	default_task_params.parser_starting_hxs = SNIC_HXS;
 
@@ -278,88 +262,264 @@ __HOT_CODE ENTRY_POINT void snic_process_packet(void)
 		pr_err("HF-NIC[%d]: parser status: 0x%x\n", snic_id, parse_status);
 		fdma_discard_default_frame(FDMA_DIS_FRAME_TC_BIT);
 	}
+}
+
+__HOT_CODE static inline void snic_finish(uint16_t snic_id,
+			struct fdma_queueing_destination_params *enqueue_params)
+{
+#ifdef ENABLE_SNIC_OSM
+	struct scope_status_params scope_status;
+#endif
 
-	/* Check IP & TCP */
-	if (!(PARSER_IS_IP_DEFAULT() && PARSER_IS_TCP_DEFAULT())) {
+	snic_set_enqueue_param(snic_id, enqueue_params);
+
+#ifdef ENABLE_SNIC_OSM
+	/* Get OSM status (ordering scope mode and levels) */
+	osm_get_scope(&scope_status);
+
+	if (scope_status.scope_mode == CONCURRENT) 
+	{
+		/* change to exclusive ordering mode */
+		osm_scope_transition_to_exclusive_with_increment_scope_id();
 	}
-	else if (SNIC_IS_INGRESS_GET) {
-		/* snic uses only 1 QDID so we need to have different
-		 * qd/priority for ingress than for egress */
-		default_task_params.qd_priority = 8;
+#endif
 
-		snic_tcp_gro(snic_id, &enqueue_params);
+	/* error cases */
+	snic_send(enqueue_params, FDMA_DIS_FRAME_TC_BIT);
+	fdma_terminate_task();
+}
+
+/* Ingress pipeline. Specialized pipelines pass constant features, so that
+ * only the code of the enabled features is left in them */
+__HOT_CODE static inline void snic_rx_pipeline(uint16_t snic_id,
+						uint32_t features)
+{
+	struct fdma_queueing_destination_params enqueue_params;
+#if defined(ENABLE_SNIC_IPR) || defined(ENABLE_SNIC_IPSEC)
+	struct snic_params *snic = &snic_params[snic_id];
+#endif
+
+	/* snic uses only 1 QDID so we need to have different
+	 * qd/priority for ingress than for egress */
+	default_task_params.qd_priority = 8;
+
+	/* No parse results needed when there is nothing to do */
+	if (features)
+		snic_parse(snic_id);
 
 #ifdef ENABLE_SNIC_IPR
-		/* For ingress may need to do IPR and then Remove Vlan */
-		if (snic->snic_enable_flags & SNIC_IPR_EN)
-			snic_ipr(snic);
+	/* For ingress may need to do IPR and then Remove Vlan */
+	if (features & SNIC_IPR_EN)
+		snic_ipr(snic);
 #endif
 
 #ifdef ENABLE_SNIC_VLAN
-		/*reach here if re-assembly success or regular or IPR disabled*/
-		if (snic->snic_enable_flags & SNIC_VLAN_REMOVE_EN)
-			l2_pop_vlan();
+	/*reach here if re-assembly success or regular or IPR disabled*/
+	if (features & SNIC_VLAN_REMOVE_EN)
+		l2_pop_vlan();
 #endif
 
 #ifdef ENABLE_SNIC_IPSEC
-		/* Check if ipsec transport mode is required */
-		if (snic->snic_enable_flags & SNIC_IPSEC_EN)
-			snic_ipsec_decrypt(snic);
+	/* Check if ipsec transport mode is required */
+	if (features & SNIC_IPSEC_EN)
+		snic_ipsec_decrypt(snic);
 #endif
-	}
-	/* Egress*/
-	else {
-		default_task_params.qd_priority = ((*((uint8_t *)
-				(HWC_ADC_ADDRESS +
-				ADC_WQID_PRI_OFFSET)) & ADC_WQID_MASK) >> 4);
 
+	/* GRO is last since it terminates the task */
+	if ((features & SNIC_PIPE_TCP_GRO) &&
+			PARSER_IS_IP_DEFAULT() && PARSER_IS_TCP_DEFAULT())
+		snic_tcp_gro(snic_id, &enqueue_params);
+
+	snic_finish(snic_id, &enqueue_params);
+}
+
+/* Egress pipeline, see snic_rx_pipeline() */
+__HOT_CODE static inline void snic_tx_pipeline(uint16_t snic_id,
+						uint32_t features)
+{
+	struct fdma_queueing_destination_params enqueue_params;
+#if defined(ENABLE_SNIC_IPF) || defined(ENABLE_SNIC_IPSEC)
+	struct snic_params *snic = &snic_params[snic_id];
+#endif
+#if defined(ENABLE_SNIC_IPSEC) || defined(ENABLE_SNIC_VLAN)
+	uint16_t asa_length;
+#endif
+
+	default_task_params.qd_priority = ((*((uint8_t *)
+			(HWC_ADC_ADDRESS +
+			ADC_WQID_PRI_OFFSET)) & ADC_WQID_MASK) >> 4);
+
+	/* No parse results needed when there is nothing to do */
+	if (features)
+		snic_parse(snic_id);
+
+	if ((features & SNIC_PIPE_TCP_GSO) &&
+			PARSER_IS_IP_DEFAULT() && PARSER_IS_TCP_DEFAULT())
 		snic_tcp_gso(snic_id, &enqueue_params);
 
 #if defined(ENABLE_SNIC_IPSEC) || defined(ENABLE_SNIC_VLAN)
-		/* epid defaults is not present ASA */
-		if ((snic->snic_enable_flags & SNIC_VLAN_ADD_EN) ||
-			(snic->snic_enable_flags & SNIC_IPSEC_EN))
-		{
-			fdma_read_default_frame_asa((void*)SNIC_ASA_LOCATION, 0,
-					SNIC_ASA_SIZE, &asa_length);
-		}
+	/* epid defaults is not present ASA */
+	if (features & (SNIC_VLAN_ADD_EN | SNIC_IPSEC_EN))
+		fdma_read_default_frame_asa((void*)SNIC_ASA_LOCATION, 0,
+				SNIC_ASA_SIZE, &asa_length);
 #endif
 
 #ifdef ENABLE_SNIC_IPSEC
-		/* Check if ipsec transport mode is required */
-		if (snic->snic_enable_flags & SNIC_IPSEC_EN)
-			snic_ipsec_encrypt(snic);
+	/* Check if ipsec transport mode is required */
+	if (features & SNIC_IPSEC_EN)
+		snic_ipsec_encrypt(snic);
 #endif
 
 #ifdef ENABLE_SNIC_VLAN
-		/* For Egress may need to do add Vlan and then IPF */
-		if (snic->snic_enable_flags & SNIC_VLAN_ADD_EN)
-			snic_add_vlan();
+	/* For Egress may need to do add Vlan and then IPF */
+	if (features & SNIC_VLAN_ADD_EN)
+		snic_add_vlan();
 #endif
 
 #ifdef ENABLE_SNIC_IPF
-		if ((snic->snic_enable_flags & SNIC_IPF_EN)
-			&& PARSER_IS_IP_DEFAULT())
-				snic_ipf(snic);
+	if ((features & SNIC_IPF_EN) && PARSER_IS_IP_DEFAULT())
+		snic_ipf(snic);
 #endif
-	}
 
-	snic_set_enqueue_param(snic_id, &enqueue_params);
+	snic_finish(snic_id, &enqueue_params);
+}
 
-#ifdef ENABLE_SNIC_OSM
-	/* Get OSM status (ordering scope mode and levels) */
-	osm_get_scope(&scope_status);
+/* Specialized pipelines for the common feature combinations */
+__HOT_CODE static void snic_rx_plain(uint16_t snic_id)
+{
+	snic_rx_pipeline(snic_id, 0);
+}
 
-	if (scope_status.scope_mode == CONCURRENT) 
-	{
-		/* change to exclusive ordering mode */
-		osm_scope_transition_to_exclusive_with_increment_scope_id();
+__HOT_CODE static void snic_rx_gro(uint16_t snic_id)
+{
+	snic_rx_pipeline(snic_id, SNIC_PIPE_TCP_GRO);
+}
+
+__HOT_CODE static void snic_tx_plain(uint16_t snic_id)
+{
+	snic_tx_pipeline(snic_id, 0);
+}
+
+__HOT_CODE static void snic_tx_gso(uint16_t snic_id)
+{
+	snic_tx_pipeline(snic_id, SNIC_PIPE_TCP_GSO);
+}
+
+#if defined(ENABLE_SNIC_IPSEC) && defined(ENABLE_SNIC_VLAN)
+__HOT_CODE static void snic_rx_ipsec_vlan(uint16_t snic_id)
+{
+	snic_rx_pipeline(snic_id, SNIC_IPSEC_EN | SNIC_VLAN_REMOVE_EN);
+}
+
+__HOT_CODE static void snic_tx_ipsec_vlan(uint16_t snic_id)
+{
+	snic_tx_pipeline(snic_id, SNIC_IPSEC_EN | SNIC_VLAN_ADD_EN);
+}
+#endif
+
+#ifdef ENABLE_SNIC_IPF
+__HOT_CODE static void snic_tx_gso_ipf(uint16_t snic_id)
+{
+	snic_tx_pipeline(snic_id, SNIC_PIPE_TCP_GSO | SNIC_IPF_EN);
+}
+#endif
+
+/* Any other combination, features are checked per packet */
+__HOT_CODE static void snic_rx_generic(uint16_t snic_id)
+{
+	snic_rx_pipeline(snic_id, snic_params[snic_id].pipe_features &
+			 SNIC_PIPE_RX_MASK);
+}
+
+__HOT_CODE static void snic_tx_generic(uint16_t snic_id)
+{
+	snic_tx_pipeline(snic_id, snic_params[snic_id].pipe_features &
+			 SNIC_PIPE_TX_MASK);
+}
+
+/* Called on configuration, selects the pipelines of the snic */
+static void snic_select_pipelines(uint16_t snic_id)
+{
+	struct snic_params *snic = &snic_params[snic_id];
+	uint32_t flags = snic->snic_enable_flags;
+	uint32_t features = 0;
+
+	if (!(flags & SNIC_TCP_GRO_DIS))
+		features |= SNIC_PIPE_TCP_GRO;
+	if (!(flags & SNIC_TCP_GSO_DIS))
+		features |= SNIC_PIPE_TCP_GSO;
+	/* Only the features built in */
+#ifdef ENABLE_SNIC_IPR
+	features |= flags & SNIC_IPR_EN;
+#endif
+#ifdef ENABLE_SNIC_VLAN
+	features |= flags & (SNIC_VLAN_REMOVE_EN | SNIC_VLAN_ADD_EN);
+#endif
+#ifdef ENABLE_SNIC_IPF
+	features |= flags & SNIC_IPF_EN;
+#endif
+#ifdef ENABLE_SNIC_IPSEC
+	features |= flags & SNIC_IPSEC_EN;
+#endif
+	snic->pipe_features = features;
+
+	switch (features & SNIC_PIPE_RX_MASK) {
+	case 0:
+		snic->rx_pipeline = snic_rx_plain;
+		break;
+	case SNIC_PIPE_TCP_GRO:
+		snic->rx_pipeline = snic_rx_gro;
+		break;
+#if defined(ENABLE_SNIC_IPSEC) && defined(ENABLE_SNIC_VLAN)
+	case (SNIC_IPSEC_EN | SNIC_VLAN_REMOVE_EN):
+		snic->rx_pipeline = snic_rx_ipsec_vlan;
+		break;
+#endif
+	default:
+		snic->rx_pipeline = snic_rx_generic;
+		break;
 	}
+
+	switch (features & SNIC_PIPE_TX_MASK) {
+	case 0:
+		snic->tx_pipeline = snic_tx_plain;
+		break;
+	case SNIC_PIPE_TCP_GSO:
+		snic->tx_pipeline = snic_tx_gso;
+		break;
+#if defined(ENABLE_SNIC_IPSEC) && defined(ENABLE_SNIC_VLAN)
+	case (SNIC_IPSEC_EN | SNIC_VLAN_ADD_EN):
+		snic->tx_pipeline = snic_tx_ipsec_vlan;
+		break;
 #endif
+#ifdef ENABLE_SNIC_IPF
+	case (SNIC_PIPE_TCP_GSO | SNIC_IPF_EN):
+		snic->tx_pipeline = snic_tx_gso_ipf;
+		break;
+#endif
+	default:
+		snic->tx_pipeline = snic_tx_generic;
+		break;
+	}
+}
 
-	/* error cases */
-	snic_send(&enqueue_params, FDMA_DIS_FRAME_TC_BIT);
-	fdma_terminate_task();
+__HOT_CODE ENTRY_POINT void snic_process_packet(void)
+{
+	uint16_t snic_id;
+
+	/* get sNIC ID */
+	snic_id = SNIC_ID_GET;
+	ASSERT_COND(snic_id < MAX_SNIC_NO);
+
+	osm_task_init();
+	*((uint8_t *)HWC_SPID_ADDRESS) = snic_params[snic_id].spid;
+
+	/* Pipelines were selected according to the snic features when it was
+	 * configured */
+	if (SNIC_IS_INGRESS_GET)
+		snic_params[snic_id].rx_pipeline(snic_id);
+	else
+		snic_params[snic_id].tx_pipeline(snic_id);
 }
 
 #ifdef ENABLE_SNIC_IPF
@@ -618,6 +778,7 @@ __COLD_CODE static int snic_ctrl_cb(void *dev, uint16_t cmd, uint32_t size, void
 	case SNIC_ENABLE_FLAGS:
 		SNIC_ENABLE_FLAGS_CMD(SNIC_CMD_READ);
 		snic_params[snic_id].snic_enable_flags = snic_flags;
+		snic_select_pipelines(snic_id);
 		return 0;
 	case SNIC_SET_QDID:
 		SNIC_SET_QDID_CMD(SNIC_CMD_READ);
@@ -635,7 +796,8 @@ __COLD_CODE static int snic_ctrl_cb(void *dev, uint16_t cmd, uint32_t size, void
 			{
 				snic_params[i].valid = TRUE;
 				snic_id = (uint16_t)i;
-				snic_reset_tcp_gro_ctx(snic_id);
+				snic_reset_tcp_gro(snic_id);
+				snic_select_pipelines(snic_id);
 				break;
 			}
 		}
@@ -648,6 +810,7 @@ __COLD_CODE static int snic_ctrl_cb(void *dev, uint16_t cmd, uint32_t size, void
 	case SNIC_UNREGISTER:
 		SNIC_UNREGISTER_CMD(SNIC_CMD_READ);
 		memset(&snic_params[snic_id], 0, sizeof(struct snic_params));
+		snic_select_pipelines(snic_id);
 		return 0;
 	case SNIC_IPSEC_CREATE_INSTANCE:
 #ifdef ENABLE_SNIC_IPSEC
@@ -1269,6 +1432,8 @@ int aiop_snic_init(void)
 		return status;
 	}
 	memset(snic_params, 0, sizeof(snic_params));
+	for (i = 0; i < MAX_SNIC_NO; i++)
+		snic_select_pipelines((uint16_t)i);
 
 	status = fsl_get_mem((SNIC_MAX_NO_OF_TIMERS + 4) * 64, mem_pid,
 		    SNIC_MEM_ALIGN, &snic_tmi_mem_base_addr);
@@ -1285,8 +1450,8 @@ int aiop_snic_init(void)
 		return status;
 	}
 
-	size = MAX_SNIC_NO * TCP_GRO_CONTEXT_SIZE;
-	status = fsl_get_mem(size, mem_pid, SNIC_MEM_ALIGN, &snic_gro_addr);
+	status = tcp_gro_flow_table_init(&snic_gro_flow_table,
+					 SNIC_GRO_MAX_FLOWS, mem_pid);
 	if (status) {
 		pr_info("sNIC:Failed to allocate memory for TCP GRO.\n");
 		return status;
@@ -1325,7 +1490,7 @@ void snic_tman_confirm_cb(tman_arg_8B_t arg1, tman_arg_2B_t arg2)
 			TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
 	fsl_put_mem(snic_tmi_mem_base_addr);
 	fsl_put_mem(snic_gro_stats_addr);
-	fsl_put_mem(snic_gro_addr);
+	tcp_gro_flow_table_free(&snic_gro_flow_table);
 	fdma_terminate_task();
 }
 
@@ -78,6 +78,8 @@
 #define MAX_OPEN_IPR_FRAMES     100
 /* Maximum number of IPsec SAs per nic */
 #define MAX_SA_NO               100
+/* Maximum number of TCP GRO flows of all snics */
+#define SNIC_GRO_MAX_FLOWS      256
 
 /* ipsec_flags */
 #define SNIC_IPSEC_IPV4_ENABLE  0x01
@@ -91,6 +93,15 @@
 #define FASWO1 0x50
 #define FASWO2 0x54
 
+/* Pipeline features. The optional features use the bits of the snic enable
+ * flags, GRO and GSO are on unless disabled by the flags */
+#define SNIC_PIPE_TCP_GRO	0x00010000
+#define SNIC_PIPE_TCP_GSO	0x00020000
+#define SNIC_PIPE_RX_MASK	(SNIC_PIPE_TCP_GRO | SNIC_IPR_EN | \
+				SNIC_VLAN_REMOVE_EN | SNIC_IPSEC_EN)
+#define SNIC_PIPE_TX_MASK	(SNIC_PIPE_TCP_GSO | SNIC_VLAN_ADD_EN | \
+				SNIC_IPF_EN | SNIC_IPSEC_EN)
+
 /** @} */ /* end of SNIC_MACROS */
 
 /**************************************************************************//**
@@ -101,6 +112,13 @@
 @{
 *//***************************************************************************/
 
+/**************************************************************************//**
+@Description	Packet processing pipeline of a snic direction. Selected by
+		snic_select_pipelines() when the snic is configured, it
+		terminates the task.
+*//***************************************************************************/
+typedef void (*snic_pipeline_t)(uint16_t snic_id);
+
 /**************************************************************************//**
 @Description	AIOP snic parameters
 *//***************************************************************************/
@@ -126,6 +144,12 @@ struct snic_params {
 	uint32_t valid;
 	/** Storage profile ID */
 	uint8_t spid;
+	/** Features of the pipelines, used by the generic ones */
+	uint32_t pipe_features;
+	/** Ingress pipeline */
+	snic_pipeline_t rx_pipeline;
+	/** Egress pipeline */
+	snic_pipeline_t tx_pipeline;
 
 #ifdef ENABLE_SNIC_IPSEC
 	uint8_t ipsec_ipv4_key_size;
@@ -137,9 +161,6 @@ struct snic_params {
 	uint8_t dec_ipsec_ipv6_key_id;
 	uint8_t ipsec_flags;
 #endif
-
-	/** Address of the TCP GRO internal context */
-	uint64_t tcp_gro_ctx;
 };
 
 /** @} */ /* end of SNIC_STRUCTS */
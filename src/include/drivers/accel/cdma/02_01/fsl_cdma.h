@@ -466,6 +466,34 @@ void cdma_refcount_get(
 		uint64_t context_address,
 		uint32_t *refcount_value);
 
+#ifdef CDMA_MUTEX_PROFILE
+/*************************************************************************//**
+@Function	cdma_mutex_prof_dump
+
+@Description	Print the take count, the wait time and the hold time of the
+		mutexes sampled by the CDMA mutex profile (CDMA_MUTEX_PROFILE).
+		Debug function.
+
+@Return		None.
+
+@Cautions	In this function the task yields.
+
+*//***************************************************************************/
+void cdma_mutex_prof_dump(void);
+
+/*************************************************************************//**
+@Function	cdma_mutex_prof_reset
+
+@Description	Clear the CDMA mutex profile (CDMA_MUTEX_PROFILE).
+
+@Return		None.
+
+@Cautions	In this function the task yields.
+
+*//***************************************************************************/
+void cdma_mutex_prof_reset(void);
+#endif /* CDMA_MUTEX_PROFILE */
+
 /** @} end of group CDMA_Functions */
 /** @} */ /* end of FSL_CDMA */
 /** @} */ /* end of ACCEL */
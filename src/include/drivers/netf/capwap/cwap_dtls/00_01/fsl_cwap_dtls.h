@@ -181,6 +181,22 @@ struct cwap_dtls_sa_descriptor_params {
 	uint16_t spid;
 };
 
+/**************************************************************************//**
+ @Description   CAPWAP DTLS SA statistics
+*//***************************************************************************/
+struct cwap_dtls_sa_stats {
+	/** Frames encrypted/decrypted by the SA */
+	uint64_t packets;
+	/** Bytes of the frames encrypted/decrypted by the SA (SEC output) */
+	uint64_t bytes;
+	/** Frames dropped by the anti-replay check (late or replayed) */
+	uint64_t ar_dropped;
+	/** Frames with failed ICV check */
+	uint64_t icv_failed;
+	/** Frames failed for another SEC error or a buffer pool depletion */
+	uint64_t errors;
+};
+
 /** @} */ /* end of FSL_CWAP_DTLS_STRUCTS */
 
 /**************************************************************************//**
@@ -336,6 +352,24 @@ void cwap_dtls_get_ar_info(cwap_dtls_sa_handle_t sa_handle,
 			   uint64_t *sequence_number,
 			   uint32_t anti_replay_bitmap[4]);
 
+/**************************************************************************//**
+@Function	cwap_dtls_get_sa_stats
+
+@Description	This function returns the SA statistics. The counters are kept
+		in the SA internal parameters; the SEC shared descriptor is not
+		accessed.
+
+@Param[in]	sa_handle - CAPWAP DTLS SA handle
+@Param[out]	stats - SA statistics.
+
+@Return		0 - success
+
+@Cautions	With CWAP_DTLS_STATS_BATCH the frames staged on the cores are
+		included. A frame being staged on another core may be missed.
+*//****************************************************************************/
+int cwap_dtls_get_sa_stats(cwap_dtls_sa_handle_t sa_handle,
+			   struct cwap_dtls_sa_stats *stats);
+
 /**************************************************************************//**
 @Function	cwap_dtls_frame_decrypt
 
@@ -381,6 +381,50 @@ struct tcp_gro_context_params {
 	uint64_t stats_addr;
 };
 
+/**************************************************************************//**
+@Description	TCP GRO flow table.
+
+		The flow table keeps one TCP GRO context per flow, looked up
+		by the hash of the flow 5-tuple. The user allocates this
+		structure (in shared RAM) and initializes it with
+		\ref tcp_gro_flow_table_init(). The fields are internal.
+*//***************************************************************************/
+struct tcp_gro_flow_table {
+		/** Address (in HW buffers) of the table buckets. */
+	uint64_t buckets_addr;
+		/** Address (in HW buffers) of the flows TCP GRO contexts. */
+	uint64_t ctx_addr;
+		/** Address (in HW buffers) of the flow records. */
+	uint64_t records_addr;
+		/** Address (in HW buffers) of the statistics counters
+		 * (\ref tcp_gro_flow_stats). */
+	uint64_t stats_addr;
+		/** Number of buckets - 1. */
+	uint32_t bucket_mask;
+};
+
+/**************************************************************************//**
+@Description	TCP GRO flow table statistics.
+*//***************************************************************************/
+struct tcp_gro_flow_stats {
+		/** Segments which found their flow context. */
+	uint32_t	hits;
+		/** Segments which created a flow context. */
+	uint32_t	misses;
+		/** Flows evicted with an open aggregation. */
+	uint32_t	evictions;
+		/** Segments returned as is since no flow context was
+		 * available. */
+	uint32_t	bypassed;
+		/** Segments received by \ref tcp_gro_flow_aggregate_seg(). */
+	uint32_t	seg_num;
+		/** Packets returned to the user (aggregated, flushed or
+		 * bypassed). */
+	uint32_t	pkt_num;
+		/** Average segments per returned packet, in hundredths
+		 * (computed by \ref tcp_gro_flow_table_get_stats()). */
+	uint32_t	agg_ratio;
+};
 
 /** @} */ /* end of GRO_STRUCTS */
 
@@ -473,6 +517,121 @@ int tcp_gro_aggregate_seg(
 int tcp_gro_flush_aggregation(
 		uint64_t tcp_gro_context_addr);
 
+/**************************************************************************//**
+@Function	tcp_gro_flow_table_init
+
+@Description	This function initializes a TCP GRO flow table.
+
+		The table holds up to max_flows flows, rounded up to a power of
+		2. The flows are kept in buckets of 4, each bucket is protected
+		by its own CDMA mutex so that segments of different buckets
+		are aggregated in parallel. When a bucket is full the least
+		recently used flow is reused; if it has an open aggregation,
+		its timer is forced to expire and the timeout callback returns
+		the aggregation.
+
+@Param[in]	table - The flow table to initialize.
+@Param[in]	max_flows - Maximum number of flows.
+@Param[in]	mem_pid - Memory partition of the table
+		(\ref memory_partition_id).
+
+@Return		0 on success, or negative value on error.
+
+@Retval		EINVAL - Invalid number of flows.
+@Retval		ENOMEM - Not enough memory in the partition.
+
+@Cautions	In this function the task yields.
+*//***************************************************************************/
+int tcp_gro_flow_table_init(
+		struct tcp_gro_flow_table *table,
+		uint32_t max_flows,
+		int mem_pid);
+
+/**************************************************************************//**
+@Function	tcp_gro_flow_table_free
+
+@Description	This function releases the memory of a TCP GRO flow table.
+
+@Param[in]	table - The flow table.
+
+@Return		None.
+
+@Cautions	The timers of the table aggregations must be deleted (e.g.
+		their TMAN instance is deleted) before the table is freed.
+*//***************************************************************************/
+void tcp_gro_flow_table_free(struct tcp_gro_flow_table *table);
+
+/**************************************************************************//**
+@Function	tcp_gro_flow_aggregate_seg
+
+@Description	This function aggregates a TCP segment in the context of its
+		flow in the flow table, as \ref tcp_gro_aggregate_seg().
+
+		The flow is identified by the outer IP addresses, the TCP
+		ports and the user tag. A flow context is created for a new
+		flow.
+
+@Param[in]	table - The flow table.
+@Param[in]	tag - User tag of the flow (e.g. interface id).
+@Param[in]	params - Pointer to the TCP GRO aggregation parameters \ref
+		tcp_gro_context_params. The timeout callback function and
+		argument are the ones of the segment which created the flow
+		context.
+@Param[in]	flags - Please refer to \ref TCP_GRO_AGG_FLAGS.
+@Param[out]	tcp_gro_context_addr - Address (in HW buffers) of the flow
+		TCP GRO context. It should be passed to
+		\ref tcp_gro_flush_aggregation() on \ref TCP_GRO_FLUSH_REQUIRED.
+
+@Return		GRO Status, or negative value on error, as
+		\ref tcp_gro_aggregate_seg().
+		\ref TCP_GRO_SEG_AGG_DONE is returned with the segment as is
+		in the default frame location when no flow context is
+		available for a new flow. The segments of an evicted flow are
+		added to its aggregation, which is returned by the timer
+		expiration.
+
+@Cautions	The segment should be parsed and its outer L4 should be TCP.
+@Cautions	This function requires 2 CDMA mutexes (out of 4 available per
+		task).
+@Cautions	In this function the task yields.
+*//***************************************************************************/
+int tcp_gro_flow_aggregate_seg(
+		struct tcp_gro_flow_table *table,
+		uint16_t tag,
+		struct tcp_gro_context_params *params,
+		uint32_t flags,
+		uint64_t *tcp_gro_context_addr);
+
+/**************************************************************************//**
+@Function	tcp_gro_flow_table_get_stats
+
+@Description	This function reads the statistics of a TCP GRO flow table.
+
+@Param[in]	table - The flow table.
+@Param[out]	stats - The flow table statistics.
+
+@Return		None.
+
+@Cautions	In this function the task yields.
+*//***************************************************************************/
+void tcp_gro_flow_table_get_stats(
+		struct tcp_gro_flow_table *table,
+		struct tcp_gro_flow_stats *stats);
+
+#ifdef GRO_CTX_DMA_STATS
+/**************************************************************************//**
+@Function	tcp_gro_get_ctx_dma_bytes
+
+@Description	This function returns the number of bytes of TCP GRO contexts
+		transferred by CDMA on all the cores (GRO_CTX_DMA_STATS build).
+
+@Return		Number of bytes.
+
+@Cautions	The per core counts are read without synchronization.
+*//***************************************************************************/
+uint64_t tcp_gro_get_ctx_dma_bytes(void);
+#endif /* GRO_CTX_DMA_STATS */
+
 /** @} */ /* end of GRO_Functions */
 /** @} */ /* end of FSL_AIOP_GRO */
 /** @} */ /* end of group AIOP_L4 */
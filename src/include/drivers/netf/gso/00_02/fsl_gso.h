@@ -98,6 +98,24 @@ typedef uint8_t tcp_gso_ctx_t[TCP_GSO_CONTEXT_SIZE];
 
 /** @} */ /* end of TCP_GSO_FLAGS */
 
+/**************************************************************************//**
+ @Group	TCP_GSO_ENQUEUE_FLAGS TCP GSO Enqueue Flags
+
+ @Description Flags for tcp_gso_segment_and_enqueue() function.
+
+ @{
+*//***************************************************************************/
+
+	/** No flags indication. Segments are enqueued to the queueing
+	 * destination (QD, QD bin, QD priority) of
+	 * \ref tcp_gso_enqueue_params. */
+#define TCP_GSO_ENQUEUE_NO_FLAGS	0x00000000
+	/** Enqueue the segments to the frame queue ID of
+	 * \ref tcp_gso_enqueue_params instead of the queueing destination. */
+#define TCP_GSO_ENQUEUE_FQID		0x00000001
+
+/** @} */ /* end of TCP_GSO_ENQUEUE_FLAGS */
+
 /**************************************************************************//**
 @Group	TCP_GSO_GENERATE_SEG_STATUS  TCP GSO Statuses
 
@@ -122,6 +140,45 @@ typedef uint8_t tcp_gso_ctx_t[TCP_GSO_CONTEXT_SIZE];
 
 /** @} */ /* end of GSO_MACROS */
 
+/**************************************************************************//**
+@Group		GSO_STRUCTS GSO Structures
+
+@Description	GSO Structures
+
+@{
+*//***************************************************************************/
+
+/**************************************************************************//**
+@Description	TCP GSO enqueue destination, used by
+		tcp_gso_segment_and_enqueue().
+*//***************************************************************************/
+struct tcp_gso_enqueue_params {
+	/** Frame queue ID. Used when \ref TCP_GSO_ENQUEUE_FQID is set. */
+	uint32_t fqid;
+	/** Queueing destination. Used when \ref TCP_GSO_ENQUEUE_FQID is not
+	 * set. */
+	uint16_t qd;
+	/** Distribution hash value passed to QMan for the enqueue. */
+	uint16_t qdbin;
+	/** Queueing destination priority. */
+	uint8_t	qd_priority;
+	/** Padding */
+	uint8_t	pad[3];
+};
+
+/**************************************************************************//**
+@Description	TCP GSO enqueue statistics, returned by
+		tcp_gso_segment_and_enqueue().
+*//***************************************************************************/
+struct tcp_gso_enqueue_stats {
+	/** Number of segments enqueued. */
+	uint32_t segments;
+	/** Number of bytes enqueued (sum of the segments FD length). */
+	uint32_t bytes;
+};
+
+/** @} */ /* end of GSO_STRUCTS */
+
 
 /**************************************************************************//**
 @Group		GSO_Functions GSO Functions
@@ -176,6 +233,56 @@ typedef uint8_t tcp_gso_ctx_t[TCP_GSO_CONTEXT_SIZE];
 int tcp_gso_generate_seg(
 		tcp_gso_ctx_t tcp_gso_context_addr);
 
+/**************************************************************************//**
+@Function	tcp_gso_segment_and_enqueue
+
+@Description	This function segments the packet located at the default
+		frame location in the workspace and enqueues all the segments
+		to the given destination, in a single call.
+
+		The first segment is generated as by tcp_gso_generate_seg().
+		Its IP and TCP headers are then used as a template: the one's
+		complement sum of the header fields which are the same in all
+		the segments is computed once, and for each following segment
+		only the sequence number, the flags, the urgent pointer, the IP
+		length and ID are stamped and the IP and TCP checksums are
+		updated from the template sum. The parser is not run on these
+		segments.
+
+		Ordering: see \ref tcp_gso_generate_seg().
+
+@Param[in]	tcp_gso_context_addr - Address to the TCP GSO internal context.
+		Must be initialized by gso_context_init() prior to this call.
+		Must be aligned to Frame Descriptor size.
+@Param[in]	flags - Please refer to \ref TCP_GSO_ENQUEUE_FLAGS.
+@Param[in]	enqueue_params - Enqueue destination of the segments.
+@Param[out]	stats - Number of segments and bytes enqueued. Valid also
+		when an error is returned.
+
+@Return		\ref TCP_GSO_GEN_SEG_STATUS_DONE,
+		\ref TCP_GSO_GEN_SEG_STATUS_SYN_RST_SET, or negative value on
+		error.
+
+@Retval		ENOMEM - Received packet cannot be stored, or a segment
+		cannot be enqueued, due to buffer pool depletion. The packet
+		(or its remaining segments) is discarded.
+@Retval		EIO - Received packet FD contain errors (FD.err != 0).
+		The packet was not segmented and is left in the default frame
+		location.
+@Retval		EBUSY - Enqueue failed due to congestion in QMAN. The
+		remaining segments are discarded.
+
+@Cautions	Except for \ref TCP_GSO_GEN_SEG_STATUS_SYN_RST_SET and EIO, no
+		packet resides in the default frame location in the task
+		defaults following this function.\n
+		In this Service Routine the task yields.
+*//***************************************************************************/
+int tcp_gso_segment_and_enqueue(
+		tcp_gso_ctx_t tcp_gso_context_addr,
+		uint32_t flags,
+		struct tcp_gso_enqueue_params *enqueue_params,
+		struct tcp_gso_enqueue_stats *stats);
+
 /**************************************************************************//**
 @Function	tcp_gso_discard_frame_remainder
 
@@ -84,6 +84,25 @@ typedef uint8_t ipf_ctx_t[IPF_CONTEXT_SIZE];
 
 /** @} */ /* end of IPF_FLAGS */
 
+/**************************************************************************//**
+ @Group	IPF_ENQUEUE_FLAGS IPF Enqueue Flags
+
+ @Description	Flags for ipf_fragment_and_enqueue() function
+
+ @{
+*//***************************************************************************/
+/** No flags indication. Fragments are enqueued to the queueing destination
+ * (QD, QD bin, QD priority) of \ref ipf_enqueue_params. */
+#define IPF_ENQUEUE_NO_FLAGS		0x00000000
+/** Enqueue the fragments to the frame queue ID of \ref ipf_enqueue_params
+ * instead of the queueing destination. */
+#define IPF_ENQUEUE_FQID		0x00000001
+/** Move to exclusive ordering mode (incrementing the scope ID) just before
+ * the last fragment is enqueued, if the task is in concurrent mode. */
+#define IPF_ENQUEUE_EXCLUSIVE_LAST	0x00000002
+
+/** @} */ /* end of IPF_ENQUEUE_FLAGS */
+
 /**************************************************************************//**
 @Group	IPF_GENERATE_FRAG_STATUS  IPF Return Status
 
@@ -104,6 +123,33 @@ typedef uint8_t ipf_ctx_t[IPF_CONTEXT_SIZE];
 
 /** @} */ /* end of IPF_MACROS */
 
+/**************************************************************************//**
+@Group		IPF_STRUCTS IPF Structures
+
+@Description	AIOP IPF Structures
+
+@{
+*//***************************************************************************/
+
+/**************************************************************************//**
+@Description	IPF enqueue destination, used by ipf_fragment_and_enqueue().
+*//***************************************************************************/
+struct ipf_enqueue_params {
+	/** Frame queue ID. Used when \ref IPF_ENQUEUE_FQID is set. */
+	uint32_t fqid;
+	/** Queueing destination. Used when \ref IPF_ENQUEUE_FQID is not
+	 * set. */
+	uint16_t qd;
+	/** Distribution hash value passed to QMan for the enqueue. */
+	uint16_t qdbin;
+	/** Queueing destination priority. */
+	uint8_t	qd_priority;
+	/** Padding */
+	uint8_t	pad[3];
+};
+
+/** @} */ /* end of IPF_STRUCTS */
+
 
 /**************************************************************************//**
 @Group		IPF_Functions IPF Functions
@@ -192,6 +238,53 @@ int ipf_generate_frag(ipf_ctx_t ipf_context_addr);
 *//***************************************************************************/
 int ipf_discard_frame_remainder(ipf_ctx_t ipf_context_addr);
 
+/**************************************************************************//**
+@Function	ipf_fragment_and_enqueue
+
+@Description	This function fragments the packet located at the default
+		frame location in the workspace and enqueues all the fragments
+		to the given destination, in a single call.
+
+		The IP header of the first fragment is the template of all the
+		following fragments: it is built once and carried at the head
+		of the remaining frame, and only the fragment offset, the M
+		flag, the length and the IPv4 header checksum are stamped on
+		each fragment. Since the fragments are enqueued straight away,
+		the parser is not run on them.
+
+		Ordering: see \ref ipf_generate_frag(). When
+		\ref IPF_ENQUEUE_EXCLUSIVE_LAST is set, the transition to
+		exclusive mode is done before the last fragment is enqueued.
+
+@Param[in]	ipf_context_addr - Address to the IPF internal context. Must
+		be initialized by ipf_context_init() prior to this call.
+@Param[in]	flags - Please refer to \ref IPF_ENQUEUE_FLAGS.
+@Param[in]	enqueue_params - Enqueue destination of the fragments.
+
+@Return		Number of fragments enqueued, or negative value on error.
+
+@Retval		0 - Fragmentation not done due to Length > MTU but DF=1. The
+		packet is left in the default frame location.
+@Retval		ENOMEM - Received packet cannot be stored due to buffer pool
+		depletion. When no fragment was enqueued yet, the packet is
+		left in the default frame location, as in
+		\ref ipf_generate_frag(). Otherwise the remaining fragments are
+		discarded.
+@Retval		EIO - Received packet FD contain errors (FD.err != 0).
+		The packet is left in the default frame location, as in
+		\ref ipf_generate_frag().
+@Retval		EBUSY - Enqueue failed due to congestion in QMAN. The
+		remaining fragments are discarded.
+
+@Cautions	Same as \ref ipf_generate_frag().\n
+		On success and on enqueue error no packet resides in the
+		default frame location in the task defaults.\n
+		Fragments enqueued before an error are not recalled.\n
+		In this Service Routine the task yields.
+*//***************************************************************************/
+int ipf_fragment_and_enqueue(ipf_ctx_t ipf_context_addr, uint32_t flags,
+				struct ipf_enqueue_params *enqueue_params);
+
 /**************************************************************************//**
 @Function	ipf_context_init
 
@@ -150,6 +150,18 @@ struct ipr_params {
 	 * This instance may use up to
 	 * (max_open_frames_ipv4+max_open_frames_ipv6+1) timers. */
 	uint8_t	  tmi_id;
+	/** Number of entries on a line of the IPR software fragment table.
+	 * Valid only if IPR_MODE_SW_TABLE_GEOMETRY flag is set. */
+	uint8_t	  sw_table_ways;
+	/** Number of overflow lines of the IPR software fragment table,
+	 * shared by all the lines. They hold the fragment keys of full lines.
+	 * 0 - the fragments of a new frame on a full line are not reassembled.
+	 * Valid only if IPR_MODE_SW_TABLE_GEOMETRY flag is set. */
+	uint16_t  sw_table_overflow_lines;
+	/** Number of lines of the IPR software fragment table.
+	 * Must be a power of 2.
+	 * Valid only if IPR_MODE_SW_TABLE_GEOMETRY flag is set. */
+	uint32_t  sw_table_bins;
 };
 
 /**************************************************************************//**
@@ -283,6 +295,14 @@ struct extended_stats_cntrs {
  */
 #define IPR_MODE_TMI 0x02000000
 
+/** The geometry of the IPR software fragment table is given by
+ *  ipr_params::sw_table_bins, ipr_params::sw_table_ways and
+ *  ipr_params::sw_table_overflow_lines. If reset, the default geometry is
+ *  used. Relevant only when the service layer is built with
+ *  USE_IPR_SW_TABLE.
+ */
+#define IPR_MODE_SW_TABLE_GEOMETRY 0x01000000
+
 /** @} */ /* end of group FSL_IPRInsModeBits */
 
 
@@ -620,6 +640,30 @@ void ipr_modify_timeout_value_ipv6(ipr_instance_handle_t ipr_instance,
 void ipr_get_reass_frm_cntr(ipr_instance_handle_t ipr_instance,
 				uint32_t flags, uint32_t *reass_frm_cntr);
 
+/**************************************************************************//**
+@Function	ipr_get_sw_table_line_full_cntr
+
+@Description	Returns the number of fragments of the given instance that
+		found their IPR software fragment table line full.
+
+		These fragments are stored in the table overflow lines, or
+		dropped if the overflow lines are full too.
+		The counter is incremented only when the service layer is built
+		with USE_IPR_SW_TABLE.
+
+@Param[in]	ipr_instance - The IPR instance handle.
+@Param[in]	flags - \link FSL_IPRStatsFlags flags \endlink
+@Param[out]	line_full_cntr - The number of IPv4/IPv6 fragments that found
+		their table line full.
+		This pointer should points within workspace.
+
+@Return		None
+
+@Cautions	None.
+*//***************************************************************************/
+void ipr_get_sw_table_line_full_cntr(ipr_instance_handle_t ipr_instance,
+				     uint32_t flags, uint32_t *line_full_cntr);
+
 /** @} */ /* end of group FSL_IPR_Functions */
 /** @} */ /* end of group FSL_IPR */
 /** @} */ /* end of group NETF */
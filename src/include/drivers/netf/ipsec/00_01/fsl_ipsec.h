@@ -646,6 +646,10 @@ int ipsec_del_sa_descriptor(ipsec_handle_t ipsec_handle);
 			IPSEC_FLG_LIFETIME_KB_CNTR_EN, IPSEC_FLG_LIFETIME_PKT_CNTR_EN
 			and IPSEC_FLG_LIFETIME_SEC_CNTR_EN flags
 		
+		Note: with IPSEC_LIFETIME_BATCH the frames staged on the cores
+			are included. A frame being staged on another core may
+			be missed.
+		
 @Param[in]	ipsec_handle - IPsec handle.
 @Param[out]	bytes - number of bytes processed by this SA.
 @Param[out]	packets - number of packets processed by this SA.
@@ -213,6 +213,106 @@ Note, this functionality is not relevant for AIOP client.
 int cmdif_resp_read(struct cmdif_desc *cidesc, int priority);
 
 
+/**************************************************************************//**
+@Description   Command interface batch descriptor.
+
+Used by cmdif_batch_send() to pack several no response commands into one frame.
+The user should not modify it.
+*//***************************************************************************/
+struct cmdif_batch {
+	struct cmdif_desc *cidesc;
+	/*!< Session which was setup by cmdif_open() */
+	uint64_t data;
+	/*!< Buffer split into 2 halves, one is filled while the other one
+	 * is handled by server */
+	uint32_t half_size;
+	/*!< Size of each half of the buffer */
+	uint32_t offset;
+	/*!< Write offset inside the current half */
+	uint16_t count;
+	/*!< Number of commands in the current half */
+	uint16_t max_cmds;
+	/*!< Flush after this number of commands */
+	uint8_t  half;
+	/*!< Current half of the buffer */
+	uint8_t  priority;
+	/*!< High or low priority queue */
+};
+
+/**************************************************************************//**
+@Function	cmdif_batch_init
+
+@Description	Setup batch descriptor for sending no response commands
+		packed into one frame.
+
+The commands are sent when max_cmds commands were packed, when the current half
+of the buffer is full or upon cmdif_batch_flush().
+There is no flush timeout: the packed commands wait until one of the above, the
+caller must call cmdif_batch_flush() when it stops sending (e.g. at the end of
+a burst or from its own periodic timer).
+Sharing of the same batch by multiple threads requires locks outside CMDIF API.
+Note, it is supported only by AIOP client.
+
+@Param[in]	batch       Batch descriptor to be setup.
+@Param[in]	cidesc      Command interface descriptor which was setup by
+		cmdif_open().
+@Param[in]	priority    High or low priority queue.
+		See \ref CMDIF_SEND_ATTRIBUTES.
+@Param[in]	data        8 bytes aligned buffer for the packed commands.
+		This address should be accessible by Server and Client.
+		It should be virtual address that belongs to current SW context.
+		This buffer can be freed only after all the commands have been
+		handled by server.
+@Param[in]	size        Size of the data buffer.
+@Param[in]	max_cmds    Maximal number of commands inside one frame.
+
+@Return		0 on success; error code, otherwise.
+ *//***************************************************************************/
+int cmdif_batch_init(struct cmdif_batch *batch,
+		struct cmdif_desc *cidesc,
+		int priority,
+		uint64_t data,
+		uint32_t size,
+		uint16_t max_cmds);
+
+/**************************************************************************//**
+@Function	cmdif_batch_send
+
+@Description	Pack no response command into the batch frame.
+
+The command data is copied, the data buffer can be reused upon return.
+Note, it is supported only by AIOP client.
+
+@Param[in]	batch      Batch descriptor which was setup by cmdif_batch_init().
+@Param[in]	cmd_id     Id which represent command on the module that was
+		registered on Server; Application may use bits 11-0.
+		Must be set with \ref CMDIF_NORESP_CMD.
+@Param[in]	size       Size of the data.
+@Param[in]	data       Data of the command, in local memory.
+
+@Return		0 on success; -EBUSY if server didn't finish handling the
+		previous frame sent from the same half of the buffer;
+		error code, otherwise.
+ *//***************************************************************************/
+int cmdif_batch_send(struct cmdif_batch *batch,
+		uint16_t cmd_id,
+		uint32_t size,
+		void *data);
+
+/**************************************************************************//**
+@Function	cmdif_batch_flush
+
+@Description	Send the commands that were packed by cmdif_batch_send().
+
+The packed commands are not sent by any timer, the caller must flush them.
+Note, it is supported only by AIOP client.
+
+@Param[in]	batch      Batch descriptor which was setup by cmdif_batch_init().
+
+@Return		0 on success; error code, otherwise.
+ *//***************************************************************************/
+int cmdif_batch_flush(struct cmdif_batch *batch);
+
 /** @} *//* end of cmdif_client_g group */
 
 #endif /* __FSL_CMDIF_CLIENT_H */
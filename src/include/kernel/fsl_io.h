@@ -186,9 +186,13 @@ static inline void iowrite8(uint8_t val, volatile uint8_t *addr)
  *//***************************************************************************/
 static inline void iowrite8_wt(uint8_t val, volatile uint8_t *addr)
 {
+#if __COVERITY__
+	*addr = val;
+#else
 	register uint8_t rval = val;
 	register volatile uint8_t *raddr = addr;
 	asm {stbwtx rval, 0, raddr}	
+#endif
 	core_memory_barrier();
 }
 
@@ -60,6 +60,72 @@
 *//***************************************************************************/
 int rcu_synchronize();
 
+/**************************************************************************//**
+@Description	Prototype of the callback invoked by rcu_synchronize_nb() after
+		a grace period.
+
+@Param[in]	param  The parameter given to rcu_synchronize_nb().
+*//***************************************************************************/
+typedef void (rcu_cb_t)(uint64_t param);
+
+/**************************************************************************//**
+@Description	RCU statistics, see rcu_get_stats()
+*//***************************************************************************/
+struct rcu_stats {
+	uint64_t callbacks;		/**< Callbacks invoked */
+	uint64_t grace_periods;		/**< Grace periods completed */
+	uint64_t gp_latency_sum;	/**< Sum of grace period latencies */
+	uint32_t gp_latency_min;	/**< Grace period latency, usec */
+	uint32_t gp_latency_max;	/**< Grace period latency, usec */
+	uint32_t gp_latency_avg;	/**< Grace period latency, usec */
+	uint32_t callbacks_per_sec;	/**< Average since the RCU init */
+	uint32_t enqueue_errors;	/**< Failed rcu_synchronize_nb() */
+};
+
+/**************************************************************************//**
+@Function	rcu_synchronize_nb
+
+@Description	Invoke the callback after all the tasks that are holding
+		resources at the time of this call are done.
+
+		The callback is staged on the calling core and does not wait
+		for the RCU lock of the calling task.
+		The callbacks of all the cores are collected by a grace period
+		task and invoked as a batch when the grace period ends; several
+		grace periods may be in progress.
+		The grace period task is scheduled sooner as more callbacks are
+		staged.
+
+@Param[in]	cb  Callback to be invoked from the grace period task.
+@Param[in]	param  Parameter for the callback.
+
+@Return		0 on succees, POSIX error code otherwise  \ref error_g.
+		The callback is never invoked when an error is returned.
+@Retval		ENOMEM - The callbacks staged on this core were not collected
+		yet, try again later.
+@Retval		EBUSY - A grace period could not be scheduled, try again
+		later.
+
+@Cautions	The callback runs in the grace period task together with the
+		rest of the batch; it should not wait on other tasks.
+@Cautions	This function may perform a task switch.
+*//***************************************************************************/
+int rcu_synchronize_nb(rcu_cb_t *cb, uint64_t param);
+
+/**************************************************************************//**
+@Function	rcu_get_stats
+
+@Description	Get the statistics of the grace periods of
+		rcu_synchronize_nb().
+
+@Param[out]	stats  Statistics since the RCU init.
+
+@Return		0 on succees, POSIX error code otherwise  \ref error_g
+
+@Cautions	In this function the task yields
+*//***************************************************************************/
+int rcu_get_stats(struct rcu_stats *stats);
+
 /**************************************************************************//**
 @Function	rcu_read_unlock
 
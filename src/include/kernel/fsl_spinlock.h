@@ -100,6 +100,107 @@ void unlock_spinlock(uint8_t *spinlock);
 
 /** @} end of group Spinlock_Functions */
 
+/**************************************************************************//**
+@Group			Queued_Spinlock_Functions Queued spin-lock functions
+
+@Description	AIOP queued (ticket) spin-lock operations functions.
+
+				A queued spin-lock grants the lock in the order it was
+				requested, and a waiting task backs off exponentially (and in
+				proportion to the number of tasks ahead of it) between polls,
+				instead of retrying the reservation in a tight loop.
+				It is a drop-in replacement for the spin-lock at lock sites
+				contended by many cores.
+
+@{
+*//***************************************************************************/
+
+/**************************************************************************//**
+@Description	Queued spin-lock. Must be placed in the shared memory.
+*//***************************************************************************/
+struct qspinlock {
+	/** Next ticket to hand out */
+	volatile uint16_t next;
+	/** Ticket holding the lock */
+	volatile uint16_t owner;
+#ifdef SPINLOCK_STATS
+	/** Number of times the lock was acquired */
+	uint32_t acquired;
+	/** Number of times the lock was acquired after waiting */
+	uint32_t contended;
+	/** Longest wait, in polls of the lock */
+	uint32_t max_spin;
+	/** Lock name, for qspinlock_stats_dump() */
+	const char *name;
+	/** Next lock in the statistics list */
+	struct qspinlock *next_lock;
+#endif /* SPINLOCK_STATS */
+};
+
+/*************************************************************************//**
+@Function		qspinlock_init
+
+@Description	Initialize a queued spin-lock (unlocked).
+				When SPINLOCK_STATS is defined, the lock statistics are
+				cleared and the lock is added to the locks reported by
+				qspinlock_stats_dump().
+
+@Param[in]		lock - Pointer to the lock.
+@Param[in]		name - Lock name. Must be a constant string.
+
+@Return			None.
+
+@Cautions		A lock must be initialized once. A zeroed lock is unlocked
+				but it is not reported by qspinlock_stats_dump().
+
+*//***************************************************************************/
+void qspinlock_init(struct qspinlock *lock, const char *name);
+
+/*************************************************************************//**
+@Function		lock_qspinlock
+
+@Description	Lock the queued spin-lock. Tasks get the lock in the order
+				they called this function.
+
+@Param[in]		lock - Pointer to the lock.
+
+@Return			None.
+
+@Cautions		It is not allowed to yield if the task holds a lock.
+@Cautions		Every lock_qspinlock function must be followed by an
+				unlock_qspinlock function to release the lock.
+
+*//***************************************************************************/
+void lock_qspinlock(struct qspinlock *lock);
+
+/*************************************************************************//**
+@Function		unlock_qspinlock
+
+@Description	Unlock the queued spin-lock, the lock is passed to the next
+				waiting task.
+
+@Param[in]		lock - Pointer to the lock.
+
+@Return			None.
+
+*//***************************************************************************/
+void unlock_qspinlock(struct qspinlock *lock);
+
+#ifdef SPINLOCK_STATS
+/*************************************************************************//**
+@Function		qspinlock_stats_dump
+
+@Description	Print the statistics of all the initialized queued spin-locks.
+				Debug function.
+
+@Return			None.
+
+*//***************************************************************************/
+void qspinlock_stats_dump(void);
+#endif /* SPINLOCK_STATS */
+
+/** @} end of group Queued_Spinlock_Functions */
+
 /**************************************************************************//**
 @Group			atomic_operations Atomic operations
 
@@ -78,6 +78,46 @@ int fsl_get_time_ms(uint32_t *time);
 *//***************************************************************************/
 int fsl_get_time_since_epoch_ms(uint64_t *time);
 
+/**************************************************************************//**
+@Function   fsl_get_time_ms_coarse
+
+ @Description  Function returns the time as the number of milliseconds
+		since midnight (UTC), as of the last refresh of the coarse
+		time.
+
+ @Param[out]  time - if not null, time is filled with milliseconds since
+                     midnight UTC.
+
+ @Return   standard POSIX error code.
+ 	 	 For error posix refer to
+		\ref error_g
+
+ @Cautions	The time is refreshed every TIME_COARSE_PERIOD_USEC micro
+		seconds when the TIME_COARSE build flag is defined. Otherwise
+		it is the same as fsl_get_time_ms().
+*//***************************************************************************/
+int fsl_get_time_ms_coarse(uint32_t *time);
+
+/**************************************************************************//**
+@Function   fsl_get_time_us_coarse
+
+@Description  returns the time as the number of microseconds since epoch,
+		1970-01-01 00:00:00 +0000 (UTC), as of the last refresh of the
+		coarse time.
+
+ @Param[out]  time - if not null, time is filled with microseconds since
+                     epoch UTC.
+
+ @Return   standard POSIX error code.
+ 	 	 For error posix refer to
+		\ref error_g
+
+ @Cautions	The time is refreshed every TIME_COARSE_PERIOD_USEC micro
+		seconds when the TIME_COARSE build flag is defined. Otherwise
+		it is read from the time base and the TMAN time stamp.
+*//***************************************************************************/
+int fsl_get_time_us_coarse(uint64_t *time);
+
 /** @} */ /* end of time_g Time Queries group */
 
 #endif /* __FSL_TIME_H */
@@ -167,6 +167,8 @@ int evmng_register(
 
 @Cautions	The application can unregister from event only in app_init or at
 		runtime.
+		The registration is released after all the tasks that may be
+		raising the event are done; in this function the task yields.
 
 @Return	0 on success;
 	error code, otherwise. For error posix refer to \ref error_g
@@ -194,6 +196,9 @@ int evmng_unregister(
 
 @Param[in]	event_data  A pointer to data specific for event
 
+@Cautions	The callback functions are invoked without any lock held, they
+		may register or unregister events.
+
 @Return	0 on success;
 	error code, otherwise. For error posix refer to \ref error_g
 *//***************************************************************************/
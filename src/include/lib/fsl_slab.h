@@ -69,6 +69,13 @@ struct slab;
 /** Decrement reference count caused the reference count to
 	go to zero. (not an error) */
 #define SLAB_CDMA_REFCOUNT_DECREMENT_TO_ZERO   0x03
+/**Flag to use for requesting a per core buffers cache (magazine) in front
+ * of the slab pool*/
+#define SLAB_MAGAZINE_FLAG                     0x04
+
+/**Flag to use in slab_acquire_bulk() for acquiring as many buffers as
+ * available (default - all or nothing)*/
+#define SLAB_BULK_BEST_EFFORT_FLAG             0x01
 
 
 /**************************************************************************//**
@@ -97,6 +104,13 @@ struct slab_debug_info {
 	 * Is difference between max
 	 * number of buffers and number of allocated buffers */
 	uint32_t num_buff_free;
+	/** Number of free buffers cached by the per core magazines.
+	 * Valid only for pools created with SLAB_MAGAZINE_FLAG */
+	uint32_t magazine_cached_buffs;
+	/** Number of acquire/release served by the per core magazines */
+	uint32_t magazine_hits;
+	/** Number of acquire/release which had to access the slab pool */
+	uint32_t magazine_misses;
 };
 
 /**************************************************************************//**
@@ -147,6 +161,9 @@ typedef void (slab_release_cb_t)(uint64_t);
 @Param[in]	flags               Set it to 0 for default slab creation.
 		For extra pools managed in DDR with lower
 		performance set: SLAB_DDR_MANAGEMENT_FLAG
+		For a per core buffers cache in front of the pool
+		set: SLAB_MAGAZINE_FLAG (if no magazine is available
+		the pool is created without it)
 @Param[in]	release_cb          Function to be called on release of buffer
 @Param[out]	slab                Handle to new pool is returned through here.
 
@@ -171,6 +188,8 @@ int slab_create(uint32_t    committed_buffs,
 @Function	slab_free
 
 @Description	Free a specific pool and all it's buffers.
+		Buffers cached by the pool magazines are returned to the
+		pool before it is freed.
 
 @Param[in]	slab - Handle to memory pool.
 
@@ -211,6 +230,47 @@ int slab_acquire(struct slab *slab, uint64_t *buff);
 *//***************************************************************************/
 int slab_release(struct slab *slab, uint64_t buff);
 
+/**************************************************************************//**
+@Function	slab_acquire_bulk
+
+@Description	Get a number of buffers from a pool;
+		the pool accounting is updated once for all the buffers.
+		AIOP HW pool buffers reference counter will be set to 1.
+
+@Param[in]	slab - Handle to memory pool.
+@Param[in]	num_buffs - Number of requested buffers.
+@Param[out]	buffs - Array of at least num_buffs entries for the acquired
+		buffers.
+@Param[in]	flags - Set it to 0 for all or nothing acquire.
+		For acquiring as many buffers as available set:
+		SLAB_BULK_BEST_EFFORT_FLAG
+
+@Return		Number of acquired buffers (num_buffs unless
+		SLAB_BULK_BEST_EFFORT_FLAG is set) - on success,
+		-ENOMEM - no buffer available,
+		-EINVAL - not a valid slab handle
+ *//***************************************************************************/
+int slab_acquire_bulk(struct slab *slab, uint32_t num_buffs, uint64_t *buffs,
+                      uint32_t flags);
+
+/**************************************************************************//**
+@Function	slab_release_bulk
+
+@Description	Return a number of buffers back to a pool;
+		the pool accounting is updated once for all the buffers.
+		AIOP HW pool buffers reference counter must be 0, it
+		is NOT decremented.
+
+@Param[in]	slab - Handle to memory pool.
+@Param[in]	num_buffs - Number of buffers to return.
+@Param[in]	buffs - Array of the buffers to return.
+
+@Return		0      - on success,
+		-EINVAL - not a valid slab handle
+		-EFAULT - bad address, trying to release to wrong slab
+*//***************************************************************************/
+int slab_release_bulk(struct slab *slab, uint32_t num_buffs, uint64_t *buffs);
+
 /**************************************************************************//**
 @Function	slab_refcount_incr
 
@@ -329,6 +329,154 @@ int cmdif_send(struct cmdif_desc *cidesc,
 	return 0;
 }
 
+#define BATCH_IC_GET(BATCH) \
+	((struct icontext *)(&(((struct cmdif_dev *) \
+		(BATCH)->cidesc->dev)->reserved[0])))
+
+#define BATCH_ADDR_GET(BATCH) \
+	((BATCH)->data + (BATCH)->half * (BATCH)->half_size)
+
+int cmdif_batch_init(struct cmdif_batch *batch,
+		struct cmdif_desc *cidesc,
+		int pr,
+		uint64_t data,
+		uint32_t size,
+		uint16_t max_cmds)
+{
+	struct cmdif_batch_hdr hdr;
+
+#ifdef DEBUG
+	if ((batch == NULL) || (cidesc == NULL) || (cidesc->dev == NULL) ||
+		(data == 0) || (data & 0x7))
+		return -EINVAL;
+#endif
+
+	if ((max_cmds == 0) ||
+		(size < 2 * (sizeof(hdr) + sizeof(struct cmdif_batch_cmd))))
+		return -EINVAL;
+
+	batch->cidesc    = cidesc;
+	batch->data      = data;
+	batch->half_size = (size / 2) & ~((uint32_t)0x7);
+	batch->offset    = sizeof(hdr);
+	batch->count     = 0;
+	batch->max_cmds  = max_cmds;
+	batch->half      = 0;
+	batch->priority  = (uint8_t)pr;
+
+	/* Both halves are free */
+	hdr.done     = 1;
+	hdr.reserved = 0;
+	hdr.count    = 0;
+	hdr.size     = 0;
+	icontext_dma_write(BATCH_IC_GET(batch), sizeof(hdr), &hdr, data);
+	icontext_dma_write(BATCH_IC_GET(batch), sizeof(hdr), &hdr,
+	                   data + batch->half_size);
+
+	return 0;
+}
+
+int cmdif_batch_flush(struct cmdif_batch *batch)
+{
+	struct cmdif_fd fd;
+	struct cmdif_batch_hdr hdr;
+	uint64_t addr;
+
+#ifdef DEBUG
+	if ((batch == NULL) || (batch->cidesc == NULL))
+		return -EINVAL;
+#endif
+
+	if (batch->count == 0)
+		return 0;
+
+	addr = BATCH_ADDR_GET(batch);
+
+	hdr.done     = 0;
+	hdr.reserved = 0;
+	hdr.count    = CPU_TO_SRV16(batch->count);
+	hdr.size     = CPU_TO_SRV32(batch->offset - sizeof(hdr));
+	icontext_dma_write(BATCH_IC_GET(batch), sizeof(hdr), &hdr, addr);
+
+	CMDIF_CMD_FD_SET(&fd, (struct cmdif_dev *)batch->cidesc->dev, addr,
+	                 batch->offset, CMD_ID_BATCH);
+
+	_fd.addr   = CPU_TO_LE64(fd.u_addr.d_addr);
+	_fd.flc    = CPU_TO_LE64(fd.u_flc.flc);
+	_fd.frc    = CPU_TO_LE32(fd.u_frc.frc);
+	_fd.length = CPU_TO_LE32(fd.d_size);
+
+	/* The packed commands are kept for retry */
+	if (send_fd(batch->priority, batch->cidesc->regs))
+		return -EINVAL;
+
+	/* Fill the other half while server handles this one */
+	batch->half  ^= 1;
+	batch->offset = sizeof(hdr);
+	batch->count  = 0;
+
+	sl_pr_debug("PASSED sent batch of %d commands\n", CPU_TO_SRV16(hdr.count));
+	return 0;
+}
+
+int cmdif_batch_send(struct cmdif_batch *batch,
+		uint16_t cmd_id,
+		uint32_t size,
+		void *data)
+{
+	struct cmdif_batch_cmd cmd;
+	struct cmdif_batch_hdr hdr;
+	uint32_t rec_size;
+	uint64_t addr;
+	int err;
+
+#ifdef DEBUG
+	if ((batch == NULL) || (batch->cidesc == NULL) ||
+		((data == NULL) && (size > 0)))
+		return -EINVAL;
+#endif
+
+	/* Only no response application commands can be packed */
+	if ((cmd_id & 0xF000) != CMDIF_NORESP_CMD)
+		return -ENOTSUP;
+
+	rec_size = sizeof(cmd) + ((size + 7) & ~((uint32_t)7));
+	if ((sizeof(hdr) + rec_size) > batch->half_size)
+		return -ENOMEM;
+
+	if ((batch->offset + rec_size) > batch->half_size) {
+		err = cmdif_batch_flush(batch);
+		if (err)
+			return err;
+	}
+
+	addr = BATCH_ADDR_GET(batch);
+
+	if (batch->count == 0) {
+		/* This half may still be in use by the server */
+		icontext_dma_read(BATCH_IC_GET(batch), sizeof(hdr), addr, &hdr);
+		if (!hdr.done)
+			return -EBUSY;
+	}
+
+	cmd.cmid     = CPU_TO_SRV16(cmd_id);
+	cmd.reserved = 0;
+	cmd.size     = CPU_TO_SRV32(size);
+	addr += batch->offset;
+	icontext_dma_write(BATCH_IC_GET(batch), sizeof(cmd), &cmd, addr);
+	if (size > 0)
+		icontext_dma_write(BATCH_IC_GET(batch), (uint16_t)size, data,
+		                   addr + sizeof(cmd));
+
+	batch->offset += rec_size;
+	batch->count++;
+
+	if (batch->count >= batch->max_cmds)
+		return cmdif_batch_flush(batch);
+
+	return 0;
+}
+
 void cmdif_cl_isr(void)
 {
 	struct cmdif_fd fd;
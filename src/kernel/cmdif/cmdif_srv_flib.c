@@ -365,6 +365,45 @@ __COLD_CODE int cmdif_srv_close(void *srv,
 	return 0;
 }
 
+CMDIF_CODE_PLACEMENT static int batch_cmd(struct cmdif_srv *srv,
+		uint16_t auth_id,
+		uint32_t size,
+		struct cmdif_batch_hdr *hdr)
+{
+	uint8_t  *rec = (uint8_t *)(hdr + 1);
+	uint8_t  *end = (uint8_t *)hdr + size;
+	uint16_t count = CPU_TO_SRV16(hdr->count);
+	uint32_t cmd_size;
+	struct cmdif_batch_cmd *cmd;
+	int    err = 0;
+	int    i;
+
+	for (i = 0; i < count; i++) {
+		cmd = (struct cmdif_batch_cmd *)rec;
+		if ((rec + sizeof(*cmd)) > end) {
+			err = -EINVAL;
+			break;
+		}
+		cmd_size = CPU_TO_SRV32(cmd->size);
+		rec += sizeof(*cmd);
+		if ((rec + cmd_size) > end) {
+			err = -EINVAL;
+			break;
+		}
+
+		if (CTRL_CB(auth_id, CPU_TO_SRV16(cmd->cmid), cmd_size,
+		            (void *)((cmd_size > 0) ? rec : NULL)))
+			err = -EIO;
+
+		rec += (cmd_size + 7) & ~((uint32_t)7);
+	}
+
+	/* Client may reuse this buffer from now on */
+	hdr->done = 1;
+
+	return err;
+}
+
 CMDIF_CODE_PLACEMENT int cmdif_srv_cmd(void *_srv,
 		struct cmdif_fd *cfd,
 		void   *v_addr,
@@ -391,6 +430,11 @@ CMDIF_CODE_PLACEMENT int cmdif_srv_cmd(void *_srv,
 	if (*send_resp && (cfd_out == NULL))
 		return -EINVAL;
 
+	if (in_cfd.u_flc.cmd.cmid == CMD_ID_BATCH)
+		return batch_cmd(srv, in_cfd.u_flc.cmd.auth_id, cfd->d_size,
+		                 (struct cmdif_batch_hdr *)((v_addr != NULL) ?
+		                 v_addr : cfd->u_addr.d_addr));
+
 	err = CTRL_CB(in_cfd.u_flc.cmd.auth_id, \
 	              in_cfd.u_flc.cmd.cmid, \
 	              cfd->d_size, \
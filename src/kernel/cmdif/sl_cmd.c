@@ -27,6 +27,7 @@
 #include "fsl_sl_cmd.h"
 #include "fsl_errors.h"
 #include "fsl_dbg.h"
+#include "fsl_cdma.h"
 
 int sl_cmd_ctrl_cb(void *dev, uint16_t cmd, uint32_t size, void *data);
 int sl_cmd_open_cb(uint8_t instance_id, void **dev);
@@ -42,6 +43,14 @@ int sl_cmd_ctrl_cb(void *dev, uint16_t cmd, uint32_t size, void *data)
 		ASSERT_COND(size > 0);
 		ASSERT_COND(data);
 		break;
+#ifdef CDMA_MUTEX_PROFILE
+	case SL_CMD_CDMA_MUTEX_PROF_DUMP:
+		cdma_mutex_prof_dump();
+		break;
+	case SL_CMD_CDMA_MUTEX_PROF_RESET:
+		cdma_mutex_prof_reset();
+		break;
+#endif
 	default:
 		break;
 	}
@@ -28,6 +28,7 @@
 #include "fsl_fdma.h"
 #include "fsl_dbg.h"
 #include "fsl_stdlib.h"
+#include "fsl_log.h"
 #include <string.h>
 
 extern __TASK uint32_t exception_flag;
@@ -55,6 +56,9 @@ void exception_handler(char *filename,
 	pr_err("Fatal error encountered in file: %s, line: %d\n", filename, line);
 	pr_err("function: %s\n", function_name);
 	pr_err("error: %s\n", message);
+#ifdef LOG_PER_CORE_STAGING
+	log_flush();
+#endif
 
 	exception_flag = 0;
 	fdma_terminate_task();
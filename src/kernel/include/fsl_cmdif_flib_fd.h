@@ -101,6 +101,30 @@ struct cmdif_fd {
 	}u_addr;
 };
 
+#define CMD_ID_BATCH          0xD000
+/*!< Special command that carries several no response commands in one frame.
+ * FD[ADDR] points to struct cmdif_batch_hdr followed by
+ * cmdif_batch_hdr.count records, each one is struct cmdif_batch_cmd followed
+ * by the command data padded to 8 bytes */
+
+/*! Header of the #CMD_ID_BATCH frame data */
+struct cmdif_batch_hdr {
+	uint8_t  done;
+	/*!< Set to 1 by server after all the commands have been handled */
+	uint8_t  reserved;
+	uint16_t count;
+	/*!< Number of commands inside this frame */
+	uint32_t size;
+	/*!< Size of the command records after this header */
+};
+
+/*! Command record inside #CMD_ID_BATCH frame data */
+struct cmdif_batch_cmd {
+	uint16_t cmid;     /*!< Command id */
+	uint16_t reserved;
+	uint32_t size;     /*!< Size of the command data, without padding */
+};
+
 /** @} *//* end of cmdif_flib_g group */
 
 #endif /* __FSL_CMDIF_FD_H */
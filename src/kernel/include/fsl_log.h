@@ -60,4 +60,23 @@ int log_init(void);
 *//***************************************************************************/
 void log_print_to_buffer(char *str, uint16_t str_length);
 
+#ifdef LOG_PER_CORE_STAGING
+/**************************************************************************//**
+ @Function      log_flush
+
+ @Description   Writes the messages staged by all the cores to the log buffer,
+                ordered by their time stamp.
+
+                At runtime log_print_to_buffer() only stages the message on
+                the calling core; the staged messages are written when a core
+                reaches LOG_STAGE_FLUSH_THRESHOLD, every
+                LOG_STAGE_FLUSH_PERIOD_USEC by a TMAN timer or when this
+                function is called.
+
+ @Cautions      This function use fdma accelerator and cann't be called under
+                spinlock.
+*//***************************************************************************/
+void log_flush(void);
+#endif /* LOG_PER_CORE_STAGING */
+
 #endif /* __FSL_LOG_H */
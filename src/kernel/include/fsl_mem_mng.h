@@ -143,6 +143,50 @@ typedef struct t_mem_mng_partition_info
 
 } t_mem_mng_partition_info;
 
+/**************************************************************************//**
+ @Description   Size classes of a memory partition
+
+                Allocations of up to MEM_MNG_SC_MAX_SIZE bytes (size and
+                alignment) are served from a region that is reserved from
+                the slob of the partition when it is registered. The region is
+                carved in chunks of MEM_MNG_SC_CHUNK_SIZE bytes, each chunk
+                belongs to one size class. Freed objects are linked through
+                their first 8 bytes, the list heads are kept here.
+ *//***************************************************************************/
+#define MEM_MNG_SC_MIN_SIZE         16
+#define MEM_MNG_SC_NUM_CLASSES      6   /**< 16 to 512 bytes */
+#define MEM_MNG_SC_MAX_SIZE         \
+	(MEM_MNG_SC_MIN_SIZE << (MEM_MNG_SC_NUM_CLASSES - 1))
+#define MEM_MNG_SC_CHUNK_SHIFT      10
+#define MEM_MNG_SC_CHUNK_SIZE       (1 << MEM_MNG_SC_CHUNK_SHIFT)
+#define MEM_MNG_SC_MAX_CHUNKS       32
+/**< Up to this part of a partition is reserved for the size classes */
+#define MEM_MNG_SC_REGION_RATIO     16
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+#define MEM_MNG_HIST_BUCKETS        16  /**< log2 of time base ticks */
+#define MEM_MNG_HIST_SC             0
+#define MEM_MNG_HIST_SLOB           1
+#endif /* MEM_MNG_ALLOC_HISTOGRAM */
+
+struct mem_mng_size_class
+{
+    uint64_t    free_head;  /**< Freed objects, 0 - empty */
+    uint64_t    bump;       /**< Next unused object of the last chunk */
+    uint8_t     lock;       /**< Spinlock for malloc partitions */
+};
+
+struct mem_mng_sc
+{
+    struct mem_mng_size_class   classes[MEM_MNG_SC_NUM_CLASSES];
+    uint64_t    base;       /**< Region base; 0 - no size classes */
+    uint32_t    num_chunks;
+    uint32_t    next_chunk; /**< Protected by the partition spinlock */
+    uint8_t     chunk_class[MEM_MNG_SC_MAX_CHUNKS];
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+    int32_t     hist[2][MEM_MNG_HIST_BUCKETS];
+#endif /* MEM_MNG_ALLOC_HISTOGRAM */
+};
+
 /**************************************************************************//**
  @Description   Memory management partition control structure
  *//***************************************************************************/
@@ -150,6 +194,7 @@ typedef struct t_mem_mng_phys_addr_alloc_partition
 {
     int                              id;             /**< Partition ID */
     uint64_t                         h_mem_manager;   /**< Memory manager handle */
+    struct mem_mng_sc                sc;             /**< Small allocations */
     t_mem_mng_phys_addr_alloc_info   info;           /**< Partition information */
     uint8_t *                        lock;
     int                              was_initialized;
@@ -162,6 +207,7 @@ typedef struct t_mem_mng_partition
 {
     int                     id;             /**< Partition ID */
     uint64_t                h_mem_manager;    /**< Memory manager handle */
+    struct mem_mng_sc       sc;             /**< Small allocations */
     int                     enable_debug;    /**< '1' to track malloc/free operations */
     int                     was_initialized;
     list_t                  mem_debug_list;   /**< List of allocation entries (for debug) */
@@ -451,6 +497,20 @@ uint32_t sys_get_mem_partition_attributes(int partition_id);
 void sys_print_mem_partition_debug_info(int partition_id, int report_leaks);
 #endif
 
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+/**************************************************************************//**
+ @Function      sys_print_mem_alloc_histogram
+
+ @Description   Prints the allocation latency histograms of the given memory
+                partition, for the size classes and for the slob.
+
+ @Param[in]     partition_id - Memory partition ID
+
+ @Return        None.
+*//***************************************************************************/
+void sys_print_mem_alloc_histogram(int partition_id);
+#endif /* MEM_MNG_ALLOC_HISTOGRAM */
+
 /**************************************************************************//**
 @Function      sys_get_phys_mem
 
@@ -495,7 +555,7 @@ void  sys_mem_partitions_init_complete();
 
 extern const  uint32_t g_boot_mem_mng_size;
 #define MEM_PART_SYSTEM_DDR1_BOOT_MEM_MNG MEM_PART_LAST+1
-#define MEMORY_PARTITIONS\
+#define MEMORY_PARTITIONS \
 {   /* Memory partition ID                  Phys. Addr.  Virt. Addr.  Size , Attributes */\
 	{MEM_PART_SYSTEM_DDR1_BOOT_MEM_MNG,  0xFFFFFFFF,  0xFFFFFFFF, g_boot_mem_mng_size,\
 	        MEMORY_ATTR_NONE, "BOOT MEMORY MANAGER"},\
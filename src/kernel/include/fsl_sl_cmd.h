@@ -40,5 +40,11 @@
 #define SL_CMD_NEW_BUFF		(0x1 | CMDIF_NORESP_CMD)
 /*!<  Command for new buffer */
 
+#define SL_CMD_CDMA_MUTEX_PROF_DUMP	(0x2 | CMDIF_NORESP_CMD)
+/*!<  Command for printing the CDMA mutex profile (CDMA_MUTEX_PROFILE) */
+
+#define SL_CMD_CDMA_MUTEX_PROF_RESET	(0x3 | CMDIF_NORESP_CMD)
+/*!<  Command for clearing the CDMA mutex profile (CDMA_MUTEX_PROFILE) */
+
 
 #endif /* __FSL_SL_CMDIF_H */
@@ -35,6 +35,16 @@
 
 #include "log.h"
 #include "fsl_dbg.h"
+#ifdef LOG_PER_CORE_STAGING
+#include "general.h"
+#include "fsl_system.h"
+#include "fsl_core_booke.h"
+#include "fsl_string.h"
+#include "fsl_tman.h"
+#include "fsl_fdma.h"
+#include "fsl_malloc.h"
+#include "tman_inline.h"
+#endif
 
 /*******************************************************************
  	 	 	 	 	 Global Variables
@@ -47,6 +57,17 @@ uint32_t g_log_last_byte;
 
 extern struct aiop_init_info g_init_data;
 extern struct icontext icontext_aiop;
+
+#ifdef LOG_PER_CORE_STAGING
+struct log_stage g_log_stage[INTG_MAX_NUM_OF_CORES];
+/* Merge buffer of the flusher, protected by the log mutex */
+static char g_log_flush_batch[LOG_FLUSH_BATCH_SIZE];
+/* TMI of the periodic flush timer, 0 if there is no periodic flush */
+static uint64_t g_log_flush_tmi_addr;
+static uint8_t g_log_flush_tmi_id;
+
+#define LOG_MUTEX_ID	((uint64_t)&g_log_last_byte)
+#endif
 /*******************************************************************
  	 	 	 	 	 Static Functions
  *******************************************************************/
@@ -87,8 +108,10 @@ int log_init()
 }
 /*
  * @Cautions - Calling this function from not protected by mutex print is dangerous.
+ * The string is written before last_byte so the header never points past
+ * the written data.
  * */
-void log_print_to_buffer(char *str, uint16_t str_length)
+static void log_write(char *str, uint16_t str_length)
 {
 	uint32_t local_counter;
 	uint16_t second_write_len;
@@ -107,19 +130,12 @@ void log_print_to_buffer(char *str, uint16_t str_length)
 	if(local_counter + str_length <= g_log_buf_size /*Buf size without the log header*/)
 	{
 		/* Enough buffer*/
-		g_log_last_byte += str_length;
-		log_last_byte = CPU_TO_LE32(g_log_last_byte);
-		icontext_dma_write(&icontext_aiop,
-		                   (uint16_t)sizeof(log_last_byte),
-		                   &(log_last_byte),
-		                   g_log_buf_phys_address +
-		                   LOG_HEADER_LAST_BYTE_OFFSET);
 		icontext_dma_write(&icontext_aiop,
 		                   str_length,
 		                   str,
 		                   /* Log address + size of the header + offset from the end of the header */
 		                   g_log_buf_phys_address + g_log_buf_start + local_counter);
-
+		g_log_last_byte += str_length;
 	}
 	else /*cyclic write needed*/
 	{
@@ -127,16 +143,6 @@ void log_print_to_buffer(char *str, uint16_t str_length)
 		second_write_len = str_length - (uint16_t)(g_log_buf_size - local_counter);
 		str_length -= second_write_len; /*str_length is now "first_write" length*/
 
-		/*The counter will point to the end of the string from the end of the Log header*/
-		g_log_last_byte = second_write_len;
-		g_log_last_byte |= LOG_HEADER_FLAG_BUFFER_WRAPAROUND;
-		log_last_byte = CPU_TO_LE32(g_log_last_byte);
-		icontext_dma_write(&icontext_aiop,
-		                   (uint16_t)sizeof(log_last_byte),
-		                   &(log_last_byte),
-		                   g_log_buf_phys_address +
-		                   LOG_HEADER_LAST_BYTE_OFFSET);
-
 		icontext_dma_write(&icontext_aiop,
 		                   str_length,
 		                   str,
@@ -148,6 +154,264 @@ void log_print_to_buffer(char *str, uint16_t str_length)
 		                   &str[str_length],
 		                   g_log_buf_phys_address + g_log_buf_start);
 
+		/*The counter will point to the end of the string from the end of the Log header*/
+		g_log_last_byte = second_write_len;
+		g_log_last_byte |= LOG_HEADER_FLAG_BUFFER_WRAPAROUND;
 	}
+
+	log_last_byte = CPU_TO_LE32(g_log_last_byte);
+	icontext_dma_write(&icontext_aiop,
+	                   (uint16_t)sizeof(log_last_byte),
+	                   &(log_last_byte),
+	                   g_log_buf_phys_address +
+	                   LOG_HEADER_LAST_BYTE_OFFSET);
 }
 
+#ifdef LOG_PER_CORE_STAGING
+static inline struct log_stage_rec *log_stage_rec_get(struct log_stage *stage,
+                                                      uint32_t pos)
+{
+	return (struct log_stage_rec *)((uint8_t *)stage->buf +
+		(pos & (LOG_STAGE_SIZE - 1)));
+}
+
+/*
+ * Merges the staged messages of all the cores by their time stamp into
+ * g_log_flush_batch and writes each batch with log_write().
+ * Must be called under the log mutex.
+ * */
+static void log_stage_drain(void)
+{
+	struct log_stage_rec *rec, *next;
+	uint32_t head[INTG_MAX_NUM_OF_CORES];
+	uint32_t fill = 0;
+	int i, core;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++)
+		head[i] = g_log_stage[i].head;
+
+	do {
+		rec = NULL;
+		core = 0;
+		for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+			if (g_log_stage[i].tail == head[i])
+				continue;
+			next = log_stage_rec_get(&g_log_stage[i],
+			                         g_log_stage[i].tail);
+			if (next->len == LOG_STAGE_REC_WRAP) {
+				g_log_stage[i].tail += next->size;
+				i--; /* Same core again from the ring start */
+				continue;
+			}
+			if (!rec || (next->timestamp < rec->timestamp)) {
+				rec = next;
+				core = i;
+			}
+		}
+
+		if (rec) {
+			if (fill + rec->len > LOG_FLUSH_BATCH_SIZE) {
+				log_write(g_log_flush_batch, (uint16_t)fill);
+				fill = 0;
+			}
+			memcpy(&g_log_flush_batch[fill], rec + 1, rec->len);
+			fill += rec->len;
+			/* The record may be reused by its core from now on */
+			g_log_stage[core].tail += rec->size;
+		}
+	} while (rec);
+
+	if (fill)
+		log_write(g_log_flush_batch, (uint16_t)fill);
+}
+
+/*
+ * Drains the staging rings and writes str after them (if not NULL).
+ * It may be called from print without the print protection, so the
+ * accelerator context is kept for the caller.
+ * */
+static void log_stage_flush(char *str, uint16_t str_length)
+{
+	uint8_t hwc[LOG_HWC_SIZE];
+
+	memcpy(hwc, (void *)HWC_ACC_IN_ADDRESS, LOG_HWC_SIZE);
+	cdma_mutex_lock_take(LOG_MUTEX_ID, CDMA_MUTEX_WRITE_LOCK);
+	log_stage_drain();
+	if (str)
+		log_write(str, str_length);
+	cdma_mutex_lock_release(LOG_MUTEX_ID);
+	memcpy((void *)HWC_ACC_IN_ADDRESS, hwc, LOG_HWC_SIZE);
+}
+
+void log_flush(void)
+{
+	if (sys.print_to_buffer)
+		log_stage_flush(NULL, 0);
+}
+
+/*
+ * Appends the message to the staging ring of this core. The tasks of a core
+ * are switched only on accelerator calls, so only log_flush() may interleave
+ * with another task of the same core and the position is read after it.
+ * */
+static void log_stage_append(char *str, uint16_t str_length)
+{
+	struct log_stage *stage = &g_log_stage[core_get_id()];
+	struct log_stage_rec *rec;
+	uint32_t size, head, contig;
+
+	size = ALIGN_UP(sizeof(struct log_stage_rec) + str_length,
+	                LOG_STAGE_ALIGN);
+	if (size > (LOG_STAGE_SIZE / 2)) {
+		/* Too long to stage, keep the order with the staged ones */
+		log_stage_flush(str, str_length);
+		return;
+	}
+
+	head = stage->head;
+	contig = LOG_STAGE_SIZE - (head & (LOG_STAGE_SIZE - 1));
+	if (contig >= size)
+		contig = 0;
+	while ((head + contig + size - stage->tail) > LOG_STAGE_SIZE) {
+		log_stage_flush(NULL, 0);
+		head = stage->head;
+		contig = LOG_STAGE_SIZE - (head & (LOG_STAGE_SIZE - 1));
+		if (contig >= size)
+			contig = 0;
+	}
+
+	if (contig) {
+		rec = log_stage_rec_get(stage, head);
+		rec->len = LOG_STAGE_REC_WRAP;
+		rec->size = (uint16_t)contig;
+		head += contig;
+	}
+
+	rec = log_stage_rec_get(stage, head);
+	rec->timestamp = booke_get_time_base_time();
+	rec->len = str_length;
+	rec->size = (uint16_t)size;
+	memcpy(rec + 1, str, str_length);
+
+	/* The record must be visible to the flusher before the head */
+	core_memory_barrier();
+	stage->head = head + size;
+
+	if ((stage->head - stage->tail) >= LOG_STAGE_FLUSH_THRESHOLD)
+		log_stage_flush(NULL, 0);
+}
+
+static int log_stage_empty(void)
+{
+	int i;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++)
+		if (g_log_stage[i].head != g_log_stage[i].tail)
+			return 0;
+	return 1;
+}
+
+static void log_flush_tman_cb(uint64_t opaque1, uint16_t opaque2)
+{
+	UNUSED(opaque1);
+	UNUSED(opaque2);
+
+	/* Bound the time a message stays staged on a quiet core */
+	if (!log_stage_empty())
+		log_flush();
+
+	tman_timer_completion_confirmation(
+		TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
+	fdma_terminate_task();
+}
+
+static void log_flush_delete_tmi_cb(uint64_t opaque1, uint16_t opaque2)
+{
+	UNUSED(opaque1);
+	UNUSED(opaque2);
+	tman_timer_completion_confirmation(
+		TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
+	fdma_terminate_task();
+}
+
+__COLD_CODE int log_flush_timer_init(void)
+{
+	int mem_heap;
+	uint64_t tmi_addr;
+	uint32_t timer_handle;
+	int err;
+
+	if (!sys.print_to_buffer)
+		return 0;
+
+	if (fsl_mem_exists(MEM_PART_DP_DDR)) {
+		mem_heap = MEM_PART_DP_DDR;
+	} else if (fsl_mem_exists(MEM_PART_SYSTEM_DDR)) {
+		mem_heap = MEM_PART_SYSTEM_DDR;
+	} else {
+		pr_warn("DDR memory not found, no periodic log flush\n");
+		return 0;
+	}
+
+	/* One timer */
+	err = fsl_get_mem(64 * 2, mem_heap, 64, &tmi_addr);
+	if (err) {
+		pr_warn("No memory for the log flush TMI\n");
+		return 0;
+	}
+
+	err = tman_create_tmi(tmi_addr, 1, &g_log_flush_tmi_id);
+	if (err) {
+		pr_warn("No TMI for the log flush\n");
+		fsl_put_mem(tmi_addr);
+		return 0;
+	}
+
+	err = tman_create_timer(g_log_flush_tmi_id,
+				TMAN_CREATE_TIMER_MODE_USEC_GRANULARITY,
+				LOG_STAGE_FLUSH_PERIOD_USEC, 0, 0,
+				log_flush_tman_cb, &timer_handle);
+	if (err) {
+		pr_warn("No periodic log flush timer\n");
+		tman_delete_tmi(log_flush_delete_tmi_cb,
+				TMAN_INS_DELETE_MODE_WO_EXPIRATION,
+				g_log_flush_tmi_id, 0, 0);
+		fsl_put_mem(tmi_addr);
+		return 0;
+	}
+
+	g_log_flush_tmi_addr = tmi_addr;
+	return 0;
+}
+
+void log_flush_timer_free(void)
+{
+	uint64_t tmi_addr = g_log_flush_tmi_addr;
+
+	if (!tmi_addr)
+		return;
+
+	g_log_flush_tmi_addr = 0;
+	tman_delete_tmi(log_flush_delete_tmi_cb,
+			TMAN_INS_DELETE_MODE_WO_EXPIRATION,
+			g_log_flush_tmi_id, 0, 0);
+	fsl_put_mem(tmi_addr);
+	/* Messages staged after the last expiration */
+	log_flush();
+}
+#endif /* LOG_PER_CORE_STAGING */
+
+void log_print_to_buffer(char *str, uint16_t str_length)
+{
+#ifdef LOG_PER_CORE_STAGING
+	if (sys.runtime_flag) {
+		log_stage_append(str, str_length);
+		return;
+	}
+	cdma_mutex_lock_take(LOG_MUTEX_ID, CDMA_MUTEX_WRITE_LOCK);
+	log_write(str, str_length);
+	cdma_mutex_lock_release(LOG_MUTEX_ID);
+#else
+	log_write(str, str_length);
+#endif
+}
@@ -54,4 +54,43 @@ struct log_header {
 #define LOG_VERSION_MAJOR 1
 #define LOG_VERSION_MINOR 1
 
+#ifdef LOG_PER_CORE_STAGING
+
+#ifndef LOG_STAGE_SIZE
+#define LOG_STAGE_SIZE 512
+#endif /* Bytes of staging per core, must be power of 2 */
+
+#ifndef LOG_STAGE_FLUSH_THRESHOLD
+#define LOG_STAGE_FLUSH_THRESHOLD (LOG_STAGE_SIZE / 2)
+#endif /* Staged bytes of a core that trigger a flush of all the cores */
+
+#ifndef LOG_STAGE_FLUSH_PERIOD_USEC
+#define LOG_STAGE_FLUSH_PERIOD_USEC 10000
+#endif /* Period of the timer flushing the staged messages of all the cores */
+
+#define LOG_STAGE_ALIGN 16
+#define LOG_FLUSH_BATCH_SIZE 1024 /* Bytes written to DDR with one DMA */
+#define LOG_HWC_SIZE 32 /* Accelerator context saved by the flush */
+
+/* Staged message, the string follows it.
+ * A record with len LOG_STAGE_REC_WRAP pads the end of the ring. */
+struct log_stage_rec {
+	uint64_t timestamp; /* core time base when the message was staged */
+	uint16_t len; /* string length */
+	uint16_t size; /* record size including this header, LOG_STAGE_ALIGN multiple */
+	uint32_t reserved;
+};
+
+#define LOG_STAGE_REC_WRAP 0xFFFF
+
+/* Single producer (tasks of the owner core) single consumer (flusher under
+ * the log mutex) ring. The counters are free running byte counts. */
+struct log_stage {
+	volatile uint32_t head; /* written only by the owner core */
+	volatile uint32_t tail; /* written only by the flusher */
+	uint64_t buf[LOG_STAGE_SIZE / sizeof(uint64_t)];
+};
+
+#endif /* LOG_PER_CORE_STAGING */
+
 #endif /* __LOG_H */
@@ -92,6 +92,8 @@ int buff_pool_create(struct buffer_pool *p_bf_pool,
 	p_bf_pool->current = 0;
 	p_bf_pool->buff_size = buff_size;
 	p_bf_pool->bf_pool_id = bf_pool_id;
+	p_bf_pool->window_count = 0;
+	p_bf_pool->window_lock = 0;
 	/* Allocate stack of pointers to blocks */
 	rc =  boot_get_mem(boot_mem_mng,num_buffs*STACK_ENTRY_BYTE_SIZE,&phys_addr);
 	if(rc){
@@ -124,53 +126,132 @@ int buff_pool_create(struct buffer_pool *p_bf_pool,
 	return 0;
 }
 
-int buff_pool_get(struct buffer_pool *bf_pool, uint64_t* buffer_addr)
+/*
+ * The free addresses are kept in the DDR stack from index current up to
+ * num_buffs, and in the shared ram window above it. The window is accessed
+ * under its spinlock without task switches; the DDR stack is accessed under
+ * the CDMA mutex of the pool.
+ */
+static int buff_pool_refill(struct buffer_pool *bf_pool, uint64_t* buffer_addr)
 {
+	uint64_t burst[BUFF_POOL_BURST];
+	uint32_t n, i;
 
-	ASSERT_COND(bf_pool);
 	cdma_mutex_lock_take(bf_pool->p_buffers_addr, CDMA_MUTEX_WRITE_LOCK);
 	/* check if there is an available block */
-	if (bf_pool->current == bf_pool->num_buffs)
+	n = bf_pool->num_buffs - bf_pool->current;
+	if (n == 0)
 	{
-		sl_pr_err("Buffer pool memory depletion for id = %d, num_buffs = %d\n",
-		bf_pool->bf_pool_id, bf_pool->num_buffs);
+		/* Other tasks may have put buffers in the window */
+		lock_spinlock(&bf_pool->window_lock);
+		if (bf_pool->window_count > 0)
+			*buffer_addr = bf_pool->window[--bf_pool->window_count];
+		else
+			n = 1;
+		unlock_spinlock(&bf_pool->window_lock);
 		cdma_mutex_lock_release(bf_pool->p_buffers_addr);
-		ASSERT_COND(0);
-		return -ENAVAIL;
+		return (n == 0) ? 0 : -ENAVAIL;
+	}
+	if (n > BUFF_POOL_BURST)
+		n = BUFF_POOL_BURST;
+	cdma_read(burst,
+	          bf_pool->buffers_stack_addr +
+	          STACK_ENTRY_BYTE_SIZE*bf_pool->current,
+	          (uint16_t)(n*STACK_ENTRY_BYTE_SIZE));
+	bf_pool->current += n;
+
+	*buffer_addr = burst[0];
+	/* Other tasks may have filled the window during the DMA */
+	lock_spinlock(&bf_pool->window_lock);
+	for (i = 1; i < n && bf_pool->window_count < BUFF_POOL_WINDOW_SIZE; i++)
+		bf_pool->window[bf_pool->window_count++] = burst[i];
+	unlock_spinlock(&bf_pool->window_lock);
+
+	if (i < n)
+	{
+		bf_pool->current -= n - i;
+		cdma_write(bf_pool->buffers_stack_addr +
+		           STACK_ENTRY_BYTE_SIZE*bf_pool->current,
+		           &burst[i],
+		           (uint16_t)((n - i)*STACK_ENTRY_BYTE_SIZE));
 	}
-	/* get the  address of a buffer */
-	cdma_read(buffer_addr,bf_pool->buffers_stack_addr +
-	               STACK_ENTRY_BYTE_SIZE*bf_pool->current,
-	               STACK_ENTRY_BYTE_SIZE);
-	/* advance current index */
-	bf_pool->current++;
 	cdma_mutex_lock_release(bf_pool->p_buffers_addr);
 	return 0;
 }
 
-int buff_pool_put(struct buffer_pool  *bf_pool, uint64_t buffer_addr)
+static int buff_pool_spill(struct buffer_pool *bf_pool, uint64_t buffer_addr)
 {
-	ASSERT_COND(bf_pool);
+	uint64_t burst[BUFF_POOL_BURST + 1];
+	uint32_t n;
+
 	cdma_mutex_lock_take(bf_pool->p_buffers_addr, CDMA_MUTEX_WRITE_LOCK);
+	n = 0;
+	burst[n++] = buffer_addr;
+	/* Other tasks may have emptied the window in the meanwhile */
+	lock_spinlock(&bf_pool->window_lock);
+	while (n <= BUFF_POOL_BURST && bf_pool->window_count > 0)
+		burst[n++] = bf_pool->window[--bf_pool->window_count];
+	unlock_spinlock(&bf_pool->window_lock);
+
 	/* check if blocks stack is full */
-	if (bf_pool->current > 0)
+	if (bf_pool->current < n)
 	{
-		/* decrease current index */
-		bf_pool->current--;
-		/* put the block */
-		/*bf_pool->p_buffers_stack[bf_pool->current] = PTR_TO_UINT(p_block);*/
-		cdma_write(bf_pool->buffers_stack_addr+
-	                      +STACK_ENTRY_BYTE_SIZE*bf_pool->current,
-	                      &buffer_addr,
-	                      STACK_ENTRY_BYTE_SIZE);
+		sl_pr_err("Couldn't put buffer 0x%x%08x into buffer pool id %d\n",
+		       (uint32_t)(buffer_addr >> 32),
+		       (uint32_t)(buffer_addr),bf_pool->bf_pool_id);
 		cdma_mutex_lock_release(bf_pool->p_buffers_addr);
-		return 0;
+		return -ENOSPC;
 	}
-	sl_pr_err("Couldn't put buffer 0x%x%08x into buffer pool id %d\n",
-	       (uint32_t)(buffer_addr >> 32),
-	       (uint32_t)(buffer_addr),bf_pool->bf_pool_id);
+	bf_pool->current -= n;
+	cdma_write(bf_pool->buffers_stack_addr +
+	           STACK_ENTRY_BYTE_SIZE*bf_pool->current,
+	           burst,
+	           (uint16_t)(n*STACK_ENTRY_BYTE_SIZE));
 	cdma_mutex_lock_release(bf_pool->p_buffers_addr);
-	return -ENOSPC;
+	return 0;
+}
+
+/*****************************************************************************/
+int buff_pool_get(struct buffer_pool *bf_pool, uint64_t* buffer_addr)
+{
+	int rc;
+
+	ASSERT_COND(bf_pool);
+
+	lock_spinlock(&bf_pool->window_lock);
+	if (bf_pool->window_count > 0)
+	{
+		*buffer_addr = bf_pool->window[--bf_pool->window_count];
+		unlock_spinlock(&bf_pool->window_lock);
+		return 0;
+	}
+	unlock_spinlock(&bf_pool->window_lock);
+
+	rc = buff_pool_refill(bf_pool, buffer_addr);
+	if (rc)
+	{
+		sl_pr_err("Buffer pool memory depletion for id = %d, num_buffs = %d\n",
+		bf_pool->bf_pool_id, bf_pool->num_buffs);
+		ASSERT_COND(0);
+	}
+	return rc;
+}
+
+/*****************************************************************************/
+int buff_pool_put(struct buffer_pool  *bf_pool, uint64_t buffer_addr)
+{
+	ASSERT_COND(bf_pool);
+
+	lock_spinlock(&bf_pool->window_lock);
+	if (bf_pool->window_count < BUFF_POOL_WINDOW_SIZE)
+	{
+		bf_pool->window[bf_pool->window_count++] = buffer_addr;
+		unlock_spinlock(&bf_pool->window_lock);
+		return 0;
+	}
+	unlock_spinlock(&bf_pool->window_lock);
+
+	return buff_pool_spill(bf_pool, buffer_addr);
 }
 
 __END_COLD_CODE
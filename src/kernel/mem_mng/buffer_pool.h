@@ -30,6 +30,13 @@
 #include "fsl_smp.h"
 #include "fsl_icontext.h"
 
+/* Free buffer addresses cached in shared ram, on top of the stack */
+#ifndef BUFF_POOL_WINDOW_SIZE
+#define BUFF_POOL_WINDOW_SIZE	16
+#endif
+/* Addresses moved by one DMA when the window is refilled or spilled */
+#define BUFF_POOL_BURST		(BUFF_POOL_WINDOW_SIZE / 2)
+
 /**************************************************************************//*
  @Description    Buffer pool structure
 *//***************************************************************************/
@@ -40,6 +47,9 @@
 	uint32_t  num_buffs;          /* Number of buffers in this pool*/
 	uint32_t  current;            /* Current buffer */
 	uint32_t  bf_pool_id;
+	uint64_t  window[BUFF_POOL_WINDOW_SIZE]; /* Top of the stack */
+	uint32_t  window_count;       /* Addresses in the window */
+	uint8_t   window_lock;        /* Spinlock of the window */
 };
 
  /* Put all function (execution code) into  dtext_vle section,aka __COLD_CODE */
@@ -84,6 +94,8 @@ int buff_pool_create(struct buffer_pool    *bf_pool,
  @Function      get_buff
 
  @Description   Returns a 64b address of a free buffer from the pool.
+                The buffer is taken from the shared ram window of the stack
+                top; an empty window is refilled by one DMA from the stack.
 
  @Param[in]     bf_pool - Object of buffer pool, returned by buffer_pool_create
  @Param[out]    buff_addr Address of a buffer.
@@ -96,6 +108,8 @@ int buff_pool_get(struct buffer_pool *bf_pool,uint64_t* buff_addr );
  @Function      put_buff
 
  @Description   Returns a  previously returned buffer to the pool.
+                The buffer is put in the shared ram window of the stack top;
+                a full window is spilled by one DMA to the stack.
 
  @Param[in]     bf_pool - Object of buffer pool, returned by buffer_pool_create
  @Param[out]    buff_addr Address of a buffer to be returned to the pool.
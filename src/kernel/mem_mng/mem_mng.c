@@ -45,6 +45,9 @@
 #include "slob.h"
 #include "buffer_pool.h"
 #include "fsl_cdma.h"
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+#include "fsl_core_booke.h"
+#endif
 
 
 
@@ -76,10 +79,22 @@
 static uint8_t g_mem_part_spinlock[PLATFORM_MAX_MEM_INFO_ENTRIES] = {0};
 static uint8_t g_phys_mem_part_spinlock[PLATFORM_MAX_MEM_INFO_ENTRIES] = {0};
 extern struct aiop_init_info g_init_data;
-/* Mutex lock to lock calls of slob_put functions. */
-//static uint8_t s_free_lock = 0;
-/* Mutex lock to lock calls of slob_get functions */
+/* The slobs of all the partitions are serialized by one CDMA mutex, slob
+ * keeps function-static scratch variables which are shared by all the
+ * partitions (see slob.c) */
 static uint8_t s_malloc_lock = 0;
+#define MEM_MNG_SLOB_LOCK(_p) \
+	cdma_mutex_lock_take((uint64_t)&s_malloc_lock, CDMA_MUTEX_WRITE_LOCK)
+#define MEM_MNG_SLOB_UNLOCK(_p) \
+	cdma_mutex_lock_release((uint64_t)&s_malloc_lock)
+
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+#define MEM_MNG_HIST_START(_t)          (_t) = booke_get_time_base_time()
+#define MEM_MNG_HIST_ADD(_sc, _h, _t)   mem_mng_hist_add((_sc), (_h), (_t))
+#else
+#define MEM_MNG_HIST_START(_t)
+#define MEM_MNG_HIST_ADD(_sc, _h, _t)
+#endif /* MEM_MNG_ALLOC_HISTOGRAM */
 
 
 /* Put all function (execution code) into  dtext_vle section , aka __COLD_CODE */
@@ -111,6 +126,9 @@ static void mem_mng_free_partition(struct t_mem_mng *p_mem_mng,
 static void mem_phys_mng_free_partition(struct t_mem_mng *p_mem_mng,
                            t_mem_mng_phys_addr_alloc_partition   *p_partition);
 
+static void mem_mng_sc_init(struct mem_mng_sc *sc, uint64_t *h_mem_manager,
+                            uint64_t size);
+
 
 
 
@@ -340,6 +358,8 @@ int mem_mng_register_partition(void*   h_mem_mng,
 	return -EAGAIN;
     }
 
+    mem_mng_sc_init(&p_new_partition->sc, &p_new_partition->h_mem_manager,
+                    size);
 
     /* Copy partition name */
     strncpy(p_new_partition->info.name, name, MEM_MNG_MAX_PARTITION_NAME_LEN-1);
@@ -411,6 +431,9 @@ int mem_mng_register_phys_addr_alloc_partition(void*   h_mem_mng,
        return -EAGAIN;
    }
 
+   mem_mng_sc_init(&p_new_partition->sc, &p_new_partition->h_mem_manager,
+                   size);
+
    /* Copy partition name */
    strncpy(p_new_partition->info.name, name, MEM_MNG_MAX_PARTITION_NAME_LEN-1);
 
@@ -582,6 +605,204 @@ uint32_t mem_mng_check_leaks(void*                 h_mem_mng,
 	return count;
 }
 
+/*****************************************************************************/
+/*
+ * Size classes. The region is reserved when the partition is registered, by
+ * one core. Malloc partitions are accessed directly and use a spinlock per
+ * class; physical address partitions are accessed through the CDMA and use
+ * a CDMA mutex per class.
+ */
+static void mem_mng_sc_init(struct mem_mng_sc *sc, uint64_t *h_mem_manager,
+                            uint64_t size)
+{
+    uint64_t num_chunks;
+
+    memset(sc, 0, sizeof(struct mem_mng_sc));
+
+    num_chunks = (size / MEM_MNG_SC_REGION_RATIO) >> MEM_MNG_SC_CHUNK_SHIFT;
+    if (num_chunks > MEM_MNG_SC_MAX_CHUNKS)
+        num_chunks = MEM_MNG_SC_MAX_CHUNKS;
+    if (num_chunks == 0)
+        return;
+
+    sc->base = slob_get(h_mem_manager,
+                        num_chunks << MEM_MNG_SC_CHUNK_SHIFT,
+                        MEM_MNG_SC_CHUNK_SIZE);
+    if (sc->base)
+        sc->num_chunks = (uint32_t)num_chunks;
+}
+
+static inline int mem_mng_sc_class(uint64_t size, uint32_t alignment)
+{
+    int c = 0;
+
+    if (alignment > size)
+        size = alignment;
+    if (size > MEM_MNG_SC_MAX_SIZE)
+        return -1;
+    while ((MEM_MNG_SC_MIN_SIZE << c) < size)
+        c++;
+
+    return c;
+}
+
+static inline void mem_mng_sc_lock(struct mem_mng_size_class *cls, int phys)
+{
+    if (phys)
+        cdma_mutex_lock_take((uint64_t)cls, CDMA_MUTEX_WRITE_LOCK);
+    else
+        lock_spinlock(&cls->lock);
+}
+
+static inline void mem_mng_sc_unlock(struct mem_mng_size_class *cls, int phys)
+{
+    if (phys)
+        cdma_mutex_lock_release((uint64_t)cls);
+    else
+        unlock_spinlock(&cls->lock);
+}
+
+/* Returns the next unused chunk of the region, 0 if all are used */
+static uint64_t mem_mng_sc_chunk(struct mem_mng_sc *sc, uint8_t *part_lock,
+                                 int c)
+{
+    uint32_t idx;
+
+    lock_spinlock(part_lock);
+    idx = sc->next_chunk;
+    if (idx >= sc->num_chunks)
+    {
+        unlock_spinlock(part_lock);
+        return 0;
+    }
+    sc->chunk_class[idx] = (uint8_t)c;
+    sc->next_chunk++;
+    unlock_spinlock(part_lock);
+
+    return sc->base + ((uint64_t)idx << MEM_MNG_SC_CHUNK_SHIFT);
+}
+
+/* Returns 0 if the allocation should be done by the slob */
+MEM_MNG_CODE_PLACEMENT static uint64_t mem_mng_sc_get(struct mem_mng_sc *sc,
+                                                      uint8_t *part_lock,
+                                                      uint64_t size,
+                                                      uint32_t alignment,
+                                                      int phys)
+{
+    struct mem_mng_size_class *cls;
+    uint64_t addr, next;
+    int c;
+
+    if (!sc->base)
+        return 0;
+    c = mem_mng_sc_class(size, alignment);
+    if (c < 0)
+        return 0;
+    cls = &sc->classes[c];
+
+    mem_mng_sc_lock(cls, phys);
+    addr = cls->free_head;
+    if (addr)
+    {
+        if (phys)
+            cdma_read(&next, addr, sizeof(next));
+        else
+            next = *((uint64_t *)UINT_TO_PTR(addr));
+        cls->free_head = next;
+    }
+    else
+    {
+        /* The last chunk is used up when the next object is aligned to
+         * a chunk, or there is no chunk yet */
+        if (!(cls->bump & (MEM_MNG_SC_CHUNK_SIZE - 1)))
+            cls->bump = mem_mng_sc_chunk(sc, part_lock, c);
+        addr = cls->bump;
+        if (addr)
+            cls->bump += (MEM_MNG_SC_MIN_SIZE << c);
+    }
+    mem_mng_sc_unlock(cls, phys);
+
+    return addr;
+}
+
+/* Returns 0 if the address was not allocated from the size classes */
+MEM_MNG_CODE_PLACEMENT static int mem_mng_sc_put(struct mem_mng_sc *sc,
+                                                 uint64_t addr, int phys)
+{
+    struct mem_mng_size_class *cls;
+    uint64_t next;
+    uint32_t idx;
+
+    if (!sc->base || (addr < sc->base))
+        return 0;
+    idx = (uint32_t)((addr - sc->base) >> MEM_MNG_SC_CHUNK_SHIFT);
+    if (idx >= sc->num_chunks)
+        return 0;
+    cls = &sc->classes[sc->chunk_class[idx]];
+
+    mem_mng_sc_lock(cls, phys);
+    next = cls->free_head;
+    if (phys)
+        cdma_write(addr, &next, sizeof(next));
+    else
+        *((uint64_t *)UINT_TO_PTR(addr)) = next;
+    cls->free_head = addr;
+    mem_mng_sc_unlock(cls, phys);
+
+    return 1;
+}
+
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+static void mem_mng_hist_add(struct mem_mng_sc *sc, int hist, uint64_t start)
+{
+    uint64_t ticks = booke_get_time_base_time() - start;
+    int b = 0;
+
+    while ((ticks >>= 1) && (b < (MEM_MNG_HIST_BUCKETS - 1)))
+        b++;
+    atomic_incr32(&sc->hist[hist][b], 1);
+}
+
+static void mem_mng_hist_print(char *name, struct mem_mng_sc *sc)
+{
+    int b;
+
+    pr_info("\r\n_allocation latency - %s (time base ticks):\r\n", name);
+    pr_info("------------------------------------------------------------\r\n");
+    pr_info("     below      size class        slob\r\n");
+    for (b = 0; b < MEM_MNG_HIST_BUCKETS; b++)
+    {
+        if (sc->hist[MEM_MNG_HIST_SC][b] || sc->hist[MEM_MNG_HIST_SLOB][b])
+            pr_info("%10u  %10u  %10u\r\n", (uint32_t)(2 << b),
+                    (uint32_t)sc->hist[MEM_MNG_HIST_SC][b],
+                    (uint32_t)sc->hist[MEM_MNG_HIST_SLOB][b]);
+    }
+    pr_info("size class chunks used:   %u of %u\r\n",
+            sc->next_chunk, sc->num_chunks);
+}
+
+/*****************************************************************************/
+/*
+ * Caution: No locks on p_mem_mng->mem_partitions_array.
+ */
+void mem_mng_print_alloc_histogram(void* h_mem_mng, int partition_id)
+{
+    struct t_mem_mng *p_mem_mng = (struct t_mem_mng *)h_mem_mng;
+    t_mem_mng_partition *p_partition;
+    t_mem_mng_phys_addr_alloc_partition *p_phys_partition;
+
+    p_partition = &p_mem_mng->mem_partitions_array[partition_id];
+    if (p_partition->was_initialized)
+        mem_mng_hist_print(p_partition->info.name, &p_partition->sc);
+
+    p_phys_partition =
+        &p_mem_mng->phys_allocation_mem_partitions_array[partition_id];
+    if (p_phys_partition->was_initialized)
+        mem_mng_hist_print(p_phys_partition->info.name,
+                           &p_phys_partition->sc);
+}
+#endif /* MEM_MNG_ALLOC_HISTOGRAM */
+
 /*****************************************************************************/
 /*
  * Caution: No locks on p_mem_mng->mem_partitions_array.
@@ -600,6 +821,9 @@ MEM_MNG_CODE_PLACEMENT void * mem_mng_alloc_mem(void*     h_mem_mng,
     t_mem_mng_partition   *p_partition;
     uint32_t i = 0, array_size = 0,virt_address = 0;
     void                *p_memory;
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+    uint64_t            start;
+#endif
 
 
 #ifndef ENABLE_DEBUG_ENTRIES
@@ -621,10 +845,18 @@ MEM_MNG_CODE_PLACEMENT void * mem_mng_alloc_mem(void*     h_mem_mng,
                   partition_id);
         return NULL;
     }
-    cdma_mutex_lock_take((uint64_t)&s_malloc_lock,CDMA_MUTEX_WRITE_LOCK);
-    p_memory = UINT_TO_PTR(
-    slob_get(&p_partition->h_mem_manager, size, alignment));
-    cdma_mutex_lock_release((uint64_t)&s_malloc_lock);
+    MEM_MNG_HIST_START(start);
+    p_memory = UINT_TO_PTR(mem_mng_sc_get(&p_partition->sc, p_partition->lock,
+                                          size, alignment, 0));
+    if (p_memory) {
+        MEM_MNG_HIST_ADD(&p_partition->sc, MEM_MNG_HIST_SC, start);
+    } else {
+        MEM_MNG_SLOB_LOCK(p_partition);
+        p_memory = UINT_TO_PTR(
+        slob_get(&p_partition->h_mem_manager, size, alignment));
+        MEM_MNG_SLOB_UNLOCK(p_partition);
+        MEM_MNG_HIST_ADD(&p_partition->sc, MEM_MNG_HIST_SLOB, start);
+    }
     if ((uintptr_t)p_memory == 0LL)
         /* Do not report error - let the allocating entity report it */
     return NULL;
@@ -660,6 +892,9 @@ MEM_MNG_CODE_PLACEMENT int mem_mng_get_phys_mem(void*  h_mem_mng, int  partition
     struct t_mem_mng            *p_mem_mng = (struct t_mem_mng *)h_mem_mng;
     t_mem_mng_phys_addr_alloc_partition   *p_partition;
     uint32_t array_size = 0, i = 0;
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+    uint64_t start;
+#endif
 
 
     if (size == 0)
@@ -671,17 +906,31 @@ MEM_MNG_CODE_PLACEMENT int mem_mng_get_phys_mem(void*  h_mem_mng, int  partition
     p_partition = &p_mem_mng->phys_allocation_mem_partitions_array[partition_id];
     if (p_partition->was_initialized)
     {
-	    cdma_mutex_lock_take((uint64_t)&s_malloc_lock,CDMA_MUTEX_WRITE_LOCK);
+	    MEM_MNG_HIST_START(start);
+	    if (alignment <= MEM_MNG_SC_MAX_SIZE)
+	    {
+		    *paddr = mem_mng_sc_get(&p_partition->sc,
+		                            p_partition->lock, size,
+		                            (uint32_t)alignment, 1);
+		    if (*paddr)
+		    {
+			    MEM_MNG_HIST_ADD(&p_partition->sc,
+			                     MEM_MNG_HIST_SC, start);
+			    return 0;
+		    }
+	    }
+	    MEM_MNG_SLOB_LOCK(p_partition);
             if((*paddr = slob_get(&p_partition->h_mem_manager,size,
                                   (uint32_t)alignment)) == 0LL)
             {
                 sl_pr_err("Mem. manager memory allocation failed: Required size 0x%x%08x exceeds "
                    "available memory for partition ID %d\n",
                    (uint32_t)(size >> 32),(uint32_t)size,partition_id);
-                cdma_mutex_lock_release((uint64_t)&s_malloc_lock);
+                MEM_MNG_SLOB_UNLOCK(p_partition);
                 return -ENOMEM;
             }
-            cdma_mutex_lock_release((uint64_t)&s_malloc_lock);
+            MEM_MNG_SLOB_UNLOCK(p_partition);
+            MEM_MNG_HIST_ADD(&p_partition->sc, MEM_MNG_HIST_SLOB, start);
             return 0; // Success
     }
     sl_pr_err("Partition ID %d is not found\n", partition_id);
@@ -706,9 +955,11 @@ MEM_MNG_CODE_PLACEMENT void mem_mng_put_phys_mem(void*  h_mem_mng, uint64_t padd
         if (p_partition->was_initialized && paddress >= p_partition->info.base_paddress &&
            paddress < (p_partition->info.base_paddress + p_partition->info.size))
 	{
-            cdma_mutex_lock_take((uint64_t)&s_malloc_lock,CDMA_MUTEX_WRITE_LOCK);
+            if (mem_mng_sc_put(&p_partition->sc, paddress, 1))
+                return;
+            MEM_MNG_SLOB_LOCK(p_partition);
             slob_put(&p_partition->h_mem_manager,paddress);
-            cdma_mutex_lock_release((uint64_t)&s_malloc_lock);
+            MEM_MNG_SLOB_UNLOCK(p_partition);
             return;
 	}
     }// for
@@ -733,11 +984,12 @@ MEM_MNG_CODE_PLACEMENT void mem_mng_free_mem(void*  h_mem_mng, void *p_memory)
 		address_found = 0;
 	}
 #endif
-	if (address_found)
+	if (address_found &&
+	    !mem_mng_sc_put(&p_partition->sc, PTR_TO_UINT(p_memory), 0))
 	{
-		cdma_mutex_lock_take((uint64_t)&s_malloc_lock,CDMA_MUTEX_WRITE_LOCK);
+		MEM_MNG_SLOB_LOCK(p_partition);
 		slob_put(&p_partition->h_mem_manager, PTR_TO_UINT(p_memory));
-		cdma_mutex_lock_release((uint64_t)&s_malloc_lock);
+		MEM_MNG_SLOB_UNLOCK(p_partition);
 	}
     }
     else
@@ -808,6 +1060,7 @@ static void mem_mng_free_partition(struct t_mem_mng *p_mem_mng,
     unlock_spinlock(p_partition->lock);
 
     /* Release the memory manager object */
+    p_partition->sc.base = 0;
     slob_free(&p_partition->h_mem_manager);
 }
 
@@ -817,6 +1070,7 @@ static void mem_phys_mng_free_partition(struct t_mem_mng *p_mem_mng,
 {
     UNUSED(p_mem_mng);
     /* Release the memory manager object */
+    p_partition->sc.base = 0;
     slob_free(&p_partition->h_mem_manager);
 }
 /*****************************************************************************/
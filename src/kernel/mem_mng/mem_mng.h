@@ -156,6 +156,10 @@ typedef void (t_mem_mng_leak_report_func)(void      *p_memory,
 uint32_t mem_mng_check_leaks(void *                h_mem_mng,
                             int                     partition_id,
                             t_mem_mng_leak_report_func  *f_report_leak);
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+/**************************************************************************//**/
+void mem_mng_print_alloc_histogram(void * h_mem_mng, int partition_id);
+#endif /* MEM_MNG_ALLOC_HISTOGRAM */
 /**************************************************************************//**/
 int mem_mng_mem_partitions_init_completed(void * h_mem_mng);
 /**************************************************************************//**
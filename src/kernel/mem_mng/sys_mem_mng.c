@@ -480,6 +480,14 @@ static void sys_print_mem_leak(void        *p_memory,
     pr_info("memory leak: 0x%09p, file: %s (%d)\r\n", p_memory, filename, line);
 }
 
+#ifdef MEM_MNG_ALLOC_HISTOGRAM
+/*****************************************************************************/
+void sys_print_mem_alloc_histogram(int partition_id)
+{
+    mem_mng_print_alloc_histogram(&sys.mem_mng, partition_id);
+}
+#endif /* MEM_MNG_ALLOC_HISTOGRAM */
+
 /*****************************************************************************/
 MEM_MNG_CODE_PLACEMENT int  sys_get_phys_mem(uint64_t size, int mem_partition_id, uint64_t alignment,
                  uint64_t* paddr)
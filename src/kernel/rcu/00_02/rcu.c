@@ -29,10 +29,21 @@
 #include "fsl_rcu.h"
 #include "fsl_cdma.h"
 #include "cdma.h"
+#include "fsl_tman.h"
+#include "fsl_fdma.h"
+#include "fsl_malloc.h"
+#include "fsl_spinlock.h"
+#include "fsl_core_booke.h"
+#include "rcu.h"
+
+struct rcu g_rcu = {0};
+/* Callbacks staged by rcu_synchronize_nb(), per core */
+struct rcu_core_jobs g_rcu_core_jobs[INTG_MAX_NUM_OF_CORES];
 
 int rcu_init();
 void rcu_free();
 int rcu_default_early_init();
+void rcu_tman_cb(uint64_t opaque1, uint16_t opaque2);
 
 
 int rcu_default_early_init()
@@ -42,13 +53,66 @@ int rcu_default_early_init()
 
 int rcu_init()
 {
+	int err;
+
+	/* Support no dp ddr */
+	if (fsl_mem_exists(MEM_PART_DP_DDR)) {
+		g_rcu.mem_heap = MEM_PART_DP_DDR;
+	} else if (fsl_mem_exists(MEM_PART_SYSTEM_DDR)) {
+		g_rcu.mem_heap = MEM_PART_SYSTEM_DDR;
+	} else {
+		pr_warn("DDR memory not found, no rcu_synchronize_nb()\n");
+		return 0;
+	}
+
+	err = fsl_get_mem(RCU_NB_SEGS * RCU_NB_SEG_SIZE, g_rcu.mem_heap, 64,
+	                  &g_rcu.segs);
+	if (err) {
+		pr_err("No memory for RCU segments\n");
+		g_rcu.segs = 0;
+		return err;
+	}
+
+	err = fsl_get_mem(64 * (RCU_NB_TMI_TIMERS + 1), g_rcu.mem_heap, 64,
+	                  &g_rcu.tman_addr);
+	if (!err)
+		err = tman_create_tmi(g_rcu.tman_addr, RCU_NB_TMI_TIMERS,
+		                      &g_rcu.tmi_id);
+	if (err) {
+		pr_err("No TMI for RCU\n");
+		if (g_rcu.tman_addr)
+			fsl_put_mem(g_rcu.tman_addr);
+		fsl_put_mem(g_rcu.segs);
+		g_rcu.tman_addr = 0;
+		g_rcu.segs = 0;
+		return err;
+	}
+
+	g_rcu.free_segs = (uint32_t)((1ULL << RCU_NB_SEGS) - 1);
+	g_rcu.stats.gp_latency_min = 0xFFFFFFFF;
+	tman_get_timestamp(&g_rcu.start);
+
 	return 0;
 }
 
+static void rcu_delete_tmi_cb(uint64_t opaque1, uint16_t opaque2)
+{
+	UNUSED(opaque1);
+	UNUSED(opaque2);
+	tman_timer_completion_confirmation(
+		TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
+	fdma_terminate_task();
+}
 
 void rcu_free()
 {
-	return;
+	if (!g_rcu.segs)
+		return;
+
+	tman_delete_tmi(rcu_delete_tmi_cb, TMAN_INS_DELETE_MODE_WO_EXPIRATION,
+	                g_rcu.tmi_id, 0, 0);
+	fsl_put_mem(g_rcu.segs);
+	g_rcu.segs = 0;
 }
 
 RCU_CODE_PLACEMENT int rcu_synchronize()
@@ -66,3 +130,274 @@ RCU_CODE_PLACEMENT void rcu_read_lock()
 {
 	cdma_ephemeral_reference_take();
 }
+
+static uint16_t rcu_nb_delay(uint32_t staged)
+{
+	uint32_t delay;
+
+	/* Halve the delay for each quarter of the ring that is staged */
+	delay = RCU_NB_DELAY_MAX >> ((staged * 4) / RCU_NB_CORE_CBS);
+	if (delay < RCU_NB_DELAY_MIN)
+		delay = RCU_NB_DELAY_MIN;
+
+	return (uint16_t)delay;
+}
+
+/*
+ * Every callback that is staged while a grace period is scheduled and not
+ * started is collected when it starts; only the first callback after that
+ * schedules a new one. An extra grace period is scheduled on the high water
+ * mark so that a long delay does not fill the ring.
+ */
+static int rcu_nb_schedule(uint32_t staged, int urgent)
+{
+	int err;
+	uint32_t timer_handle;
+
+	lock_spinlock(&g_rcu.inflight_lock);
+	if (g_rcu.inflight &&
+		(!urgent || (g_rcu.inflight >= RCU_NB_MAX_INFLIGHT))) {
+		unlock_spinlock(&g_rcu.inflight_lock);
+		return 0;
+	}
+	g_rcu.inflight++;
+	unlock_spinlock(&g_rcu.inflight_lock);
+
+	err = tman_create_timer(g_rcu.tmi_id,
+	                        TMAN_CREATE_TIMER_MODE_USEC_GRANULARITY |
+	                        TMAN_CREATE_TIMER_ONE_SHOT,
+	                        rcu_nb_delay(staged),
+	                        0,
+	                        0,
+	                        rcu_tman_cb,
+	                        &timer_handle);
+	if (err) {
+		sl_pr_err("Failed timer err = %d\n", err);
+		lock_spinlock(&g_rcu.inflight_lock);
+		g_rcu.inflight--;
+		unlock_spinlock(&g_rcu.inflight_lock);
+		return -EBUSY;
+	}
+
+	return 0;
+}
+
+static void rcu_nb_cancelled(uint64_t param)
+{
+	UNUSED(param);
+}
+
+/*
+ * The callback staged at pos got no grace period. Unless a grace period
+ * already collected it, it is replaced in the ring so that it is never
+ * invoked; other callbacks may have been staged after it.
+ * Returns 0 if the callback is invoked, -EBUSY if it was cancelled.
+ */
+static int rcu_nb_cancel(struct rcu_core_jobs *ring, uint32_t pos)
+{
+	int err = 0;
+
+	/* The collection moves the tail under the RCU mutex */
+	RCU_MUTEX_W_TAKE;
+	if ((int32_t)(pos - ring->tail) >= 0) {
+		ring->jobs[pos & (RCU_NB_CORE_CBS - 1)].cb = rcu_nb_cancelled;
+		err = -EBUSY;
+	}
+	RCU_MUTEX_RELEASE;
+
+	return err;
+}
+
+RCU_CODE_PLACEMENT int rcu_synchronize_nb(rcu_cb_t *cb, uint64_t param)
+{
+	struct rcu_core_jobs *ring;
+	struct rcu_job *job;
+	uint32_t head, staged;
+	int err;
+
+	ASSERT_COND(cb);
+
+	if (!g_rcu.segs)
+		return -ENODEV;
+
+	/* No task switch on this core until the head is updated.
+	 * Nothing is staged without a free slot. */
+	ring = &g_rcu_core_jobs[core_get_id()];
+	head = ring->head;
+	staged = head - ring->tail;
+	if (staged >= RCU_NB_CORE_CBS) {
+		atomic_incr32(&g_rcu.enqueue_errors, 1);
+		rcu_nb_schedule(staged, 0);
+		return -ENOMEM;
+	}
+
+	job = &ring->jobs[head & (RCU_NB_CORE_CBS - 1)];
+	job->cb = cb;
+	job->param = param;
+	/* The job must be visible to the collector before the head */
+	core_memory_barrier();
+	ring->head = head + 1;
+	staged++;
+
+	/* The job is staged before the grace period is scheduled, so a grace
+	 * period that is already scheduled collects it */
+	err = rcu_nb_schedule(staged, (staged == RCU_NB_HIGH_WATER));
+	if (err) {
+		err = rcu_nb_cancel(ring, head);
+		if (err)
+			atomic_incr32(&g_rcu.enqueue_errors, 1);
+	}
+
+	return err;
+}
+
+/* Must be called under the RCU mutex */
+static int rcu_nb_seg_get(void)
+{
+	int i;
+
+	for (i = 0; i < RCU_NB_SEGS; i++) {
+		if (g_rcu.free_segs & (0x1 << i)) {
+			g_rcu.free_segs &= ~(0x1 << i);
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Close the epoch: move the callbacks staged on all the cores to the
+ * segment, one CDMA per contiguous run. Must be called under the RCU mutex.
+ */
+static uint32_t rcu_nb_collect(uint64_t seg)
+{
+	struct rcu_core_jobs *ring;
+	uint32_t i, n, tail, staged, idx, run;
+
+	n = 0;
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+		ring = &g_rcu_core_jobs[i];
+		tail = ring->tail;
+		staged = ring->head - tail;
+		while (staged) {
+			idx = tail & (RCU_NB_CORE_CBS - 1);
+			run = RCU_NB_CORE_CBS - idx;
+			if (run > staged)
+				run = staged;
+			cdma_write(seg + n * sizeof(struct rcu_job),
+			           &ring->jobs[idx],
+			           (uint16_t)(run * sizeof(struct rcu_job)));
+			n += run;
+			tail += run;
+			staged -= run;
+		}
+		/* The slots are free once they are copied */
+		ring->tail = tail;
+	}
+
+	return n;
+}
+
+static void rcu_nb_stats_update(uint32_t n, uint32_t latency)
+{
+	g_rcu.stats.callbacks += n;
+	g_rcu.stats.grace_periods++;
+	g_rcu.stats.gp_latency_sum += latency;
+	if (latency < g_rcu.stats.gp_latency_min)
+		g_rcu.stats.gp_latency_min = latency;
+	if (latency > g_rcu.stats.gp_latency_max)
+		g_rcu.stats.gp_latency_max = latency;
+}
+
+/*
+ * Grace period task. Several may be waiting for the readers, each one with
+ * the segment of its own epoch.
+ */
+RCU_CODE_PLACEMENT void rcu_tman_cb(uint64_t opaque1, uint16_t opaque2)
+{
+	struct rcu_job jobs[RCU_NB_READ_CBS];
+	uint64_t seg, start, end;
+	uint32_t n, i, j, run;
+	int s;
+
+	UNUSED(opaque1);
+	UNUSED(opaque2);
+
+	tman_timer_completion_confirmation(
+		TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
+
+	/* Callbacks staged after the collection need a new grace period */
+	lock_spinlock(&g_rcu.inflight_lock);
+	g_rcu.inflight--;
+	unlock_spinlock(&g_rcu.inflight_lock);
+
+	RCU_MUTEX_W_TAKE;
+	s = rcu_nb_seg_get();
+	if (s < 0) {
+		RCU_MUTEX_RELEASE;
+		/* All the segments are waiting for readers, retry soon */
+		rcu_nb_schedule(RCU_NB_CORE_CBS, 1);
+		fdma_terminate_task();
+		return;
+	}
+	seg = g_rcu.segs + (uint64_t)s * RCU_NB_SEG_SIZE;
+	n = rcu_nb_collect(seg);
+	g_rcu.epoch++;
+	RCU_MUTEX_RELEASE;
+
+	if (n) {
+		tman_get_timestamp(&start);
+		/* Wait for all the readers of the closed epoch */
+		cdma_ephemeral_reference_sync();
+		tman_get_timestamp(&end);
+
+		for (i = 0; i < n; i += run) {
+			run = n - i;
+			if (run > RCU_NB_READ_CBS)
+				run = RCU_NB_READ_CBS;
+			cdma_read(jobs, seg + i * sizeof(struct rcu_job),
+			          (uint16_t)(run * sizeof(struct rcu_job)));
+			for (j = 0; j < run; j++)
+				jobs[j].cb(jobs[j].param);
+		}
+	}
+
+	RCU_MUTEX_W_TAKE;
+	g_rcu.free_segs |= (0x1 << s);
+	if (n)
+		rcu_nb_stats_update(n, (uint32_t)(end - start));
+	RCU_MUTEX_RELEASE;
+
+	fdma_terminate_task();
+}
+
+int rcu_get_stats(struct rcu_stats *stats)
+{
+	uint64_t now;
+
+	ASSERT_COND(stats);
+
+	if (!g_rcu.segs)
+		return -ENODEV;
+
+	tman_get_timestamp(&now);
+
+	cdma_mutex_lock_take((uint64_t)(&g_rcu), CDMA_MUTEX_READ_LOCK);
+	*stats = g_rcu.stats;
+	RCU_MUTEX_RELEASE;
+
+	stats->enqueue_errors = (uint32_t)g_rcu.enqueue_errors;
+	if (stats->grace_periods) {
+		stats->gp_latency_avg = (uint32_t)(stats->gp_latency_sum /
+			stats->grace_periods);
+	} else {
+		stats->gp_latency_min = 0;
+	}
+	now -= g_rcu.start;
+	if (now)
+		stats->callbacks_per_sec =
+			(uint32_t)((stats->callbacks * 1000000) / now);
+
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2016 Freescale Semiconductor, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of Freescale Semiconductor nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Freescale Semiconductor ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Freescale Semiconductor BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RCU_H
+#define __RCU_H
+
+#include "fsl_rcu.h"
+#include "fsl_types.h"
+#include "fsl_soc_arch.h"
+
+/* Callbacks staged per core, must be power of 2 */
+#ifndef RCU_NB_CORE_CBS
+#define RCU_NB_CORE_CBS		16
+#endif
+
+/* DDR segments, one per grace period that waits for the readers */
+#ifndef RCU_NB_SEGS
+#define RCU_NB_SEGS		8
+#endif
+#if (RCU_NB_SEGS > 32)
+#error "RCU_NB_SEGS must not be larger than 32"
+#endif
+
+/* Grace periods that may be scheduled and not yet started, at least 2 */
+#ifndef RCU_NB_MAX_INFLIGHT
+#define RCU_NB_MAX_INFLIGHT	4
+#endif
+
+/* Poll delay bounds in usec, the delay shrinks as the queues fill */
+#ifndef RCU_NB_DELAY_MAX
+#define RCU_NB_DELAY_MAX	1000
+#endif
+#ifndef RCU_NB_DELAY_MIN
+#define RCU_NB_DELAY_MIN	20
+#endif
+
+/* Staged callbacks on a core that schedule an extra grace period */
+#define RCU_NB_HIGH_WATER	((RCU_NB_CORE_CBS * 3) / 4)
+
+/* A segment holds the callbacks of all the cores */
+#define RCU_NB_SEG_CBS		(INTG_MAX_NUM_OF_CORES * RCU_NB_CORE_CBS)
+#define RCU_NB_SEG_SIZE		(RCU_NB_SEG_CBS * sizeof(struct rcu_job))
+
+/* Callbacks read by one CDMA before they are invoked */
+#define RCU_NB_READ_CBS		8
+
+/* TMAN requires 3 spare timers */
+#define RCU_NB_TMI_TIMERS	(RCU_NB_MAX_INFLIGHT + 3)
+
+#define RCU_MUTEX_W_TAKE \
+	do { \
+		cdma_mutex_lock_take((uint64_t)(&g_rcu), CDMA_MUTEX_WRITE_LOCK); \
+	} while(0)
+
+#define RCU_MUTEX_RELEASE \
+	do { \
+		cdma_mutex_lock_release((uint64_t)(&g_rcu)); \
+	} while(0)
+
+struct rcu_job {
+	uint64_t param;
+	rcu_cb_t *cb;
+	uint32_t reserved;
+};
+
+/* Single producer (the core tasks), single consumer (the grace period
+ * task that holds the RCU mutex) ring of callbacks */
+struct rcu_core_jobs {
+	volatile uint32_t head;		/**< Written by the owner core */
+	volatile uint32_t tail;		/**< Written under the RCU mutex */
+	struct rcu_job jobs[RCU_NB_CORE_CBS];
+};
+
+struct rcu {
+	uint64_t segs;		/**< RCU_NB_SEGS segments in DDR */
+	uint64_t tman_addr;	/**< TMI memory */
+	uint64_t start;		/**< TMAN time stamp of rcu_init() */
+	struct rcu_stats stats;	/**< Protected by the RCU mutex */
+	uint32_t free_segs;	/**< Bit per free segment */
+	uint32_t epoch;		/**< Last closed epoch */
+	int32_t enqueue_errors;
+	int mem_heap;
+	uint8_t inflight;	/**< Grace periods scheduled, not started */
+	uint8_t inflight_lock;
+	uint8_t tmi_id;
+};
+
+#endif /* __RCU_H */
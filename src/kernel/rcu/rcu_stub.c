@@ -26,6 +26,8 @@
 
 
 #include "fsl_sl_dbg.h"
+#include "fsl_rcu.h"
+#include "fsl_string.h"
 
 int rcu_init();
 void rcu_free();
@@ -58,3 +60,22 @@ void rcu_read_lock()
 {
 	return;
 }
+
+/* Does not wait for a grace period: without RCU, the readers of the data
+ * released after rcu_synchronize() must hold a lock (e.g. evmng) */
+int rcu_synchronize()
+{
+	return 0;
+}
+
+int rcu_synchronize_nb(rcu_cb_t *cb, uint64_t param)
+{
+	cb(param);
+	return 0;
+}
+
+int rcu_get_stats(struct rcu_stats *stats)
+{
+	memset(stats, 0, sizeof(struct rcu_stats));
+	return 0;
+}
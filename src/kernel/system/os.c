@@ -65,10 +65,25 @@ static int vsnprintf_lite(char *buf, size_t size, const char *fmt, va_list args)
 static char *number(char *str, uint64_t num, uint8_t base, uint8_t type, size_t *max_size, uint8_t fix_size);
 static void fsl_print_boot(const char *format, va_list args);
 
+#ifdef LOG_PER_CORE_STAGING
+/* At runtime without a console the print goes only to the per core log
+ * staging, which needs neither the print mutex nor the accelerator context
+ * backup. The console is registered only at boot. */
+#define PRINT_IS_LOCKLESS() \
+	(sys.runtime_flag && sys.print_to_buffer && !sys.console)
+#else
+#define PRINT_IS_LOCKLESS() 0
+#endif
+
 
 __COLD_CODE void enable_print_protection()
 {
 	uint8_t hwc[SIZE_OF_HWC_TO_RESERVE];
+
+	if (PRINT_IS_LOCKLESS()) {
+		exception_flag += 1;
+		return;
+	}
 	/*Save Accelerator Hardware Context*/
 	/**HWC_ACC_IN_ADDRESS - Address for passing parameters to accelerators
 	 * The accelerator hardware context must be stored on stack first,
@@ -90,6 +105,11 @@ __COLD_CODE void enable_print_protection()
 __COLD_CODE void disable_print_protection()
 {
 	uint8_t hwc[SIZE_OF_HWC_TO_RESERVE];
+
+	if (PRINT_IS_LOCKLESS()) {
+		exception_flag -= 1;
+		return;
+	}
 	/* g_hwc already locked by mutex*/
 	/**HWC_ACC_IN_ADDRESS - Address for passing parameters to accelerators
 	 * The accelerator hardware context must be restored to stack first,
@@ -369,6 +389,115 @@ __HOT_CODE void unlock_spinlock(
 	*spinlock = 0;
 }
 
+/*****************************************************************************/
+/*                    Queued Spinlock Service Routines                       */
+/*****************************************************************************/
+/* Polls delayed per task waiting ahead in the queue */
+#define QSPINLOCK_BACKOFF_MIN	16
+/* Upper limit of the delay between two polls of the lock */
+#define QSPINLOCK_BACKOFF_MAX	1024
+
+#ifdef SPINLOCK_STATS
+/* Initialized queued spinlocks, reported by qspinlock_stats_dump() */
+static struct qspinlock *g_qspinlock_list;
+static uint8_t g_qspinlock_list_lock;
+#endif /* SPINLOCK_STATS */
+
+/* Returns the ticket and increments the next ticket of the lock */
+static inline uint16_t qspinlock_take_ticket(register volatile uint16_t *next)
+{
+	register uint16_t ticket;
+	register uint16_t new_next;
+	asm{
+		ticket_loop:
+		/* load and reserve the next ticket */
+		lharx ticket, 0, next
+		addi new_next, ticket, 1
+		sthcx. new_next, 0, next /* store new value if still reserved */
+		bne - ticket_loop /* loop if lost reservation */
+	}
+	return ticket;
+}
+
+void qspinlock_init(struct qspinlock *lock, const char *name)
+{
+	lock->next = 0;
+	lock->owner = 0;
+#ifdef SPINLOCK_STATS
+	lock->acquired = 0;
+	lock->contended = 0;
+	lock->max_spin = 0;
+	lock->name = name;
+	lock_spinlock(&g_qspinlock_list_lock);
+	lock->next_lock = g_qspinlock_list;
+	g_qspinlock_list = lock;
+	unlock_spinlock(&g_qspinlock_list_lock);
+#else
+	UNUSED(name);
+#endif /* SPINLOCK_STATS */
+}
+
+__HOT_CODE void lock_qspinlock(struct qspinlock *lock)
+{
+	uint16_t ticket, ahead;
+	uint32_t delay, backoff = QSPINLOCK_BACKOFF_MIN;
+#ifdef SPINLOCK_STATS
+	uint32_t spin = 0;
+#endif
+
+	ticket = qspinlock_take_ticket(&lock->next);
+	while ((ahead = (uint16_t)(ticket - lock->owner)) != 0) {
+		/* Wait longer when more tasks are ahead in the queue, and
+		 * double the delay on each poll to stay off the bus */
+		delay = backoff * ahead;
+		if (delay > QSPINLOCK_BACKOFF_MAX)
+			delay = QSPINLOCK_BACKOFF_MAX;
+		while (delay--)
+			__asm__ ("nop");
+		if (backoff < QSPINLOCK_BACKOFF_MAX)
+			backoff <<= 1;
+#ifdef SPINLOCK_STATS
+		spin++;
+#endif
+	}
+	/* Do not read the protected data before the lock is taken */
+	core_memory_barrier();
+#ifdef SPINLOCK_STATS
+	lock->acquired++;
+	if (spin) {
+		lock->contended++;
+		if (spin > lock->max_spin)
+			lock->max_spin = spin;
+	}
+#endif /* SPINLOCK_STATS */
+}
+
+__HOT_CODE void unlock_qspinlock(struct qspinlock *lock)
+{
+	/* Complete the protected accesses before passing the lock */
+	core_memory_barrier();
+	/* Only the lock holder writes the owner ticket */
+	lock->owner++;
+}
+
+#ifdef SPINLOCK_STATS
+__COLD_CODE void qspinlock_stats_dump(void)
+{
+	struct qspinlock *lock;
+
+	fsl_print("\nQueued spinlocks statistics\n");
+	/* Locks are only added at the list head, the list is walked without
+	 * the list lock since fsl_print() may yield */
+	for (lock = g_qspinlock_list; lock; lock = lock->next_lock) {
+		fsl_print("\t %s (0x%x)\n", lock->name ? lock->name : "-",
+			  (uint32_t)lock);
+		fsl_print("\t\t acquired  = %d\n", lock->acquired);
+		fsl_print("\t\t contended = %d\n", lock->contended);
+		fsl_print("\t\t max spin  = %d\n", lock->max_spin);
+	}
+}
+#endif /* SPINLOCK_STATS */
+
 /***************************************************************************
  *            Atomic Increment and Decrement macros
  *            Using the relevant Core instructions:
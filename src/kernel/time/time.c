@@ -30,6 +30,10 @@
 #include "fsl_dbg.h"
 #include "fsl_spinlock.h"
 #include "fsl_cmgw.h"
+#include "fsl_tman.h"
+#include "fsl_fdma.h"
+#include "fsl_malloc.h"
+#include "fsl_core_booke.h"
 #include "tman_inline.h"
 
 uint64_t time_epoch_to_midnight_ms __attribute__((aligned(8))) = 0; /*microseconds since epoch till midnight
@@ -37,6 +41,12 @@ uint64_t time_epoch_to_midnight_ms __attribute__((aligned(8))) = 0; /*microsecon
 */
 uint8_t time_to_midnight_lock = 0;
 
+#ifdef TIME_COARSE
+struct time_coarse g_time_coarse __attribute__((aligned(8))) = {
+	.err = -ENODEV
+};
+#endif
+
 int time_init(void);
 void time_free(void);
 
@@ -61,6 +71,26 @@ TIME_CODE_PLACEMENT int _get_time_tman(uint64_t *time)
 	return 0;
 }
 
+/*****************************************************************************/
+static int _get_time_tman_us(uint64_t *time)
+{
+	uint64_t time_base;
+
+	time_base = cmgw_get_time_base(); /* Timebase is in mSec */
+
+	if(time_base == CMGW_TIME_BASE_NOT_VALID)
+		return -EACCES; /* Something wrong while reading */
+
+	if(time_base == 0)
+		return -ENODEV; /* Time-base is not yet configured by MC */
+
+	tman_get_timestamp(time); /* Tman value is in uSec */
+
+	*time += time_base * 1000;
+
+	return 0;
+}
+
 /*****************************************************************************/
 TIME_CODE_PLACEMENT int fsl_get_time_ms(uint32_t *time)
 {
@@ -80,7 +110,7 @@ TIME_CODE_PLACEMENT int fsl_get_time_ms(uint32_t *time)
 	}
 	else {
 		time_ms += local_epoch_to_midnight;
-		local_epoch_to_midnight = time_ms - (time_ms % 86400000);
+		local_epoch_to_midnight = time_ms_to_midnight(time_ms);
 		*time = (uint32_t) (time_ms - local_epoch_to_midnight);
 		lock_spinlock(&time_to_midnight_lock);
 		LLSTDW(local_epoch_to_midnight,0 , &time_epoch_to_midnight_ms);
@@ -95,16 +125,202 @@ TIME_CODE_PLACEMENT int fsl_get_time_since_epoch_ms(uint64_t *time)
 	return _get_time_tman(time);
 }
 
+#ifdef TIME_COARSE
+/*****************************************************************************/
+static void time_coarse_refresh(void)
+{
+	uint64_t time_us, time_ms, midnight_ms;
+	int err;
+
+	err = _get_time_tman_us(&time_us);
+
+	lock_spinlock(&g_time_coarse.lock);
+	midnight_ms = g_time_coarse.midnight_ms;
+	time_ms = 0;
+	if (!err) {
+		time_ms = ulldiv1000(time_us);
+		if (time_ms - midnight_ms >= TIME_DAY_MS)
+			midnight_ms = time_ms_to_midnight(time_ms);
+	}
+
+	/* Readers retry while the sequence is odd or changed */
+	g_time_coarse.seq++;
+	core_memory_barrier();
+	g_time_coarse.err = err;
+	if (!err) {
+		g_time_coarse.epoch_us = time_us;
+		g_time_coarse.midnight_ms = midnight_ms;
+		g_time_coarse.day_ms = (uint32_t)(time_ms - midnight_ms);
+	}
+	core_memory_barrier();
+	g_time_coarse.seq++;
+	unlock_spinlock(&g_time_coarse.lock);
+}
+
+/*****************************************************************************/
+static void time_coarse_tman_cb(uint64_t opaque1, uint16_t opaque2)
+{
+	UNUSED(opaque1);
+	UNUSED(opaque2);
+
+	time_coarse_refresh();
+
+	tman_timer_completion_confirmation(
+		TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
+	fdma_terminate_task();
+}
+
+/*****************************************************************************/
+static void time_coarse_delete_tmi_cb(uint64_t opaque1, uint16_t opaque2)
+{
+	UNUSED(opaque1);
+	UNUSED(opaque2);
+	tman_timer_completion_confirmation(
+		TMAN_GET_TIMER_HANDLE(HWC_FD_ADDRESS));
+	fdma_terminate_task();
+}
+
+/*****************************************************************************/
+static inline uint32_t time_coarse_read_begin(void)
+{
+	uint32_t seq;
+
+	do {
+		seq = g_time_coarse.seq;
+	} while (seq & 0x1);
+	core_memory_barrier();
+
+	return seq;
+}
+
+/*****************************************************************************/
+static inline int time_coarse_read_retry(uint32_t seq)
+{
+	core_memory_barrier();
+	return (g_time_coarse.seq != seq);
+}
+#endif /* TIME_COARSE */
+
+/*****************************************************************************/
+TIME_CODE_PLACEMENT int fsl_get_time_ms_coarse(uint32_t *time)
+{
+#ifdef TIME_COARSE
+	uint32_t seq, day_ms;
+	int err;
+
+	if (!g_time_coarse.tmi_addr)
+		return fsl_get_time_ms(time);
+
+	do {
+		seq = time_coarse_read_begin();
+		err = g_time_coarse.err;
+		day_ms = g_time_coarse.day_ms;
+	} while (time_coarse_read_retry(seq));
+
+	if (err)
+		return err;
+	*time = day_ms;
+	return 0;
+#else
+	return fsl_get_time_ms(time);
+#endif
+}
+
+/*****************************************************************************/
+TIME_CODE_PLACEMENT int fsl_get_time_us_coarse(uint64_t *time)
+{
+#ifdef TIME_COARSE
+	uint64_t epoch_us;
+	uint32_t seq;
+	int err;
+
+	if (!g_time_coarse.tmi_addr)
+		return _get_time_tman_us(time);
+
+	do {
+		seq = time_coarse_read_begin();
+		err = g_time_coarse.err;
+		epoch_us = g_time_coarse.epoch_us;
+	} while (time_coarse_read_retry(seq));
+
+	if (err)
+		return err;
+	*time = epoch_us;
+	return 0;
+#else
+	return _get_time_tman_us(time);
+#endif
+}
+
 /*****************************************************************************/
 __COLD_CODE int time_init(void)
 {
+#ifdef TIME_COARSE
+	int mem_heap;
+	uint64_t tmi_addr;
+	uint32_t timer_handle;
+	int err;
+
+	if (fsl_mem_exists(MEM_PART_DP_DDR)) {
+		mem_heap = MEM_PART_DP_DDR;
+	} else if (fsl_mem_exists(MEM_PART_SYSTEM_DDR)) {
+		mem_heap = MEM_PART_SYSTEM_DDR;
+	} else {
+		pr_warn("DDR memory not found, no coarse time refresh\n");
+		return 0;
+	}
+
+	/* One timer */
+	err = fsl_get_mem(64 * 2, mem_heap, 64, &tmi_addr);
+	if (err) {
+		pr_warn("No memory for the coarse time TMI\n");
+		return 0;
+	}
+
+	err = tman_create_tmi(tmi_addr, 1, &g_time_coarse.tmi_id);
+	if (err) {
+		pr_warn("No TMI for the coarse time\n");
+		fsl_put_mem(tmi_addr);
+		return 0;
+	}
+
+	time_coarse_refresh();
+
+	err = tman_create_timer(g_time_coarse.tmi_id,
+				TMAN_CREATE_TIMER_MODE_USEC_GRANULARITY,
+				TIME_COARSE_PERIOD_USEC, 0, 0,
+				time_coarse_tman_cb, &timer_handle);
+	if (err) {
+		pr_warn("No coarse time refresh timer\n");
+		tman_delete_tmi(time_coarse_delete_tmi_cb,
+				TMAN_INS_DELETE_MODE_WO_EXPIRATION,
+				g_time_coarse.tmi_id, 0, 0);
+		fsl_put_mem(tmi_addr);
+		return 0;
+	}
+
+	/* The coarse time readers use the refreshed time from now on */
+	g_time_coarse.tmi_addr = tmi_addr;
+#endif
 	return 0;
 }
 
 /*****************************************************************************/
 void time_free(void)
 {
+#ifdef TIME_COARSE
+	uint64_t tmi_addr = g_time_coarse.tmi_addr;
+
+	if (!tmi_addr)
+		return;
 
+	/* The coarse time readers fall back to the precise time */
+	g_time_coarse.tmi_addr = 0;
+	tman_delete_tmi(time_coarse_delete_tmi_cb,
+			TMAN_INS_DELETE_MODE_WO_EXPIRATION,
+			g_time_coarse.tmi_id, 0, 0);
+	fsl_put_mem(tmi_addr);
+#endif
 }
 
 
@@ -95,5 +95,58 @@ static inline uint64_t ulldiv1000(uint64_t numerator) {
 	return quotient;
 }
 
+/** Milliseconds in a day (24*60*60*1000) */
+#define TIME_DAY_MS		86400000ULL
+/** 2^40 / 86400, rounded down: seconds to days multiplier */
+#define TIME_DAY_SEC_RECIPROCAL	12725829ULL
+
+/**************************************************************************//**
+@Function      time_ms_to_midnight
+
+@Description   routine to round down a time in milliseconds since epoch to the
+               last midnight, without division.
+
+@Param[in]     time_ms - milliseconds since epoch.
+@Return        milliseconds since epoch till the last midnight (UTC).
+*//***************************************************************************/
+static inline uint64_t time_ms_to_midnight(uint64_t time_ms)
+{
+	uint64_t midnight;
+
+	midnight = ((ulldiv1000(time_ms) * TIME_DAY_SEC_RECIPROCAL) >> 40) *
+			TIME_DAY_MS;
+	/* The multiplier is rounded down, the result may be a day short */
+	while (time_ms - midnight >= TIME_DAY_MS)
+		midnight += TIME_DAY_MS;
+
+	return midnight;
+}
+
+#ifdef TIME_COARSE
+#ifndef TIME_COARSE_PERIOD_USEC
+/** Coarse time refresh period, in micro seconds (up to 65535) */
+#define TIME_COARSE_PERIOD_USEC	1000
+#endif
+
+/** Coarse time, refreshed by a periodic TMAN timer */
+struct time_coarse {
+	/** Odd while the time is updated */
+	volatile uint32_t seq;
+	/** 0 or the error of the last time base read */
+	int err;
+	/** Microseconds since epoch */
+	uint64_t epoch_us;
+	/** Milliseconds since epoch till the last midnight */
+	uint64_t midnight_ms;
+	/** Milliseconds since the last midnight */
+	uint32_t day_ms;
+	/** Serializes the refreshes */
+	uint8_t lock;
+	/** TMI of the refresh timer */
+	uint8_t tmi_id;
+	/** Memory of the TMI, 0 when the refresh timer is not running */
+	uint64_t tmi_addr;
+};
+#endif /* TIME_COARSE */
 
 #endif /* _TIME_H */
@@ -32,9 +32,11 @@
 #include "fsl_string.h"
 #include "fsl_spinlock.h"
 #include "fsl_cdma.h"
+#include "fsl_rcu.h"
 
 struct evmng g_evmng_irq_events_list[NUM_OF_IRQ_EVENTS];
 struct evmng g_evmng_events_list[EVMNG_MAX_NUM_OF_EVENTS];
+uint8_t g_evmng_events_hash[EVMNG_HASH_SIZE];
 int g_evmng_events_last_used_index;
 uint32_t *g_evmng_b_pool_pointer;
 uint32_t *g_evmng_first_b_pool_pointer;
@@ -43,6 +45,108 @@ uint8_t g_evmng_b_pool_spinlock;
 
 extern int cmdif_srv_mc_evm_session_open();
 
+#if (EVMNG_MAX_NUM_OF_EVENTS >= EVMNG_HASH_SIZE) || \
+	(EVMNG_MAX_NUM_OF_EVENTS >= EVMNG_HASH_DELETED)
+#error "EVMNG_HASH_BITS is too small for EVMNG_MAX_NUM_OF_EVENTS"
+#endif
+
+static inline uint32_t evmng_hash(uint8_t generator_id, uint8_t event_id)
+{
+	uint32_t key = ((uint32_t)generator_id << 8) | event_id;
+
+	return (key * 0x9E3779B1) >> (32 - EVMNG_HASH_BITS);
+}
+
+/*
+ * Open addressing index over g_evmng_events_list, linear probing.
+ * The index is updated only under the events list write mutex. Lookups are
+ * not protected, therefore each index hit is validated against the list
+ * entry: an entry is added to the index after it was written and it is
+ * removed from the index before it is cleared (see evmng_unregister()).
+ * Deleted slots are kept as EVMNG_HASH_DELETED so that probe chains stay
+ * unbroken for the lookups in progress.
+ */
+EV_MNG_CODE_PLACEMENT static inline int evmng_hash_find(uint8_t generator_id,
+                                                        uint8_t event_id)
+{
+	uint32_t h = evmng_hash(generator_id, event_id);
+	int i;
+	int ind;
+
+	for (i = 0; i < EVMNG_HASH_SIZE; i++) {
+		ind = g_evmng_events_hash[h];
+		if (ind == EVMNG_HASH_FREE)
+			break;
+
+		if (ind != EVMNG_HASH_DELETED) {
+			ind--;
+			if (g_evmng_events_list[ind].generator_id == generator_id &&
+				g_evmng_events_list[ind].event_id == event_id)
+				return ind;
+		}
+		h = EVMNG_HASH_NEXT(h);
+	}
+
+	return -ENOENT;
+}
+
+static void evmng_hash_add(uint8_t generator_id, uint8_t event_id, int ind)
+{
+	uint32_t h = evmng_hash(generator_id, event_id);
+	int i;
+
+	for (i = 0; i < EVMNG_HASH_SIZE; i++) {
+		if (g_evmng_events_hash[h] == EVMNG_HASH_FREE ||
+			g_evmng_events_hash[h] == EVMNG_HASH_DELETED) {
+			g_evmng_events_hash[h] = (uint8_t)(ind + 1);
+			return;
+		}
+		h = EVMNG_HASH_NEXT(h);
+	}
+
+	/* The index has more slots than the list */
+	ASSERT_COND(0);
+}
+
+static void evmng_hash_remove(uint8_t generator_id, uint8_t event_id, int ind)
+{
+	uint32_t h = evmng_hash(generator_id, event_id);
+	int i;
+
+	for (i = 0; i < EVMNG_HASH_SIZE; i++) {
+		if (g_evmng_events_hash[h] == EVMNG_HASH_FREE)
+			return;
+
+		if (g_evmng_events_hash[h] == (uint8_t)(ind + 1)) {
+			g_evmng_events_hash[h] = EVMNG_HASH_DELETED;
+			break;
+		}
+		h = EVMNG_HASH_NEXT(h);
+	}
+
+	/* Deleted slots at the end of a probe chain are not needed anymore */
+	for (i = 0; (i < EVMNG_HASH_SIZE) &&
+		(g_evmng_events_hash[h] == EVMNG_HASH_DELETED) &&
+		(g_evmng_events_hash[EVMNG_HASH_NEXT(h)] == EVMNG_HASH_FREE);
+		i++) {
+		g_evmng_events_hash[h] = EVMNG_HASH_FREE;
+		h = EVMNG_HASH_PREV(h);
+	}
+}
+
+static void free_event_registration(struct evmng_priority_list *evmng_cb_list)
+{
+	/*Lock spinlock to take the next address for buffer to list
+	 * of registration request*/
+	lock_spinlock(&g_evmng_b_pool_spinlock);
+	/* Decrement buffer pool pointer to insert the memory pointer back
+	 * to pool for future registrations*/
+	g_evmng_b_pool_pointer --;
+	*g_evmng_b_pool_pointer = (uint32_t)evmng_cb_list;
+	/*Unlock spinlock*/
+	unlock_spinlock(&g_evmng_b_pool_spinlock);
+}
+
 static int add_event_registration(
 	uint8_t priority, uint64_t app_ctx, evmng_cb cb,
 	struct evmng *evmng_ptr)
@@ -64,6 +168,8 @@ static int add_event_registration(
 	/*Unlock spinlock*/
 	unlock_spinlock(&g_evmng_b_pool_spinlock);
 
+	/* The registration is written before it is linked, the list is
+	 * walked without lock by raise_event() */
 	evmng_cb_list->app_ctx = app_ctx;
 	evmng_cb_list->cb = cb;
 	evmng_cb_list->priority = priority;
@@ -151,61 +257,61 @@ int evmng_register(
 	/* Lock EVM table*/
 	cdma_mutex_lock_take((uint64_t) g_evmng_events_list, CDMA_MUTEX_WRITE_LOCK);
 
-	for(i = 0; i < g_evmng_events_last_used_index; i++ )
+	i = evmng_hash_find(generator_id, event_id);
+	if(i < 0)
 	{
-		if(g_evmng_events_list[i].generator_id == generator_id &&
-			g_evmng_events_list[i].event_id == event_id){
-			break;
+		/* An entry which is being unregistered keeps its generator id
+		 * until no task can see it */
+		for(i = 0; i < g_evmng_events_last_used_index; i++ )
+		{
+			if(g_evmng_events_list[i].generator_id == 0){
+				break;
+			}
 		}
-		if(g_evmng_events_list[i].generator_id == NULL &&
-			empty_index == -1){
-			empty_index = i;
+		if(i == g_evmng_events_last_used_index)
+		{
+			if(g_evmng_events_last_used_index == EVMNG_MAX_NUM_OF_EVENTS)
+			{
+				cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
+				return -ENOMEM;
+			}
+			g_evmng_events_last_used_index ++;
 		}
+		empty_index = i;
+		g_evmng_events_list[i].generator_id = generator_id;
+		g_evmng_events_list[i].event_id = event_id;
+		g_evmng_events_list[i].head = NULL;
 	}
-
-	if(i < g_evmng_events_last_used_index)
-	{
-		evmng_ptr = &g_evmng_events_list[i];
-	}
-	/* empty entry was found during search of used indexes*/
-	else if(empty_index >= 0)
-	{
-		g_evmng_events_list[empty_index].generator_id = generator_id;
-		g_evmng_events_list[empty_index].event_id = event_id;
-		evmng_ptr = &g_evmng_events_list[empty_index];
-	}
-	else if(g_evmng_events_last_used_index < EVMNG_MAX_NUM_OF_EVENTS)
-	{
-		empty_index = g_evmng_events_last_used_index;
-		g_evmng_events_list[empty_index].generator_id = generator_id;
-		g_evmng_events_list[empty_index].event_id = event_id;
-		evmng_ptr = &g_evmng_events_list[empty_index];
-		g_evmng_events_last_used_index ++;
-	}
-	else
-	{
-		cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
-		return -ENOMEM;
-	}
+	evmng_ptr = &g_evmng_events_list[i];
 
 	err = add_event_registration(priority, app_ctx, cb, evmng_ptr);
 
-	/* if err != 0, check if the generator ID need to be cleared again */
-	/* i == EVMNG_MAX_NUM_OF_EVENTS: The event was not found at the list.*/
-	if(err && i == EVMNG_MAX_NUM_OF_EVENTS && empty_index >= 0)
+	if(empty_index >= 0)
 	{
-		g_evmng_events_list[empty_index].generator_id = NULL;
-
+		if(err)
+		{
+			/* The generator ID needs to be cleared again */
+			g_evmng_events_list[empty_index].generator_id = 0;
+			if(empty_index + 1 == g_evmng_events_last_used_index)
+				g_evmng_events_last_used_index --;
+		}
+		else
+		{
+			evmng_hash_add(generator_id, event_id, empty_index);
+		}
 	}
 	cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
 	return err;
 }
 /*****************************************************************************/
 
+/* The removed registration is returned in removed, it may be freed only
+ * after rcu_synchronize() */
 static int remove_event_registration(struct evmng *evmng_ptr,
                                      uint8_t priority,
                                      uint64_t app_ctx,
-                                     evmng_cb cb)
+                                     evmng_cb cb,
+                                     struct evmng_priority_list **removed)
 {
 	struct evmng_priority_list *evmng_cb_list_ptr;
 	struct evmng_priority_list *evmng_cb_list_tmp_ptr;
@@ -246,25 +352,17 @@ static int remove_event_registration(struct evmng *evmng_ptr,
 		}
 		else{
 			evmng_ptr->head = NULL;
-			evmng_ptr->generator_id = NULL;
 		}
 	}
 
-	/*Lock spinlock to take the next address for buffer to list
-	 * of registration request*/
-	lock_spinlock(&g_evmng_b_pool_spinlock);
-	/* Decrement buffer pool pointer to insert the memory pointer back
-	 * to pool for future registrations*/
-	g_evmng_b_pool_pointer --;
-	*g_evmng_b_pool_pointer = (uint32_t)evmng_cb_list_ptr;
-	/*Unlock spinlock*/
-	unlock_spinlock(&g_evmng_b_pool_spinlock);
+	*removed = evmng_cb_list_ptr;
 	return 0;
 }
 /*****************************************************************************/
 
 int evmng_irq_unregister(uint8_t generator_id, uint8_t event_id, uint8_t priority, uint64_t app_ctx, evmng_cb cb)
 {
+	struct evmng_priority_list *removed;
 	int err;
 	if(cb == NULL){
 		sl_pr_debug("CB is NULL\n");
@@ -275,15 +373,22 @@ int evmng_irq_unregister(uint8_t generator_id, uint8_t event_id, uint8_t priorit
 		return -EINVAL;
 	}
 	cdma_mutex_lock_take((uint64_t) g_evmng_irq_events_list, CDMA_MUTEX_WRITE_LOCK);
-	err = remove_event_registration(&g_evmng_irq_events_list[event_id], priority, app_ctx, cb);
+	err = remove_event_registration(&g_evmng_irq_events_list[event_id], priority, app_ctx, cb, &removed);
 	cdma_mutex_lock_release((uint64_t) g_evmng_irq_events_list);
-	return err;
+	if(err)
+		return err;
+
+	/* IRQ events are raised without lock */
+	rcu_synchronize();
+	free_event_registration(removed);
+	return 0;
 }
 /*****************************************************************************/
 
 int evmng_unregister(uint8_t generator_id, uint8_t event_id, uint8_t priority, uint64_t app_ctx, evmng_cb cb)
 {
-	int i, err;
+	struct evmng_priority_list *removed;
+	int i, err, retired = 0;
 
 	if(cb == NULL){
 		sl_pr_debug("CB is NULL\n");
@@ -291,26 +396,43 @@ int evmng_unregister(uint8_t generator_id, uint8_t event_id, uint8_t priority, u
 	}
 
 	cdma_mutex_lock_take((uint64_t) g_evmng_events_list, CDMA_MUTEX_WRITE_LOCK);
-	for(i = 0; i < g_evmng_events_last_used_index; i++ )
-	{
-		if(g_evmng_events_list[i].generator_id == generator_id &&
-			g_evmng_events_list[i].event_id == event_id){
-			break;
-		}
-	}
+	i = evmng_hash_find(generator_id, event_id);
 	/* Check if entry with generator and event id was found */
-	if(i == g_evmng_events_last_used_index){
+	if(i < 0){
 		cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
 		return -ENAVAIL;
 	}
-	/* Check if the removed index is the last used one */
-	else if(i + 1 == g_evmng_events_last_used_index){
-		g_evmng_events_last_used_index --;
+
+	err = remove_event_registration(&g_evmng_events_list[i], priority, app_ctx, cb, &removed);
+	if(err){
+		cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
+		return err;
 	}
+	/* The last registration was removed: new raise_event() calls will not
+	 * find the entry, but it is reused only after the grace period */
+	if(g_evmng_events_list[i].head == NULL){
+		evmng_hash_remove(generator_id, event_id, i);
+		retired = 1;
+	}
+	cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
+
+	/* Wait for the raise_event() calls which may still walk the removed
+	 * registration or the removed entry */
+	rcu_synchronize();
+	free_event_registration(removed);
+
+	if(!retired)
+		return 0;
 
-	err = remove_event_registration(&g_evmng_events_list[i], priority, app_ctx, cb);
+	/* The retired entry is not in the index so nobody registered to it */
+	cdma_mutex_lock_take((uint64_t) g_evmng_events_list, CDMA_MUTEX_WRITE_LOCK);
+	g_evmng_events_list[i].generator_id = 0;
+	/* Check if the removed index is the last used one */
+	while(g_evmng_events_last_used_index > 0 &&
+		g_evmng_events_list[g_evmng_events_last_used_index - 1].generator_id == 0)
+		g_evmng_events_last_used_index --;
 	cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
-	return err;
+	return 0;
 }
 /*****************************************************************************/
 
@@ -351,10 +473,16 @@ int evmng_raise_irq_event_cb(void *dev, uint16_t cmd, uint32_t size, void *event
 	}
 
 	sl_pr_debug("addr %d, val %d\n", (int)evmng_irq_cfg->addr, (int)evmng_irq_cfg->val);
+#ifdef EVMNG_READ_LOCKED
+	cdma_mutex_lock_take((uint64_t) g_evmng_irq_events_list, CDMA_MUTEX_READ_LOCK);
+#endif
 	/*Only one event can be processed at a time*/
 	if(g_evmng_irq_events_list[evmng_irq_cfg->addr].head == NULL)
 	{
 		sl_pr_debug("No registered CB's for event %d\n",evmng_irq_cfg->addr);
+#ifdef EVMNG_READ_LOCKED
+		cdma_mutex_lock_release((uint64_t) g_evmng_irq_events_list);
+#endif
 		return 0;
 	}
 
@@ -368,6 +496,9 @@ int evmng_raise_irq_event_cb(void *dev, uint16_t cmd, uint32_t size, void *event
 				(void *)evmng_irq_cfg->val);
 		evmng_cb_list_ptr = evmng_cb_list_ptr->next;
 	}
+#ifdef EVMNG_READ_LOCKED
+	cdma_mutex_lock_release((uint64_t) g_evmng_irq_events_list);
+#endif
 	return 0;
 }
 /*****************************************************************************/
@@ -377,29 +508,24 @@ EV_MNG_CODE_PLACEMENT static void raise_event(uint8_t generator_id, uint8_t even
 	struct evmng_priority_list *evmng_cb_list_ptr;
 	int i;
 
-	/* More than one event can be processed at a time*/
-	/* Find the index in table which has the same generator and event id.
-	 * The table should be locked.*/
-	/* Lock EVM table*/
+	/* More than one event can be processed at a time.
+	 * The table is not locked: registrations are published by a single
+	 * pointer write and freed only after rcu_synchronize(), so the
+	 * callbacks are free to register or unregister events.
+	 * Without RCU, the table is read locked as the registrations are freed
+	 * right after they are unlinked. */
+#ifdef EVMNG_READ_LOCKED
 	cdma_mutex_lock_take((uint64_t) g_evmng_events_list, CDMA_MUTEX_READ_LOCK);
-
-	for(i = 0; i < g_evmng_events_last_used_index; i++){
-		if(g_evmng_events_list[i].generator_id == generator_id &&
-			g_evmng_events_list[i].event_id == event_id){
-			break;
-		}
-	}
-
-	if(i == g_evmng_events_last_used_index){
-		cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
-		return;
-	}
-
-	if(g_evmng_events_list[i].head == NULL)
+#endif
+	i = evmng_hash_find(generator_id, event_id);
+	if(i < 0)
 	{
+#ifdef EVMNG_READ_LOCKED
 		cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
+#endif
 		return;
 	}
+
 	evmng_cb_list_ptr = g_evmng_events_list[i].head;
 #pragma fn_ptr_candidates(app_dpni_event_added_cb)
 	while(evmng_cb_list_ptr != NULL){
@@ -410,7 +536,9 @@ EV_MNG_CODE_PLACEMENT static void raise_event(uint8_t generator_id, uint8_t even
 				event_data);
 		evmng_cb_list_ptr = evmng_cb_list_ptr->next;
 	}
+#ifdef EVMNG_READ_LOCKED
 	cdma_mutex_lock_release((uint64_t) g_evmng_events_list);
+#endif
 }
 /*****************************************************************************/
 
@@ -475,6 +603,7 @@ int evmng_early_init(void)
 
 
 	memset(g_evmng_events_list, 0, EVMNG_MAX_NUM_OF_EVENTS *  sizeof(struct evmng));
+	memset(g_evmng_events_hash, EVMNG_HASH_FREE, EVMNG_HASH_SIZE);
 
 	g_evmng_events_last_used_index = 0;
 
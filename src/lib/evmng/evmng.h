@@ -42,6 +42,21 @@
 /** Sum of all events in the system */
 #define EVMNG_MAX_NUM_OF_EVENTS (NUM_OF_SL_DEFINED_EVENTS + 128)
 
+/** Index of g_evmng_events_list by (generator_id, event_id), must be power
+ * of 2 and larger than EVMNG_MAX_NUM_OF_EVENTS */
+#define EVMNG_HASH_BITS		8
+#define EVMNG_HASH_SIZE		(1 << EVMNG_HASH_BITS)
+#define EVMNG_HASH_FREE		0	/**< Never used index slot */
+#define EVMNG_HASH_DELETED	0xFF	/**< Index slot of a removed event */
+#define EVMNG_HASH_NEXT(H)	(((H) + 1) & (EVMNG_HASH_SIZE - 1))
+#define EVMNG_HASH_PREV(H)	(((H) - 1) & (EVMNG_HASH_SIZE - 1))
+
+#ifdef LS2085A_REV1
+/** This build has no RCU (rcu_stub.c) and rcu_synchronize() does not wait:
+ * the raised events walk the callbacks under the events list read mutex */
+#define EVMNG_READ_LOCKED
+#endif
+
 /**************************************************************************//**
 @Description Structure representing linked list per event_id sorted by priority.
 
@@ -77,6 +77,38 @@ void *shbp_flib_acquire(uint64_t bp);
  */
 int shbp_flib_release(uint64_t bp, void *buf);
 
+/**
+ * @brief	Get up to num buffers from shared pool
+ *
+ * The pool header is read once for the whole burst.
+ *
+ * @param[in]	bp   - Buffer pool handle
+ * @param[out]	bufs - Array of at least num pointers to be filled
+ * @param[in]	num  - Maximal number of buffers to acquire
+ *
+ * @returns	The number of acquired buffers, 0 if the pool is empty or
+ * 		the host is not the allocation master
+ *
+ */
+int shbp_flib_acquire_burst(uint64_t bp, void **bufs, uint32_t num);
+
+/**
+ * @brief	Return or add up to num buffers into the shared pool
+ *
+ * The pool header is read once for the whole burst. If the pool was
+ * created with #SHBP_HOST_MP it may be called by several threads at the
+ * same time.
+ *
+ * @param[in]	bp   - Buffer pool handle
+ * @param[in]	bufs - Array of buffer pointers
+ * @param[in]	num  - Number of buffers in bufs
+ *
+ * @returns	The number of released buffers, it is less than num if the
+ * 		allocation queue is full
+ *
+ */
+int shbp_flib_release_burst(uint64_t bp, void **bufs, uint32_t num);
+
 /**
  * @brief	Create shared pool from a given buffer
  *
@@ -88,7 +120,7 @@ int shbp_flib_release(uint64_t bp, void *buf);
  *
  * @param[in]	size     - Size of mem_ptr
  * @param[in]	flags    - Flags to be used for pool creation, 0 means AIOP is
- * 		the allocation master. See #SHBP_GPP_MASTER.
+ * 		the allocation master. See #SHBP_GPP_MASTER and #SHBP_HOST_MP.
  * @param[out]  bp       - Pointer to shared pool handle
  *
  * @returns	0 on Success; or POSIX error code otherwise
@@ -45,6 +45,10 @@
 
 #define SHBP_HOST_IS_MASTER	0x1	/*!< Host is the allocation master */
 #define SHBP_HOST_SAFE		0x2	/*!< Host API is multithread safe */
+#define SHBP_HOST_MP		0x4
+/*!< Several host threads may release into the pool at the same time without
+ * a lock. The enqueue index is reserved by compare and swap; acquire,
+ * refill and destroy must still be called by one thread at a time */
 
 
 /**
@@ -75,7 +79,8 @@ int shbp_release(uint64_t bp, void *buf);
  * @param[in]	flags    - Flags to be used for pool creation, 0 means AIOP is
  * 		the allocation master, #SHBP_HOST_IS_MASTER means GPP is
  * 		the allocation master and can acquire buffers from it,
- * 		#SHBP_HOST_SAFE makes it thread safe.
+ * 		#SHBP_HOST_SAFE makes it thread safe, #SHBP_HOST_MP allows
+ * 		lockless multi-producer release.
  * @param[in]	buf_num  - Maximal number of buffers in pool.
  * 		Must be power of 2.
  * @param[out]  bp       - Pointer to shared pool handle
@@ -44,6 +44,23 @@
 	} while(0)
 /*!< It is more efficient to copy to cached stack and then process */
 
+#ifndef SHBP_CAS32
+#define SHBP_CAS32(PTR, OLD, NEW) \
+	__sync_bool_compare_and_swap((PTR), (OLD), (NEW))
+#endif /*!< May be overridden by the host environment */
+
+#ifndef SHBP_MB
+#define SHBP_MB()	__sync_synchronize()
+#endif /*!< May be overridden by the host environment */
+
+#ifndef SHBP_CPU_RELAX
+#define SHBP_CPU_RELAX()
+#endif /*!< Called while waiting for another producer to publish */
+
+#define SHBP_IS_MP(BP)	((BP)->flags & SHBP_HOST_MP)
+
+#define SHBP_BD(Q, IND)	(((uint64_t *)SHBP_BUF_TO_PTR((Q)->base))[IND])
+
 uint32_t shbp_flib_mem_ptr_size(uint32_t num_bufs)
 {
 	return SHBP_TOTAL_BYTES + (16 * (num_bufs));
@@ -81,6 +98,97 @@ static void release(struct shbp *bp, struct shbp_q *lq,
 	q->enq = CPU_TO_LE32(lq->enq); /* Must be last */
 }
 
+static uint32_t acquire_burst(struct shbp *bp, struct shbp_q *lq,
+                              struct shbp_q *q, void **bufs, uint32_t num)
+{
+	uint32_t i;
+	uint32_t avail = lq->enq - lq->deq;
+
+	if (num > avail)
+		num = avail;
+
+	SHBP_MB(); /* BDs must be read after the enqueue index */
+	for (i = 0; i < num; i++)
+		bufs[i] = SHBP_BUF_TO_PTR(CPU_TO_LE64(
+			SHBP_BD(lq, SHBP_BD_IND(bp, lq->deq + i))));
+
+	lq->deq += num;
+	q->deq = CPU_TO_LE32(lq->deq); /* Must be last */
+
+	return num;
+}
+
+static uint32_t release_burst(struct shbp *bp, struct shbp_q *lq,
+                              struct shbp_q *q, void **bufs, uint32_t num)
+{
+	uint32_t i;
+	uint32_t room = SHBP_SIZE(bp) - (lq->enq - lq->deq);
+
+	if (num > room)
+		num = room;
+
+	for (i = 0; i < num; i++)
+		SHBP_BD(lq, SHBP_BD_IND(bp, lq->enq + i)) =
+			CPU_TO_LE64(SHBP_PTR_TO_BUF(bufs[i]));
+
+	lq->enq += num;
+	q->enq = CPU_TO_LE32(lq->enq); /* Must be last */
+
+	return num;
+}
+
+/* Reserve up to num BDs of the allocations queue for this producer,
+ * returns the number of reserved BDs starting at head */
+static uint32_t mp_reserve(struct shbp *lbp, struct shbp *bp, uint32_t num,
+                           uint32_t *head)
+{
+	uint32_t resv, deq, room;
+
+	do {
+		resv = bp->alloc_resv;
+		deq = CPU_TO_LE32(bp->alloc.deq);
+		*head = CPU_TO_LE32(resv);
+		room = SHBP_SIZE(lbp) - (*head - deq);
+		if (num > room)
+			num = room;
+		if (num == 0)
+			return 0;
+	} while (!SHBP_CAS32(&bp->alloc_resv, resv,
+	                     CPU_TO_LE32(*head + num)));
+
+	return num;
+}
+
+/* Publish the reserved BDs once all the earlier reservations are
+ * published, the consumers see only alloc.enq */
+static void mp_commit(struct shbp *bp, uint32_t head, uint32_t num)
+{
+	volatile uint32_t *enq = &bp->alloc.enq;
+
+	while (CPU_TO_LE32(*enq) != head)
+		SHBP_CPU_RELAX();
+
+	SHBP_MB(); /* BDs must be visible before the enqueue index */
+	*enq = CPU_TO_LE32(head + num);
+}
+
+static uint32_t release_burst_mp(struct shbp *lbp, struct shbp *bp,
+                                 void **bufs, uint32_t num)
+{
+	uint32_t head, i;
+
+	num = mp_reserve(lbp, bp, num, &head);
+
+	for (i = 0; i < num; i++)
+		SHBP_BD(&lbp->alloc, SHBP_BD_IND(lbp, head + i)) =
+			CPU_TO_LE64(SHBP_PTR_TO_BUF(bufs[i]));
+
+	if (num)
+		mp_commit(bp, head, num);
+
+	return num;
+}
+
 int shbp_flib_create(void *mem_ptr, uint32_t size, uint32_t flags, uint64_t *_bp)
 {
 	struct shbp *bp;
@@ -109,6 +217,7 @@ int shbp_flib_create(void *mem_ptr, uint32_t size, uint32_t flags, uint64_t *_bp
 	bp->max_num = get_num_of_first_bit(ring_size);
 	
 	bp->alloc_master = (uint8_t)(flags & SHBP_HOST_IS_MASTER);
+	bp->flags = (uint8_t)(flags & SHBP_HOST_MP);
 		
 	bp->alloc.base = (uint64_t)(((uint8_t *)bp) + SHBP_TOTAL_BYTES);
 	/* Each BD is 8 bytes */
@@ -166,6 +275,9 @@ int shbp_flib_release(uint64_t _bp, void *buf)
 	
 	COPY_AND_SWAP(lbp, bp);
 
+	if (SHBP_IS_MP(&lbp))
+		return release_burst_mp(&lbp, bp, &buf, 1) ? 0 : -ENOSPC;
+
 	if (SHBP_ALLOC_IS_FULL(&lbp))
 		return -ENOSPC;
 	
@@ -174,6 +286,63 @@ int shbp_flib_release(uint64_t _bp, void *buf)
 	return 0;
 }
 
+int shbp_flib_acquire_burst(uint64_t _bp, void **bufs, uint32_t num)
+{
+	struct shbp lbp;
+	struct shbp *bp = (struct shbp *)_bp;
+
+#ifdef DEBUG
+	if ((bufs == NULL) || (bp == NULL))
+		return -EINVAL;
+#endif
+
+	COPY_AND_SWAP(lbp, bp);
+
+	if (!(lbp.alloc_master & SHBP_HOST_IS_MASTER))
+		return 0;
+
+	return (int)acquire_burst(&lbp, &lbp.alloc, &bp->alloc, bufs, num);
+}
+
+int shbp_flib_release_burst(uint64_t _bp, void **bufs, uint32_t num)
+{
+	struct shbp lbp;
+	struct shbp *bp = (struct shbp *)_bp;
+
+#ifdef DEBUG
+	if ((bufs == NULL) || (bp == NULL))
+		return -EINVAL;
+#endif
+
+	COPY_AND_SWAP(lbp, bp);
+
+	if (SHBP_IS_MP(&lbp))
+		return (int)release_burst_mp(&lbp, bp, bufs, num);
+
+	return (int)release_burst(&lbp, &lbp.alloc, &bp->alloc, bufs, num);
+}
+
+static int refill_mp(struct shbp *lbp, struct shbp *bp)
+{
+	uint32_t head, num, i;
+
+	/* Only this thread consumes the free queue so its content can only
+	 * grow until the BDs are moved */
+	num = mp_reserve(lbp, bp, lbp->free.enq - lbp->free.deq, &head);
+
+	for (i = 0; i < num; i++)
+		SHBP_BD(&lbp->alloc, SHBP_BD_IND(lbp, head + i)) =
+			SHBP_BD(&lbp->free, SHBP_BD_IND(lbp, lbp->free.deq + i));
+
+	if (num) {
+		lbp->free.deq += num;
+		bp->free.deq = CPU_TO_LE32(lbp->free.deq);
+		mp_commit(bp, head, num);
+	}
+
+	return (int)num;
+}
+
 int shbp_flib_refill(uint64_t _bp)
 {
 	void *buf;
@@ -187,6 +356,9 @@ int shbp_flib_refill(uint64_t _bp)
 #endif
 	COPY_AND_SWAP(lbp, bp);
 
+	if (SHBP_IS_MP(&lbp))
+		return refill_mp(&lbp, bp);
+
 	while(!SHBP_FREE_IS_EMPTY(&lbp) && !SHBP_ALLOC_IS_FULL(&lbp)) {
 		buf = acquire(&lbp, &lbp.free, &bp->free);
 #ifdef DEBUG
@@ -117,6 +117,13 @@ struct shbp {
 	/*!< Max number of BDs in the pool is 2^max_buf, must be 1 byte */
 	uint8_t host_user_space[SHBP_HOST_BYTES];
 	/*!< Space to be used by host implementation */
+	uint8_t flags;
+	/*!< Host flags the pool was created with, see #SHBP_HOST_MP */
+	uint8_t reserved;
+	uint32_t alloc_resv;
+	/*!< Allocations queue enqueue index reserved by the host producers,
+	 * used only with #SHBP_HOST_MP; alloc.enq follows it once the
+	 * buffers are written */
 	
 	/* See also SHBP_TOTAL_BYTES */
 };
@@ -43,9 +43,15 @@
 #include "fsl_bman.h"
 #include "fsl_sys.h"
 #include "fsl_platform.h"
+#include "fsl_core.h"
+#include "fsl_ste.h"
 
 struct slab_bman_pool_desc g_slab_bman_pools[SLAB_MAX_BMAN_POOLS_NUM];
 struct slab_virtual_pools_main_desc g_slab_virtual_pools;
+struct slab_magazine *g_slab_magazines;
+#ifdef SLAB_DDR_STE_ACCOUNTING
+struct slab_ddr_credit *g_slab_ddr_credits;
+#endif
 uint64_t g_slab_pool_pointer_ddr;
 uint64_t g_slab_last_pool_pointer_ddr;
 uint16_t g_slab_ddr_memory;
@@ -89,6 +95,9 @@ __COLD_CODE static int slab_read_pool(uint32_t slab_pool_id,
 	struct slab_v_pool slab_virtual_pool_ddr;
 	uint32_t pool_id = SLAB_POOL_ID_GET(slab_pool_id); /*fetch pool id*/
 	uint64_t pool_data_address;
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	struct slab_ddr_credit *credit;
+#endif
 
 	pr_info("pool ID %d, Cluster %d\n", pool_id, cluster);
 	if(cluster == 0){
@@ -106,6 +115,16 @@ __COLD_CODE static int slab_read_pool(uint32_t slab_pool_id,
 		cdma_read(  &slab_virtual_pool_ddr,
 		            pool_data_address,
 		            (uint16_t)sizeof(slab_virtual_pool_ddr));
+#ifdef SLAB_DDR_STE_ACCOUNTING
+		/* The STE counters may miss the updates queued by other tasks */
+		credit = &g_slab_ddr_credits[SLAB_DDR_CREDIT_INDEX(cluster,
+		                                                   pool_id)];
+		lock_spinlock((uint8_t *)&credit->spinlock);
+		slab_virtual_pool_ddr.allocated_bufs = credit->committed_bufs -
+			credit->credits + credit->extra_bufs;
+		unlock_spinlock((uint8_t *)&credit->spinlock);
+		slab_virtual_pool_ddr.failed_allocs = credit->failed_allocs;
+#endif
 		slab_virtual_pool = &slab_virtual_pool_ddr;
 	}
 
@@ -146,6 +165,7 @@ __COLD_CODE static void slab_pool_init(
 	g_slab_virtual_pools.virtual_pool_struct = virtual_pool_struct;
 	g_slab_virtual_pools.shram_count = 0;
 	g_slab_virtual_pools.flags = flags;
+	qspinlock_init(&g_slab_virtual_pools.global_lock, "slab root");
 
 	/* Init 'max' to zero, since it's an indicator to
 	 * pool ID availability */
@@ -159,8 +179,7 @@ __COLD_CODE static void slab_pool_init(
 
 	for (i = 0; i< SLAB_MAX_BMAN_POOLS_NUM; i++) {
 		g_slab_bman_pools[i].remaining = -1;
-		/* clear spinlock indicator */
-		g_slab_bman_pools[i].spinlock = 0;
+		qspinlock_init(&g_slab_bman_pools[i].lock, "slab bman pool");
 	}
 
 	for (i = 0; i <= g_slab_virtual_pools.num_clusters ; i++) /*number of clusters: 1 for SHRAM and 100 for DDR*/
@@ -217,8 +236,7 @@ __COLD_CODE static int slab_decr_bman_buffs_from_pool(
 		sl_pr_err("Error, pool with bpid %d not found\n", bman_pool_id);
 		return -EINVAL;
 	}
-	lock_spinlock(
-		(uint8_t *)&g_slab_bman_pools[bman_array_index].spinlock);
+	lock_qspinlock(&g_slab_bman_pools[bman_array_index].lock);
 
 	/* Check if there are enough buffers to reserve */
 	if (g_slab_bman_pools[bman_array_index].remaining >= less_bufs) {
@@ -226,12 +244,10 @@ __COLD_CODE static int slab_decr_bman_buffs_from_pool(
 		g_slab_bman_pools[bman_array_index].remaining -=
 			less_bufs;
 
-		unlock_spinlock((uint8_t *)
-		                &g_slab_bman_pools[bman_array_index].spinlock);
+		unlock_qspinlock(&g_slab_bman_pools[bman_array_index].lock);
 
 	} else {
-		unlock_spinlock((uint8_t *)
-		                &g_slab_bman_pools[bman_array_index].spinlock);
+		unlock_qspinlock(&g_slab_bman_pools[bman_array_index].lock);
 		return -ENOMEM;
 	}
 
@@ -294,7 +310,7 @@ __COLD_CODE int slab_find_and_reserve_bpid(uint32_t num_buffs,
 			 * if lower found, lock acquire return*/
 
 
-			lock_spinlock((uint8_t *)&g_slab_bman_pools[i].spinlock);
+			lock_qspinlock(&g_slab_bman_pools[i].lock);
 			if (g_slab_bman_pools[i].remaining >= num_buffs)
 			{
 				if(!found) { /*found  = FALSE in the first time */
@@ -312,7 +328,7 @@ __COLD_CODE int slab_find_and_reserve_bpid(uint32_t num_buffs,
 
 				}
 			}
-			unlock_spinlock((uint8_t *) &g_slab_bman_pools[i].spinlock);
+			unlock_qspinlock(&g_slab_bman_pools[i].lock);
 
 		}
 	} /*for (i = 0; i < num_bpids; i++)*/
@@ -338,6 +354,12 @@ __COLD_CODE static void free_slab_module_memory(struct slab_module_info *slab_m)
 		if (g_slab_virtual_pools.slab_context_address[i])
 			cdma_refcount_decrement_and_release(g_slab_virtual_pools.slab_context_address[i]);
 	fsl_free(g_slab_virtual_pools.slab_context_address);
+	if (g_slab_magazines)
+		fsl_free(g_slab_magazines);
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	if (g_slab_ddr_credits)
+		fsl_free(g_slab_ddr_credits);
+#endif
 	if (g_slab_virtual_pools.virtual_pool_struct)
 		fsl_free(g_slab_virtual_pools.virtual_pool_struct);
 	if (slab_m->hw_pools)
@@ -353,8 +375,8 @@ static int sanity_check_slab_create(uint16_t    buff_size,
 {
 	SLAB_ASSERT_COND_RETURN(buff_size > 0,   -EINVAL);
 	SLAB_ASSERT_COND_RETURN(alignment > 0,   -EINVAL);
-	SLAB_ASSERT_COND_RETURN(flags == 0 || flags == SLAB_DDR_MANAGEMENT_FLAG,
-	                        -EINVAL);
+	SLAB_ASSERT_COND_RETURN((flags & ~(SLAB_DDR_MANAGEMENT_FLAG |
+		SLAB_MAGAZINE_FLAG)) == 0, -EINVAL);
 	SLAB_ASSERT_COND_RETURN(is_power_of_2(alignment), -EINVAL);
 	SLAB_ASSERT_COND_RETURN(((mem_pid == MEM_PART_DP_DDR) ||
 		(mem_pid == MEM_PART_SYSTEM_DDR) ||
@@ -362,6 +384,428 @@ static int sanity_check_slab_create(uint16_t    buff_size,
 	return 0;
 }
 #endif
+/*****************************************************************************/
+__COLD_CODE static void slab_magazine_attach(struct slab **slab,
+                                             uint16_t bman_array_index,
+                                             slab_release_cb_t *release_cb)
+{
+	int i, j;
+	struct slab_magazine *mag = g_slab_magazines;
+
+	lock_qspinlock(&g_slab_virtual_pools.global_lock);
+	for (i = 0; i < SLAB_MAX_NUM_MAGAZINES; i++, mag++) {
+		if (mag->slab == 0) {
+			mag->slab = *((uint32_t *)slab);
+			break;
+		}
+	}
+	unlock_qspinlock(&g_slab_virtual_pools.global_lock);
+
+	if (i == SLAB_MAX_NUM_MAGAZINES) {
+		/* Magazine is an optimization, the slab is usable without it */
+		pr_debug("No free magazine, slab created without magazine\n");
+		return;
+	}
+
+	mag->callback_func = release_cb;
+	mag->bman_array_index = bman_array_index;
+	mag->failed_allocs = 0;
+	for (j = 0; j < INTG_MAX_NUM_OF_CORES; j++) {
+		mag->core[j].credits = 0;
+		mag->core[j].hits = 0;
+		mag->core[j].misses = 0;
+		mag->core[j].spinlock = 0;
+	}
+
+	*((uint32_t *)slab) |= SLAB_MAGAZINE_SET(i + 1);
+}
+
+#ifdef SLAB_DDR_STE_ACCOUNTING
+/*****************************************************************************/
+__COLD_CODE static void slab_ddr_credit_init(uint16_t cluster,
+                                             uint32_t pool_id,
+                                             uint32_t committed_buffs,
+                                             uint16_t bman_array_index,
+                                             slab_release_cb_t *release_cb)
+{
+	struct slab_ddr_credit *credit =
+		&g_slab_ddr_credits[SLAB_DDR_CREDIT_INDEX(cluster, pool_id)];
+
+	credit->credits = (int32_t)committed_buffs;
+	credit->committed_bufs = (int32_t)committed_buffs;
+	credit->extra_bufs = 0;
+	credit->failed_allocs = 0;
+	credit->bman_array_index = bman_array_index;
+	credit->spinlock = 0;
+	credit->flags = (uint8_t)((release_cb != NULL) ?
+		SLAB_DDR_CREDIT_CB_FLAG : 0);
+}
+
+/*****************************************************************************/
+/* DDR managed pool version of slab_vp_reserve_bufs().
+ * Only the shared RAM credits are checked, the pool max is read from DDR
+ * only for allocations above the committed area. */
+SLAB_CODE_PLACEMENT static int32_t slab_ddr_reserve_bufs(uint32_t vp_id,
+                                                         int32_t num_buffs,
+                                                         int32_t min_buffs,
+                                                         int allow_extra,
+                                                         uint16_t *bman_index)
+{
+	uint16_t cluster = SLAB_CLUSTER_ID_GET(vp_id);
+	uint32_t pool_id = SLAB_POOL_ID_GET(vp_id);
+	struct slab_ddr_credit *credit =
+		&g_slab_ddr_credits[SLAB_DDR_CREDIT_INDEX(cluster, pool_id)];
+	uint16_t bman_array_index = credit->bman_array_index;
+	uint64_t pool_data_address =
+		g_slab_virtual_pools.slab_context_address[cluster] +
+		(sizeof(struct slab_v_pool) * pool_id);
+	int32_t max_bufs = 0, reserved, extra;
+
+	if (bman_index != NULL)
+		*bman_index = bman_array_index;
+
+	/* max_bufs is not modified while the slab exists */
+	if (allow_extra && (credit->credits < num_buffs))
+		cdma_read(&max_bufs,
+		          pool_data_address +
+		          offsetof(struct slab_v_pool, max_bufs),
+		          (uint16_t)sizeof(max_bufs));
+
+	lock_spinlock((uint8_t *)&credit->spinlock);
+	reserved = MIN(credit->credits, num_buffs);
+	extra = MIN(num_buffs - reserved, max_bufs - credit->committed_bufs -
+		credit->extra_bufs);
+	if (extra > 0) {
+		lock_qspinlock(&g_slab_bman_pools[bman_array_index].lock);
+		if (extra > g_slab_bman_pools[bman_array_index].remaining)
+			extra = g_slab_bman_pools[bman_array_index].remaining;
+		if ((extra > 0) && (reserved + extra >= min_buffs))
+			g_slab_bman_pools[bman_array_index].remaining -= extra;
+		else
+			extra = 0;
+		unlock_qspinlock(&g_slab_bman_pools[bman_array_index].lock);
+	} else {
+		extra = 0;
+	}
+
+	if (reserved + extra < min_buffs) {
+		unlock_spinlock((uint8_t *)&credit->spinlock);
+		/* Only the last attempt (allow_extra) is a failure */
+		if (allow_extra) {
+			ste_inc_counter(pool_data_address +
+			                offsetof(struct slab_v_pool, failed_allocs),
+			                1, STE_MODE_32_BIT_CNTR_SIZE);
+			atomic_incr32(&credit->failed_allocs, 1);
+			atomic_incr32(&g_slab_bman_pools[bman_array_index].
+			              failed_allocs, 1);
+		}
+		return 0;
+	}
+	credit->credits -= reserved;
+	credit->extra_bufs += extra;
+	unlock_spinlock((uint8_t *)&credit->spinlock);
+
+	reserved += extra;
+	if (reserved) {
+		ste_inc_counter(pool_data_address +
+		                offsetof(struct slab_v_pool, allocated_bufs),
+		                (uint32_t)reserved, STE_MODE_32_BIT_CNTR_SIZE);
+		atomic_incr32(&g_slab_bman_pools[bman_array_index].allocated,
+		              reserved);
+	}
+	return reserved;
+}
+
+/*****************************************************************************/
+/* DDR managed pool version of slab_vp_unreserve_bufs() */
+SLAB_CODE_PLACEMENT static void slab_ddr_unreserve_bufs(uint32_t vp_id,
+                                                        int32_t num_buffs)
+{
+	uint16_t cluster = SLAB_CLUSTER_ID_GET(vp_id);
+	uint32_t pool_id = SLAB_POOL_ID_GET(vp_id);
+	struct slab_ddr_credit *credit =
+		&g_slab_ddr_credits[SLAB_DDR_CREDIT_INDEX(cluster, pool_id)];
+	int32_t extra;
+
+	/* Buffers above the committed area return to the common pool first */
+	lock_spinlock((uint8_t *)&credit->spinlock);
+	extra = MIN(num_buffs, credit->extra_bufs);
+	credit->extra_bufs -= extra;
+	credit->credits += num_buffs - extra;
+	unlock_spinlock((uint8_t *)&credit->spinlock);
+
+	if (extra > 0)
+		atomic_incr32(&g_slab_bman_pools[credit->bman_array_index].
+		              remaining, extra);
+	ste_dec_counter(g_slab_virtual_pools.slab_context_address[cluster] +
+	                (sizeof(struct slab_v_pool) * pool_id) +
+	                offsetof(struct slab_v_pool, allocated_bufs),
+	                (uint32_t)num_buffs, STE_MODE_32_BIT_CNTR_SIZE);
+	atomic_decr32(&g_slab_bman_pools[credit->bman_array_index].allocated,
+	              num_buffs);
+}
+
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT static int slab_ddr_acquire(struct slab *slab,
+                                                uint64_t *buff)
+{
+	int return_val;
+	uint32_t slab_pool_id = SLAB_VP_POOL_GET(slab);
+	uint16_t bman_array_index;
+
+	if (slab_ddr_reserve_bufs(slab_pool_id, 1, 1, 1,
+	                          &bman_array_index) == 0) {
+		sl_pr_err("No memory to acquire from\n");
+		return -ENOMEM;
+	}
+
+	/* allocate a buffer with the CDMA */
+	return_val = cdma_acquire_context_memory(
+		(uint16_t)g_slab_bman_pools[bman_array_index].bman_pool_id,
+		buff);
+	if (return_val) {
+		slab_ddr_unreserve_bufs(slab_pool_id, 1);
+		ste_inc_counter(
+			g_slab_virtual_pools.slab_context_address[
+				SLAB_CLUSTER_ID_GET(slab_pool_id)] +
+			(sizeof(struct slab_v_pool) *
+				SLAB_POOL_ID_GET(slab_pool_id)) +
+			offsetof(struct slab_v_pool, failed_allocs),
+			1, STE_MODE_32_BIT_CNTR_SIZE);
+		atomic_incr32(&g_slab_ddr_credits[SLAB_DDR_CREDIT_INDEX(
+			SLAB_CLUSTER_ID_GET(slab_pool_id),
+			SLAB_POOL_ID_GET(slab_pool_id))].failed_allocs, 1);
+		atomic_incr32(&g_slab_bman_pools[bman_array_index].
+		              failed_allocs, 1);
+	}
+	return return_val;
+}
+
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT static int slab_ddr_release(struct slab *slab,
+                                                uint64_t buff)
+{
+	uint32_t slab_pool_id = SLAB_VP_POOL_GET(slab);
+	uint16_t cluster = SLAB_CLUSTER_ID_GET(slab_pool_id);
+	uint32_t pool_id = SLAB_POOL_ID_GET(slab_pool_id);
+	slab_release_cb_t *callback_func;
+
+	/* callback is not modified while the slab exists */
+	if (g_slab_ddr_credits[SLAB_DDR_CREDIT_INDEX(cluster, pool_id)].flags &
+		SLAB_DDR_CREDIT_CB_FLAG) {
+		cdma_read(&callback_func,
+		          g_slab_virtual_pools.slab_context_address[cluster] +
+		          (sizeof(struct slab_v_pool) * pool_id) +
+		          offsetof(struct slab_v_pool, callback_func),
+		          (uint16_t)sizeof(callback_func));
+		(callback_func)(buff);
+	}
+
+	cdma_release_context_memory(buff);
+
+	slab_ddr_unreserve_bufs(slab_pool_id, 1);
+	return 0;
+}
+#endif /* SLAB_DDR_STE_ACCOUNTING */
+
+/*****************************************************************************/
+/* Reserve up to num_buffs buffers in the virtual pool accounting with a single
+ * pool update. Buffers are taken from the committed area and, if allow_extra
+ * is set, from the BMAN pool remaining buffers up to the pool max.
+ * Nothing is reserved if less than min_buffs buffers are available.
+ * Returns the number of reserved buffers and the pool bman_index */
+SLAB_CODE_PLACEMENT static int32_t slab_vp_reserve_bufs(uint32_t vp_id,
+                                                        int32_t num_buffs,
+                                                        int32_t min_buffs,
+                                                        int allow_extra,
+                                                        uint16_t *bman_index)
+{
+	uint16_t cluster = SLAB_CLUSTER_ID_GET(vp_id);
+	uint32_t pool_id = SLAB_POOL_ID_GET(vp_id);
+	uint16_t bman_array_index;
+	int32_t reserved, extra;
+	uint64_t pool_data_address;
+	struct slab_v_pool *slab_virtual_pool;
+	struct slab_v_pool slab_virtual_pool_ddr;
+
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	if (cluster != 0)
+		return slab_ddr_reserve_bufs(vp_id, num_buffs, min_buffs,
+		                             allow_extra, bman_index);
+#endif
+	if (cluster == 0) {
+		slab_virtual_pool = g_slab_virtual_pools.virtual_pool_struct +
+			pool_id;
+		lock_spinlock((uint8_t *)&slab_virtual_pool->spinlock);
+	} else {
+		pool_data_address =
+			g_slab_virtual_pools.slab_context_address[cluster] +
+			(sizeof(slab_virtual_pool_ddr) * pool_id);
+		cdma_read_with_mutex(pool_data_address,
+		                     CDMA_PREDMA_MUTEX_WRITE_LOCK,
+		                     &slab_virtual_pool_ddr,
+		                     (uint16_t)sizeof(slab_virtual_pool_ddr));
+		slab_virtual_pool = &slab_virtual_pool_ddr;
+	}
+	bman_array_index = slab_virtual_pool->bman_array_index;
+
+	/* First take buffers from the VP committed area */
+	reserved = slab_virtual_pool->committed_bufs -
+		slab_virtual_pool->allocated_bufs;
+	if (reserved < 0)
+		reserved = 0;
+	if (reserved > num_buffs)
+		reserved = num_buffs;
+
+	/* Then from the VP max-committed area, if BMAN pool has buffers */
+	extra = MIN(num_buffs - reserved, slab_virtual_pool->max_bufs -
+		slab_virtual_pool->allocated_bufs - reserved);
+	if (allow_extra && (extra > 0)) {
+		lock_qspinlock(&g_slab_bman_pools[bman_array_index].lock);
+		if (extra > g_slab_bman_pools[bman_array_index].remaining)
+			extra = g_slab_bman_pools[bman_array_index].remaining;
+		if ((extra > 0) && (reserved + extra >= min_buffs)) {
+			g_slab_bman_pools[bman_array_index].remaining -= extra;
+			reserved += extra;
+		}
+		unlock_qspinlock(&g_slab_bman_pools[bman_array_index].lock);
+	}
+
+	if (reserved < min_buffs) {
+		reserved = 0;
+		/* Only the last attempt (allow_extra) is a failure */
+		if (allow_extra) {
+			slab_virtual_pool->failed_allocs++;
+			atomic_incr32(&g_slab_bman_pools[bman_array_index].
+			              failed_allocs, 1);
+		}
+	}
+	slab_virtual_pool->allocated_bufs += reserved;
+
+	if (cluster == 0)
+		unlock_spinlock((uint8_t *)&slab_virtual_pool->spinlock);
+	else
+		cdma_write_with_mutex(pool_data_address,
+		                      CDMA_POSTDMA_MUTEX_RM_BIT,
+		                      &slab_virtual_pool_ddr,
+		                      (uint16_t)sizeof(slab_virtual_pool_ddr));
+
+	if (reserved)
+		atomic_incr32(&g_slab_bman_pools[bman_array_index].allocated,
+		              reserved);
+	if (bman_index != NULL)
+		*bman_index = bman_array_index;
+	return reserved;
+}
+
+/*****************************************************************************/
+/* Return num_buffs buffers to the virtual pool accounting with a single
+ * pool update */
+SLAB_CODE_PLACEMENT static void slab_vp_unreserve_bufs(uint32_t vp_id,
+                                                       int32_t num_buffs)
+{
+	uint16_t cluster = SLAB_CLUSTER_ID_GET(vp_id);
+	uint32_t pool_id = SLAB_POOL_ID_GET(vp_id);
+	uint16_t bman_array_index;
+	int32_t extra;
+	uint64_t pool_data_address;
+	struct slab_v_pool *slab_virtual_pool;
+	struct slab_v_pool slab_virtual_pool_ddr;
+
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	if (cluster != 0) {
+		slab_ddr_unreserve_bufs(vp_id, num_buffs);
+		return;
+	}
+#endif
+	if (cluster == 0) {
+		slab_virtual_pool = g_slab_virtual_pools.virtual_pool_struct +
+			pool_id;
+		lock_spinlock((uint8_t *)&slab_virtual_pool->spinlock);
+	} else {
+		pool_data_address =
+			g_slab_virtual_pools.slab_context_address[cluster] +
+			(sizeof(slab_virtual_pool_ddr) * pool_id);
+		cdma_read_with_mutex(pool_data_address,
+		                     CDMA_PREDMA_MUTEX_WRITE_LOCK,
+		                     &slab_virtual_pool_ddr,
+		                     (uint16_t)sizeof(slab_virtual_pool_ddr));
+		slab_virtual_pool = &slab_virtual_pool_ddr;
+	}
+
+	/* Buffers above the committed area return to the common pool */
+	extra = slab_virtual_pool->allocated_bufs -
+		slab_virtual_pool->committed_bufs;
+	if (extra > num_buffs)
+		extra = num_buffs;
+	slab_virtual_pool->allocated_bufs -= num_buffs;
+	bman_array_index = slab_virtual_pool->bman_array_index;
+
+	if (cluster == 0)
+		unlock_spinlock((uint8_t *)&slab_virtual_pool->spinlock);
+	else
+		cdma_write_with_mutex(pool_data_address,
+		                      CDMA_POSTDMA_MUTEX_RM_BIT,
+		                      &slab_virtual_pool_ddr,
+		                      (uint16_t)sizeof(slab_virtual_pool_ddr));
+
+	if (extra > 0)
+		atomic_incr32(&g_slab_bman_pools[bman_array_index].remaining,
+		              extra);
+	atomic_decr32(&g_slab_bman_pools[bman_array_index].allocated,
+	              num_buffs);
+}
+
+/*****************************************************************************/
+/* Number of buffers of the virtual pool allocated above its committed area,
+ * i.e. taken from the BMAN pool remaining buffers shared with the other
+ * slabs. The buffers cached by the magazines are allocated buffers. */
+SLAB_CODE_PLACEMENT static int32_t slab_vp_extra_bufs(uint32_t vp_id)
+{
+	uint16_t cluster = SLAB_CLUSTER_ID_GET(vp_id);
+	uint32_t pool_id = SLAB_POOL_ID_GET(vp_id);
+	struct slab_v_pool *slab_virtual_pool;
+	struct slab_v_pool slab_virtual_pool_ddr;
+
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	if (cluster != 0)
+		return g_slab_ddr_credits[
+			SLAB_DDR_CREDIT_INDEX(cluster, pool_id)].extra_bufs;
+#endif
+	if (cluster == 0) {
+		slab_virtual_pool = g_slab_virtual_pools.virtual_pool_struct +
+			pool_id;
+	} else {
+		cdma_read(&slab_virtual_pool_ddr,
+		          g_slab_virtual_pools.slab_context_address[cluster] +
+		          (sizeof(slab_virtual_pool_ddr) * pool_id),
+		          (uint16_t)sizeof(slab_virtual_pool_ddr));
+		slab_virtual_pool = &slab_virtual_pool_ddr;
+	}
+
+	return slab_virtual_pool->allocated_bufs -
+		slab_virtual_pool->committed_bufs;
+}
+
+/*****************************************************************************/
+/* Return the buffers cached by all the core magazines to the virtual pool */
+SLAB_CODE_PLACEMENT static void slab_magazine_drain(struct slab_magazine *mag,
+                                                    uint32_t vp_id)
+{
+	int i;
+	int32_t num_credits = 0;
+
+	for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+		lock_spinlock((uint8_t *)&mag->core[i].spinlock);
+		num_credits += mag->core[i].credits;
+		mag->core[i].credits = 0;
+		unlock_spinlock((uint8_t *)&mag->core[i].spinlock);
+	}
+
+	if (num_credits)
+		slab_vp_unreserve_bufs(vp_id, num_credits);
+}
+
 /*****************************************************************************/
 __COLD_CODE int slab_create(uint32_t    committed_buffs,
                 uint32_t    max_buffs,
@@ -421,7 +865,7 @@ __COLD_CODE int slab_create(uint32_t    committed_buffs,
 
 	/*********************found the right bpid for future virtual pool*************************/
 
-	lock_spinlock((uint8_t *)&g_slab_virtual_pools.global_spinlock);
+	lock_qspinlock(&g_slab_virtual_pools.global_lock);
 	/*
 	 * Allocate pool
 	 * Return with error if it was not possible to allocate pool.
@@ -442,7 +886,7 @@ __COLD_CODE int slab_create(uint32_t    committed_buffs,
 			slab_virtual_pool++; /* increment the pointer for slab virtual pull */
 		}
 		if(found){
-			unlock_spinlock((uint8_t *)&g_slab_virtual_pools.global_spinlock);
+			unlock_qspinlock(&g_slab_virtual_pools.global_lock);
 
 			slab_virtual_pool->committed_bufs = (int32_t)committed_buffs;
 			slab_virtual_pool->allocated_bufs = 0;
@@ -450,11 +894,14 @@ __COLD_CODE int slab_create(uint32_t    committed_buffs,
 			slab_virtual_pool->flags = (uint8_t)flags;
 			slab_virtual_pool->callback_func = release_cb;
 			*((uint32_t *)slab) = SLAB_HW_POOL_CREATE(pool_id); /*the cluster is 0, no need to write it in slab id*/
+			if (flags & SLAB_MAGAZINE_FLAG)
+				slab_magazine_attach(slab, bman_array_index,
+				                     release_cb);
 			return 0;
 		}
 	}
 
-	unlock_spinlock((uint8_t *)&g_slab_virtual_pools.global_spinlock);
+	unlock_qspinlock(&g_slab_virtual_pools.global_lock);
 
 	if((flags & SLAB_DDR_MANAGEMENT_FLAG) == 0){ /*Check if DDR management flag is on*/
 		atomic_incr32(&g_slab_bman_pools[bman_array_index].remaining,
@@ -539,11 +986,23 @@ __COLD_CODE int slab_create(uint32_t    committed_buffs,
 		/* uint16_t size */
 	);
 
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	/* STE counters must be initialized by the STE */
+	ste_set_32bit_counter(context_address +
+	                      offsetof(struct slab_v_pool, allocated_bufs), 0);
+	ste_set_32bit_counter(context_address +
+	                      offsetof(struct slab_v_pool, failed_allocs), 0);
+	slab_ddr_credit_init(cluster, pool_id, committed_buffs,
+	                     bman_array_index, release_cb);
+#endif
+
 	cdma_mutex_lock_release(g_slab_last_pool_pointer_ddr);
 
 	pool_id = SLAB_CLUSTER_ID_SET(cluster) | pool_id;
 	/* Return the ID (cluster and pool_id) */
 	*((uint32_t *)slab) = SLAB_HW_POOL_CREATE(pool_id);
+	if (flags & SLAB_MAGAZINE_FLAG)
+		slab_magazine_attach(slab, bman_array_index, release_cb);
 
 	return 0;
 
@@ -565,11 +1024,15 @@ __COLD_CODE int slab_free(struct slab **slab)
 {
 	uint32_t pool_id =  SLAB_VP_POOL_GET(*slab);
 	uint16_t cluster = SLAB_CLUSTER_ID_GET(pool_id);
+	uint32_t mag_index = SLAB_MAGAZINE_GET(*slab);
 
 	struct slab_v_pool *slab_virtual_pool;
 	struct slab_v_pool slab_virtual_pool_ddr = {0};
 	uint64_t pool_data_address;
 	struct slab_module_info *slab_m = sys_get_unique_handle(FSL_MOD_SLAB);
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	struct slab_ddr_credit *credit;
+#endif
 
 	if (slab_m == NULL)
 		return -ENAVAIL;
@@ -577,10 +1040,14 @@ __COLD_CODE int slab_free(struct slab **slab)
 	if (!SLAB_IS_HW_POOL(*slab))
 		return -EINVAL;
 
+	/* Buffers cached by the magazine are not in use, return them first */
+	if (mag_index)
+		slab_magazine_drain(&g_slab_magazines[mag_index - 1], pool_id);
+
 
 	pool_id = SLAB_POOL_ID_GET(pool_id); /*take only the pool id without the cluster id bits*/
 	if(cluster == 0){
-		lock_spinlock((uint8_t *)&g_slab_virtual_pools.global_spinlock);
+		lock_qspinlock(&g_slab_virtual_pools.global_lock);
 		slab_virtual_pool = (struct slab_v_pool *)
 			g_slab_virtual_pools.virtual_pool_struct;
 		slab_virtual_pool += pool_id;
@@ -588,7 +1055,7 @@ __COLD_CODE int slab_free(struct slab **slab)
 		lock_spinlock((uint8_t *)&slab_virtual_pool->spinlock);
 		if (slab_virtual_pool->allocated_bufs != 0) {
 			unlock_spinlock((uint8_t *)&slab_virtual_pool->spinlock);
-			unlock_spinlock((uint8_t *)&g_slab_virtual_pools.global_spinlock);
+			unlock_qspinlock(&g_slab_virtual_pools.global_lock);
 			sl_pr_err("Allocated number of buffers is not 0.\n");
 			return -EACCES;
 		}
@@ -599,12 +1066,47 @@ __COLD_CODE int slab_free(struct slab **slab)
 		slab_virtual_pool->callback_func = NULL;
 		g_slab_virtual_pools.shram_count --;
 		unlock_spinlock((uint8_t *)&slab_virtual_pool->spinlock);
-		unlock_spinlock((uint8_t *)&g_slab_virtual_pools.global_spinlock);
+		unlock_qspinlock(&g_slab_virtual_pools.global_lock);
 	}
 	else{
 		pool_data_address = g_slab_virtual_pools.slab_context_address[cluster] +
 			(sizeof(slab_virtual_pool_ddr) *
 				pool_id);
+#ifdef SLAB_DDR_STE_ACCOUNTING
+		/* The shared RAM credits are exact for all the tasks, the STE
+		 * counters may still have queued updates */
+		credit = &g_slab_ddr_credits[SLAB_DDR_CREDIT_INDEX(cluster,
+		                                                   pool_id)];
+		lock_spinlock((uint8_t *)&credit->spinlock);
+		if ((credit->credits != credit->committed_bufs) ||
+		    (credit->extra_bufs != 0)) {
+			unlock_spinlock((uint8_t *)&credit->spinlock);
+			sl_pr_err("Allocated number of buffers is not 0.\n");
+			return -EACCES;
+		}
+		slab_virtual_pool_ddr.committed_bufs = credit->committed_bufs;
+		slab_virtual_pool_ddr.bman_array_index =
+			credit->bman_array_index;
+		/* No reservation from now on */
+		credit->credits = 0;
+		credit->committed_bufs = 0;
+		credit->flags = 0;
+		unlock_spinlock((uint8_t *)&credit->spinlock);
+
+		/* Only the fields owned by this path are written, the STE
+		 * counters are not rewritten. max_bufs = 0 indicates a free
+		 * pool */
+		slab_virtual_pool_ddr.max_bufs = 0;
+		slab_virtual_pool_ddr.callback_func = NULL;
+		cdma_write(pool_data_address +
+		           offsetof(struct slab_v_pool, callback_func),
+		           &slab_virtual_pool_ddr.callback_func,
+		           (uint16_t)sizeof(slab_virtual_pool_ddr.callback_func));
+		cdma_write(pool_data_address +
+		           offsetof(struct slab_v_pool, max_bufs),
+		           &slab_virtual_pool_ddr.max_bufs,
+		           (uint16_t)sizeof(slab_virtual_pool_ddr.max_bufs));
+#else
 		cdma_read_with_mutex(pool_data_address,
 		                     CDMA_PREDMA_MUTEX_WRITE_LOCK,
 		                     &slab_virtual_pool_ddr,
@@ -628,6 +1130,7 @@ __COLD_CODE int slab_free(struct slab **slab)
 		                      CDMA_POSTDMA_MUTEX_RM_BIT,
 		                      &slab_virtual_pool_ddr,
 		                      (uint16_t)sizeof(slab_virtual_pool_ddr));
+#endif /* SLAB_DDR_STE_ACCOUNTING */
 
 		cdma_mutex_lock_take(g_slab_last_pool_pointer_ddr,
 		                     CDMA_MUTEX_WRITE_LOCK);
@@ -649,12 +1152,15 @@ __COLD_CODE int slab_free(struct slab **slab)
 		cdma_mutex_lock_release(g_slab_last_pool_pointer_ddr);
 
 	}
+	if (mag_index)
+		g_slab_magazines[mag_index - 1].slab = 0; /* free the magazine */
 	*((uint32_t *)slab) = 0; /**< Delete all pool information */
 	return 0;
 }
 
 /*****************************************************************************/
-SLAB_CODE_PLACEMENT int slab_acquire(struct slab *slab, uint64_t *buff)
+SLAB_CODE_PLACEMENT static int slab_vp_acquire(struct slab *slab,
+                                               uint64_t *buff)
 {
 	int return_val;
 	int allocate = 0;
@@ -665,11 +1171,10 @@ SLAB_CODE_PLACEMENT int slab_acquire(struct slab *slab, uint64_t *buff)
 	struct slab_v_pool *slab_virtual_pool;
 	struct slab_v_pool slab_virtual_pool_ddr = {0};
 
-
-#ifdef DEBUG
-	SLAB_ASSERT_COND_RETURN(SLAB_IS_HW_POOL(slab), -EINVAL);
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	if (cluster != 0)
+		return slab_ddr_acquire(slab, buff);
 #endif
-
 	slab_pool_id = SLAB_POOL_ID_GET(slab_pool_id); /*fetch pool id*/
 
 	if(cluster == 0){
@@ -704,8 +1209,8 @@ SLAB_CODE_PLACEMENT int slab_acquire(struct slab *slab, uint64_t *buff)
 		 * check BMAN pool */
 
 		/* spinlock this BMAN pool counter */
-		lock_spinlock((uint8_t *)&g_slab_bman_pools[slab_virtual_pool->
-		                                            bman_array_index].spinlock);
+		lock_qspinlock(&g_slab_bman_pools[slab_virtual_pool->
+		                                            bman_array_index].lock);
 
 		if ((g_slab_bman_pools[
 		                       slab_virtual_pool->bman_array_index].remaining) > 0)
@@ -715,8 +1220,8 @@ SLAB_CODE_PLACEMENT int slab_acquire(struct slab *slab, uint64_t *buff)
 			[slab_virtual_pool->bman_array_index].remaining--;
 		}
 
-		unlock_spinlock((uint8_t *)&g_slab_bman_pools[slab_virtual_pool->
-		                                              bman_array_index].spinlock);
+		unlock_qspinlock(&g_slab_bman_pools[slab_virtual_pool->
+		                                              bman_array_index].lock);
 	}
 
 	/* Request CDMA to allocate a buffer*/
@@ -807,6 +1312,79 @@ SLAB_CODE_PLACEMENT int slab_acquire(struct slab *slab, uint64_t *buff)
 	}
 }
 
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT static int slab_magazine_acquire(struct slab *slab,
+                                                     uint64_t *buff)
+{
+	int return_val;
+	int32_t credits;
+	uint32_t slab_pool_id = SLAB_VP_POOL_GET(slab);
+	struct slab_magazine *mag =
+		&g_slab_magazines[SLAB_MAGAZINE_GET(slab) - 1];
+	struct slab_magazine_core *mag_core = &mag->core[core_get_id()];
+
+	lock_spinlock((uint8_t *)&mag_core->spinlock);
+	if (mag_core->credits > 0) {
+		mag_core->credits--;
+		mag_core->hits++;
+		unlock_spinlock((uint8_t *)&mag_core->spinlock);
+	} else {
+		mag_core->misses++;
+		unlock_spinlock((uint8_t *)&mag_core->spinlock);
+
+		credits = slab_vp_reserve_bufs(slab_pool_id,
+		                               SLAB_MAGAZINE_BATCH, 1, 0,
+		                               NULL);
+		if (credits == 0) {
+			/* Committed area is in use or cached by other cores,
+			 * take back the cached buffers before going to the
+			 * max-committed area */
+			slab_magazine_drain(mag, slab_pool_id);
+			credits = slab_vp_reserve_bufs(slab_pool_id,
+			                               SLAB_MAGAZINE_BATCH, 1, 0,
+			                               NULL);
+			if (credits == 0)
+				return slab_vp_acquire(slab, buff);
+		}
+
+		if (credits > 1) {
+			lock_spinlock((uint8_t *)&mag_core->spinlock);
+			mag_core->credits += credits - 1;
+			unlock_spinlock((uint8_t *)&mag_core->spinlock);
+		}
+	}
+
+	/* allocate a buffer with the CDMA */
+	return_val = cdma_acquire_context_memory(
+		(uint16_t)g_slab_bman_pools[mag->bman_array_index].bman_pool_id,
+		buff);
+
+	/* If allocation failed, the buffer returns to the magazine */
+	if (return_val) {
+		lock_spinlock((uint8_t *)&mag_core->spinlock);
+		mag_core->credits++;
+		unlock_spinlock((uint8_t *)&mag_core->spinlock);
+		atomic_incr32(&mag->failed_allocs, 1);
+		atomic_incr32(&g_slab_bman_pools[mag->bman_array_index].
+		              failed_allocs, 1);
+	}
+
+	return return_val;
+}
+
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT int slab_acquire(struct slab *slab, uint64_t *buff)
+{
+#ifdef DEBUG
+	SLAB_ASSERT_COND_RETURN(SLAB_IS_HW_POOL(slab), -EINVAL);
+#endif
+
+	if (SLAB_MAGAZINE_GET(slab))
+		return slab_magazine_acquire(slab, buff);
+
+	return slab_vp_acquire(slab, buff);
+}
+
 /*****************************************************************************/
 /* Must be used only in DEBUG */
 #ifdef DEBUG
@@ -855,7 +1433,8 @@ __COLD_CODE static int slab_check_bpid(struct slab *slab, uint64_t buff)
 #endif
 
 /*****************************************************************************/
-SLAB_CODE_PLACEMENT int slab_release(struct slab *slab, uint64_t buff)
+SLAB_CODE_PLACEMENT static int slab_vp_release(struct slab *slab,
+                                               uint64_t buff)
 {
 	uint32_t slab_pool_id = SLAB_VP_POOL_GET(slab);
 	uint16_t cluster = SLAB_CLUSTER_ID_GET(slab_pool_id);
@@ -863,9 +1442,9 @@ SLAB_CODE_PLACEMENT int slab_release(struct slab *slab, uint64_t buff)
 	struct slab_v_pool *slab_virtual_pool;
 	struct slab_v_pool slab_virtual_pool_ddr = {0};
 
-#ifdef DEBUG
-	SLAB_ASSERT_COND_RETURN(SLAB_IS_HW_POOL(slab), -EINVAL);
-	SLAB_ASSERT_COND_RETURN(slab_check_bpid(slab, buff) == 0, -EFAULT);
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	if (cluster != 0)
+		return slab_ddr_release(slab, buff);
 #endif
 	slab_pool_id = SLAB_POOL_ID_GET(slab_pool_id); /*Fetch pool ID*/
 	if(cluster == 0) {
@@ -926,6 +1505,212 @@ SLAB_CODE_PLACEMENT int slab_release(struct slab *slab, uint64_t buff)
 	return 0;
 }
 
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT static int slab_magazine_release(struct slab *slab,
+                                                     uint64_t buff)
+{
+	struct slab_magazine *mag =
+		&g_slab_magazines[SLAB_MAGAZINE_GET(slab) - 1];
+	struct slab_magazine_core *mag_core = &mag->core[core_get_id()];
+
+	/* Only buffers of the committed area are cached, the other ones
+	 * return to the BMAN pool shared with the other slabs */
+	if (slab_vp_extra_bufs(SLAB_VP_POOL_GET(slab)) > 0)
+		return slab_vp_release(slab, buff);
+
+	if (mag->callback_func != NULL)
+		(mag->callback_func)(buff);
+
+	cdma_release_context_memory(buff);
+
+	lock_spinlock((uint8_t *)&mag_core->spinlock);
+	if (mag_core->credits < SLAB_MAGAZINE_SIZE) {
+		mag_core->credits++;
+		mag_core->hits++;
+		unlock_spinlock((uint8_t *)&mag_core->spinlock);
+		return 0;
+	}
+	/* Magazine is full, return a batch together with this buffer */
+	mag_core->credits -= SLAB_MAGAZINE_BATCH;
+	mag_core->misses++;
+	unlock_spinlock((uint8_t *)&mag_core->spinlock);
+
+	slab_vp_unreserve_bufs(SLAB_VP_POOL_GET(slab), SLAB_MAGAZINE_BATCH + 1);
+	return 0;
+}
+
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT int slab_release(struct slab *slab, uint64_t buff)
+{
+#ifdef DEBUG
+	SLAB_ASSERT_COND_RETURN(SLAB_IS_HW_POOL(slab), -EINVAL);
+	SLAB_ASSERT_COND_RETURN(slab_check_bpid(slab, buff) == 0, -EFAULT);
+#endif
+
+	if (SLAB_MAGAZINE_GET(slab))
+		return slab_magazine_release(slab, buff);
+
+	return slab_vp_release(slab, buff);
+}
+
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT int slab_acquire_bulk(struct slab *slab,
+                                          uint32_t num_buffs,
+                                          uint64_t *buffs,
+                                          uint32_t flags)
+{
+	int return_val;
+	int32_t i, reserved = 0, cached = 0, min_buffs;
+	uint32_t slab_pool_id = SLAB_VP_POOL_GET(slab);
+	uint16_t bman_array_index = 0;
+	struct slab_magazine *mag = NULL;
+	struct slab_magazine_core *mag_core;
+
+#ifdef DEBUG
+	SLAB_ASSERT_COND_RETURN(SLAB_IS_HW_POOL(slab), -EINVAL);
+	SLAB_ASSERT_COND_RETURN(buffs != NULL, -EINVAL);
+#endif
+
+	if (num_buffs == 0)
+		return 0;
+
+	/* Buffers cached by this core magazine are used first */
+	if (SLAB_MAGAZINE_GET(slab)) {
+		mag = &g_slab_magazines[SLAB_MAGAZINE_GET(slab) - 1];
+		mag_core = &mag->core[core_get_id()];
+		bman_array_index = mag->bman_array_index;
+
+		lock_spinlock((uint8_t *)&mag_core->spinlock);
+		cached = MIN(mag_core->credits, (int32_t)num_buffs);
+		mag_core->credits -= cached;
+		mag_core->hits += (uint32_t)cached;
+		if (cached < (int32_t)num_buffs)
+			mag_core->misses++;
+		unlock_spinlock((uint8_t *)&mag_core->spinlock);
+	}
+
+	/* All the missing buffers are accounted with a single pool update */
+	if (cached < (int32_t)num_buffs) {
+		min_buffs = (flags & SLAB_BULK_BEST_EFFORT_FLAG) ?
+			1 : (int32_t)num_buffs - cached;
+		reserved = slab_vp_reserve_bufs(slab_pool_id,
+		                                (int32_t)num_buffs - cached,
+		                                min_buffs,
+		                                1,
+		                                &bman_array_index);
+	}
+	reserved += cached;
+
+	if ((reserved == 0) ||
+		((reserved < (int32_t)num_buffs) &&
+			!(flags & SLAB_BULK_BEST_EFFORT_FLAG))) {
+		if (reserved)
+			slab_vp_unreserve_bufs(slab_pool_id, reserved);
+		sl_pr_err("No memory to acquire from\n");
+		return -ENOMEM;
+	}
+
+	/* allocate the buffers with the CDMA */
+	for (i = 0; i < reserved; i++) {
+		return_val = cdma_acquire_context_memory(
+			(uint16_t)g_slab_bman_pools[bman_array_index].
+				bman_pool_id,
+			&buffs[i]);
+		if (return_val) {
+			atomic_incr32(&g_slab_bman_pools[bman_array_index].
+			              failed_allocs, 1);
+			break;
+		}
+	}
+
+	if (i < reserved) {
+		if (!(flags & SLAB_BULK_BEST_EFFORT_FLAG) || (i == 0)) {
+			/* Undo the buffers which were already acquired */
+			while (i > 0)
+				cdma_refcount_decrement_and_release(buffs[--i]);
+			slab_vp_unreserve_bufs(slab_pool_id, reserved);
+			return return_val;
+		}
+		slab_vp_unreserve_bufs(slab_pool_id, reserved - i);
+		reserved = i;
+	}
+
+	return (int)reserved;
+}
+
+/*****************************************************************************/
+SLAB_CODE_PLACEMENT int slab_release_bulk(struct slab *slab,
+                                          uint32_t num_buffs,
+                                          uint64_t *buffs)
+{
+	uint32_t i;
+	int32_t cached = 0, extra;
+	uint32_t slab_pool_id = SLAB_VP_POOL_GET(slab);
+	uint16_t cluster = SLAB_CLUSTER_ID_GET(slab_pool_id);
+	slab_release_cb_t *callback_func;
+	struct slab_v_pool slab_virtual_pool_ddr;
+	struct slab_magazine *mag = NULL;
+	struct slab_magazine_core *mag_core;
+
+#ifdef DEBUG
+	SLAB_ASSERT_COND_RETURN(SLAB_IS_HW_POOL(slab), -EINVAL);
+	SLAB_ASSERT_COND_RETURN(buffs != NULL, -EINVAL);
+	for (i = 0; i < num_buffs; i++)
+		SLAB_ASSERT_COND_RETURN(slab_check_bpid(slab, buffs[i]) == 0,
+		                        -EFAULT);
+#endif
+
+	if (num_buffs == 0)
+		return 0;
+
+	if (SLAB_MAGAZINE_GET(slab)) {
+		mag = &g_slab_magazines[SLAB_MAGAZINE_GET(slab) - 1];
+		callback_func = mag->callback_func;
+	} else if (cluster == 0) {
+		callback_func = (g_slab_virtual_pools.virtual_pool_struct +
+			SLAB_POOL_ID_GET(slab_pool_id))->callback_func;
+	} else {
+		/* callback is not modified while the slab exists */
+		cdma_read(&slab_virtual_pool_ddr,
+		          g_slab_virtual_pools.slab_context_address[cluster] +
+		          (sizeof(slab_virtual_pool_ddr) *
+		        	  SLAB_POOL_ID_GET(slab_pool_id)),
+		          (uint16_t)sizeof(slab_virtual_pool_ddr));
+		callback_func = slab_virtual_pool_ddr.callback_func;
+	}
+
+	for (i = 0; i < num_buffs; i++) {
+		if (callback_func != NULL)
+			(callback_func)(buffs[i]);
+		cdma_release_context_memory(buffs[i]);
+	}
+
+	/* Keep as many buffers of the committed area as possible in this core
+	 * magazine, the buffers above it return to the BMAN pool */
+	if (mag != NULL) {
+		extra = slab_vp_extra_bufs(slab_pool_id);
+		if (extra < 0)
+			extra = 0;
+		mag_core = &mag->core[core_get_id()];
+		lock_spinlock((uint8_t *)&mag_core->spinlock);
+		cached = MIN(SLAB_MAGAZINE_SIZE - mag_core->credits,
+		             (int32_t)num_buffs - extra);
+		if (cached < 0)
+			cached = 0;
+		mag_core->credits += cached;
+		mag_core->hits += (uint32_t)cached;
+		if (cached < (int32_t)num_buffs)
+			mag_core->misses++;
+		unlock_spinlock((uint8_t *)&mag_core->spinlock);
+	}
+
+	/* All the other buffers are accounted with a single pool update */
+	if (cached < (int32_t)num_buffs)
+		slab_vp_unreserve_bufs(slab_pool_id,
+		                       (int32_t)num_buffs - cached);
+	return 0;
+}
+
 /*****************************************************************************/
 __COLD_CODE static int dpbp_add(struct dprc_obj_desc *dev_desc,
                                 struct slab_bpid_info *bpids_arr,
@@ -1530,6 +2315,10 @@ __COLD_CODE int slab_module_init(void)
 				fsl_malloc((sizeof(struct slab_v_pool) *
 					SLAB_MAX_NUM_VP_SHRAM),1);
 
+	g_slab_magazines = (struct slab_magazine *)
+				fsl_malloc((sizeof(struct slab_magazine) *
+					SLAB_MAX_NUM_MAGAZINES),1);
+
 
 	err = dpbp_discovery(bpids_arr_init, &num_bpids);
 	if (err) {
@@ -1557,12 +2346,24 @@ __COLD_CODE int slab_module_init(void)
 
 	if ((slab_m->hw_pools == NULL) ||
 		(virtual_pool_struct == NULL) ||
+		(g_slab_magazines == NULL) ||
 		(err))
 	{
 		free_slab_module_memory(slab_m);
 		return -ENOMEM;
 	}
 
+#ifdef SLAB_DDR_STE_ACCOUNTING
+	g_slab_ddr_credits = (struct slab_ddr_credit *)
+		fsl_malloc((sizeof(struct slab_ddr_credit) *
+			SLAB_MAX_NUM_VP_DDR *
+			num_clusters_for_ddr_mamangement_pools), 1);
+	if (g_slab_ddr_credits == NULL) {
+		free_slab_module_memory(slab_m);
+		return -ENOMEM;
+	}
+#endif
+
 	g_slab_pool_pointer_ddr = ddr_pool_addr;
 
 	g_slab_last_pool_pointer_ddr = ddr_pool_addr + (SLAB_MAX_NUM_VP_DDR *
@@ -1573,6 +2374,10 @@ __COLD_CODE int slab_module_init(void)
 	               SLAB_MAX_NUM_VP_SHRAM,
 	               0);
 
+	/* slab = 0 indicates a free magazine */
+	memset(g_slab_magazines, 0,
+	       sizeof(struct slab_magazine) * SLAB_MAX_NUM_MAGAZINES);
+
 	/* AIOP ICID and AMQ bits are needed for filling BPID */
 	icontext_aiop_get(&ic);
 
@@ -1641,6 +2446,7 @@ __COLD_CODE int slab_debug_info_get(struct slab *slab, struct slab_debug_info *s
 	uint8_t flags =0;
 	int     i;
 	slab_release_cb_t *release_cb = NULL;
+	struct slab_magazine *mag;
 	struct slab_module_info *slab_m = \
 		sys_get_unique_handle(FSL_MOD_SLAB);
 
@@ -1661,6 +2467,28 @@ __COLD_CODE int slab_debug_info_get(struct slab *slab, struct slab_debug_info *s
 			slab_info->allocated_buffs = (uint32_t)allocated;
 			slab_info->num_buff_free = (uint32_t)free_bufs_in_pool;
 			slab_info->num_failed_allocs = (uint32_t)failed_allocs;
+			slab_info->magazine_cached_buffs = 0;
+			slab_info->magazine_hits = 0;
+			slab_info->magazine_misses = 0;
+			if (SLAB_MAGAZINE_GET(slab)) {
+				mag = &g_slab_magazines[SLAB_MAGAZINE_GET(slab) - 1];
+				for (i = 0; i < INTG_MAX_NUM_OF_CORES; i++) {
+					slab_info->magazine_cached_buffs +=
+						(uint32_t)mag->core[i].credits;
+					slab_info->magazine_hits +=
+						mag->core[i].hits;
+					slab_info->magazine_misses +=
+						mag->core[i].misses;
+				}
+				/* Cached buffers are accounted as allocated in
+				 * the pool but they are not in use */
+				slab_info->allocated_buffs -=
+					slab_info->magazine_cached_buffs;
+				slab_info->num_buff_free +=
+					slab_info->magazine_cached_buffs;
+				slab_info->num_failed_allocs +=
+					(uint32_t)mag->failed_allocs;
+			}
 			temp = slab_m->num_hw_pools;
 			for (i = 0; i < temp; i++)
 				CP_POOL_DATA(slab_m, slab_info, i);
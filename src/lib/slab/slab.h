@@ -37,6 +37,8 @@
 
 #include "fsl_sl_slab.h"
 #include "fsl_bman.h"
+#include "fsl_soc.h"
+#include "kernel/fsl_spinlock.h"
 
 #define SLAB_HW_HANDLE(SLAB) ((uint32_t)(SLAB)) /**< Casted HW handle */
 
@@ -57,6 +59,8 @@
  * 31----------23--------15------1--------0
  * | HW accel   |cluster | VP ID |HW flg  |
  * ----------------------------------------
+ *
+ * HW accel bits 31-25 hold the magazine index + 1 (0 - no magazine)
  */
 #define SLAB_VP_POOL_MASK      0x01FFFFFE       /*Cluster and VP ID - 23 bits */
 #define SLAB_POOL_ID_MASK      0x00007FFF       /*VP ID - 15 bits */
@@ -85,6 +89,15 @@
  * optimization flag is not set
  */
 
+#define SLAB_MAGAZINE_MASK     0xFE000000       /*Magazine index + 1 - 7 bits */
+#define SLAB_MAGAZINE_SHIFT    25
+#define SLAB_MAGAZINE_GET(SLAB) \
+	((uint32_t)((SLAB_HW_HANDLE(SLAB) & SLAB_MAGAZINE_MASK) >> \
+		SLAB_MAGAZINE_SHIFT))
+/**< Returns slab's magazine index + 1, 0 if the slab has no magazine */
+#define SLAB_MAGAZINE_SET(MAG) \
+	((uint32_t)(((uint32_t)(MAG) << SLAB_MAGAZINE_SHIFT) & SLAB_MAGAZINE_MASK))
+
 #define SLAB_HW_POOL_CREATE(VP) \
 ((((VP) & (SLAB_VP_POOL_MASK >> SLAB_VP_POOL_SHIFT)) << SLAB_VP_POOL_SHIFT) \
 	| SLAB_HW_POOL_SET)
@@ -105,6 +118,13 @@
 /* Maximum number of BMAN pools used by the slab pools array */
 #define SLAB_MAX_BMAN_POOLS_NUM			16
 
+/* Maximum number of slabs which can be created with SLAB_MAGAZINE_FLAG */
+#define SLAB_MAX_NUM_MAGAZINES			8
+/* Maximum number of buffers cached by a single core magazine */
+#define SLAB_MAGAZINE_SIZE			32
+/* Number of buffers moved between a core magazine and the virtual pool */
+#define SLAB_MAGAZINE_BATCH			16
+
 /**************************************************************************//**
 @Description   Information for every bpid
 *//***************************************************************************/
@@ -190,14 +210,69 @@ struct slab_bman_pool_desc {
 	/**< Number of allocated buffers in the bman pool */
 	int32_t failed_allocs;
 	/**< Number of failures to allocate buffers in the bman pool */
-	uint8_t spinlock;
-	/**< Spinlock for locking bman pool */
+	struct qspinlock lock;
+	/**< Queued spinlock for locking bman pool */
 	uint8_t flags;
 	/**< Flags to use when using the pool - unused  */
 	uint16_t bman_pool_id;
 	/**< Bman pool id - bpid  */
 };
 
+#ifdef SLAB_DDR_STE_ACCOUNTING
+/* DDR managed virtual pool accounting kept in shared RAM.
+ * The allocated/failed counters of the DDR virtual pool are STE counters,
+ * they may lag the updates still queued by other tasks and are only
+ * written, the service layer reads the accounting from here */
+struct slab_ddr_credit {
+	int32_t credits;
+	/**< Number of committed buffers which are not allocated */
+	int32_t committed_bufs;
+	/**< Number of requested committed buffers per pool */
+	int32_t extra_bufs;
+	/**< Number of buffers allocated above the committed area */
+	int32_t failed_allocs;
+	/**< Number of failed allocations */
+	uint16_t bman_array_index;
+	/**< Index of bman pool that the buffers were taken from*/
+	uint8_t spinlock;
+	/**< spinlock for locking the credits */
+	uint8_t flags;
+	/**< SLAB_DDR_CREDIT_CB_FLAG if the pool has a release callback */
+};
+
+#define SLAB_DDR_CREDIT_CB_FLAG	0x01
+/**< Release callback exists, read it from the DDR virtual pool */
+#define SLAB_DDR_CREDIT_INDEX(CLUSTER, POOL) \
+	((((uint32_t)(CLUSTER)) - 1) * SLAB_MAX_NUM_VP_DDR + (POOL))
+/**< Index of the DDR virtual pool credits, cluster 0 is not in DDR */
+#endif /* SLAB_DDR_STE_ACCOUNTING */
+
+/* Core magazine structure - buffers cached by a single core */
+struct slab_magazine_core {
+	int32_t credits;
+	/**< Number of buffers accounted in the virtual pool and cached here */
+	uint32_t hits;
+	/**< Number of acquire/release served by this core magazine */
+	uint32_t misses;
+	/**< Number of acquire/release which had to access the virtual pool */
+	uint8_t spinlock;
+	/**< Spinlock for locking the core magazine */
+};
+
+/* Magazine structure - per core buffers cache in front of a virtual pool */
+struct slab_magazine {
+	uint32_t slab;
+	/**< Handle of the slab which uses this magazine, 0 - magazine free */
+	slab_release_cb_t *callback_func;
+	/**< Copy of the virtual pool release callback */
+	int32_t failed_allocs;
+	/**< Number of failed allocs served by the magazine */
+	uint16_t bman_array_index;
+	/**< Copy of the virtual pool bman pool index */
+	struct slab_magazine_core core[INTG_MAX_NUM_OF_CORES];
+	/**< Per core magazines */
+};
+
 /* virtual root pool struct - holds all virtual pools data */
 struct slab_virtual_pools_main_desc {
 	struct slab_v_pool *virtual_pool_struct; /*cluster 0*/
@@ -210,8 +285,8 @@ struct slab_virtual_pools_main_desc {
 	/**< number of cluster for pools in DDR*/
 	uint8_t flags;
 	/**< Flags to use when using the pools - unused  */
-	uint8_t global_spinlock;
-	/**< Spinlock for locking the global virtual root pool */
+	struct qspinlock global_lock;
+	/**< Queued spinlock for locking the global virtual root pool */
 };
 
 /* defined array of available buffer sizes that can be requested*/
@@ -49,6 +49,7 @@ static  int check_returned_get_mem_address(uint64_t paddr,
                                    t_mem_mng_phys_addr_alloc_info* part_info);
 static int shared_ram_allocate_check_mem(uint32_t num_iter, uint32_t size,
 		                      void **allocated_pointers);
+static int size_class_test();
 
 static int mem_depletion_test(e_memory_partition_id mem_partition,
                               const uint32_t max_alloc_size,
@@ -190,6 +191,13 @@ int malloc_test()
 	local_error = get_mem_test();
 	err |= local_error;
 
+	local_error = size_class_test();
+	if (local_error)
+		fsl_print("size_class_test failed\n");
+	else
+		fsl_print("size_class_test succeeded\n");
+	err |= local_error;
+
 	/* Check depletion through fsl_malloc() function */
 	cdma_mutex_lock_take((uint64_t)&s_shared_ram_lock,CDMA_MUTEX_WRITE_LOCK);
 	local_error = shared_ram_allocate_check_mem(num_iter,size,allocated_pointers);
@@ -298,6 +306,53 @@ static int shared_ram_allocate_check_mem(uint32_t num_iter, uint32_t size,
 	return 0;
 }
 
+/* Small allocations of every size class must be distinct and aligned to the
+ * class size, also after they are freed and allocated again */
+static int size_class_test()
+{
+	uint64_t paddr[NUM_TEST_ITER];
+	void *vaddr[NUM_TEST_ITER];
+	uint32_t size, round;
+	int i, j;
+
+	for (size = MEM_MNG_SC_MIN_SIZE; size <= MEM_MNG_SC_MAX_SIZE;
+		size <<= 1) {
+		for (round = 0; round < 2; round++) {
+			for (i = 0; s_dp_ddr_mem_exists && i < NUM_TEST_ITER; i++) {
+				if (fsl_get_mem(size, MEM_PART_DP_DDR, size,
+				                &paddr[i]))
+					return -ENOMEM;
+				if (check_returned_get_mem_address(paddr[i],
+				                                   size, size,
+				                                   &dp_ddr_info))
+					return -EFAULT;
+				for (j = 0; j < i; j++)
+					if (paddr[j] == paddr[i])
+						return -EEXIST;
+			}
+			for (i = 0; s_dp_ddr_mem_exists && i < NUM_TEST_ITER; i++)
+				fsl_put_mem(paddr[i]);
+
+			for (i = 0; s_shared_ram_eixsts && i < NUM_TEST_ITER; i++) {
+				vaddr[i] = fsl_malloc(size, size);
+				if (vaddr[i] == NULL)
+					return -ENOMEM;
+				if (check_returned_malloc_address(
+					(uint32_t)vaddr[i], size, size,
+					&sh_ram_info))
+					return -EFAULT;
+				for (j = 0; j < i; j++)
+					if (vaddr[j] == vaddr[i])
+						return -EEXIST;
+			}
+			for (i = 0; s_shared_ram_eixsts && i < NUM_TEST_ITER; i++)
+				fsl_free(vaddr[i]);
+		}
+	}
+
+	return 0;
+}
+
 /* fsl_malloc()/fsl_free() is not relevant any more,
  migrated to fsl_get_mem()/fsl_free()
  */
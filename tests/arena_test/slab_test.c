@@ -42,6 +42,8 @@ int slab_test(void);
 extern struct slab_virtual_pools_main_desc g_slab_virtual_pools;
 extern struct slab_bman_pool_desc g_slab_bman_pools[SLAB_MAX_BMAN_POOLS_NUM];
 int app_test_slab_overload_test();
+int app_test_slab_magazine(void);
+int app_test_slab_bulk(void);
 int app_test_slab(struct slab *slab, int num_times, enum memory_partition_id mem_pid, uint16_t alignment);
 
 static void slab_callback_test(uint64_t context_address){
@@ -67,6 +69,18 @@ int slab_init(void)
 		return err;
 	}
 
+	err = app_test_slab_magazine();
+	if (err) {
+		fsl_print("ERROR = %d: app_test_slab_magazine()\n", err);
+		return err;
+	}
+
+	err = app_test_slab_bulk();
+	if (err) {
+		fsl_print("ERROR = %d: app_test_slab_bulk()\n", err);
+		return err;
+	}
+
 	/*err = app_test_slab_overload_test();
 	if (err) {
 		fsl_print("ERROR = %d: app_test_slab_overload_test()\n", err);
@@ -298,6 +312,105 @@ int app_test_slab_init(void)
 	return 0;
 }
 
+int app_test_slab_magazine(void)
+{
+	int        err = 0, i;
+	uint64_t buff[6];
+	struct slab *my_slab;
+	struct slab_debug_info slab_info;
+
+	err = slab_create(4, 6, 248, 8, MEM_PART_PEB, SLAB_MAGAZINE_FLAG,
+	                  NULL, &my_slab);
+	if (err) return err;
+
+	/* Committed buffers are served by the magazine, the rest by the pool */
+	for (i = 0; i < 6; i++) {
+		err = slab_acquire(my_slab, &buff[i]);
+		if (err) return err;
+	}
+
+	err = slab_acquire(my_slab, &buff[0]);
+	if (!err) return -EEXIST;
+	else
+		fsl_print("PASSED - Acquire more buffers than MAX failed\n");
+
+	for (i = 0; i < 6; i++) {
+		if (slab_refcount_decr(buff[i]) == SLAB_CDMA_REFCOUNT_DECREMENT_TO_ZERO){
+			err = slab_release(my_slab, buff[i]);
+			if (err) return err;
+		}
+		else
+			return -ENODEV;
+	}
+
+	/* Second round must be served by the magazine only */
+	for (i = 0; i < 4; i++) {
+		err = slab_acquire(my_slab, &buff[i]);
+		if (err) return err;
+	}
+	for (i = 0; i < 4; i++) {
+		if (slab_refcount_decr(buff[i]) == SLAB_CDMA_REFCOUNT_DECREMENT_TO_ZERO){
+			err = slab_release(my_slab, buff[i]);
+			if (err) return err;
+		}
+		else
+			return -ENODEV;
+	}
+
+	slab_debug_info_get(my_slab, &slab_info);
+	fsl_print("Magazine: cached %d, hits %d, misses %d\n",
+	          slab_info.magazine_cached_buffs, slab_info.magazine_hits,
+	          slab_info.magazine_misses);
+	if ((slab_info.allocated_buffs != 0) ||
+		(slab_info.magazine_hits == 0))
+		return -ENODEV;
+
+	/* Cached buffers must be drained back to the pool */
+	err = slab_free(&my_slab);
+	if (err) return err;
+
+	return 0;
+}
+
+int app_test_slab_bulk(void)
+{
+	int        err = 0, i, num;
+	uint64_t buff[8];
+	struct slab *my_slab;
+	struct slab_debug_info slab_info;
+
+	err = slab_create(4, 6, 248, 8, MEM_PART_PEB, 0,
+	                  NULL, &my_slab);
+	if (err) return err;
+
+	/* All or nothing - more than MAX must fail without side effects */
+	num = slab_acquire_bulk(my_slab, 8, buff, 0);
+	if (num >= 0) return -EEXIST;
+	else
+		fsl_print("PASSED - Bulk acquire more buffers than MAX failed\n");
+
+	/* Best effort - get up to MAX */
+	num = slab_acquire_bulk(my_slab, 8, buff, SLAB_BULK_BEST_EFFORT_FLAG);
+	if (num != 6) return -ENOMEM;
+
+	for (i = 0; i < num; i++)
+		if (slab_refcount_decr(buff[i]) !=
+			SLAB_CDMA_REFCOUNT_DECREMENT_TO_ZERO)
+			return -ENODEV;
+
+	err = slab_release_bulk(my_slab, (uint32_t)num, buff);
+	if (err) return err;
+
+	slab_debug_info_get(my_slab, &slab_info);
+	if (slab_info.allocated_buffs != 0)
+		return -ENODEV;
+
+	err = slab_free(&my_slab);
+	if (err) return err;
+
+	return 0;
+}
+
 static int app_write_buff_and_release(struct slab *slab, uint64_t buff)
 {
 	uint64_t data1 = 0xAABBCCDD00001122;
@@ -33,6 +33,7 @@
 #include "fsl_cmdif_server.h"
 #include "fsl_cmdif_client.h"
 #include "cmdif.h"
+#include "fsl_cmdif_flib_fd.h"
 #include "cmdif_client.h"
 #include "fsl_fdma.h"
 #include "fdma.h"
@@ -43,6 +44,7 @@
 #include "fsl_malloc.h"
 #include "fsl_shbp.h"
 #include "fsl_spinlock.h"
+#include "fsl_time.h"
 #include "cmdif_test_common.h"
 #include "apps.h"
 
@@ -60,6 +62,8 @@ extern int app_evm_register();
 #endif
 
 #define TIMEOUT_IN_SECONDS	60
+#define BATCH_TEST_CMDS		4096
+#define BATCH_TEST_MAX		64
 
 struct cmdif_desc cidesc;
 /** Counters ***/
@@ -100,6 +104,76 @@ __HOT_CODE static void tman_cb(uint64_t opaque1, uint16_t opaque2)
 	timer_deleted = 1;
 }
 
+static void batch_wait_done(struct icontext *ic, struct cmdif_batch *batch)
+{
+	struct cmdif_batch_hdr hdr;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		do {
+			icontext_dma_read(ic, sizeof(hdr),
+			                  batch->data + i * batch->half_size,
+			                  &hdr);
+		} while (!hdr.done);
+	}
+}
+
+/*
+ * AIOP client sends BATCH_TEST_CMDS no response commands to GPP server
+ * for each batch size 1..BATCH_TEST_MAX.
+ * GPP should register "IRA" module and send PERF_TEST_BATCH command with
+ * DPCI id at the first byte of the data. The command data buffer is reused
+ * for the batched commands, it should be at least 1KB.
+ */
+static void batch_test(uint8_t dpci_id, uint64_t p_data, uint32_t size)
+{
+	struct cmdif_desc cl_desc;
+	struct cmdif_batch batch;
+	struct icontext ic;
+	uint32_t start, end;
+	uint32_t i;
+	uint16_t b;
+	int err;
+
+	cl_desc.regs = (void *)dpci_id;
+	err = cmdif_open(&cl_desc, "IRA", 0, NULL, 0);
+	if (err) {
+		pr_err("cmdif_open() to DPCI%d err = %d\n", dpci_id, err);
+		return;
+	}
+	err = icontext_get(dpci_id, &ic);
+	ASSERT_COND(!err);
+
+	for (b = 1; b <= BATCH_TEST_MAX; b <<= 1) {
+		err = cmdif_batch_init(&batch, &cl_desc, CMDIF_PRI_LOW,
+		                       p_data, size, b);
+		if (err) {
+			pr_err("cmdif_batch_init() err = %d\n", err);
+			break;
+		}
+
+		fsl_get_time_ms(&start);
+		for (i = 0; i < BATCH_TEST_CMDS; ) {
+			err = cmdif_batch_send(&batch, PERF_BATCH_NOTIFY,
+			                       sizeof(i), &i);
+			if (err == -EBUSY)
+				continue; /* GPP didn't finish the previous frame */
+			if (err)
+				break;
+			i++;
+		}
+		err |= cmdif_batch_flush(&batch);
+		batch_wait_done(&ic, &batch);
+		fsl_get_time_ms(&end);
+
+		end = (end > start) ? (end - start) : 1;
+		fsl_print("Batch size %d: %d commands in %d ms, %d commands/sec, err = %d\n",
+		          b, i, end, (i * 1000) / end, err);
+	}
+
+	cmdif_close(&cl_desc);
+}
+
 __HOT_CODE static int ctrl_cb0(void *dev, uint16_t cmd, 
                                uint32_t size, void *data)
 {
@@ -135,6 +209,12 @@ __HOT_CODE static int ctrl_cb0(void *dev, uint16_t cmd,
 		}
 	}
 
+	if (cmd == PERF_TEST_BATCH) {
+		batch_test(((uint8_t *)data)[0],
+		           LDPAA_FD_GET_ADDR(HWC_FD_ADDRESS), size);
+		return 0;
+	}
+
 	if (timer_on) {
 		atomic_incr32(&cmd_count, 1);
 	}
@@ -50,6 +50,8 @@
 #define DPCI_RM		(0x113 | CMDIF_NORESP_CMD)
 #define RCU_SYNC_TEST	(0x114 | CMDIF_NORESP_CMD)
 #define RCU_SYNC_CHECK	0x115
+#define PERF_TEST_BATCH	(0x116 | CMDIF_NORESP_CMD)
+#define PERF_BATCH_NOTIFY	(0x117 | CMDIF_NORESP_CMD)
 
 #define AIOP_ASYNC_CB_DONE	5  /* Must be in sync with MC ELF */
 #define AIOP_SYNC_BUFF_SIZE	80 /* Must be in sync with MC ELF */